@@ -1397,6 +1397,7 @@ void MainWindow::updateSettings()
 
     // Cache
     m_controlView->marbleModel()->setPersistentTileCacheLimit( m_configDialog->persistentTileCacheLimit() * 1024 );
+    m_controlView->marbleModel()->setPackedTileCache( m_configDialog->packedTileCache() );
     m_controlView->marbleWidget()->setVolatileTileCacheLimit( m_configDialog->volatileTileCacheLimit() * 1024 );
 
     /*
@@ -42,6 +42,12 @@ DiscCache::DiscCache( const QString &cacheDirectory )
             s >> m_CurrentCacheSize;
             s >> m_Entries;
 
+            QMap<QString, Entry>::const_iterator it = m_Entries.constBegin();
+            QMap<QString, Entry>::const_iterator const end = m_Entries.constEnd();
+            for (; it != end; ++it ) {
+                m_AccessOrder.insert( qMakePair( it.value().first, it.key() ), true );
+            }
+
         } else {
             qWarning( "Unable to open cache directory %s", qPrintable( m_CacheDirectory ) );
         }
@@ -85,6 +91,7 @@ void DiscCache::clear()
 
     // Delete entries
     m_Entries.clear();
+    m_AccessOrder.clear();
 
     // Reset current cache size
     m_CurrentCacheSize = 0;
@@ -106,7 +113,7 @@ bool DiscCache::find( const QString &key, QByteArray &data )
     if ( file.open( QIODevice::ReadOnly ) ) {
         data = file.readAll();
 
-        m_Entries[ key ].first = QDateTime::currentDateTime();
+        setEntry( key, Entry( QDateTime::currentDateTime(), m_Entries.value( key ).second ) );
         return true;
     }
 
@@ -128,7 +135,7 @@ bool DiscCache::insert( const QString &key, const QByteArray &data )
     file.write( data );
 
     // Create/Overwrite with a new entry
-    m_Entries.insert( key, QPair<QDateTime, quint64>(QDateTime::currentDateTime(), data.length()) );
+    setEntry( key, Entry( QDateTime::currentDateTime(), data.length() ) );
 
     // Add the size of the new entry
     m_CurrentCacheSize += data.length();
@@ -146,14 +153,17 @@ void DiscCache::remove( const QString &key )
 
     // If we can't remove the file we don't remove
     // the entry to prevent inconsistency
-    if ( !QFile::remove( keyToFileName( key ) ) )
+    const QString fileName = keyToFileName( key );
+    if ( !QFile::remove( fileName ) && QFile::exists( fileName ) )
         return;
 
     // Subtract from current size
-    m_CurrentCacheSize -= m_Entries.value( key ).second;
+    const Entry entry = m_Entries.value( key );
+    m_CurrentCacheSize -= entry.second;
 
     // Finally remove entry
     m_Entries.remove( key );
+    m_AccessOrder.remove( qMakePair( entry.first, key ) );
 }
 
 void DiscCache::setCacheLimit( quint64 n )
@@ -171,29 +181,32 @@ QString DiscCache::keyToFileName( const QString &key )
     return m_CacheDirectory + '/' + fileName;
 }
 
+void DiscCache::setEntry( const QString &key, const Entry &entry )
+{
+    QMap<QString, Entry>::iterator it = m_Entries.find( key );
+    if ( it != m_Entries.end() ) {
+        m_AccessOrder.remove( qMakePair( it.value().first, key ) );
+        it.value() = entry;
+    } else {
+        m_Entries.insert( key, entry );
+    }
+
+    m_AccessOrder.insert( qMakePair( entry.first, key ), true );
+}
+
 void DiscCache::cleanup()
 {
     // Calculate 5% of our current cache limit
     quint64 fivePercent = quint64( m_CacheLimit * 0.05 );
 
-    while ( m_CurrentCacheSize > (m_CacheLimit - fivePercent) ) {
-        QDateTime oldestDate( QDateTime::currentDateTime() );
-        QString oldestKey;
-
-        QMapIterator<QString, QPair<QDateTime, quint64> > it( m_Entries );
-        while ( it.hasNext() ) {
-            it.next();
-
-            if ( it.value().first < oldestDate ) {
-                oldestDate = it.value().first;
-                oldestKey = it.key();
-            }
-        }
+    while ( m_CurrentCacheSize > (m_CacheLimit - fivePercent) && !m_AccessOrder.isEmpty() ) {
+        // The least recently used key comes first
+        const QString oldestKey = m_AccessOrder.constBegin().key().second;
+        remove( oldestKey );
 
-        if ( !oldestKey.isEmpty() ) {
-            // We found the oldest key, so using remove() to
-            // remove it from cache
-            remove( oldestKey );
+        if ( m_Entries.contains( oldestKey ) ) {
+            // The file could not be removed, try again later
+            break;
         }
     }
 }
@@ -16,12 +16,14 @@
 #include <QtCore/QPair>
 #include <QtCore/QString>
 
+#include "marble_export.h"
+
 class QByteArray;
 
 namespace Marble
 {
 
-class DiscCache
+class MARBLE_EXPORT DiscCache
 {
     public:
         explicit DiscCache( const QString &cacheDirectory );
@@ -36,15 +38,20 @@ class DiscCache
         void setCacheLimit( quint64 n );
 
     private:
+        typedef QPair<QDateTime, quint64> Entry;
+
         QString keyToFileName( const QString& );
+        void setEntry( const QString &key, const Entry &entry );
         void cleanup();
 
         QString m_CacheDirectory;
         quint64 m_CacheLimit;
         quint64 m_CurrentCacheSize;
 
-        typedef QPair<QDateTime, quint64> Entry;
         QMap<QString, Entry> m_Entries;
+
+        // The keys ordered by their access time, oldest first
+        QMap<QPair<QDateTime, QString>, bool> m_AccessOrder;
 };
 
 }
@@ -0,0 +1,271 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include "DocumentCache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataMultiGeometry.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTypes.h"
+#include "MarbleDebug.h"
+#include "MarbleDirs.h"
+
+namespace Marble
+{
+
+static const quint32 documentCacheMagicNumber = 0x4d444331; // "MDC1"
+
+// Increase whenever the serialization of any GeoData class changes
+static const qint32 documentCacheVersion = 3;
+
+static const QDataStream::Version documentCacheStreamVersion = QDataStream::Qt_4_6;
+
+static bool isCacheable( const GeoDataGeometry *geometry )
+{
+    const char *const nodeType = geometry->nodeType();
+    if ( nodeType == GeoDataTypes::GeoDataMultiGeometryType ) {
+        const GeoDataMultiGeometry *multiGeometry = static_cast<const GeoDataMultiGeometry*>( geometry );
+        QVector<GeoDataGeometry*>::ConstIterator it = multiGeometry->constBegin();
+        QVector<GeoDataGeometry*>::ConstIterator const end = multiGeometry->constEnd();
+        for ( ; it != end; ++it ) {
+            if ( !isCacheable( *it ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return nodeType == GeoDataTypes::GeoDataPointType
+        || nodeType == GeoDataTypes::GeoDataLineStringType
+        || nodeType == GeoDataTypes::GeoDataLinearRingType
+        || nodeType == GeoDataTypes::GeoDataPolygonType
+        || nodeType == GeoDataTypes::GeoDataTrackType
+        || nodeType == GeoDataTypes::GeoDataMultiTrackType;
+}
+
+static bool isCacheable( const GeoDataContainer *container )
+{
+    QVector<GeoDataFeature*>::ConstIterator it = container->constBegin();
+    QVector<GeoDataFeature*>::ConstIterator const end = container->constEnd();
+    for ( ; it != end; ++it ) {
+        const char *const nodeType = (*it)->nodeType();
+        if ( nodeType == GeoDataTypes::GeoDataFolderType ) {
+            if ( !isCacheable( static_cast<const GeoDataContainer*>( *it ) ) ) {
+                return false;
+            }
+        } else if ( nodeType == GeoDataTypes::GeoDataPlacemarkType ) {
+            const GeoDataGeometry *geometry = static_cast<const GeoDataPlacemark*>( *it )->geometry();
+            if ( geometry && !isCacheable( geometry ) ) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void writeHeader( QDataStream &stream, const QString &sourceFile, const GeoDataDocument *document, bool hasDocument )
+{
+    const QFileInfo sourceInfo( sourceFile );
+
+    stream.setVersion( documentCacheStreamVersion );
+    stream << documentCacheMagicNumber << documentCacheVersion;
+    stream << sourceInfo.absoluteFilePath() << sourceInfo.size() << sourceInfo.lastModified();
+
+    // Allows to order loading by the viewport without unpacking the document
+    const GeoDataLatLonAltBox bounds = document->latLonAltBox();
+    stream << double( bounds.north() ) << double( bounds.south() )
+           << double( bounds.east() ) << double( bounds.west() );
+    stream << hasDocument;
+}
+
+/**
+ * Reads the header of a cache file and checks whether it still belongs to the
+ * source file described by @p sourceInfo. @p hasDocument is set to false if
+ * the file only holds the bounding box.
+ */
+static bool readHeader( QDataStream &stream, const QFileInfo &sourceInfo, GeoDataLatLonBox &bounds, bool &hasDocument )
+{
+    quint32 magicNumber;
+    qint32 version;
+    stream >> magicNumber >> version;
+    if ( magicNumber != documentCacheMagicNumber || version != documentCacheVersion ) {
+        return false;
+    }
+
+    QString sourcePath;
+    qint64 sourceSize;
+    QDateTime sourceLastModified;
+    double north, south, east, west;
+    stream >> sourcePath >> sourceSize >> sourceLastModified;
+    stream >> north >> south >> east >> west;
+    stream >> hasDocument;
+    if ( stream.status() != QDataStream::Ok
+         || sourcePath != sourceInfo.absoluteFilePath()
+         || sourceSize != sourceInfo.size()
+         || sourceLastModified != sourceInfo.lastModified() ) {
+        return false;
+    }
+
+    bounds = GeoDataLatLonBox( north, south, east, west );
+    return true;
+}
+
+DocumentCache::DocumentCache( const QString &cacheDirectory ) :
+    m_cacheDirectory( cacheDirectory )
+{
+    if ( m_cacheDirectory.isEmpty() ) {
+        m_cacheDirectory = MarbleDirs::localPath() + "/cache/documents";
+    }
+}
+
+QString DocumentCache::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+QString DocumentCache::cacheFile( const QString &sourceFile ) const
+{
+    const QByteArray path = QFileInfo( sourceFile ).absoluteFilePath().toUtf8();
+    const QByteArray hash = QCryptographicHash::hash( path, QCryptographicHash::Sha1 ).toHex();
+    return m_cacheDirectory + '/' + QString::fromLatin1( hash ) + ".cache";
+}
+
+bool DocumentCache::isCacheable( const QString &sourceFile )
+{
+    const QString suffix = QFileInfo( sourceFile ).suffix().toLower();
+    return suffix == "kml" || suffix == "gpx" || suffix == "osm";
+}
+
+bool DocumentCache::isCacheable( const GeoDataDocument *document )
+{
+    return Marble::isCacheable( static_cast<const GeoDataContainer*>( document ) );
+}
+
+GeoDataDocument *DocumentCache::load( const QString &sourceFile ) const
+{
+    const QFileInfo sourceInfo( sourceFile );
+    QFile file( cacheFile( sourceFile ) );
+    if ( !sourceInfo.exists() || !file.open( QIODevice::ReadOnly ) || file.size() == 0 ) {
+        return 0;
+    }
+
+    uchar *const data = file.map( 0, file.size() );
+    if ( !data ) {
+        mDebug() << "Unable to map" << file.fileName() << file.errorString();
+        return 0;
+    }
+
+    // The data is copied into the document while unpacking, so the mapping
+    // is only needed until the document is complete
+    const QByteArray buffer = QByteArray::fromRawData( reinterpret_cast<const char*>( data ), file.size() );
+    QDataStream stream( buffer );
+    stream.setVersion( documentCacheStreamVersion );
+
+    GeoDataLatLonBox bounds;
+    bool hasDocument = false;
+    if ( !readHeader( stream, sourceInfo, bounds, hasDocument ) || !hasDocument ) {
+        file.unmap( data );
+        return 0;
+    }
+
+    GeoDataDocument *document = new GeoDataDocument;
+    document->unpack( stream );
+    file.unmap( data );
+
+    if ( stream.status() != QDataStream::Ok ) {
+        mDebug() << "Ignoring corrupt document cache" << file.fileName();
+        delete document;
+        return 0;
+    }
+
+    return document;
+}
+
+GeoDataLatLonBox DocumentCache::latLonBox( const QString &sourceFile ) const
+{
+    const QFileInfo sourceInfo( sourceFile );
+    QFile file( cacheFile( sourceFile ) );
+    if ( !sourceInfo.exists() || !file.open( QIODevice::ReadOnly ) ) {
+        return GeoDataLatLonBox();
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( documentCacheStreamVersion );
+
+    GeoDataLatLonBox bounds;
+    bool hasDocument = false;
+    if ( !readHeader( stream, sourceInfo, bounds, hasDocument ) ) {
+        return GeoDataLatLonBox();
+    }
+
+    return bounds;
+}
+
+QByteArray DocumentCache::pack( const QString &sourceFile, const GeoDataDocument *document )
+{
+    if ( !isCacheable( document ) ) {
+        return QByteArray();
+    }
+
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+    writeHeader( stream, sourceFile, document, true );
+    document->pack( stream );
+
+    return data;
+}
+
+QByteArray DocumentCache::packLatLonBox( const QString &sourceFile, const GeoDataDocument *document )
+{
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+    writeHeader( stream, sourceFile, document, false );
+
+    return data;
+}
+
+bool DocumentCache::save( const QString &sourceFile, const QByteArray &data ) const
+{
+    if ( data.isEmpty() || !QDir::root().mkpath( m_cacheDirectory ) ) {
+        return false;
+    }
+
+    // Readers must never see a partially written file
+    const QString fileName = cacheFile( sourceFile );
+    QFile file( fileName + ".tmp" );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to write" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    if ( file.write( data ) != data.size() ) {
+        mDebug() << "Unable to write" << file.fileName() << file.errorString();
+        file.close();
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    QFile::remove( fileName );
+    return file.rename( fileName );
+}
+
+}
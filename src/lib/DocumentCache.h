@@ -0,0 +1,105 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#ifndef MARBLE_DOCUMENTCACHE_H
+#define MARBLE_DOCUMENTCACHE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoDataDocument;
+class GeoDataLatLonBox;
+
+/**
+ * @short Binary copies of parsed KML, GPX and OSM files.
+ *
+ * Parsing large XML files takes much longer than reading back the serialized
+ * document tree. After a file was parsed, pack() serializes the document
+ * together with the size and modification time of the source file, and save()
+ * stores the result in the cache directory. load() memory-maps the cached
+ * copy and unpacks it as long as the source file did not change.
+ *
+ * Documents with features or geometries that have no binary serialization,
+ * e.g. overlays, network links or models, are not cached. Only their bounding
+ * box is, see packLatLonBox().
+ *
+ * All methods are thread-safe.
+ */
+class MARBLE_EXPORT DocumentCache
+{
+ public:
+    /**
+     * Creates a cache in @p cacheDirectory, which defaults to a directory
+     * in the local Marble cache.
+     */
+    explicit DocumentCache( const QString &cacheDirectory = QString() );
+
+    QString cacheDirectory() const;
+
+    /**
+     * Returns the path of the cached copy of @p sourceFile.
+     */
+    QString cacheFile( const QString &sourceFile ) const;
+
+    /**
+     * Returns whether documents of the format of @p sourceFile may be cached.
+     */
+    static bool isCacheable( const QString &sourceFile );
+
+    /**
+     * Returns whether every feature and geometry of @p document can be serialized.
+     */
+    static bool isCacheable( const GeoDataDocument *document );
+
+    /**
+     * Returns the cached copy of @p sourceFile, or 0 if there is none or if
+     * it is outdated. The caller takes ownership of the document.
+     */
+    GeoDataDocument *load( const QString &sourceFile ) const;
+
+    /**
+     * Returns the bounding box of the cached copy of @p sourceFile without
+     * unpacking the document, or an empty box if there is no valid copy.
+     */
+    GeoDataLatLonBox latLonBox( const QString &sourceFile ) const;
+
+    /**
+     * Serializes @p document parsed from @p sourceFile for save(). Returns an
+     * empty byte array if the document cannot be cached.
+     *
+     * Call this before the document is handed on, as the modification time
+     * of the source file is captured here.
+     */
+    static QByteArray pack( const QString &sourceFile, const GeoDataDocument *document );
+
+    /**
+     * Like pack(), but only the bounding box of @p document is stored. This
+     * works for every document, so that latLonBox() knows about files whose
+     * documents cannot be cached.
+     */
+    static QByteArray packLatLonBox( const QString &sourceFile, const GeoDataDocument *document );
+
+    /**
+     * Writes @p data as returned by pack() as the cached copy of @p sourceFile.
+     */
+    bool save( const QString &sourceFile, const QByteArray &data ) const;
+
+ private:
+    QString m_cacheDirectory;
+};
+
+}
+
+#endif
@@ -32,7 +32,7 @@ using namespace Marble;
 class EquirectScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewportParams, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewportParams, MapQuality mapQuality, int yTop, int yBottom, int xLeft, int xRight );
 
     virtual void run();
 
@@ -44,16 +44,20 @@ private:
     const MapQuality m_mapQuality;
     const int m_yPaintedTop;
     const int m_yPaintedBottom;
+    const int m_xPaintedLeft;
+    const int m_xPaintedRight;
 };
 
-EquirectScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+EquirectScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom, int xLeft, int xRight )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
       m_yPaintedTop( yTop ),
-      m_yPaintedBottom( yBottom )
+      m_yPaintedBottom( yBottom ),
+      m_xPaintedLeft( xLeft ),
+      m_xPaintedRight( xRight )
 {
 }
 
@@ -63,7 +67,14 @@ QRect EquirectScanlineTextureMapper::rect( const ViewportParams *viewport ) cons
     return QRect( QPoint( 0, 0 ), viewport->size() );
 }
 
-void EquirectScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
+int EquirectScanlineTextureMapper::yCenterOffset( qreal centerLat, int radius )
+{
+    const qreal rad2Pixel = (qreal)( 2 * radius ) / M_PI;
+
+    return (int)( centerLat * rad2Pixel );
+}
+
+void EquirectScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, const QRect &dirtyRect )
 {
     // Reset backend
     tileLoader->resetTilehash();
@@ -90,12 +101,21 @@ void EquirectScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTile
     if (yPaintedBottom < 0)             yPaintedBottom = 0;
     if (yPaintedBottom > imageHeight) yPaintedBottom = imageHeight;
 
+    // Only the dirty rows need to be painted again
+    yPaintedTop    = qMax( yPaintedTop, dirtyRect.top() );
+    yPaintedBottom = qMax( yPaintedTop, qMin( yPaintedBottom, dirtyRect.bottom() + 1 ) );
+
+    // ... and only the dirty columns of them
+    const int xPaintedLeft  = qBound( 0, dirtyRect.left(), canvasImage->width() );
+    const int xPaintedRight = qBound( xPaintedLeft, dirtyRect.right() + 1, canvasImage->width() );
+
     const int numThreads = m_threadPool.maxThreadCount();
     const int yStep = ( yPaintedBottom - yPaintedTop ) / numThreads;
     for ( int i = 0; i < numThreads; ++i ) {
         const int yStart = yPaintedTop +  i      * yStep;
-        const int yEnd   = yPaintedTop + (i + 1) * yStep;
-        QRunnable *const job = new RenderJob( tileLoader, tileZoomLevel, canvasImage, viewport, mapQuality, yStart, yEnd );
+        const int yEnd   = ( i == numThreads - 1 ) ? yPaintedBottom
+                                                   : yPaintedTop + (i + 1) * yStep;
+        QRunnable *const job = new RenderJob( tileLoader, tileZoomLevel, canvasImage, viewport, mapQuality, yStart, yEnd, xPaintedLeft, xPaintedRight );
         m_threadPool.start( job );
     }
 
@@ -127,7 +147,7 @@ void EquirectScanlineTextureMapper::RenderJob::run()
     const qreal centerLon = m_viewport->centerLongitude();
     const qreal centerLat = m_viewport->centerLatitude();
 
-    const int yCenterOffset = (int)( centerLat * rad2Pixel );
+    const int yCenterOffset = EquirectScanlineTextureMapper::yCenterOffset( centerLat, radius );
 
     const int yTop = imageHeight / 2 - radius + yCenterOffset;
 
@@ -135,7 +155,8 @@ void EquirectScanlineTextureMapper::RenderJob::run()
     while ( leftLon < -M_PI ) leftLon += 2 * M_PI;
     while ( leftLon >  M_PI ) leftLon -= 2 * M_PI;
 
-    const int maxInterpolationPointX = n * (int)( imageWidth / n - 1 ) + 1;
+    const int paintedWidth = m_xPaintedRight - m_xPaintedLeft;
+    const int maxInterpolationPointX = m_xPaintedLeft + n * (int)( paintedWidth / n - 1 ) + 1;
 
 
     // initialize needed variables that are modified during texture mapping:
@@ -147,16 +168,17 @@ void EquirectScanlineTextureMapper::RenderJob::run()
 
     for ( int y = m_yPaintedTop; y < m_yPaintedBottom; ++y ) {
 
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) );
+        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + m_xPaintedLeft;
 
-        qreal lon = leftLon;
+        qreal lon = leftLon + m_xPaintedLeft * pixel2Rad;
+        while ( lon >  M_PI ) lon -= 2 * M_PI;
         const qreal lat = M_PI/2 - (y - yTop )* pixel2Rad;
 
-        for ( int x = 0; x < imageWidth; ++x ) {
+        for ( int x = m_xPaintedLeft; x < m_xPaintedRight; ++x ) {
 
             // Prepare for interpolation
             bool interpolate = false;
-            if ( x > 0 && x <= maxInterpolationPointX ) {
+            if ( x > m_xPaintedLeft && x <= maxInterpolationPointX ) {
                 x += n - 1;
                 lon += (n - 1) * pixel2Rad;
                 interpolate = !printQuality;
@@ -177,7 +199,7 @@ void EquirectScanlineTextureMapper::RenderJob::run()
                 scanLine += ( n - 1 );
             }
 
-            if ( x < imageWidth ) {
+            if ( x < m_xPaintedRight ) {
                 if ( highQuality )
                     context.pixelValueF( lon, lat, scanLine );
                 else
@@ -193,9 +215,9 @@ void EquirectScanlineTextureMapper::RenderJob::run()
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-            memcpy( m_canvasImage->scanLine( y + 1 ),
-                    m_canvasImage->scanLine( y     ),
-                    imageWidth * pixelByteSize );
+            memcpy( m_canvasImage->scanLine( y + 1 ) + m_xPaintedLeft * pixelByteSize,
+                    m_canvasImage->scanLine( y     ) + m_xPaintedLeft * pixelByteSize,
+                    paintedWidth * pixelByteSize );
             ++y;
         }
     }
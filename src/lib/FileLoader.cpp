@@ -14,8 +14,11 @@
 #include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QFile>
+#include <QtCore/QRunnable>
 #include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 
+#include "DocumentCache.h"
 #include "GeoDataParser.h"
 #include "GeoDataDocument.h"
 #include "GeoDataFolder.h"
@@ -36,6 +39,38 @@
 namespace Marble
 {
 
+class DocumentCacheWriter : public QRunnable
+{
+public:
+    DocumentCacheWriter( FileLoader *loader, const DocumentCache &cache,
+                         const QString &sourceFile, const GeoDataDocument *document )
+        : m_loader( loader ),
+          m_cache( cache ),
+          m_sourceFile( sourceFile ),
+          m_document( document )
+    {
+    }
+
+    virtual void run()
+    {
+        QByteArray data = DocumentCache::pack( m_sourceFile, m_document );
+        if ( data.isEmpty() ) {
+            // still helps the file manager to load files in the viewport first
+            data = DocumentCache::packLatLonBox( m_sourceFile, m_document );
+        }
+        m_cache.save( m_sourceFile, data );
+
+        // The loader waits for this in its destructor, so it is still alive
+        QMetaObject::invokeMethod( m_loader, "documentCached", Qt::QueuedConnection );
+    }
+
+private:
+    FileLoader *const m_loader;
+    const DocumentCache m_cache;
+    const QString m_sourceFile;
+    const GeoDataDocument *const m_document;
+};
+
 class FileLoaderPrivate
 {
 public:
@@ -49,8 +84,11 @@ public:
           m_documentRole ( role ),
           m_styleMap( new GeoDataStyleMap ),
           m_document( 0 ),
+          m_parsedDocument( 0 ),
           m_clock( model->clock() )
     {
+        m_documentCachePool.setMaxThreadCount( 1 );
+
         if( m_style ) {
             m_styleMap->setStyleId("default-map");
             m_styleMap->insert("normal", QString("#").append(m_style->styleId()));
@@ -65,14 +103,20 @@ public:
           m_contents ( contents ),
           m_documentRole ( role ),
           m_document( 0 ),
+          m_parsedDocument( 0 ),
           m_clock( model->clock() )
     {
+        m_documentCachePool.setMaxThreadCount( 1 );
     }
 
     ~FileLoaderPrivate()
     {
+        // the document is still being serialized if it wasn't handed on yet
+        m_documentCachePool.waitForDone();
+        delete m_parsedDocument;
     }
 
+    void resolveFilePath();
     void saveFile(const QString& filename );
     void savePlacemarks(QDataStream &out, const GeoDataContainer *container);
 
@@ -82,17 +126,26 @@ public:
     int areaPopIdx( qreal area ) const;
 
     void documentParsed( GeoDataDocument *doc, const QString& error);
+    void documentCached();
+    void addDocument( GeoDataDocument *doc );
 
     FileLoader *q;
     MarbleRunnerManager m_runner;
     QString m_filepath;
+    QString m_sourceFile;
+    QString m_cacheFile;
     QString m_contents;
     QString m_nonExistentLocalCacheFile;
+    DocumentCache m_documentCache;
+    QString m_documentCacheSource;
     QString m_property;
     GeoDataStyle* m_style;
     DocumentRole m_documentRole;
     GeoDataStyleMap* m_styleMap;
     GeoDataDocument *m_document;
+    // parsed, but not handed on before it is serialized for the document cache
+    GeoDataDocument *m_parsedDocument;
+    QThreadPool m_documentCachePool;
     QString m_error;
 
     const MarbleClock *m_clock;
@@ -103,6 +156,7 @@ FileLoader::FileLoader( QObject* parent, MarbleModel *model,
     : QThread( parent ),
       d( new FileLoaderPrivate( this, model, file, property, style, role ) )
 {
+    d->resolveFilePath();
 }
 
 FileLoader::FileLoader( QObject* parent, MarbleModel *model,
@@ -122,6 +176,11 @@ QString FileLoader::path() const
     return d->m_filepath;
 }
 
+QString FileLoader::sourceFile() const
+{
+    return d->m_sourceFile;
+}
+
 GeoDataDocument* FileLoader::document()
 {
     return d->m_document;
@@ -135,43 +194,14 @@ QString FileLoader::error() const
 void FileLoader::run()
 {
     if ( d->m_contents.isEmpty() ) {
-        QString defaultSourceName;
+        const QString &defaultSourceName = d->m_sourceFile;
+        const QString &cacheFile = d->m_cacheFile;
 
         mDebug() << "starting parser for" << d->m_filepath;
 
-        QFileInfo fileinfo( d->m_filepath );
-        QString path = fileinfo.path();
-        if ( path == "." ) path.clear();
-        QString name = fileinfo.completeBaseName();
-        QString suffix = fileinfo.suffix();
-        QString cacheFile;
-
-        // determine source, cache names
-        if ( fileinfo.isAbsolute() ) {
-            // We got an _absolute_ path now: e.g. "/patrick.kml"
-            defaultSourceName   = path + '/' + name + '.' + suffix;
-        }
-        else if ( d->m_filepath.contains( '/' ) ) {
-            // _relative_ path: "maps/mars/viking/patrick.kml"
-            defaultSourceName   = MarbleDirs::path( path + '/' + name + '.' + suffix );
-        }
-        else {
-            // _standard_ shared placemarks: "placemarks/patrick.kml"
-            defaultSourceName   = MarbleDirs::path( "placemarks/" + path + name + '.' + suffix );
-
-            cacheFile = MarbleDirs::path( "placemarks/" + path + name + ".cache" );
-            if ( cacheFile.isEmpty()) {
-                cacheFile = MarbleDirs::localPath() + "/placemarks/" + path + name + ".cache";
-                if ( !QFileInfo( cacheFile ).exists() ) {
-                    d->m_nonExistentLocalCacheFile = cacheFile;
-                }
-            }
-        }
-
         // if cache file more recent that source file, load cache file
+        bool isCacheRecent = false;
         if ( QFile::exists( cacheFile ) ) {
-            mDebug() << "Loading Cache File:" + cacheFile;
-
             QDateTime sourceLastModified;
 
             if ( QFile::exists( defaultSourceName ) ) {
@@ -180,23 +210,44 @@ void FileLoader::run()
 
             const QDateTime cacheLastModified  = QFileInfo( cacheFile ).lastModified();
 
-            if ( sourceLastModified < cacheLastModified ) {
-                connect( &d->m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
-                         this, SLOT(documentParsed(GeoDataDocument*,QString)) );
-                d->m_runner.parseFile( cacheFile, d->m_documentRole );
-            }
+            isCacheRecent = sourceLastModified < cacheLastModified;
+        }
+
+        if ( isCacheRecent ) {
+            mDebug() << "Loading Cache File:" + cacheFile;
+
+            connect( &d->m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
+                     this, SLOT(documentParsed(GeoDataDocument*,QString)) );
+            d->m_runner.parseFile( cacheFile, d->m_documentRole );
         }
         // we load source file, multiple cases
         else if ( QFile::exists( defaultSourceName ) ) {
             mDebug() << "No recent Default Placemark Cache File available!";
 
+            // Binary copies of the parsed document spare the XML parser
+            if ( cacheFile.isEmpty() && DocumentCache::isCacheable( defaultSourceName ) ) {
+                GeoDataDocument *document = d->m_documentCache.load( defaultSourceName );
+                if ( document ) {
+                    mDebug() << "Loaded" << defaultSourceName << "from the document cache";
+                    document->setDocumentRole( d->m_documentRole );
+                    document->setFileName( defaultSourceName );
+                    document->setBaseUri( defaultSourceName );
+                    d->documentParsed( document, QString() );
+                    return;
+                }
+
+                d->m_documentCacheSource = defaultSourceName;
+            }
+
             // use runners: pnt, gpx, osm
             connect( &d->m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
                     this, SLOT(documentParsed(GeoDataDocument*,QString)) );
             d->m_runner.parseFile( defaultSourceName, d->m_documentRole );
         }
         else {
-            mDebug() << "No Default Placemark Source File for " << name;
+            mDebug() << "No Default Placemark Source File for " << d->m_filepath;
+            // The file manager waits for every loader to finish
+            emit loaderFinished( this );
         }
     // content is not empty, we load from data
     } else {
@@ -232,6 +283,37 @@ void FileLoader::run()
 
 const quint32 MarbleMagicNumber = 0x31415926;
 
+void FileLoaderPrivate::resolveFilePath()
+{
+    QFileInfo fileinfo( m_filepath );
+    QString path = fileinfo.path();
+    if ( path == "." ) path.clear();
+    QString name = fileinfo.completeBaseName();
+    QString suffix = fileinfo.suffix();
+
+    // determine source, cache names
+    if ( fileinfo.isAbsolute() ) {
+        // We got an _absolute_ path now: e.g. "/patrick.kml"
+        m_sourceFile   = path + '/' + name + '.' + suffix;
+    }
+    else if ( m_filepath.contains( '/' ) ) {
+        // _relative_ path: "maps/mars/viking/patrick.kml"
+        m_sourceFile   = MarbleDirs::path( path + '/' + name + '.' + suffix );
+    }
+    else {
+        // _standard_ shared placemarks: "placemarks/patrick.kml"
+        m_sourceFile   = MarbleDirs::path( "placemarks/" + path + name + '.' + suffix );
+
+        m_cacheFile = MarbleDirs::path( "placemarks/" + path + name + ".cache" );
+        if ( m_cacheFile.isEmpty()) {
+            m_cacheFile = MarbleDirs::localPath() + "/placemarks/" + path + name + ".cache";
+            if ( !QFileInfo( m_cacheFile ).exists() ) {
+                m_nonExistentLocalCacheFile = m_cacheFile;
+            }
+        }
+    }
+}
+
 void FileLoaderPrivate::saveFile( const QString& filename )
 {
 
@@ -294,6 +376,26 @@ void FileLoaderPrivate::savePlacemarks(QDataStream &out, const GeoDataContainer
 void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& error )
 {
     m_error = error;
+    if ( doc && !m_documentCacheSource.isEmpty() ) {
+        // Serializing a large document takes a while. Do it in another thread,
+        // before the document gets modified and handed on in addDocument().
+        m_parsedDocument = doc;
+        m_documentCachePool.start( new DocumentCacheWriter( q, m_documentCache, m_documentCacheSource, doc ) );
+        return;
+    }
+
+    addDocument( doc );
+}
+
+void FileLoaderPrivate::documentCached()
+{
+    GeoDataDocument *const doc = m_parsedDocument;
+    m_parsedDocument = 0;
+    addDocument( doc );
+}
+
+void FileLoaderPrivate::addDocument( GeoDataDocument *doc )
+{
     if ( doc ) {
         m_document = doc;
         doc->setProperty( m_property );
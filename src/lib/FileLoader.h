@@ -34,6 +34,7 @@ class FileLoader : public QThread
 
         void run();
         QString path() const;
+        QString sourceFile() const;
         GeoDataDocument *document();
         QString error() const;
 
@@ -43,6 +44,7 @@ class FileLoader : public QThread
 
 private:
         Q_PRIVATE_SLOT ( d, void documentParsed( GeoDataDocument *, QString) )
+        Q_PRIVATE_SLOT ( d, void documentCached() )
 
         friend class FileLoaderPrivate;
 
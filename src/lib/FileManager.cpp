@@ -13,9 +13,16 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QPair>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTime>
+#include <QtCore/QTimer>
 #include <QtGui/QMessageBox>
 
+#include "DocumentCache.h"
 #include "FileLoader.h"
 #include "MarbleDebug.h"
 #include "MarbleModel.h"
@@ -30,35 +37,97 @@ using namespace Marble;
 
 namespace Marble
 {
+
+/**
+ * Reads the bounding box of the cached copy of a file, which involves disk
+ * access, away from the GUI thread.
+ */
+class CachedLatLonBoxReader : public QRunnable
+{
+public:
+    CachedLatLonBoxReader( FileManager *manager, const DocumentCache &cache, const QString &sourceFile )
+        : m_manager( manager ),
+          m_cache( cache ),
+          m_sourceFile( sourceFile )
+    {
+    }
+
+    virtual void run()
+    {
+        const GeoDataLatLonBox bounds = m_cache.latLonBox( m_sourceFile );
+        if ( !bounds.isEmpty() ) {
+            // The manager waits for this in its destructor, so it is still alive
+            QMetaObject::invokeMethod( m_manager, "setCachedLatLonBox", Qt::QueuedConnection,
+                                       Q_ARG( QString, m_sourceFile ), Q_ARG( GeoDataLatLonBox, bounds ) );
+        }
+    }
+
+private:
+    FileManager *const m_manager;
+    const DocumentCache m_cache;
+    const QString m_sourceFile;
+};
+
 class FileManagerPrivate
 {
 public:
     FileManagerPrivate( MarbleModel* model, FileManager* parent )
         : m_model( model ),
           q( parent ),
-          m_recenter( false )
+          m_maximumLoaderCount( qMax( 1, QThread::idealThreadCount() ) )
     {
+        // Documents finishing within this interval are added in one go
+        m_documentTimer.setSingleShot( true );
+        m_documentTimer.setInterval( 100 );
+        QObject::connect( &m_documentTimer, SIGNAL(timeout()),
+                          q, SLOT(addLoadedDocuments()) );
+
+        qRegisterMetaType<GeoDataLatLonBox>( "GeoDataLatLonBox" );
+        m_latLonBoxPool.setMaxThreadCount( 1 );
     }
 
     ~FileManagerPrivate()
     {
+        m_latLonBoxPool.waitForDone();
         foreach ( FileLoader *loader, m_loaderList ) {
             if ( loader ) {
                 loader->wait();
             }
         }
+        qDeleteAll( m_pendingLoaders );
+        for ( int i = 0; i < m_loadedDocuments.size(); ++i ) {
+            delete m_loadedDocuments.at( i ).second;
+        }
     }
 
-    void appendLoader( FileLoader *loader );
+    void appendLoader( FileLoader *loader, bool prioritized = false );
+    void startLoaders();
+    bool isLoading( const QString &key ) const;
     void closeFile( const QString &key );
     void cleanupLoader( FileLoader *loader );
+    void addLoadedDocuments();
+    void setCachedLatLonBox( const QString &sourceFile, const GeoDataLatLonBox &bounds );
 
     MarbleModel* const m_model;
 
     FileManager * const q;
+    /// Loaders which are running, in the order they were started
     QList<FileLoader*> m_loaderList;
+    /// Loaders waiting for one of the running ones to finish
+    QList<FileLoader*> m_pendingLoaders;
+    /// Pending loaders at the front of the queue which bypass the viewport order
+    QSet<FileLoader*> m_prioritizedLoaders;
+    /// Bounding boxes of the cached copies of the pending loaders' files
+    QHash<FileLoader*, GeoDataLatLonBox> m_pendingBounds;
+    /// Documents which have been loaded, but are not in the tree model yet
+    QList< QPair<QString, GeoDataDocument*> > m_loadedDocuments;
     QHash < QString, GeoDataDocument* > m_fileItemHash;
-    bool m_recenter;
+    int m_maximumLoaderCount;
+    GeoDataLatLonBox m_viewport;
+    DocumentCache m_documentCache;
+    QThreadPool m_latLonBoxPool;
+    QString m_recenterKey;
+    QTimer m_documentTimer;
     QTime m_timer;
 };
 }
@@ -81,17 +150,19 @@ void FileManager::addFile( const QString& filepath, const QString& property, Geo
             return;  // already loaded
     }
 
-    foreach ( const FileLoader *loader, d->m_loaderList ) {
-        if ( loader->path() == filepath )
-            return;  // currently loading
+    if ( d->isLoading( filepath ) ) {
+        return;  // currently loading
     }
 
     mDebug() << "adding container:" << filepath;
     mDebug() << "Starting placemark loading timer";
     d->m_timer.start();
-    d->m_recenter = recenter;
+    if ( recenter ) {
+        d->m_recenterKey = filepath;
+    }
     FileLoader* loader = new FileLoader( this, d->m_model, filepath, property, style, role );
-    d->appendLoader( loader );
+    // Files the user is waiting for go before the default data
+    d->appendLoader( loader, recenter || role == UserDocument );
 }
 
 void FileManager::addFile( const QStringList& filepaths, const QStringList& propertyList, const QList<GeoDataStyle*>& styles, DocumentRole role )
@@ -107,23 +178,104 @@ void FileManager::addData( const QString &name, const QString &data, DocumentRol
     d->appendLoader( loader );
 }
 
-void FileManagerPrivate::appendLoader( FileLoader *loader )
+void FileManagerPrivate::appendLoader( FileLoader *loader, bool prioritized )
 {
     QObject::connect( loader, SIGNAL(loaderFinished(FileLoader*)),
              q, SLOT(cleanupLoader(FileLoader*)) );
 
-    m_loaderList.append( loader );
-    loader->start();
+    if ( prioritized ) {
+        m_pendingLoaders.insert( m_prioritizedLoaders.size(), loader );
+        m_prioritizedLoaders.insert( loader );
+    } else {
+        m_pendingLoaders.append( loader );
+        if ( !loader->sourceFile().isEmpty() ) {
+            m_latLonBoxPool.start( new CachedLatLonBoxReader( q, m_documentCache, loader->sourceFile() ) );
+        }
+    }
+
+    startLoaders();
+}
+
+void FileManagerPrivate::startLoaders()
+{
+    while ( m_loaderList.size() < m_maximumLoaderCount && !m_pendingLoaders.isEmpty() ) {
+        // Prioritized loaders are at the front. Among the others, prefer the
+        // first one whose cached copy shows that it has data in the viewport.
+        int next = 0;
+        if ( m_prioritizedLoaders.isEmpty() && !m_viewport.isEmpty() ) {
+            for ( int i = 0; i < m_pendingLoaders.size(); ++i ) {
+                const GeoDataLatLonBox bounds = m_pendingBounds.value( m_pendingLoaders.at( i ) );
+                if ( !bounds.isEmpty() && bounds.intersects( m_viewport ) ) {
+                    next = i;
+                    break;
+                }
+            }
+        }
+
+        FileLoader *loader = m_pendingLoaders.takeAt( next );
+        m_prioritizedLoaders.remove( loader );
+        m_pendingBounds.remove( loader );
+        m_loaderList.append( loader );
+        loader->start();
+    }
+}
+
+void FileManagerPrivate::setCachedLatLonBox( const QString &sourceFile, const GeoDataLatLonBox &bounds )
+{
+    // Loaders which were started or removed meanwhile don't need it anymore
+    foreach ( FileLoader *loader, m_pendingLoaders ) {
+        if ( loader->sourceFile() == sourceFile && !m_prioritizedLoaders.contains( loader ) ) {
+            m_pendingBounds.insert( loader, bounds );
+        }
+    }
+}
+
+bool FileManagerPrivate::isLoading( const QString &key ) const
+{
+    foreach ( const FileLoader *loader, m_loaderList ) {
+        if ( loader->path() == key )
+            return true;
+    }
+
+    foreach ( const FileLoader *loader, m_pendingLoaders ) {
+        if ( loader->path() == key )
+            return true;
+    }
+
+    for ( int i = 0; i < m_loadedDocuments.size(); ++i ) {
+        if ( m_loadedDocuments.at( i ).first == key )
+            return true;
+    }
+
+    return false;
 }
 
 void FileManager::removeFile( const QString& key )
 {
+    foreach ( FileLoader *loader, d->m_pendingLoaders ) {
+        if ( loader->path() == key ) {
+            d->m_pendingLoaders.removeAll( loader );
+            d->m_prioritizedLoaders.remove( loader );
+            d->m_pendingBounds.remove( loader );
+            delete loader;
+            return;
+        }
+    }
+
     foreach ( FileLoader *loader, d->m_loaderList ) {
         if ( loader->path() == key ) {
             disconnect( loader, 0, this, 0 );
             loader->wait();
             d->m_loaderList.removeAll( loader );
             delete loader->document();
+            d->startLoaders();
+            return;
+        }
+    }
+
+    for ( int i = 0; i < d->m_loadedDocuments.size(); ++i ) {
+        if ( d->m_loadedDocuments.at( i ).first == key ) {
+            delete d->m_loadedDocuments.takeAt( i ).second;
             return;
         }
     }
@@ -164,6 +316,22 @@ void FileManager::closeFile( GeoDataDocument *document )
     }
 }
 
+void FileManager::setMaximumLoaderCount( int count )
+{
+    d->m_maximumLoaderCount = qMax( 1, count );
+    d->startLoaders();
+}
+
+int FileManager::maximumLoaderCount() const
+{
+    return d->m_maximumLoaderCount;
+}
+
+void FileManager::setViewport( const GeoDataLatLonAltBox &viewport )
+{
+    d->m_viewport = viewport;
+}
+
 int FileManager::size() const
 {
     return d->m_fileItemHash.size();
@@ -179,34 +347,61 @@ GeoDataDocument * FileManager::at( const QString &key )
 
 void FileManagerPrivate::cleanupLoader( FileLoader* loader )
 {
+    if ( !m_loaderList.removeOne( loader ) ) {
+        return;  // already cleaned up
+    }
+
+    // The signal may have been emitted before run() returned
+    loader->wait();
+
     GeoDataDocument *doc = loader->document();
-    m_loaderList.removeAll( loader );
-    if ( loader->isFinished() ) {
-        if ( doc ) {
-            if ( doc->name().isEmpty() && !doc->fileName().isEmpty() )
-            {
-                QFileInfo file( doc->fileName() );
-                doc->setName( file.baseName() );
-            }
-            m_model->treeModel()->addDocument( doc );
-            m_fileItemHash.insert( loader->path(), doc );
-            emit q->fileAdded( loader->path() );
-            if( m_recenter ) {
-                emit q->centeredDocument( doc->latLonAltBox() );
-                m_recenter = false;
-            }
+    if ( doc ) {
+        m_loadedDocuments.append( qMakePair( loader->path(), doc ) );
+        if ( !m_documentTimer.isActive() ) {
+            m_documentTimer.start();
+        }
+    }
+    if ( !loader->error().isEmpty() ) {
+        QMessageBox errorBox;
+        errorBox.setWindowTitle( QObject::tr("File Parsing Error"));
+        errorBox.setText( loader->error() );
+        errorBox.setIcon( QMessageBox::Warning );
+        errorBox.exec();
+        qWarning() << "File Parsing error " << loader->error();
+    }
+    delete loader;
+
+    startLoaders();
+}
+
+void FileManagerPrivate::addLoadedDocuments()
+{
+    QList<GeoDataDocument*> documents;
+    for ( int i = 0; i < m_loadedDocuments.size(); ++i ) {
+        GeoDataDocument *doc = m_loadedDocuments.at( i ).second;
+        if ( doc->name().isEmpty() && !doc->fileName().isEmpty() )
+        {
+            QFileInfo file( doc->fileName() );
+            doc->setName( file.baseName() );
         }
-        if ( !loader->error().isEmpty() ) {
-            QMessageBox errorBox;
-            errorBox.setWindowTitle( QObject::tr("File Parsing Error"));
-            errorBox.setText( loader->error() );
-            errorBox.setIcon( QMessageBox::Warning );
-            errorBox.exec();
-            qWarning() << "File Parsing error " << loader->error();
+        documents.append( doc );
+        m_fileItemHash.insert( m_loadedDocuments.at( i ).first, doc );
+    }
+
+    const QList< QPair<QString, GeoDataDocument*> > loadedDocuments = m_loadedDocuments;
+    m_loadedDocuments.clear();
+    m_model->treeModel()->addDocuments( documents );
+
+    for ( int i = 0; i < loadedDocuments.size(); ++i ) {
+        const QString &key = loadedDocuments.at( i ).first;
+        emit q->fileAdded( key );
+        if ( key == m_recenterKey ) {
+            emit q->centeredDocument( loadedDocuments.at( i ).second->latLonAltBox() );
+            m_recenterKey.clear();
         }
-        delete loader;
     }
-    if ( m_loaderList.isEmpty()  )
+
+    if ( m_loaderList.isEmpty() && m_pendingLoaders.isEmpty() )
     {
         mDebug() << "Finished loading all placemarks " << m_timer.elapsed();
     }
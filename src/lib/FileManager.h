@@ -13,6 +13,7 @@
 #define MARBLE_FILEMANAGER_H
 
 #include "GeoDataDocument.h"
+#include "marble_export.h"
 
 #include <QtCore/QObject>
 #include <QtCore/QString>
@@ -25,6 +26,7 @@ class MarbleModel;
 class FileManagerPrivate;
 class FileLoader;
 class GeoDataLatLonBox;
+class GeoDataLatLonAltBox;
 
 /**
  * This class is responsible for loading the
@@ -32,8 +34,13 @@ class GeoDataLatLonBox;
  *
  * The loaded data are accessible via
  * various models in MarbleModel.
+ *
+ * At most maximumLoaderCount() files are parsed at the same time. Files
+ * which are to be recentered on and files whose cached copy is known to
+ * intersect the viewport are loaded first. Documents which finish loading
+ * shortly after each other are added to the tree model in one go.
  */
-class FileManager : public QObject
+class MARBLE_EXPORT FileManager : public QObject
 {
     Q_OBJECT
 
@@ -78,6 +85,18 @@ class FileManager : public QObject
     int size() const;
     GeoDataDocument *at( const QString &key );
 
+    /**
+     * Sets the number of files which may be loaded concurrently. Defaults to
+     * the number of processor cores.
+     */
+    void setMaximumLoaderCount( int count );
+    int maximumLoaderCount() const;
+
+ public Q_SLOTS:
+    /**
+     * Files with data in @p viewport are loaded before other files.
+     */
+    void setViewport( const GeoDataLatLonAltBox &viewport );
 
  Q_SIGNALS:
     void fileAdded( const QString &key );
@@ -87,6 +106,8 @@ class FileManager : public QObject
  private:
 
     Q_PRIVATE_SLOT( d, void cleanupLoader( FileLoader *loader ) )
+    Q_PRIVATE_SLOT( d, void addLoadedDocuments() )
+    Q_PRIVATE_SLOT( d, void setCachedLatLonBox( const QString &, const GeoDataLatLonBox & ) )
 
     Q_DISABLE_COPY( FileManager )
 
@@ -22,12 +22,14 @@
 #include "MarbleDebug.h"
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
+#include "TileArchive.h"
 
 using namespace Marble;
 
 FileStoragePolicy::FileStoragePolicy( const QString &dataDirectory, QObject *parent )
     : StoragePolicy( parent ),
-      m_dataDirectory( dataDirectory )
+      m_dataDirectory( dataDirectory ),
+      m_packTiles( false )
 {
     if ( m_dataDirectory.isEmpty() )
         m_dataDirectory = MarbleDirs::localPath() + "/cache/";
@@ -43,6 +45,13 @@ FileStoragePolicy::~FileStoragePolicy()
 bool FileStoragePolicy::fileExists( const QString &fileName ) const
 {
     const QString fullName( m_dataDirectory + '/' + fileName );
+
+    QString archiveName;
+    TileArchive *const archive = TileArchive::archiveForFile( fullName, &archiveName );
+    if ( archive && archive->contains( archiveName ) ) {
+        return true;
+    }
+
     return QFile::exists( fullName );
 }
 
@@ -51,6 +60,25 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     QFileInfo const dirInfo( fileName );
     QString const fullName = dirInfo.isAbsolute() ? fileName : m_dataDirectory + '/' + fileName;
 
+    // Tiles of themes which are packed into an archive go there instead
+    QString archiveName;
+    TileArchive *archive = TileArchive::archiveForFile( fullName, &archiveName );
+    if ( !archive && m_packTiles && !dirInfo.isAbsolute() ) {
+        archive = createTileArchive( fileName, &archiveName );
+    }
+
+    if ( archive ) {
+        const qint64 oldSize = archive->size();
+        if ( !archive->insert( archiveName, data ) ) {
+            m_errorMsg = archive->lastErrorMessage();
+            qCritical() << "archive->insert" << m_errorMsg;
+            return false;
+        }
+
+        emit sizeChanged( archive->size() - oldSize );
+        return true;
+    }
+
     // Create directory if it doesn't exist yet...
     QFileInfo info( fullName );
 
@@ -80,6 +108,8 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     emit sizeChanged( file.size() - oldSize );
     file.close();
 
+    emit fileUpdated( fullName );
+
     return true;
 }
 
@@ -102,6 +132,13 @@ void FileStoragePolicy::clearCache()
         while (itPlanet.hasNext()) {
             itPlanet.next();
             QString themeDirectory = itPlanet.filePath();
+
+            if ( TileArchive *const archive = TileArchive::archive( themeDirectory ) ) {
+                const qint64 oldSize = archive->size();
+                archive->compact( maxBaseTileLevel );
+                emit sizeChanged( archive->size() - oldSize );
+            }
+
             QDirIterator itTheme( themeDirectory, QDir::NoDotAndDotDot | QDir::Dirs );
             while (itTheme.hasNext()) {
                 itTheme.next();
@@ -142,4 +179,35 @@ QString FileStoragePolicy::lastErrorMessage() const
     return m_errorMsg;
 }
 
+void FileStoragePolicy::setPackTiles( bool pack )
+{
+    m_packTiles = pack;
+}
+
+bool FileStoragePolicy::packTiles() const
+{
+    return m_packTiles;
+}
+
+TileArchive *FileStoragePolicy::createTileArchive( const QString &fileName, QString *archiveName )
+{
+    // Only tiles get packed: maps/<planet>/<theme>/<level>/...
+    bool ok = false;
+    fileName.section( '/', 3, 3 ).toInt( &ok );
+    if ( !ok || !fileName.startsWith( QLatin1String( "maps/" ) ) ) {
+        return 0;
+    }
+
+    TileArchive *const archive = TileArchive::create( m_dataDirectory + '/' + fileName.section( '/', 0, 2 ) );
+    if ( !archive ) {
+        return 0;
+    }
+
+    // let the FileStorageWatcher know about the new archive
+    emit fileUpdated( archive->filePath() );
+
+    *archiveName = fileName.section( '/', 3 );
+    return archive;
+}
+
 #include "FileStoragePolicy.moc"
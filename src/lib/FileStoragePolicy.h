@@ -16,6 +16,8 @@
 namespace Marble
 {
 
+class TileArchive;
+
 class FileStoragePolicy : public StoragePolicy
 {
     Q_OBJECT
@@ -53,11 +55,30 @@ class FileStoragePolicy : public StoragePolicy
          */
         QString lastErrorMessage() const;
 
+        /**
+         * If @p pack is true, downloaded tiles of a map theme are stored in a
+         * TileArchive in the theme directory, which gets created on demand.
+         * Tiles stored as files before stay where they are and are still found.
+         * Themes which have an archive already always store their tiles there.
+         */
+        void setPackTiles( bool pack );
+
+        bool packTiles() const;
+
+    Q_SIGNALS:
+        /**
+         * Is emitted after the file @p fileName was written.
+         */
+        void fileUpdated( const QString &fileName );
+
     private:
 	Q_DISABLE_COPY( FileStoragePolicy )
+
+        TileArchive *createTileArchive( const QString &fileName, QString *archiveName );
 	
         QString m_dataDirectory;
         QString m_errorMsg;
+        bool m_packTiles;
 };
 
 }
@@ -12,32 +12,44 @@
 #include "FileStorageWatcher.h"
 
 // Qt
+#include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QDirIterator>
 #include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
 #include <QtCore/QTimer>
 
 // Marble
 #include "MarbleGlobal.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "TileArchive.h"
 
 using namespace Marble;
 
-// Only remove 20 files without checking
+// Spend at most this many milliseconds deleting files before checking
 // changed cacheLimits and changed themes etc.
-static const int maxFilesDelete = 20;
+static const int maxDeleteMSecs = 50;
 // Delete only files that are older than 120 Seconds
 static const int deleteOnlyFilesOlderThan = 120;
 static const int softLimitPercent = 5;
+// Rescan the data directory after a week to correct the cache size for
+// files written behind our back
+static const int maxIndexAgeSecs = 7 * 24 * 60 * 60;
+
+static const quint32 indexMagic = 0x4d465357; // "MFSW"
+static const quint32 indexVersion = 2;
 
 
 // Methods of FileStorageWatcherThread
 FileStorageWatcherThread::FileStorageWatcherThread( const QString &dataDirectory, QObject *parent )
     : QObject( parent ),
       m_dataDirectory( dataDirectory ),
+      m_currentCacheSize( 0 ),
       m_deleting( false ),
+      m_indexCreated( QDateTime::currentDateTime().toTime_t() ),
       m_willQuit( false )
 {
     // For now setting cache limit to 0. This won't delete anything
@@ -78,9 +90,25 @@ void FileStorageWatcherThread::addToCurrentSize( qint64 bytes )
     emit variableChanged();
 }
 
+void FileStorageWatcherThread::addFile( const QString &fileName )
+{
+    const QString dataDirectory = QDir::cleanPath( m_dataDirectory ) + '/';
+    const QString filePath = QDir::cleanPath( fileName );
+    if ( !filePath.startsWith( dataDirectory ) ) {
+	return;
+    }
+
+    const QFileInfo info( filePath );
+    indexFile( filePath.mid( dataDirectory.length() ), info.size(), info.lastModified().toTime_t() );
+}
+
 void FileStorageWatcherThread::resetCurrentSize()
 {
+    // The cache was cleared, forget about the deleted files. Tile archives
+    // only lose their tiles, so they are still tracked.
     m_currentCacheSize = 0;
+    m_filesByTheme.clear();
+    m_fileAges.clear();
     emit variableChanged();
 }
 
@@ -100,7 +128,18 @@ void FileStorageWatcherThread::prepareQuit()
 
 void FileStorageWatcherThread::getCurrentCacheSize()
 {
+    if ( loadIndex() ) {
+	mDebug() << "FileStorageWatcher: Loaded cache index with" << m_fileAges.size() << "files";
+	return;
+    }
+
     mDebug() << "FileStorageWatcher: Creating cache size";
+    m_filesByTheme.clear();
+    m_fileAges.clear();
+    m_archiveThemes.clear();
+    m_indexCreated = QDateTime::currentDateTime().toTime_t();
+
+    const QString dataDirectory = QDir::cleanPath( m_dataDirectory ) + '/';
     quint64 dataSize = 0;
     QDirIterator it( m_dataDirectory, QDir::Files, QDirIterator::Subdirectories );
     
@@ -109,8 +148,208 @@ void FileStorageWatcherThread::getCurrentCacheSize()
 	it.next();
 	QFileInfo file = it.fileInfo();
 	dataSize += file.size();
+
+	const QString filePath = QDir::cleanPath( it.filePath() );
+	if ( filePath.startsWith( dataDirectory ) ) {
+	    indexFile( filePath.mid( dataDirectory.length() ), file.size(), file.lastModified().toTime_t() );
+	}
     }
     m_currentCacheSize = dataSize;
+
+    if ( m_willQuit ) {
+	// The scan is incomplete, make sure that the saved index expires.
+	m_indexCreated = 0;
+    }
+}
+
+QString FileStorageWatcherThread::indexFileName() const
+{
+    return m_dataDirectory + "/cache_watcher.idx";
+}
+
+bool FileStorageWatcherThread::loadIndex()
+{
+    QFile file( indexFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+	return false;
+    }
+
+    QDataStream stream( &file );
+    quint32 magic = 0;
+    quint32 version = 0;
+    uint created = 0;
+    quint64 cacheSize = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> created >> cacheSize >> count;
+
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    bool valid = stream.status() == QDataStream::Ok
+		 && magic == indexMagic && version == indexVersion
+		 && created <= now && now - created < uint( maxIndexAgeSecs );
+
+    for ( quint32 i = 0; valid && i < count && !m_willQuit; ++i ) {
+	QString relativePath;
+	qint64 size;
+	uint lastModified;
+	stream >> relativePath >> size >> lastModified;
+	valid = stream.status() == QDataStream::Ok;
+	if ( valid ) {
+	    indexFile( relativePath, size, lastModified );
+	}
+    }
+
+    if ( valid ) {
+	stream >> m_archiveThemes;
+	valid = stream.status() == QDataStream::Ok;
+    }
+
+    file.close();
+
+    // The index is only valid until the next start. If we crash, the
+    // data directory will be scanned again.
+    QFile::remove( indexFileName() );
+
+    if ( !valid || m_willQuit ) {
+	m_filesByTheme.clear();
+	m_fileAges.clear();
+	m_archiveThemes.clear();
+	return false;
+    }
+
+    m_indexCreated = created;
+    m_currentCacheSize = cacheSize;
+    return true;
+}
+
+void FileStorageWatcherThread::saveIndex()
+{
+    QFile file( indexFileName() );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+	mDebug() << "FileStorageWatcher: Could not save cache index" << file.fileName();
+	return;
+    }
+
+    QDataStream stream( &file );
+    stream << indexMagic << indexVersion << m_indexCreated << quint64( m_currentCacheSize )
+	   << quint32( m_fileAges.size() );
+
+    QHash<QString, FilesByAge>::const_iterator theme = m_filesByTheme.constBegin();
+    for (; theme != m_filesByTheme.constEnd(); ++theme ) {
+	FilesByAge::const_iterator it = theme.value().constBegin();
+	for (; it != theme.value().constEnd(); ++it ) {
+	    stream << it.key().second << it.value() << it.key().first;
+	}
+    }
+    stream << m_archiveThemes;
+
+    file.close();
+    if ( file.error() != QFile::NoError ) {
+	QFile::remove( file.fileName() );
+    }
+}
+
+void FileStorageWatcherThread::indexFile( const QString &relativePath, qint64 size, uint lastModified )
+{
+    // Only tiles of the levels above the base tiles of the cached maps
+    // are deleted: maps/<planet>/<theme>/<level>/...
+    if ( !relativePath.startsWith( QLatin1String( "maps/" ) ) ) {
+	return;
+    }
+
+    // Tile archives lose their oldest tiles instead, see shrinkArchives()
+    if ( relativePath.section( '/', 3 ) == TileArchive::fileName() ) {
+	m_archiveThemes.insert( relativePath.section( '/', 1, 2 ) );
+	return;
+    }
+
+    bool ok = false;
+    const int tileLevel = relativePath.section( '/', 3, 3 ).toInt( &ok );
+    if ( !ok || tileLevel <= maxBaseTileLevel ) {
+	return;
+    }
+
+    // We try to be very careful and just delete images
+    // FIXME, when vectortiling I suppose also vector tiles will have
+    // to be deleted
+    const QString lowerCase = relativePath.toLower();
+    if ( !lowerCase.endsWith( QLatin1String( ".jpg" ) )
+	 && !lowerCase.endsWith( QLatin1String( ".png" ) )
+	 && !lowerCase.endsWith( QLatin1String( ".gif" ) )
+	 && !lowerCase.endsWith( QLatin1String( ".svg" ) ) ) {
+	return;
+    }
+
+    FilesByAge &files = m_filesByTheme[ relativePath.section( '/', 1, 2 ) ];
+
+    QHash<QString, uint>::iterator const age = m_fileAges.find( relativePath );
+    if ( age != m_fileAges.end() ) {
+	files.remove( qMakePair( age.value(), relativePath ) );
+	age.value() = lastModified;
+    } else {
+	m_fileAges.insert( relativePath, lastModified );
+    }
+
+    files.insert( qMakePair( lastModified, relativePath ), size );
+}
+
+FileStorageWatcherThread::FilesByAge *FileStorageWatcherThread::nextFilesToDelete( const QString &currentTheme, uint youngest )
+{
+    // Delete the oldest files of the other themes first, the files
+    // of the currently shown theme at last.
+    FilesByAge *result = 0;
+
+    QHash<QString, FilesByAge>::iterator it = m_filesByTheme.begin();
+    for (; it != m_filesByTheme.end(); ++it ) {
+	if ( it.key() == currentTheme || it.value().isEmpty() ) {
+	    continue;
+	}
+
+	const uint lastModified = it.value().constBegin().key().first;
+	if ( lastModified <= youngest
+	     && ( !result || lastModified < result->constBegin().key().first ) ) {
+	    result = &it.value();
+	}
+    }
+
+    if ( !result ) {
+	it = m_filesByTheme.find( currentTheme );
+	if ( it != m_filesByTheme.end() && !it.value().isEmpty()
+	     && it.value().constBegin().key().first <= youngest ) {
+	    result = &it.value();
+	}
+    }
+
+    return result;
+}
+
+void FileStorageWatcherThread::shrinkArchives( const QString &currentTheme, uint youngest )
+{
+    QStringList themes = m_archiveThemes.toList();
+    if ( themes.removeAll( currentTheme ) > 0 ) {
+	themes.append( currentTheme );
+    }
+
+    foreach ( const QString &theme, themes ) {
+	if ( m_currentCacheSize <= m_cacheSoftLimit || m_willQuit ) {
+	    break;
+	}
+
+	TileArchive *const archive = TileArchive::archive( m_dataDirectory + "/maps/" + theme );
+	if ( !archive ) {
+	    m_archiveThemes.remove( theme );
+	    continue;
+	}
+
+	const qint64 oldSize = archive->size();
+	const qint64 excess = m_currentCacheSize - m_cacheSoftLimit;
+	mDebug() << "FileStorageWatcher: Shrink " << archive->filePath();
+	archive->shrink( qMax<qint64>( 0, oldSize - excess ), maxBaseTileLevel,
+			 QDateTime::fromTime_t( youngest ) );
+	const qint64 freed = oldSize - archive->size();
+	if ( freed > 0 ) {
+	    m_currentCacheSize -= qMin<quint64>( freed, m_currentCacheSize );
+	}
+    }
 }
 
 void FileStorageWatcherThread::ensureCacheSize()
@@ -127,8 +366,6 @@ void FileStorageWatcherThread::ensureCacheSize()
 	&& !( m_mapThemeId.isEmpty() )
 	&& !m_willQuit )
     {
-	// The counter for deleted files
-	m_filesDeleted = 0;
 	// We have not reached our soft limit, yet.
 	m_deleting = true;
 	
@@ -142,52 +379,47 @@ void FileStorageWatcherThread::ensureCacheSize()
 	    return;
 	}
 	
-	// Which planet do we show now.
-	// We have to delete files for this planet at last
-	QStringList currentList = m_mapThemeId.split( '/' );
-	QString shownPlanet( currentList.first() );
-	currentList.removeFirst();
-	// The QString to save the path of the directory to the current planet
-	QString lastPlanet;
-	
-	QString cachedMapsDirectory = m_dataDirectory + "/maps";
-
-	// Iterator over planet directories
-	QDirIterator it( cachedMapsDirectory,
-			 QDir::NoDotAndDotDot | QDir::Dirs );
-
-	while ( it.hasNext() &&
-	        keepDeleting() ) {
-	    it.next();
-	    
-	    // Our current planet directory
-	    QString planetDirectory = it.filePath();
-	    QFileInfo fileInfo = it.fileInfo();
-	    
-	    // We have found the currently shown planet.
-	    // Please delete here at last.
-	    if( fileInfo.fileName() == shownPlanet ) {
-		lastPlanet = planetDirectory;
-		continue;
+	// Which theme do we show now ("planet/theme").
+	// We have to delete files for this theme at last
+	m_themeMutex.lock();
+	const QString currentTheme = m_mapThemeId.section( '/', 0, 1 );
+	m_themeMutex.unlock();
+
+	// Do not delete files younger than two minutes.
+	const uint youngest = QDateTime::currentDateTime().toTime_t() - deleteOnlyFilesOlderThan;
+
+	QTime time;
+	time.start();
+
+	while ( m_currentCacheSize > m_cacheSoftLimit && !m_willQuit ) {
+	    // We have deleted files for long enough.
+	    // Perhaps there are changes.
+	    if ( time.elapsed() > maxDeleteMSecs ) {
+		QTimer::singleShot( 0, this, SLOT(ensureCacheSize()) );
+		return;
+	    }
+
+	    FilesByAge *const files = nextFilesToDelete( currentTheme, youngest );
+	    if ( !files ) {
+		shrinkArchives( currentTheme, youngest );
+		break;
+	    }
+
+	    const FilesByAge::iterator oldest = files->begin();
+	    const QString relativePath = oldest.key().second;
+	    const qint64 size = oldest.value();
+	    files->erase( oldest );
+	    m_fileAges.remove( relativePath );
+
+	    const QString filePath = m_dataDirectory + '/' + relativePath;
+	    mDebug() << "FileStorageWatcher: Delete " << filePath;
+	    if ( QFile::remove( filePath ) ) {
+		m_currentCacheSize -= qMin<quint64>( size, m_currentCacheSize );
 	    }
-	    
-	    ensureSizePerPlanet( planetDirectory );
-	}
-	
-	if( keepDeleting() ) {
-	    ensureSizePerPlanet( lastPlanet, currentList.first() );
 	}
 	
-	// We have deleted enough files. 
-	// Perhaps there are changes.
-	if( m_filesDeleted > maxFilesDelete ) {
-	    QTimer::singleShot( 100, this, SLOT(ensureCacheSize()) );
-	    return;
-	} 
-	else {
-	    // We haven't stopped because of to many files
-	    m_deleting = false;
-	}
+	// We haven't stopped because of the time limit
+	m_deleting = false;
 	
 	if( m_currentCacheSize > m_cacheSoftLimit ) {
 	    mDebug() << "FileStorageWatcher: Could not set cache size.";
@@ -198,107 +430,6 @@ void FileStorageWatcherThread::ensureCacheSize()
 	}
     }
 }
-
-void FileStorageWatcherThread::ensureSizePerPlanet( const QString &planetDirectory,
-                                                    const QString &currentTheme )
-{
-    mDebug() << "Deleting from folder: " << planetDirectory;
-    
-    // lastTheme will store the path to our currentTheme
-    QString lastTheme;
-    
-    QDirIterator itPlanet( planetDirectory,
-	                   QDir::NoDotAndDotDot | QDir::Dirs );
-    while( itPlanet.hasNext() &&
-	   keepDeleting() ) {
-	itPlanet.next();
-	QString themeDirectory = itPlanet.filePath();
-	QFileInfo fileInfo = itPlanet.fileInfo();
-	
-	// We have found the currently shown theme.
-	// Please delete here at last.
-	if( !currentTheme.isEmpty() && fileInfo.fileName() == currentTheme ) {
-	    mDebug() << "FileStorageWatcher: Skipping " << themeDirectory
-	             << " for now";
-	    lastTheme = themeDirectory;
-	    continue;
-	}
-	
-	ensureSizePerTheme( themeDirectory );
-    }
-    
-    if( keepDeleting() ) {
-	mDebug() << "Removing files of: "
-	         << lastTheme;
-	ensureSizePerTheme( lastTheme );
-    }
-}
-
-static bool greaterThanByNumber( const QString &s1, const QString &s2)
-{
-    return s1.toInt() > s2.toInt();
-}
-
-void FileStorageWatcherThread::ensureSizePerTheme( const QString &themeDirectory )
-{
-    mDebug() << "Deleting from folder: " << themeDirectory;
-
-    // Delete from folders with high numbers first
-    QStringList folders =
-	QDir( themeDirectory ).entryList(   QDir::Dirs
-					  | QDir::NoDotAndDotDot );
-    qSort( folders.begin(), folders.end(), greaterThanByNumber );
-    
-    QStringListIterator itTheme( folders );
-    while ( itTheme.hasNext() &&
-	    keepDeleting() ) {
-	QString subDirectory = itTheme.next();
-
-	// Do not delete base tiles
-	if ( subDirectory.toInt() <= maxBaseTileLevel ) {
-	    continue;
-	}
-	
-	QString tileDirectory = themeDirectory + '/' + subDirectory;
-	
-	QDirIterator itTile( tileDirectory,
-			     QDir::Files | QDir::NoSymLinks,
-			     QDirIterator::Subdirectories );
-	while ( itTile.hasNext() &&
-	        keepDeleting() ) {
-	    itTile.next();
-	    QString filePath = itTile.filePath();
-	    QString lowerCase = filePath.toLower();
-	
-	    QFileInfo info( filePath );
-	
-	    // We try to be very careful and just delete images
-	    // Do not delete files younger than two minutes.
-        // FIXME, when vectortiling I suppose also vector tiles will have
-        // to be deleted
-	    if (   (    lowerCase.endsWith( QLatin1String( ".jpg" ) ) 
-	             || lowerCase.endsWith( QLatin1String( ".png" ) )
-	             || lowerCase.endsWith( QLatin1String( ".gif" ) )
-	             || lowerCase.endsWith( QLatin1String( ".svg" ) ) )
-		&& ( info.lastModified().secsTo( QDateTime::currentDateTime() )
-		     > deleteOnlyFilesOlderThan ) )
-	    {
-		mDebug() << "FileStorageWatcher: Delete "
-		         << filePath;
-		m_filesDeleted++;
-		m_currentCacheSize -= info.size();
-		QFile::remove( filePath );
-	    }
-	}
-    }
-}
-
-bool FileStorageWatcherThread::keepDeleting() const
-{
-    return ( ( m_currentCacheSize > m_cacheSoftLimit ) &&
-	     ( m_filesDeleted <= maxFilesDelete ) &&
-              !m_willQuit );
-}
 // End of methods of our Thread
 
 
@@ -364,6 +495,11 @@ void FileStorageWatcher::addToCurrentSize( qint64 bytes )
     emit sizeChanged( bytes );
 }
 
+void FileStorageWatcher::addFile( const QString &fileName )
+{
+    emit fileAdded( fileName );
+}
+
 void FileStorageWatcher::resetCurrentSize()
 {
     emit cleared();
@@ -394,6 +530,8 @@ void FileStorageWatcher::run()
 	
 	connect( this, SIGNAL(sizeChanged(qint64)),
 		 m_thread, SLOT(addToCurrentSize(qint64)) );
+	connect( this, SIGNAL(fileAdded(QString)),
+		 m_thread, SLOT(addFile(QString)) );
 	connect( this, SIGNAL(cleared()),
 		 m_thread, SLOT(resetCurrentSize()) );
     
@@ -403,6 +541,8 @@ void FileStorageWatcher::run()
 	    exec();
     
 	m_started = false;
+	
+	m_thread->saveIndex();
     }
     delete m_thread;
     m_thread = 0;
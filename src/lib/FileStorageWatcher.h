@@ -12,14 +12,19 @@
 #define MARBLE_FILESTORAGEWATCHER_H
 
 #include <QtCore/QThread>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
 #include <QtCore/QMutex>
+#include <QtCore/QPair>
 #include <QtCore/QSet>
 
+#include "marble_export.h"
+
 namespace Marble
 {
     
 // Lives inside the new Thread
-class FileStorageWatcherThread : public QObject
+class MARBLE_EXPORT FileStorageWatcherThread : public QObject
 {
     Q_OBJECT
     
@@ -48,6 +53,12 @@ class FileStorageWatcherThread : public QObject
 	 */
 	void addToCurrentSize( qint64 bytes );
 	
+	/**
+	 * Adds the file at @p fileName to the index of files which may be
+	 * deleted, or updates its entry.
+	 */
+	void addFile( const QString &fileName );
+	
 	/**
 	 * Setting current cache size to 0.
 	 */
@@ -67,9 +78,17 @@ class FileStorageWatcherThread : public QObject
 	void prepareQuit();
 	
 	/**
-	 * Getting the current size of the data stored on the disc
+	 * Getting the current size of the data stored on the disc.
+	 * The saved index is used if possible, otherwise the data
+	 * directory is scanned.
 	 */
 	void getCurrentCacheSize();
+	
+	/**
+	 * Saves the index of deletable files and the cache size,
+	 * so that the next start doesn't need to scan the data directory.
+	 */
+	void saveIndex();
 
     private Q_SLOTS:
 	/**
@@ -80,28 +99,48 @@ class FileStorageWatcherThread : public QObject
     private:
 	Q_DISABLE_COPY( FileStorageWatcherThread )
 	
+	// (last modified, path relative to the data directory) -> size
+	typedef QMap<QPair<uint, QString>, qint64> FilesByAge;
+	
 	/**
-	 * Deletes files of a planet if needed
+	 * Loads the index saved by saveIndex(), returns false if there is
+	 * no usable index.
 	 */
-	void ensureSizePerPlanet( const QString &planetDirectory, const QString &currentTheme = QString() );
+	bool loadIndex();
 	
 	/**
-	 * Deletes files of a theme if needed
+	 * Adds a file to the index if it is a tile which may be deleted.
 	 */
-	void ensureSizePerTheme( const QString &themeDirectory );
+	void indexFile( const QString &relativePath, qint64 size, uint lastModified );
 	
 	/**
-	 * Returns true if it is necessary to delete files.
+	 * Returns the files of the theme which should lose its oldest file
+	 * next, or 0 if there is nothing left to delete.
 	 */
-	bool keepDeleting() const;
+	FilesByAge *nextFilesToDelete( const QString &currentTheme, uint youngest );
+	
+	/**
+	 * Removes the oldest tiles from the tile archives until the cache
+	 * size reaches the soft limit, the archive of the current theme last.
+	 */
+	void shrinkArchives( const QString &currentTheme, uint youngest );
+	
+	QString indexFileName() const;
 	
 	QString m_dataDirectory;
 	
         quint64 m_cacheLimit;
 	quint64 m_cacheSoftLimit;
         quint64 m_currentCacheSize;
-	int     m_filesDeleted;
 	bool 	m_deleting;
+	
+	// theme ("planet/theme") -> deletable files of this theme
+	QHash<QString, FilesByAge> m_filesByTheme;
+	// path relative to the data directory -> last modified
+	QHash<QString, uint> m_fileAges;
+	// themes ("planet/theme") which store their tiles in a TileArchive
+	QSet<QString> m_archiveThemes;
+	uint    m_indexCreated;
 	QString m_mapThemeId;
 	QMutex	m_limitMutex;
 	QMutex	m_themeMutex;
@@ -156,8 +195,14 @@ class FileStorageWatcher : public QThread
 	 */
 	void updateTheme( const QString &mapTheme );
 	
+	/**
+	 * Tells the watcher about a file which was written to the cache.
+	 */
+	void addFile( const QString &fileName );
+	
     Q_SIGNALS:
 	void sizeChanged( qint64 bytes );
+	void fileAdded( const QString &fileName );
 	void cleared();
 	
     protected:
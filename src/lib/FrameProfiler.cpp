@@ -0,0 +1,266 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include "FrameProfiler.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+namespace Marble
+{
+
+class FrameProfilerPrivate
+{
+ public:
+    FrameProfilerPrivate( int frameCount );
+
+    void trim();
+
+    bool m_enabled;
+    int m_frameCount;
+    int m_frameNumber;
+
+    // measures the start of the frames
+    QTime m_clock;
+    // measures the events relative to the start of the current frame
+    QTime m_frameTimer;
+
+    // The following members are guarded by m_mutex
+    QMutex m_mutex;
+    bool m_recording;
+    FrameProfiler::Frame m_currentFrame;
+    QList<FrameProfiler::Frame> m_frames;
+};
+
+FrameProfilerPrivate::FrameProfilerPrivate( int frameCount ) :
+    m_enabled( false ),
+    m_frameCount( frameCount ),
+    m_frameNumber( 0 ),
+    m_recording( false )
+{
+    m_clock.start();
+}
+
+void FrameProfilerPrivate::trim()
+{
+    while ( m_frames.size() > m_frameCount ) {
+        m_frames.removeFirst();
+    }
+}
+
+static QString csvField( const QString &text )
+{
+    if ( !text.contains( ',' ) && !text.contains( '"' ) && !text.contains( '\n' ) ) {
+        return text;
+    }
+
+    QString result = text;
+    result.replace( '"', "\"\"" );
+    return '"' + result + '"';
+}
+
+static QString jsonString( const QString &text )
+{
+    QString result;
+    result.reserve( text.size() + 2 );
+    result += '"';
+    foreach ( const QChar &c, text ) {
+        if ( c == '"' || c == '\\' ) {
+            result += '\\';
+            result += c;
+        } else if ( c.unicode() < 0x20 ) {
+            result += QString( "\\u%1" ).arg( c.unicode(), 4, 16, QChar( '0' ) );
+        } else {
+            result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+FrameProfiler::FrameProfiler( int frameCount ) :
+    d( new FrameProfilerPrivate( qMax( 1, frameCount ) ) )
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    delete d;
+}
+
+bool FrameProfiler::isEnabled() const
+{
+    return d->m_enabled;
+}
+
+void FrameProfiler::setEnabled( bool enabled )
+{
+    d->m_enabled = enabled;
+}
+
+int FrameProfiler::frameCount() const
+{
+    return d->m_frameCount;
+}
+
+void FrameProfiler::setFrameCount( int frameCount )
+{
+    QMutexLocker locker( &d->m_mutex );
+    d->m_frameCount = qMax( 1, frameCount );
+    d->trim();
+}
+
+void FrameProfiler::beginFrame()
+{
+    if ( !d->m_enabled ) {
+        return;
+    }
+
+    QMutexLocker locker( &d->m_mutex );
+    d->m_currentFrame = Frame();
+    d->m_currentFrame.number = d->m_frameNumber++;
+    d->m_currentFrame.start = d->m_clock.elapsed();
+    d->m_currentFrame.duration = 0;
+    d->m_frameTimer.start();
+    d->m_recording = true;
+}
+
+void FrameProfiler::endFrame()
+{
+    QMutexLocker locker( &d->m_mutex );
+    if ( !d->m_recording ) {
+        return;
+    }
+
+    d->m_currentFrame.duration = d->m_frameTimer.elapsed();
+    d->m_frames.append( d->m_currentFrame );
+    d->m_currentFrame = Frame();
+    d->m_recording = false;
+    d->trim();
+}
+
+bool FrameProfiler::isRecording() const
+{
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_recording;
+}
+
+int FrameProfiler::elapsed() const
+{
+    return d->m_frameTimer.elapsed();
+}
+
+void FrameProfiler::addEvent( const QString &name, const QString &category, int start, int duration, int thread )
+{
+    QMutexLocker locker( &d->m_mutex );
+    if ( !d->m_recording ) {
+        return;
+    }
+
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.thread = thread;
+    event.start = start;
+    event.duration = duration;
+    d->m_currentFrame.events.append( event );
+}
+
+void FrameProfiler::addCounter( const QString &name, qint64 value )
+{
+    QMutexLocker locker( &d->m_mutex );
+    if ( !d->m_recording ) {
+        return;
+    }
+
+    d->m_currentFrame.counters[name] += value;
+}
+
+QList<FrameProfiler::Frame> FrameProfiler::frames() const
+{
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_frames;
+}
+
+void FrameProfiler::clear()
+{
+    QMutexLocker locker( &d->m_mutex );
+    d->m_frames.clear();
+}
+
+QString FrameProfiler::toCsv() const
+{
+    QStringList lines;
+    lines << "frame,category,name,thread,start,duration,value";
+
+    foreach ( const Frame &frame, frames() ) {
+        lines << QString( "%1,frame,frame,0,0,%2," ).arg( frame.number ).arg( frame.duration );
+
+        foreach ( const Event &event, frame.events ) {
+            lines << QString( "%1,%2,%3,%4,%5,%6," )
+                     .arg( QString::number( frame.number ),
+                           csvField( event.category ),
+                           csvField( event.name ),
+                           QString::number( event.thread ),
+                           QString::number( event.start ),
+                           QString::number( event.duration ) );
+        }
+
+        QMap<QString, qint64>::ConstIterator it = frame.counters.constBegin();
+        QMap<QString, qint64>::ConstIterator const end = frame.counters.constEnd();
+        for ( ; it != end; ++it ) {
+            lines << QString( "%1,counter,%2,,,,%3" )
+                     .arg( QString::number( frame.number ),
+                           csvField( it.key() ),
+                           QString::number( it.value() ) );
+        }
+    }
+
+    return lines.join( "\n" ) + '\n';
+}
+
+QString FrameProfiler::toChromeTrace() const
+{
+    // The trace event format measures time in microseconds
+    QStringList events;
+
+    foreach ( const Frame &frame, frames() ) {
+        const qint64 frameStart = frame.start * 1000;
+
+        events << QString( "{\"name\":%1,\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%2,\"dur\":%3}" )
+                  .arg( jsonString( QString( "Frame %1" ).arg( frame.number ) ),
+                        QString::number( frameStart ),
+                        QString::number( qint64( frame.duration ) * 1000 ) );
+
+        foreach ( const Event &event, frame.events ) {
+            events << QString( "{\"name\":%1,\"cat\":%2,\"ph\":\"X\",\"pid\":1,\"tid\":%3,\"ts\":%4,\"dur\":%5}" )
+                      .arg( jsonString( event.name ),
+                            jsonString( event.category ),
+                            QString::number( event.thread ),
+                            QString::number( frameStart + qint64( event.start ) * 1000 ),
+                            QString::number( qint64( event.duration ) * 1000 ) );
+        }
+
+        QMap<QString, qint64>::ConstIterator it = frame.counters.constBegin();
+        QMap<QString, qint64>::ConstIterator const end = frame.counters.constEnd();
+        for ( ; it != end; ++it ) {
+            events << QString( "{\"name\":%1,\"cat\":\"counter\",\"ph\":\"C\",\"pid\":1,\"ts\":%2,\"args\":{\"value\":%3}}" )
+                      .arg( jsonString( it.key() ),
+                            QString::number( frameStart ),
+                            QString::number( it.value() ) );
+        }
+    }
+
+    return "{\"traceEvents\":[\n" + events.join( ",\n" ) + "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+}
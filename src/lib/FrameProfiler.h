@@ -0,0 +1,137 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#ifndef MARBLE_FRAMEPROFILER_H
+#define MARBLE_FRAMEPROFILER_H
+
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class FrameProfilerPrivate;
+
+/**
+ * @short Timings and counters of the most recently painted frames.
+ *
+ * While enabled, the profiler records for every frame between beginFrame()
+ * and endFrame() how long each layer took to prepare for the viewport and to
+ * render, how long the texture mapping took, and counters such as the hits
+ * and misses of the tile cache. Only the last frameCount() frames are kept.
+ *
+ * The recorded frames can be exported as CSV or in the JSON format of the
+ * Chrome trace viewer (chrome://tracing).
+ *
+ * Timings are measured in milliseconds relative to the start of the frame.
+ * Events may be added from any thread while a frame is being recorded.
+ */
+class MARBLE_EXPORT FrameProfiler
+{
+ public:
+    /**
+     * A timed step of a frame, e.g. a layer preparing for the viewport.
+     */
+    struct Event
+    {
+        QString name;
+        QString category;
+        int thread;
+        int start;
+        int duration;
+    };
+
+    struct Frame
+    {
+        int number;
+        qint64 start;
+        int duration;
+        QList<Event> events;
+        QMap<QString, qint64> counters;
+    };
+
+    explicit FrameProfiler( int frameCount = 100 );
+    ~FrameProfiler();
+
+    /**
+     * Returns whether frames are recorded (default: false).
+     */
+    bool isEnabled() const;
+
+    void setEnabled( bool enabled );
+
+    /**
+     * Returns how many of the most recent frames are kept.
+     */
+    int frameCount() const;
+
+    void setFrameCount( int frameCount );
+
+    /**
+     * Starts recording a new frame, if the profiler is enabled.
+     */
+    void beginFrame();
+
+    /**
+     * Finishes the frame started by beginFrame().
+     */
+    void endFrame();
+
+    /**
+     * Returns whether a frame is currently being recorded.
+     */
+    bool isRecording() const;
+
+    /**
+     * Returns the milliseconds passed since beginFrame().
+     */
+    int elapsed() const;
+
+    /**
+     * Adds a step of @p duration milliseconds which started @p start
+     * milliseconds after beginFrame(). Steps running concurrently should be
+     * given distinct @p thread numbers, 0 being the GUI thread.
+     */
+    void addEvent( const QString &name, const QString &category, int start, int duration, int thread = 0 );
+
+    /**
+     * Adds @p value to the counter @p name of the current frame.
+     */
+    void addCounter( const QString &name, qint64 value );
+
+    /**
+     * Returns the recorded frames, oldest first.
+     */
+    QList<Frame> frames() const;
+
+    void clear();
+
+    /**
+     * Returns one line per event and counter of the recorded frames.
+     */
+    QString toCsv() const;
+
+    /**
+     * Returns the recorded frames in the Chrome trace event format.
+     */
+    QString toChromeTrace() const;
+
+ private:
+    Q_DISABLE_COPY( FrameProfiler )
+
+    FrameProfilerPrivate *const d;
+};
+
+}
+
+#endif
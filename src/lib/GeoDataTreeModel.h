@@ -96,6 +96,13 @@ public Q_SLOTS:
 
     int addDocument( GeoDataDocument *document );
 
+    /**
+     * Appends all @p documents to the root document with a single row
+     * insertion, which is much cheaper for views and proxy models than
+     * adding them one by one.
+     */
+    void addDocuments( const QList<GeoDataDocument*> &documents );
+
     void removeDocument( int index );
 
     void removeDocument( GeoDataDocument* document );
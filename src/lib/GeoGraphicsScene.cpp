@@ -18,9 +18,10 @@
 #include "GeoDataTypes.h"
 #include "GeoGraphicsItem.h"
 #include "TileId.h"
-#include "TileCoordsPyramid.h"
 #include "MarbleDebug.h"
-#include <QtCore/QMap>
+#include <QtCore/QHash>
+#include <QtCore/QRect>
+#include <QtCore/QVector>
 
 namespace Marble
 {
@@ -30,14 +31,58 @@ bool zValueLessThan( GeoGraphicsItem* i1, GeoGraphicsItem* i2 )
     return i1->zValue() < i2->zValue();
 }
 
+/**
+ * A node of the quad tree the items are stored in. The node at level 0 covers
+ * the whole world and each child covers a quarter of its parent, just like
+ * the tiles of TileId. Children are only created when items are added to them.
+ */
+class GeoGraphicsSceneNode
+{
+public:
+    GeoGraphicsSceneNode()
+    {
+        for ( int i = 0; i < 4; ++i ) {
+            m_children[i] = 0;
+        }
+    }
+
+    ~GeoGraphicsSceneNode()
+    {
+        for ( int i = 0; i < 4; ++i ) {
+            delete m_children[i];
+        }
+    }
+
+    GeoGraphicsSceneNode *m_children[4];
+
+    /// The items stored in this node, sorted by their z value
+    QList<GeoGraphicsItem*> m_items;
+};
+
 class GeoGraphicsScenePrivate
 {
 public:
+    GeoGraphicsScenePrivate()
+        : m_root( new GeoGraphicsSceneNode )
+    {
+    }
+
+    ~GeoGraphicsScenePrivate()
+    {
+        delete m_root;
+    }
+
+    static QRect tileRect( const GeoDataLatLonBox &box, int zoomLevel );
 
-    void addItems( const TileId &tileId, QList<GeoGraphicsItem*> &result, const GeoDataLatLonBox &bbox, int maxZoomLevel ) const;
+    void addItems( const GeoGraphicsSceneNode *node, const TileId &tileId,
+                   const QVector<QRect> &tileRects, QList<GeoGraphicsItem*> &result,
+                   const GeoDataLatLonBox &bbox, int maxZoomLevel ) const;
 
-    QMap<TileId, QList<GeoGraphicsItem*> > m_items;
-    QMultiHash<const GeoDataFeature*, TileId> m_features;
+    void reset();
+
+    GeoGraphicsSceneNode *m_root;
+    QMultiHash<const GeoDataFeature*, GeoGraphicsItem*> m_features;
+    QHash<GeoGraphicsItem*, GeoGraphicsSceneNode*> m_nodes;
 };
 
 GeoGraphicsScene::GeoGraphicsScene( QObject* parent ): QObject( parent ), d( new GeoGraphicsScenePrivate() )
@@ -52,19 +97,15 @@ GeoGraphicsScene::~GeoGraphicsScene()
 
 void GeoGraphicsScene::eraseAll()
 {
-    for( QMap< TileId, QList< GeoGraphicsItem* > >::const_iterator i = d->m_items.constBegin();
-         i != d->m_items.constEnd(); ++i )
-    {
-        qDeleteAll(*i);
-    }
-    d->m_items.clear();
-    d->m_features.clear();
+    qDeleteAll( d->m_nodes.keys() );
+    d->reset();
 }
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box, int zoomLevel ) const
 {
+    QVector<QRect> tileRects;
     if ( box.west() > box.east() ) {
-        // Handle boxes crossing the IDL by splitting it into two separate boxes
+        // Handle boxes crossing the IDL by looking up the tiles of both sides
         GeoDataLatLonBox left;
         left.setWest( -M_PI );
         left.setEast( box.east() );
@@ -77,63 +118,46 @@ QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box,
         right.setNorth( box.north() );
         right.setSouth( box.south() );
 
-        QList< GeoGraphicsItem* > allItems = items( left, zoomLevel );
-        foreach( GeoGraphicsItem* item, items( right, zoomLevel ) ) {
-            if ( !allItems.contains( item ) ) {
-                allItems << item;
-            }
-        }
-        return allItems;
+        tileRects << d->tileRect( left, zoomLevel ) << d->tileRect( right, zoomLevel );
+    } else {
+        tileRects << d->tileRect( box, zoomLevel );
     }
 
     QList< GeoGraphicsItem* > result;
-    QRect rect;
-    qreal north, south, east, west;
-    box.boundaries( north, south, east, west );
-    TileId key;
+    d->addItems( d->m_root, TileId( 0, 0, 0, 0 ), tileRects, result, box, zoomLevel );
 
-    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel );
-    rect.setLeft( key.x() );
-    rect.setTop( key.y() );
+    // The items of each node are sorted already, but the nodes overlap in z
+    qStableSort( result.begin(), result.end(), zValueLessThan );
 
-    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel );
-    rect.setRight( key.x() );
-    rect.setBottom( key.y() );
-    
-    TileCoordsPyramid pyramid( 0, zoomLevel );
-    pyramid.setBottomLevelCoords( rect );
-
-    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
-        QRect const coords = pyramid.coords( level );
-        int x1, y1, x2, y2;
-        coords.getCoords( &x1, &y1, &x2, &y2 );
-        for ( int x = x1; x <= x2; ++x ) {
-            for ( int y = y1; y <= y2; ++y ) {
-                d->addItems( TileId ( 0, level, x, y ), result, box, zoomLevel );
-            }
-        }
-    }
     return result;
 }
 
 void GeoGraphicsScene::removeItem( const GeoDataFeature* feature )
 {
-    QList<TileId> keys = d->m_features.values( feature );
-    foreach( TileId key, keys ) {
-        QList< GeoGraphicsItem* >& tileList = d->m_items[key];
-        foreach( GeoGraphicsItem* item, tileList ) {
-            if( item->feature() == feature ) {
-                d->m_features.remove( feature );
-                tileList.removeAll( item );
-                break;
-            }
+    foreach( GeoGraphicsItem* item, d->m_features.values( feature ) ) {
+        GeoGraphicsSceneNode *node = d->m_nodes.take( item );
+        if ( !node ) {
+            continue;
+        }
+
+        QList< GeoGraphicsItem* > &itemList = node->m_items;
+        QList< GeoGraphicsItem* >::iterator position = qLowerBound( itemList.begin(), itemList.end(), item, zValueLessThan );
+        while ( position != itemList.end() && *position != item && (*position)->zValue() == item->zValue() ) {
+            ++position;
+        }
+        if ( position != itemList.end() && *position == item ) {
+            itemList.erase( position );
+        } else {
+            // The z value changed after the item was added
+            itemList.removeOne( item );
         }
     }
+    d->m_features.remove( feature );
 }
 
 void GeoGraphicsScene::clear()
 {
-    d->m_items.clear();
+    d->reset();
 }
 
 void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
@@ -151,31 +175,89 @@ void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
 
     const TileId key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ); // same as GeoDataCoordinates(east, south, 0), see above
 
-    QList< GeoGraphicsItem* >& tileList = d->m_items[key];
-    QList< GeoGraphicsItem* >::iterator position = qLowerBound( tileList.begin(), tileList.end(), item, zValueLessThan );
-    tileList.insert( position, item );
-    d->m_features.insert( item->feature(), key );
+    // Walk down from the root along the ancestors of the tile
+    GeoGraphicsSceneNode *node = d->m_root;
+    for ( int level = 1; level <= key.zoomLevel(); ++level ) {
+        const int shift = key.zoomLevel() - level;
+        const int child = ( ( key.x() >> shift ) & 1 ) + 2 * ( ( key.y() >> shift ) & 1 );
+        if ( !node->m_children[child] ) {
+            node->m_children[child] = new GeoGraphicsSceneNode;
+        }
+        node = node->m_children[child];
+    }
+
+    QList< GeoGraphicsItem* >& itemList = node->m_items;
+    QList< GeoGraphicsItem* >::iterator position = qLowerBound( itemList.begin(), itemList.end(), item, zValueLessThan );
+    itemList.insert( position, item );
+    d->m_features.insert( item->feature(), item );
+    d->m_nodes.insert( item, node );
 }
 
-void GeoGraphicsScenePrivate::addItems( const TileId &tileId, QList<GeoGraphicsItem *> &result, const GeoDataLatLonBox &bbox, int maxZoomLevel ) const
+QRect GeoGraphicsScenePrivate::tileRect( const GeoDataLatLonBox &box, int zoomLevel )
 {
-    const QList< GeoGraphicsItem* > &objects = m_items.value(tileId);
-    QList< GeoGraphicsItem* >::iterator before = result.begin();
-    QList< GeoGraphicsItem* >::const_iterator currentItem = objects.constBegin();
-    while( currentItem != objects.end() ) {
-        while( ( currentItem != objects.end() )
-          && ( ( before == result.end() ) || ( (*currentItem)->zValue() < (*before)->zValue() ) ) ) {
-            if ( (*currentItem)->minZoomLevel() <= maxZoomLevel && (*currentItem)->visible() && (*currentItem)->latLonAltBox().intersects( bbox ) ) {
-                before = result.insert( before, *currentItem );
-            }
-            ++currentItem;
+    QRect rect;
+    qreal north, south, east, west;
+    box.boundaries( north, south, east, west );
+    TileId key;
+
+    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel );
+    rect.setLeft( key.x() );
+    rect.setTop( key.y() );
+
+    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel );
+    rect.setRight( key.x() );
+    rect.setBottom( key.y() );
+
+    // A box ending at the date line may wrap around to the western tiles
+    if ( zoomLevel >= 0 && rect.right() < rect.left() ) {
+        rect.setRight( ( 1 << zoomLevel ) - 1 );
+    }
+
+    return rect;
+}
+
+void GeoGraphicsScenePrivate::addItems( const GeoGraphicsSceneNode *node, const TileId &tileId,
+                                        const QVector<QRect> &tileRects, QList<GeoGraphicsItem *> &result,
+                                        const GeoDataLatLonBox &bbox, int maxZoomLevel ) const
+{
+    foreach ( GeoGraphicsItem *item, node->m_items ) {
+        if ( item->minZoomLevel() <= maxZoomLevel && item->visible() && item->latLonAltBox().intersects( bbox ) ) {
+            result.append( item );
+        }
+    }
+
+    // Items of deeper levels have a higher minimum zoom level
+    const int level = tileId.zoomLevel() + 1;
+    if ( level > maxZoomLevel ) {
+        return;
+    }
+
+    const int shift = maxZoomLevel - level;
+    for ( int child = 0; child < 4; ++child ) {
+        if ( !node->m_children[child] ) {
+            continue;
         }
-        if ( before != result.end() ) {
-            ++before;
+
+        const int x = 2 * tileId.x() + ( child & 1 );
+        const int y = 2 * tileId.y() + ( child >> 1 );
+        foreach ( const QRect &rect, tileRects ) {
+            if ( ( rect.left() >> shift ) <= x && x <= ( rect.right() >> shift )
+                 && ( rect.top() >> shift ) <= y && y <= ( rect.bottom() >> shift ) ) {
+                addItems( node->m_children[child], TileId( 0, level, x, y ), tileRects, result, bbox, maxZoomLevel );
+                break;
+            }
         }
     }
 }
 
+void GeoGraphicsScenePrivate::reset()
+{
+    delete m_root;
+    m_root = new GeoGraphicsSceneNode;
+    m_features.clear();
+    m_nodes.clear();
+}
+
 }
 
 #include "GeoGraphicsScene.moc"
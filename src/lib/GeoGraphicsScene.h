@@ -28,6 +28,10 @@ class GeoGraphicsScenePrivate;
 
 /**
  * @short This is the home of all GeoGraphicsItems to be shown on the map.
+ *
+ * The items are kept in a quad tree following the tiling of TileId, so
+ * adding and removing items as well as looking up the items of a box only
+ * touch the parts of the tree that actually contain items.
  */
 class MARBLE_EXPORT GeoGraphicsScene : public QObject
 {
@@ -73,7 +77,7 @@ public:
      *
      * @param box The box around the items.
      * @param maxZoomLevel The max zoom level of tiling
-     * @return The list of items in the specified box in no specific order.
+     * @return The list of items in the specified box, sorted by their z value.
      */
     QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int maxZoomLevel ) const;
 
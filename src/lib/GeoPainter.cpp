@@ -12,6 +12,8 @@
 #include "GeoPainter_p.h"
 
 #include <QtCore/QList>
+#include <QtGui/QImage>
+#include <QtGui/QPaintEngine>
 #include <QtGui/QPainterPath>
 #include <QtGui/QRegion>
 
@@ -828,22 +830,99 @@ void GeoPainter::drawRoundRect ( const GeoDataCoordinates &centerPosition,
         }
 }
 
+/**
+ * Returns the image painted on by @p painter if the texture can be mapped into it
+ * directly, i.e. if drawing an opaque canvas of @p size and @p format would just
+ * replace the pixels of the image.
+ */
+static QImage *directCanvasImage( const QPainter *painter, const QSize &size, QImage::Format format )
+{
+    QPaintDevice *const device = painter->device();
+    if ( !device || device->devType() != QInternal::Image
+         || !painter->paintEngine() || painter->paintEngine()->type() != QPaintEngine::Raster ) {
+        return 0;
+    }
+
+    QImage *const image = static_cast<QImage *>( device );
+    if ( image->size() != size || image->format() != format || !image->isDetached() ) {
+        // writing to a shared image would detach it from the paint engine
+        return 0;
+    }
+
+    if ( painter->hasClipping()
+         || !painter->combinedTransform().isIdentity()
+         || painter->opacity() != 1.0
+         || painter->compositionMode() != QPainter::CompositionMode_SourceOver ) {
+        return 0;
+    }
+
+    return image;
+}
+
 void GeoPainter::mapTexture( StackedTileLoader *loader, int tileLevel, const QRect &dirtyRect, TextureColorizer *texColorizer )
 {
+    QImage canvasImage;
+    mapTexture( loader, tileLevel, dirtyRect, texColorizer,
+                &canvasImage, QRect( QPoint( 0, 0 ), d->m_viewport->size() ) );
+}
+
+bool GeoPainter::mapTexture( StackedTileLoader *loader, int tileLevel, const QRect &dirtyRect, TextureColorizer *texColorizer,
+                             QImage *canvasImage, const QRegion &textureDirtyRegion )
+{
+    const QRect canvasRect( QPoint( 0, 0 ), d->m_viewport->size() );
     const QImage::Format optimalFormat = ScanlineTextureMapperContext::optimalCanvasImageFormat( d->m_viewport );
-    QImage canvasImage = QImage( d->m_viewport->size(), optimalFormat );
 
-    if ( !d->m_viewport->mapCoversViewport() ) {
-        canvasImage.fill( 0 );
+    QRegion textureRegion = textureDirtyRegion & canvasRect;
+
+    const bool canvasFits = canvasImage->size() == canvasRect.size() && canvasImage->format() == optimalFormat;
+    if ( !canvasFits ) {
+        textureRegion = canvasRect;
+    }
+
+    // the colorizer can only process the whole canvas
+    if ( texColorizer && !textureRegion.isEmpty() ) {
+        textureRegion = canvasRect;
     }
 
-    d->m_textureMapper->mapTexture( &canvasImage, loader, d->m_viewport, tileLevel, d->m_mapQuality );
+    // If the whole texture needs to be mapped anyway and the map is opaque, mapping
+    // into the paint device saves drawing the canvas. The canvas is not updated then.
+    if ( textureRegion == QRegion( canvasRect ) && d->m_viewport->mapCoversViewport() ) {
+        QImage *const deviceImage = directCanvasImage( this, canvasRect.size(), optimalFormat );
+        if ( deviceImage ) {
+            d->m_textureMapper->mapTexture( deviceImage, loader, d->m_viewport, tileLevel, d->m_mapQuality, canvasRect );
 
-    if ( texColorizer ) {
-        texColorizer->colorize( &canvasImage, d->m_viewport, d->m_mapQuality );
+            if ( texColorizer ) {
+                texColorizer->colorize( deviceImage, d->m_viewport, d->m_mapQuality );
+            }
+
+            return false;
+        }
+    }
+
+    if ( !canvasFits ) {
+        *canvasImage = QImage( canvasRect.size(), optimalFormat );
+    }
+
+    if ( !textureRegion.isEmpty() ) {
+        foreach ( const QRect &textureRect, textureRegion.rects() ) {
+            if ( !d->m_viewport->mapCoversViewport() ) {
+                for ( int y = textureRect.top(); y <= textureRect.bottom(); ++y ) {
+                    QRgb *const scanLine = (QRgb*)( canvasImage->scanLine( y ) );
+                    qFill( scanLine + textureRect.left(), scanLine + textureRect.right() + 1, 0 );
+                }
+            }
+
+            d->m_textureMapper->mapTexture( canvasImage, loader, d->m_viewport, tileLevel, d->m_mapQuality, textureRect );
+        }
+
+        if ( texColorizer ) {
+            texColorizer->colorize( canvasImage, d->m_viewport, d->m_mapQuality );
+        }
     }
 
     QRect rect = d->m_textureMapper->rect( d->m_viewport );
     rect = rect.intersect( dirtyRect );
-    QPainter::drawImage( rect, canvasImage, rect );
+    QPainter::drawImage( rect, *canvasImage, rect );
+
+    return true;
 }
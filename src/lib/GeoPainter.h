@@ -447,6 +447,24 @@ class MARBLE_EXPORT GeoPainter : public ClipPainter
 
     void mapTexture( StackedTileLoader *loader, int tileLevel, const QRect &dirtyRect, TextureColorizer *texColorizer );
 
+/*!
+    \brief Draws the texture from a canvas which is kept across frames.
+
+    Only the parts of \a canvasImage which intersect \a textureDirtyRegion
+    get mapped again, unless the canvas does not fit the viewport anymore.
+    Depending on the projection, the texture mapper may map the whole rows
+    of each rectangle of the region. The area \a dirtyRect of the canvas is
+    then drawn.
+
+    If the whole texture needs to be mapped and the painter paints on a
+    QImage which the canvas would cover completely, the texture is mapped
+    into that image instead and \a canvasImage is left untouched.
+
+    \return \c false if \a canvasImage was bypassed and is outdated now
+*/
+    bool mapTexture( StackedTileLoader *loader, int tileLevel, const QRect &dirtyRect, TextureColorizer *texColorizer,
+                     QImage *canvasImage, const QRegion &textureDirtyRegion );
+
 
 
     // Reenabling QPainter+ClipPainter methods.
@@ -19,6 +19,7 @@
 #include "AbstractDataPlugin.h"
 #include "AbstractDataPluginItem.h"
 #include "AbstractFloatItem.h"
+#include "FrameProfiler.h"
 #include "GeoPainter.h"
 #include "MarbleModel.h"
 #include "PluginManager.h"
@@ -26,6 +27,10 @@
 #include "LayerInterface.h"
 #include "ViewportParams.h"
 
+// Qt
+#include <QtCore/QHash>
+#include <QtCore/QTime>
+
 namespace Marble
 {
 
@@ -39,6 +44,23 @@ bool zValueLessThan( const LayerInterface * const one, const LayerInterface * co
     return one->zValue() < two->zValue();
 }
 
+/**
+  * Returns the name of @p layer in the frame profile. Layers which are neither plugins
+  * nor QObjects are named after their render positions.
+  */
+static QString layerName( const LayerInterface *layer )
+{
+    if ( const RenderPlugin *renderPlugin = dynamic_cast<const RenderPlugin *>( layer ) ) {
+        return renderPlugin->nameId();
+    }
+
+    if ( const QObject *object = dynamic_cast<const QObject *>( layer ) ) {
+        return QString( object->metaObject()->className() ).remove( "Marble::" );
+    }
+
+    return layer->renderPosition().join( "," );
+}
+
 class LayerManager::Private
 {
  public:
@@ -60,6 +82,8 @@ class LayerManager::Private
     bool m_showBackground;
 
     bool m_showRuntimeTrace;
+
+    FrameProfiler *m_frameProfiler;
 };
 
 LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
@@ -67,7 +91,8 @@ LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
       m_renderPlugins(),
       m_model( model ),
       m_showBackground( true ),
-      m_showRuntimeTrace( false )
+      m_showRuntimeTrace( false ),
+      m_frameProfiler( 0 )
 {
 }
 
@@ -138,7 +163,10 @@ void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
     renderPositions << "SURFACE" << "HOVERS_ABOVE_SURFACE" << "ATMOSPHERE"
                     << "ORBIT" << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS";
 
-    QStringList traceList;
+    // collect the layers of all render positions first, so that they can be
+    // prepared for the viewport at once
+    QList<QList<LayerInterface*> > layersPerPosition;
+    QList<LayerInterface*> allLayers;
     foreach( const QString& renderPosition, renderPositions ) {
         QList<LayerInterface*> layers;
 
@@ -165,17 +193,44 @@ void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
         // sort them according to their zValue()s
         qSort( layers.begin(), layers.end(), zValueLessThan );
 
-        // render the layers of the current renderPosition
-        QTime timer;
         foreach( LayerInterface *layer, layers ) {
+            if ( !allLayers.contains( layer ) ) {
+                allLayers.push_back( layer );
+            }
+        }
+        layersPerPosition.push_back( layers );
+    }
+
+    FrameProfiler *const profiler = d->m_frameProfiler && d->m_frameProfiler->isRecording() ? d->m_frameProfiler : 0;
+
+    // prepare each layer for the viewport once, even if it has several render positions
+    QHash<LayerInterface*, int> viewportTimes;
+    QTime timer;
+    foreach( LayerInterface *layer, allLayers ) {
+        const int start = profiler ? profiler->elapsed() : 0;
+        timer.start();
+        layer->setViewport( viewport );
+        viewportTimes[layer] = timer.elapsed();
+        if ( profiler ) {
+            profiler->addEvent( layerName( layer ), "viewport", start, viewportTimes[layer] );
+        }
+    }
+
+    // render the layers of each renderPosition in the order of their zValue()s
+    QStringList traceList;
+    foreach( const QList<LayerInterface*> &layers, layersPerPosition ) {
+        foreach( LayerInterface *layer, layers ) {
+            const int start = profiler ? profiler->elapsed() : 0;
             timer.start();
-            layer->setViewport( viewport );
             layer->render( painter, viewport->size() );
-            traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+            if ( profiler ) {
+                profiler->addEvent( layerName( layer ), "render", start, timer.elapsed() );
+            }
+            const int elapsed = viewportTimes.value( layer ) + timer.elapsed();
+            traceList.append( QString("%2 ms %3").arg( elapsed,3 ).arg( layer->runtimeTrace() ) );
         }
     }
 
-
     if ( d->m_showRuntimeTrace ) {
         const int totalElapsed = totalTime.elapsed();
         const int fps = 1000.0/totalElapsed;
@@ -277,6 +332,11 @@ QList<LayerInterface *> LayerManager::internalLayers() const
     return d->m_internalLayers;
 }
 
+void LayerManager::setFrameProfiler( FrameProfiler *profiler )
+{
+    d->m_frameProfiler = profiler;
+}
+
 }
 
 #include "LayerManager.moc"
@@ -25,6 +25,7 @@ namespace Marble
 
 class AbstractDataPlugin;
 class AbstractDataPluginItem;
+class FrameProfiler;
 class GeoPainter;
 class ViewportParams;
 class RenderPlugin;
@@ -83,6 +84,12 @@ class LayerManager : public QObject
 
     QList<LayerInterface *> internalLayers() const;
 
+    /**
+     * @brief Records how long each layer takes to prepare and to render in @p profiler,
+     * as long as it is enabled.
+     */
+    void setFrameProfiler( FrameProfiler *profiler );
+
  Q_SIGNALS:
     /**
      * @brief Signal that a render item has been initialized
@@ -57,6 +57,7 @@
 #include "GeoSceneVector.h"
 #include "GeoSceneVectorTile.h"
 #include "GeoSceneZoom.h"
+#include "FrameProfiler.h"
 #include "GeoDataDocument.h"
 #include "LayerManager.h"
 #include "MapThemeManager.h"
@@ -100,6 +101,7 @@ public:
     ViewParams       m_viewParams;
     ViewportParams   m_viewport;
     bool             m_showFrameRate;
+    FrameProfiler    m_frameProfiler;
 
 
     LayerManager     m_layerManager;
@@ -136,6 +138,9 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
     m_layerManager.addLayer( &m_screenLayer );
     m_layerManager.addLayer( &m_placemarkLayer );
 
+    m_layerManager.setFrameProfiler( &m_frameProfiler );
+    m_textureLayer.setFrameProfiler( &m_frameProfiler );
+
     QObject::connect( m_model, SIGNAL(themeChanged(QString)),
                       parent, SLOT(updateMapTheme()) );
     QObject::connect( m_model->fileManager(), SIGNAL(fileAdded(QString)),
@@ -162,11 +167,13 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
 
     QObject::connect( &m_textureLayer, SIGNAL(tileLevelChanged(int)),
                       parent, SIGNAL(tileLevelChanged(int)) );
-    QObject::connect( &m_textureLayer, SIGNAL(repaintNeeded()),
-                      parent, SIGNAL(repaintNeeded()) );
+    QObject::connect( &m_textureLayer, SIGNAL(repaintNeeded(QRegion)),
+                      parent, SIGNAL(repaintNeeded(QRegion)) );
 
     QObject::connect( parent, SIGNAL(visibleLatLonAltBoxChanged(GeoDataLatLonAltBox)),
                       parent, SIGNAL(repaintNeeded()) );
+    QObject::connect( parent, SIGNAL(visibleLatLonAltBoxChanged(GeoDataLatLonAltBox)),
+                      m_model->fileManager(), SLOT(setViewport(GeoDataLatLonAltBox)) );
 }
 
 void MarbleMapPrivate::updateProperty( const QString &name, bool show )
@@ -586,6 +593,11 @@ quint64 MarbleMap::volatileTileCacheLimit() const
     return d->m_textureLayer.volatileCacheLimit();
 }
 
+bool MarbleMap::asynchronousTileLoading() const
+{
+    return d->m_textureLayer.asynchronousTileLoading();
+}
+
 
 void MarbleMap::rotateBy( const qreal& deltaLon, const qreal& deltaLat )
 {
@@ -690,8 +702,6 @@ void MarbleMapPrivate::setDocument( QString key )
 // Used to be paintEvent()
 void MarbleMap::paint( GeoPainter &painter, const QRect &dirtyRect )
 {
-    Q_UNUSED( dirtyRect );
-
     if ( !d->m_model->mapTheme() ) {
         mDebug() << "No theme yet!";
         d->m_marbleSplashLayer.setViewport( &d->m_viewport );
@@ -702,13 +712,30 @@ void MarbleMap::paint( GeoPainter &painter, const QRect &dirtyRect )
     QTime t;
     t.start();
 
+    d->m_frameProfiler.beginFrame();
+
+    // Restrict painting to the damaged area. The texture layer keeps the
+    // mapped texture, so e.g. moving the position marker doesn't require
+    // to map the whole texture again.
+    const QRect viewportRect( QPoint( 0, 0 ), d->m_viewport.size() );
+    const bool partialRepaint = dirtyRect.isValid() && !dirtyRect.contains( viewportRect );
+    if ( partialRepaint ) {
+        painter.setClipRect( dirtyRect );
+    }
+
     d->m_layerManager.renderLayers( &painter, &d->m_viewport );
 
+    if ( partialRepaint ) {
+        painter.setClipping( false );
+    }
+
     if ( d->m_showFrameRate ) {
         FpsLayer fpsPainter( &t );
         fpsPainter.paint( &painter );
     }
 
+    d->m_frameProfiler.endFrame();
+
     const qreal fps = 1000.0 / (qreal)( t.elapsed() );
     emit framesPerSecond( fps );
 }
@@ -1075,6 +1102,31 @@ void MarbleMap::setShowRuntimeTrace( bool visible )
     d->m_layerManager.setShowRuntimeTrace( visible );
 }
 
+void MarbleMap::setFrameProfilingEnabled( bool enabled )
+{
+    d->m_frameProfiler.setEnabled( enabled );
+}
+
+void MarbleMap::setProfiledFrameCount( int count )
+{
+    d->m_frameProfiler.setFrameCount( count );
+}
+
+void MarbleMap::clearFrameProfile()
+{
+    d->m_frameProfiler.clear();
+}
+
+QString MarbleMap::frameProfileCsv() const
+{
+    return d->m_frameProfiler.toCsv();
+}
+
+QString MarbleMap::frameProfileChromeTrace() const
+{
+    return d->m_frameProfiler.toChromeTrace();
+}
+
 void MarbleMap::setShowBackground( bool visible )
 {
     d->m_layerManager.setShowBackground( visible );
@@ -1105,6 +1157,11 @@ void MarbleMap::setVolatileTileCacheLimit( quint64 kilobytes )
     d->m_textureLayer.setVolatileCacheLimit( kilobytes );
 }
 
+void MarbleMap::setAsynchronousTileLoading( bool enabled )
+{
+    d->m_textureLayer.setAsynchronousTileLoading( enabled );
+}
+
 AngleUnit MarbleMap::defaultAngleUnit() const
 {
     if ( GeoDataCoordinates::defaultNotation() == GeoDataCoordinates::Decimal ) {
@@ -1183,6 +1240,11 @@ void MarbleMap::removeLayer( LayerInterface *layer )
     d->m_layerManager.removeLayer(layer);
 }
 
+FrameProfiler *MarbleMap::frameProfiler()
+{
+    return &d->m_frameProfiler;
+}
+
 // this method will only temporarily "pollute" the MarbleModel class
 const TextureLayer *MarbleMap::textureLayer() const
 {
@@ -53,6 +53,7 @@ class RenderPlugin;
 class AbstractDataPlugin;
 class AbstractDataPluginItem;
 class AbstractFloatItem;
+class FrameProfiler;
 class TextureLayer;
 class TileCoordsPyramid;
 
@@ -361,6 +362,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
      */
     quint64 volatileTileCacheLimit() const;
 
+    /**
+     * @brief  Return whether texture tiles are decoded in the background.
+     * @see setAsynchronousTileLoading()
+     */
+    bool asynchronousTileLoading() const;
+
     /**
      * @brief Returns a list of all RenderPlugins in the model, this includes float items
      * @return the list of RenderPlugins
@@ -391,6 +398,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     const TextureLayer *textureLayer() const;
 
+    /**
+     * @brief Returns the per-layer timings of the most recently painted frames.
+     * @see setFrameProfilingEnabled()
+     */
+    FrameProfiler *frameProfiler();
+
     /**
      * @brief Add a layer to be included in rendering.
      */
@@ -612,6 +625,30 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     void setShowRuntimeTrace( bool visible );
 
+    /**
+     * @brief Set whether the timings of the layers get recorded for each frame
+     * @param enabled  whether frames get profiled
+     * @see frameProfileCsv(), frameProfileChromeTrace()
+     */
+    void setFrameProfilingEnabled( bool enabled );
+
+    /**
+     * @brief Set how many of the most recently painted frames are kept by the profiler
+     */
+    void setProfiledFrameCount( int count );
+
+    void clearFrameProfile();
+
+    /**
+     * @brief Returns the profiled frames as comma separated values
+     */
+    QString frameProfileCsv() const;
+
+    /**
+     * @brief Returns the profiled frames in the JSON format of the Chrome trace viewer
+     */
+    QString frameProfileChromeTrace() const;
+
     void setShowBackground( bool visible );
 
      /**
@@ -626,6 +663,16 @@ class MARBLE_EXPORT MarbleMap : public QObject
      */
     void setVolatileTileCacheLimit( quint64 kiloBytes );
 
+    /**
+     * @brief  Set whether texture tiles get decoded in the background.
+     *
+     * If enabled, tiles missing in the volatile cache are shown as scaled versions
+     * of cached lower level tiles until they have been decoded, so rendering
+     * doesn't wait for disk access.
+     * @param  enabled  whether tiles are decoded in the background
+     */
+    void setAsynchronousTileLoading( bool enabled );
+
     void setDefaultAngleUnit( AngleUnit angleUnit );
 
     void setDefaultFont( const QFont& font );
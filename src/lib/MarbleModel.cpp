@@ -178,6 +178,8 @@ MarbleModel::MarbleModel( QObject *parent )
              &d->m_storageWatcher, SLOT(resetCurrentSize()) );
     connect( &d->m_storagePolicy, SIGNAL(sizeChanged(qint64)),
              &d->m_storageWatcher, SLOT(addToCurrentSize(qint64)) );
+    connect( &d->m_storagePolicy, SIGNAL(fileUpdated(QString)),
+             &d->m_storageWatcher, SLOT(addFile(QString)) );
 
     d->m_fileManager = new FileManager( this );
 
@@ -544,6 +546,16 @@ void MarbleModel::setPersistentTileCacheLimit(quint64 kiloBytes)
     // TODO: trigger update
 }
 
+bool MarbleModel::packedTileCache() const
+{
+    return d->m_storagePolicy.packTiles();
+}
+
+void MarbleModel::setPackedTileCache( bool packed )
+{
+    d->m_storagePolicy.setPackTiles( packed );
+}
+
 void MarbleModel::setTrackedPlacemark( const GeoDataPlacemark *placemark )
 {
     d->m_trackedPlacemark = placemark;
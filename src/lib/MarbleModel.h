@@ -226,6 +226,12 @@ class MARBLE_EXPORT MarbleModel : public QObject
      */
     quint64 persistentTileCacheLimit() const;
 
+    /**
+     * @brief  Returns whether downloaded tiles are packed into one archive file per map theme.
+     * @see setPackedTileCache()
+     */
+    bool packedTileCache() const;
+
     /**
      * @brief  Returns the limit of the volatile (in RAM) tile cache.
      * @return the cache limit in kilobytes
@@ -289,6 +295,15 @@ class MARBLE_EXPORT MarbleModel : public QObject
      */
     void setPersistentTileCacheLimit( quint64 kiloBytes );
 
+    /**
+     * @brief  Sets whether downloaded tiles are packed into one archive file per map theme
+     *         instead of being stored as one file per tile.
+     *
+     * The archive of a map theme gets created as soon as the first tile is downloaded.
+     * Tiles which were stored as files before remain valid.
+     */
+    void setPackedTileCache( bool packed );
+
     /**
      * @brief Change the placemark tracked by this model
      * @see trackedPlacemark(), trackedPlacemarkChanged()
@@ -102,6 +102,12 @@ class MarbleWidgetPrivate
       */
     void updateSystemBackgroundAttribute();
 
+    /**
+      * @brief Schedule a repaint of @p dirtyRegion, or of the whole widget
+      *        if @p dirtyRegion is empty
+      */
+    void updateRegion( const QRegion &dirtyRegion );
+
     MarbleWidget    *const m_widget;
     // The model we are showing.
     MarbleModel     m_model;
@@ -125,6 +131,9 @@ class MarbleWidgetPrivate
     bool             m_showFrameRate;
 
     const qreal      m_viewAngle;
+
+    // Intermediate image of the disabled widget, kept across repaints
+    QImage           m_disabledImage;
 };
 
 
@@ -195,7 +204,7 @@ void MarbleWidgetPrivate::construct()
     m_widget->connect( &m_map,   SIGNAL(themeChanged(QString)),
                        m_widget, SLOT(updateMapTheme()) );
     m_widget->connect( &m_map,   SIGNAL(repaintNeeded(QRegion)),
-                       m_widget, SLOT(update()) );
+                       m_widget, SLOT(updateRegion(QRegion)) );
     m_widget->connect( &m_map,   SIGNAL(visibleLatLonAltBoxChanged(GeoDataLatLonAltBox)),
                        m_widget, SLOT(updateSystemBackgroundAttribute()) );
 
@@ -268,6 +277,11 @@ MarbleWidgetPopupMenu *MarbleWidget::popupMenu()
     return d->m_popupmenu;
 }
 
+FrameProfiler *MarbleWidget::frameProfiler()
+{
+    return d->m_map.frameProfiler();
+}
+
 
 void MarbleWidget::setInputHandler( MarbleWidgetInputHandler *handler )
 {
@@ -752,19 +766,25 @@ void MarbleWidget::paintEvent( QPaintEvent *evt )
     t.start();
 
     QPaintDevice *paintDevice = this;
-    QImage image;
+    QImage &image = d->m_disabledImage;
     if (!isEnabled())
     {
         // If the globe covers fully the screen then we can use the faster
-        // RGB32 as there are no translucent areas involved.
+        // RGB32 as there are no translucent areas involved. The texture
+        // then gets mapped into the image directly.
         QImage::Format imageFormat = ( d->m_map.viewport()->mapCoversViewport() )
                                      ? QImage::Format_RGB32
                                      : QImage::Format_ARGB32_Premultiplied;
         // Paint to an intermediate image
-        image = QImage( rect().size(), imageFormat );
+        if ( image.size() != rect().size() || image.format() != imageFormat ) {
+            image = QImage( rect().size(), imageFormat );
+        }
         image.fill( Qt::transparent );
         paintDevice = &image;
     }
+    else if ( !image.isNull() ) {
+        image = QImage();
+    }
 
     {
         // FIXME: Better way to get the GeoPainter
@@ -784,7 +804,7 @@ void MarbleWidget::paintEvent( QPaintEvent *evt )
         }
 
         QPainter widgetPainter( this );
-        widgetPainter.drawImage( rect(), image );
+        widgetPainter.drawImage( evt->rect(), image, evt->rect() );
     }
 
     if ( d->m_showFrameRate )
@@ -824,6 +844,16 @@ void MarbleWidget::setMapThemeId( const QString& mapThemeId )
     d->m_map.setMapThemeId( mapThemeId );
 }
 
+void MarbleWidgetPrivate::updateRegion( const QRegion &dirtyRegion )
+{
+    // an empty region means that the whole widget needs a repaint
+    if ( dirtyRegion.isEmpty() ) {
+        m_widget->update();
+    } else {
+        m_widget->update( dirtyRegion );
+    }
+}
+
 void MarbleWidgetPrivate::updateMapTheme()
 {
     m_map.removeLayer( m_routingLayer );
@@ -1024,6 +1054,31 @@ void MarbleWidget::setShowRuntimeTrace( bool visible )
     d->m_map.setShowRuntimeTrace( visible );
 }
 
+void MarbleWidget::setFrameProfilingEnabled( bool enabled )
+{
+    d->m_map.setFrameProfilingEnabled( enabled );
+}
+
+void MarbleWidget::setProfiledFrameCount( int count )
+{
+    d->m_map.setProfiledFrameCount( count );
+}
+
+void MarbleWidget::clearFrameProfile()
+{
+    d->m_map.clearFrameProfile();
+}
+
+QString MarbleWidget::frameProfileCsv() const
+{
+    return d->m_map.frameProfileCsv();
+}
+
+QString MarbleWidget::frameProfileChromeTrace() const
+{
+    return d->m_map.frameProfileChromeTrace();
+}
+
 void MarbleWidget::setShowTileId( bool visible )
 {
     d->m_map.setShowTileId( visible );
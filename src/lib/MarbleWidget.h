@@ -38,6 +38,7 @@ namespace Marble
 
 class AbstractDataPluginItem;
 class AbstractFloatItem;
+class FrameProfiler;
 class GeoDataLatLonAltBox;
 class GeoDataLatLonBox;
 class GeoPainter;
@@ -168,6 +169,12 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
 
     MarbleWidgetPopupMenu *popupMenu();
 
+    /**
+     * @brief Returns the per-layer timings of the most recently painted frames.
+     * @see setFrameProfilingEnabled()
+     */
+    FrameProfiler *frameProfiler();
+
     /**
      * Returns the current input handler
      */
@@ -910,6 +917,30 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     void setShowRuntimeTrace( bool visible );
 
+    /**
+     * @brief Set whether the timings of the layers get recorded for each frame
+     * @param enabled  whether frames get profiled
+     * @see frameProfileCsv(), frameProfileChromeTrace()
+     */
+    void setFrameProfilingEnabled( bool enabled );
+
+    /**
+     * @brief Set how many of the most recently painted frames are kept by the profiler
+     */
+    void setProfiledFrameCount( int count );
+
+    void clearFrameProfile();
+
+    /**
+     * @brief Returns the profiled frames as comma separated values
+     */
+    QString frameProfileCsv() const;
+
+    /**
+     * @brief Returns the profiled frames in the JSON format of the Chrome trace viewer
+     */
+    QString frameProfileChromeTrace() const;
+
     /**
      * @brief Set the map quality for the specified view context.
      *
@@ -1060,6 +1091,7 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
  private:
     Q_PRIVATE_SLOT( d, void updateMapTheme() )
     Q_PRIVATE_SLOT( d, void updateSystemBackgroundAttribute() )
+    Q_PRIVATE_SLOT( d, void updateRegion( const QRegion &dirtyRegion ) )
 
  private:
     Q_DISABLE_COPY( MarbleWidget )
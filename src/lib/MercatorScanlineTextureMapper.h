@@ -30,7 +30,13 @@ class MercatorScanlineTextureMapper : public TextureMapperInterface
  public:
     QRect rect( const ViewportParams *viewport ) const;
 
-    void mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+    void mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, const QRect &dirtyRect );
+
+    /**
+     * Returns by how many rows the texture is moved down on the canvas for
+     * a viewport of @p radius centered at @p centerLat.
+     */
+    static int yCenterOffset( qreal centerLat, int radius );
 
  private:
     class RenderJob;
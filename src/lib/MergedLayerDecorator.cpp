@@ -34,17 +34,50 @@
 #include "TileLoaderHelper.h"
 #include "Planet.h"
 #include "TextureTile.h"
+#include "TileId.h"
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
 
 
+#include <QtCore/QCache>
 #include <QtCore/QMutexLocker>
 #include <QtCore/QPointer>
+#include <QtCore/QReadWriteLock>
 #include <QtGui/QPainter>
 
 using namespace Marble;
 
+/**
+ * The sun shading of a single stacked tile.
+ *
+ * Only tiles which the twilight zone passes over need a brightness value
+ * for each pixel, all other tiles are either lit or dark as a whole.
+ */
+class SunShadeMask
+{
+public:
+    enum Type {
+        Lit,
+        Dark,
+        Partial
+    };
+
+    SunShadeMask() :
+        m_type( Lit ),
+        m_sunLon( 0.0 ),
+        m_sunLat( 0.0 ),
+        m_size(),
+        m_brightness()
+    {}
+
+    Type m_type;
+    qreal m_sunLon;
+    qreal m_sunLat;
+    QSize m_size;
+    QVector<uchar> m_brightness; // only for Partial, 255 means fully lit
+};
+
 class MergedLayerDecorator::Private
 {
 public:
@@ -53,8 +86,14 @@ public:
     static int maxDivisor( int maximum, int fullLength );
 
     StackedTile *createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const;
-
-    void paintSunShading( QImage *tileImage, const TileId &id ) const;
+    StackedTile *createShadedTile( const TileId &id, const QImage &unshadedImage,
+                                   const QVector<QSharedPointer<TextureTile> > &tiles,
+                                   const SunShadeMask &mask ) const;
+
+    SunShadeMask sunShadeMask( const TileId &id, const QSize &tileSize, bool *changed ) const;
+    SunShadeMask::Type estimateSunShading( const TileId &id, const QSize &tileSize ) const;
+    void calculateSunShading( SunShadeMask *mask, const TileId &id ) const;
+    void paintSunShading( QImage *tileImage, const SunShadeMask &mask ) const;
     void paintTileId( QImage *tileImage, const TileId &id ) const;
 
     void detectMaxTileLevel();
@@ -71,6 +110,14 @@ public:
     bool m_showSunShading;
     bool m_showCityLights;
     bool m_showTileId;
+
+    // Tiles get merged by the decode threads of the StackedTileLoader as
+    // well, so the members above are only changed while no tile is merged.
+    mutable QReadWriteLock m_stateLock;
+
+    // tiles are created by several threads at once
+    mutable QMutex m_shadeMasksMutex;
+    mutable QCache<TileId, SunShadeMask> m_shadeMasks;
 };
 
 MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator *sunLocator ) :
@@ -84,7 +131,10 @@ MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator
     m_levelZeroRows( 0 ),
     m_showSunShading( false ),
     m_showCityLights( false ),
-    m_showTileId( false )
+    m_showTileId( false ),
+    m_stateLock(),
+    m_shadeMasksMutex(),
+    m_shadeMasks( 16 * 1024 * 1024 ) // cost measured in bytes
 {
 }
 
@@ -103,6 +153,8 @@ void MergedLayerDecorator::setTextureLayers( const QVector<const GeoSceneTexture
 {
     mDebug() << Q_FUNC_INFO;
 
+    QWriteLocker locker( &d->m_stateLock );
+
     if ( textureLayers.count() > 0 ) {
         const GeoSceneTiled *const firstTexture = textureLayers.at( 0 );
         d->m_levelZeroColumns = firstTexture->levelZeroColumns();
@@ -113,6 +165,12 @@ void MergedLayerDecorator::setTextureLayers( const QVector<const GeoSceneTexture
 
     d->m_textureLayers = textureLayers;
 
+    // the masks depend on the tile layout of the texture layers
+    {
+        QMutexLocker masksLocker( &d->m_shadeMasksMutex );
+        d->m_shadeMasks.clear();
+    }
+
     d->detectMaxTileLevel();
 }
 
@@ -197,19 +255,37 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
         }
     }
 
-    if ( m_showSunShading && !m_showCityLights ) {
-        paintSunShading( &resultImage, id );
-    }
-
     if ( m_showTileId ) {
         paintTileId( &resultImage, id );
     }
 
+    if ( m_showSunShading && !m_showCityLights && resultImage.depth() == 32 ) {
+        // TODO add support for 8-bit maps?
+        const SunShadeMask mask = sunShadeMask( id, resultImage.size(), 0 );
+        return createShadedTile( id, resultImage, tiles, mask );
+    }
+
     return new StackedTile( id, resultImage, tiles );
 }
 
+StackedTile *MergedLayerDecorator::Private::createShadedTile( const TileId &id, const QImage &unshadedImage,
+                                                              const QVector<QSharedPointer<TextureTile> > &tiles,
+                                                              const SunShadeMask &mask ) const
+{
+    if ( mask.m_type == SunShadeMask::Lit ) {
+        return new StackedTile( id, unshadedImage, tiles );
+    }
+
+    QImage resultImage = unshadedImage.copy();
+    paintSunShading( &resultImage, mask );
+
+    return new StackedTile( id, resultImage, tiles, unshadedImage );
+}
+
 StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
 {
+    QReadLocker locker( &d->m_stateLock );
+
     const QVector<const GeoSceneTextureTile *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
     QVector<QSharedPointer<TextureTile> > tiles;
 
@@ -241,7 +317,13 @@ StackedTile *MergedLayerDecorator::updateTile( const StackedTile &stackedTile, c
 {
     Q_ASSERT( !tileImage.isNull() );
 
-    d->detectMaxTileLevel();
+    {
+        // the decode threads may be merging tiles meanwhile
+        QWriteLocker locker( &d->m_stateLock );
+        d->detectMaxTileLevel();
+    }
+
+    QReadLocker locker( &d->m_stateLock );
 
     QVector<QSharedPointer<TextureTile> > tiles = stackedTile.tiles();
 
@@ -256,6 +338,37 @@ StackedTile *MergedLayerDecorator::updateTile( const StackedTile &stackedTile, c
     return d->createTile( tiles );
 }
 
+StackedTile *MergedLayerDecorator::updateShading( const StackedTile &stackedTile )
+{
+    const TileId &id = stackedTile.id();
+
+    QReadLocker locker( &d->m_stateLock );
+
+    if ( d->m_showCityLights ) {
+        // the shading is part of the blending with the city lights
+        return d->createTile( stackedTile.tiles() );
+    }
+
+    const QImage *const unshadedImage = stackedTile.unshadedImage();
+    const bool isShaded = unshadedImage->cacheKey() != stackedTile.resultImage()->cacheKey();
+
+    if ( !d->m_showSunShading || unshadedImage->depth() != 32 ) {
+        if ( !isShaded )
+            return 0;
+
+        return new StackedTile( id, *unshadedImage, stackedTile.tiles() );
+    }
+
+    bool changed = true;
+    const SunShadeMask mask = d->sunShadeMask( id, unshadedImage->size(), &changed );
+
+    if ( isShaded ? !changed : mask.m_type == SunShadeMask::Lit ) {
+        return 0;
+    }
+
+    return d->createShadedTile( id, *unshadedImage, stackedTile.tiles(), mask );
+}
+
 void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage usage )
 {
     const QVector<const GeoSceneTextureTile *> textureLayers = d->findRelevantTextureLayers( id );
@@ -269,7 +382,14 @@ void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage
 
 void MergedLayerDecorator::setShowSunShading( bool show )
 {
+    QWriteLocker locker( &d->m_stateLock );
+
     d->m_showSunShading = show;
+
+    if ( !show ) {
+        QMutexLocker masksLocker( &d->m_shadeMasksMutex );
+        d->m_shadeMasks.clear();
+    }
 }
 
 bool MergedLayerDecorator::showSunShading() const
@@ -279,6 +399,7 @@ bool MergedLayerDecorator::showSunShading() const
 
 void MergedLayerDecorator::setShowCityLights( bool show )
 {
+    QWriteLocker locker( &d->m_stateLock );
     d->m_showCityLights = show;
 }
 
@@ -289,86 +410,175 @@ bool MergedLayerDecorator::showCityLights() const
 
 void MergedLayerDecorator::setShowTileId( bool visible )
 {
+    QWriteLocker locker( &d->m_stateLock );
     d->m_showTileId = visible;
 }
 
-void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const TileId &id ) const
+SunShadeMask MergedLayerDecorator::Private::sunShadeMask( const TileId &id, const QSize &tileSize, bool *changed ) const
 {
-    if ( tileImage->depth() != 32 )
-        return;
+    const qreal sunLon = m_sunLocator->getLon();
+    const qreal sunLat = m_sunLocator->getLat();
+
+    QMutexLocker locker( &m_shadeMasksMutex );
+
+    const SunShadeMask *const cachedMask = m_shadeMasks.object( id );
+    if ( cachedMask && cachedMask->m_size == tileSize
+         && cachedMask->m_sunLon == sunLon && cachedMask->m_sunLat == sunLat ) {
+        if ( changed )
+            *changed = false;
+        return *cachedMask;
+    }
+
+    const bool hasPreviousType = cachedMask && cachedMask->m_size == tileSize;
+    const SunShadeMask::Type previousType = hasPreviousType ? cachedMask->m_type : SunShadeMask::Partial;
 
-    // TODO add support for 8-bit maps?
-    // add sun shading
-    const qreal  global_width  = tileImage->width()
+    locker.unlock();
+
+    SunShadeMask mask;
+    mask.m_sunLon = sunLon;
+    mask.m_sunLat = sunLat;
+    mask.m_size = tileSize;
+    mask.m_type = estimateSunShading( id, tileSize );
+
+    if ( mask.m_type == SunShadeMask::Partial ) {
+        calculateSunShading( &mask, id );
+    }
+
+    if ( changed ) {
+        // the shading of a tile which stays lit or dark as a whole does not change
+        *changed = !hasPreviousType || previousType != mask.m_type || mask.m_type == SunShadeMask::Partial;
+    }
+
+    locker.relock();
+    m_shadeMasks.insert( id, new SunShadeMask( mask ), 1 + mask.m_brightness.size() );
+
+    return mask;
+}
+
+SunShadeMask::Type MergedLayerDecorator::Private::estimateSunShading( const TileId &id, const QSize &tileSize ) const
+{
+    // SunLocator::shading() evaluates h = a*a + c*b*b, the haversine of the
+    // angular distance to a fixed point on the globe. Since the haversine
+    // changes by at most half the change of the distance, h is bounded on
+    // the whole tile by its value at the center of the tile. Brightness only
+    // changes for 0.45 < h < 0.55, which covers the twilight zone of all planets.
+    const qreal globalWidth  = tileSize.width()
+            * TileLoaderHelper::levelToColumn( m_levelZeroColumns, id.zoomLevel() );
+    const qreal globalHeight = tileSize.height()
+            * TileLoaderHelper::levelToRow( m_levelZeroRows, id.zoomLevel() );
+    const qreal lonScale = 2*M_PI / globalWidth;
+    const qreal latScale = -M_PI / globalHeight;
+
+    const qreal lon = lonScale * ( id.x() + 0.5 ) * tileSize.width();
+    const qreal lat = latScale * ( id.y() + 0.5 ) * tileSize.height() - 0.5*M_PI;
+    const qreal a = sin( ( lat + DEG2RAD * m_sunLocator->getLat() ) / 2.0 );
+    const qreal b = sin( ( lon - DEG2RAD * m_sunLocator->getLon() ) / 2.0 );
+    const qreal c = cos( lat ) * cos( -DEG2RAD * m_sunLocator->getLat() );
+    const qreal h = a*a + c*b*b;
+
+    // the distance of each point of the tile to its center is at most
+    // half the height plus half the width of the tile in radians
+    const qreal radius = 0.5 * ( lonScale * tileSize.width() - latScale * tileSize.height() );
+
+    if ( h + radius / 2.0 < 0.45 )
+        return SunShadeMask::Lit;
+
+    if ( h - radius / 2.0 > 0.55 )
+        return SunShadeMask::Dark;
+
+    return SunShadeMask::Partial;
+}
+
+void MergedLayerDecorator::Private::calculateSunShading( SunShadeMask *mask, const TileId &id ) const
+{
+    const int tileWidth = mask->m_size.width();
+    const int tileHeight = mask->m_size.height();
+    const qreal  global_width  = tileWidth
             * TileLoaderHelper::levelToColumn( m_levelZeroColumns, id.zoomLevel() );
-    const qreal  global_height = tileImage->height()
+    const qreal  global_height = tileHeight
             * TileLoaderHelper::levelToRow( m_levelZeroRows, id.zoomLevel() );
     const qreal lon_scale = 2*M_PI / global_width;
     const qreal lat_scale = -M_PI / global_height;
-    const int tileHeight = tileImage->height();
-    const int tileWidth = tileImage->width();
 
-    // First we determine the supporting point interval for the interpolation.
+    // The brightness is calculated for supporting points first. Intervals
+    // which are lit or dark at both ends are filled in as a whole, all other
+    // pixels get their exact brightness.
     const int n = maxDivisor( 30, tileWidth );
-    const int ipRight = n * (int)( tileWidth / n );
+
+    mask->m_brightness.resize( tileWidth * tileHeight );
+    uchar *brightness = mask->m_brightness.data();
+    bool isLit = true;
+    bool isDark = true;
 
     for ( int cur_y = 0; cur_y < tileHeight; ++cur_y ) {
         const qreal lat = lat_scale * ( id.y() * tileHeight + cur_y ) - 0.5*M_PI;
         const qreal a = sin( (lat+DEG2RAD * m_sunLocator->getLat() )/2.0 );
         const qreal c = cos(lat)*cos( -DEG2RAD * m_sunLocator->getLat() );
 
-        QRgb* scanline = (QRgb*)tileImage->scanLine( cur_y );
+        int left = 0;
+        qreal leftShade = m_sunLocator->shading( lon_scale * id.x() * tileWidth, a, c );
 
-        qreal lastShade = -10.0;
+        while ( left < tileWidth - 1 ) {
+            const int right = qMin( left + n, tileWidth - 1 );
+            const qreal rightShade = m_sunLocator->shading( lon_scale * ( id.x() * tileWidth + right ), a, c );
 
-        int cur_x = 0;
+            if ( leftShade == rightShade && ( leftShade == 1.0 || leftShade == 0.0 ) ) {
+                const uchar value = leftShade == 1.0 ? 255 : 0;
+                for ( int cur_x = left; cur_x < right; ++cur_x ) {
+                    *brightness++ = value;
+                }
+            } else {
+                *brightness++ = qRound( 255.0 * leftShade );
+                for ( int cur_x = left + 1; cur_x < right; ++cur_x ) {
+                    const qreal shade = m_sunLocator->shading( lon_scale * ( id.x() * tileWidth + cur_x ), a, c );
+                    *brightness++ = qRound( 255.0 * shade );
+                }
+            }
 
-        while ( cur_x < tileWidth ) {
+            isLit = isLit && leftShade == 1.0 && rightShade == 1.0;
+            isDark = isDark && leftShade == 0.0 && rightShade == 0.0;
 
-            const bool interpolate = ( cur_x != 0 && cur_x < ipRight && cur_x + n < tileWidth );
+            left = right;
+            leftShade = rightShade;
+        }
 
-            qreal shade = 0;
+        *brightness++ = qRound( 255.0 * leftShade );
+        isLit = isLit && leftShade == 1.0;
+        isDark = isDark && leftShade == 0.0;
+    }
 
-            if ( interpolate ) {
-                const int check = cur_x + n;
-                const qreal checklon   = lon_scale * ( id.x() * tileWidth + check );
-                shade = m_sunLocator->shading( checklon, a, c );
+    if ( isLit || isDark ) {
+        mask->m_type = isLit ? SunShadeMask::Lit : SunShadeMask::Dark;
+        mask->m_brightness.clear();
+    }
+}
 
-                // if the shading didn't change across the interpolation
-                // interval move on and don't change anything.
-                if ( shade == lastShade && shade == 1.0 ) {
-                    scanline += n;
-                    cur_x += n;
-                    continue;
-                }
-                if ( shade == lastShade && shade == 0.0 ) {
-                    for ( int t = 0; t < n; ++t ) {
-                        m_sunLocator->shadePixel( *scanline, shade );
-                        ++scanline;
-                    }
-                    cur_x += n;
-                    continue;
-                }
-                for ( int t = 0; t < n ; ++t ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    m_sunLocator->shadePixel( *scanline, shade );
-                    ++scanline;
-                    ++cur_x;
-                }
+void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const SunShadeMask &mask ) const
+{
+    Q_ASSERT( tileImage->depth() == 32 );
+    Q_ASSERT( tileImage->size() == mask.m_size );
+
+    if ( mask.m_type == SunShadeMask::Lit )
+        return;
+
+    const int tileHeight = tileImage->height();
+    const int tileWidth = tileImage->width();
+    const uchar *brightness = mask.m_brightness.constData();
+
+    for ( int cur_y = 0; cur_y < tileHeight; ++cur_y ) {
+        QRgb* scanline = (QRgb*)tileImage->scanLine( cur_y );
+
+        if ( mask.m_type == SunShadeMask::Dark ) {
+            for ( int cur_x = 0; cur_x < tileWidth; ++cur_x ) {
+                m_sunLocator->shadePixel( scanline[cur_x], 0.0 );
             }
+            continue;
+        }
 
-            else {
-                // Make sure we don't exceed the image memory
-                if ( cur_x < tileWidth ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    m_sunLocator->shadePixel( *scanline, shade );
-                    ++scanline;
-                    ++cur_x;
-                }
+        for ( int cur_x = 0; cur_x < tileWidth; ++cur_x, ++brightness ) {
+            if ( *brightness != 255 ) {
+                m_sunLocator->shadePixel( scanline[cur_x], *brightness / 255.0 );
             }
-            lastShade = shade;
         }
     }
 }
@@ -22,6 +22,7 @@
 
 #include "GeoSceneTextureTile.h"
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 class QImage;
 class QString;
@@ -35,7 +36,7 @@ class Tile;
 class TileId;
 class TileLoader;
 
-class MergedLayerDecorator
+class MARBLE_EXPORT MergedLayerDecorator
 {
  public:
     MergedLayerDecorator( TileLoader * const tileLoader, const SunLocator* sunLocator );
@@ -59,10 +60,24 @@ class MergedLayerDecorator
 
     QSize tileSize() const;
 
+    /**
+     * Merges the texture tiles of @p id into a new stacked tile.
+     *
+     * May be called by several threads at once. The setters wait until
+     * the tiles being merged are done.
+     */
     StackedTile *loadTile( const TileId &id );
 
     StackedTile *updateTile( const StackedTile &stackedTile, const TileId &tileId, const QImage &tileImage );
 
+    /**
+     * Returns a copy of @p stackedTile shaded for the current position of the sun,
+     * or 0 if the shading of @p stackedTile is still up to date.
+     *
+     * The texture tiles are not merged again unless city lights are shown.
+     */
+    StackedTile *updateShading( const StackedTile &stackedTile );
+
     void downloadStackedTile( const TileId &id, DownloadUsage usage );
 
     void setShowSunShading( bool show );
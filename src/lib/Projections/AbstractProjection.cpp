@@ -136,6 +136,24 @@ bool AbstractProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
     return visible;
 }
 
+void AbstractProjection::screenCoordinates( int count,
+                                            const qreal *lons, const qreal *lats,
+                                            const qreal *altitudes,
+                                            const ViewportParams *viewport,
+                                            qreal *x, qreal *y, bool *visible,
+                                            bool *globeHidesPoint ) const
+{
+    // Generic fallback, the projections provide faster implementations.
+    bool hidden = false;
+    for ( int i = 0; i < count; ++i ) {
+        const GeoDataCoordinates coordinates( lons[i], lats[i], altitudes ? altitudes[i] : 0.0 );
+        visible[i] = screenCoordinates( coordinates, viewport, x[i], y[i], hidden );
+        if ( globeHidesPoint ) {
+            globeHidesPoint[i] = hidden;
+        }
+    }
+}
+
 bool AbstractProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                     const ViewportParams *viewport,
                                     qreal *x, qreal &y, int &pointRepeatNum, bool &globeHidesPoint ) const
@@ -176,6 +176,35 @@ class MARBLE_EXPORT AbstractProjection
                             const ViewportParams *viewport,
                             QVector<QPolygonF*> &polygons ) const = 0;
 
+    /**
+     * @brief Get the screen coordinates for a whole array of geographical coordinates.
+     *
+     * This is the batch version of the per point screenCoordinates() methods.
+     * Projecting many points at once avoids the per point overhead and allows
+     * the compiler to vectorize the calculation.
+     *
+     * @param count      the number of points
+     * @param lons       the longitudes of the points in radian
+     * @param lats       the latitudes of the points in radian
+     * @param altitudes  the altitudes of the points in meters, may be 0
+     * @param viewport   the viewport parameters
+     * @param x          array that receives the x coordinates of the points
+     * @param y          array that receives the y coordinates of the points
+     * @param visible    array that receives whether each point is visible
+     *                   on the screen
+     * @param globeHidesPoint  array that receives whether each point gets
+     *                   hidden on the far side of the earth, may be 0
+     *
+     * All output arrays need to hold @p count elements. For points that are
+     * hidden by the globe x and y are left undefined.
+     */
+    virtual void screenCoordinates( int count,
+                                    const qreal *lons, const qreal *lats,
+                                    const qreal *altitudes,
+                                    const ViewportParams *viewport,
+                                    qreal *x, qreal *y, bool *visible,
+                                    bool *globeHidesPoint = 0 ) const;
+
     /**
      * @brief Get the earth coordinates corresponding to a pixel in the map.
      * @param x      the x coordinate of the pixel
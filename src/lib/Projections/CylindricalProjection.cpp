@@ -117,11 +117,32 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
 
     polygons.append( new QPolygonF );
 
-    GeoDataLineString::ConstIterator itCoords = lineString.constBegin();
-    GeoDataLineString::ConstIterator itPreviousCoords = lineString.constBegin();
+    // Project all nodes in one go.
+    const int nodeCount = lineString.size();
+    const QVector<qreal> longitudeVector = lineString.longitudes();
+    const QVector<qreal> latitudeVector = lineString.latitudes();
+    const QVector<qreal> altitudeVector = lineString.altitudes();
+    const QVector<int> detailVector = lineString.details();
+    const qreal *longitudes = longitudeVector.constData();
+    const qreal *latitudes = latitudeVector.constData();
+    const int *details = detailVector.constData();
+
+    QVector<qreal> screenX( nodeCount );
+    QVector<qreal> screenY( nodeCount );
+    QVector<bool> visible( nodeCount );
 
-    GeoDataLineString::ConstIterator itBegin = lineString.constBegin();
-    GeoDataLineString::ConstIterator itEnd = lineString.constEnd();
+    Q_Q( const CylindricalProjection );
+    q->screenCoordinates( nodeCount, longitudes, latitudes, altitudeVector.constData(), viewport,
+                          screenX.data(), screenY.data(), visible.data() );
+
+    const qreal angularResolution = viewport->angularResolution();
+
+    // Walk the nodes by index, so that line strings with compact storage
+    // don't get converted into GeoDataCoordinates objects.
+    int index = 0;
+    int previousIndex = 0;
+    GeoDataCoordinates coords;
+    GeoDataCoordinates previousCoords;
 
     bool processingLastNode = false;
 
@@ -137,24 +158,25 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
                               ( viewport->radius() >   50 ) ? 1 :
                                                               0;
 
-    while ( itCoords != itEnd )
+    while ( index < nodeCount )
     {
-
         // Optimization for line strings with a big amount of nodes
-        bool skipNode = itCoords != itBegin && isLong && !processingLastNode &&
-                ( (*itCoords).detail() > maximumDetail
-                  || viewport->resolves( *itPreviousCoords, *itCoords ) );
+        // (the manhattan length check matches ViewportParams::resolves())
+        bool skipNode = index != 0 && isLong && !processingLastNode &&
+                ( details[index] > maximumDetail
+                  || ( fabs( longitudes[index] - longitudes[previousIndex] )
+                       + fabs( latitudes[index] - latitudes[previousIndex] ) < angularResolution ) );
 
         if ( !skipNode ) {
 
-
-            Q_Q( const CylindricalProjection );
-
-            q->screenCoordinates( *itCoords, viewport, x, y );
+            x = screenX[index];
+            y = screenY[index];
+            coords = lineString.coordinatesAt( index );
 
             // Initializing variables that store the values of the previous iteration
-            if ( !processingLastNode && itCoords == itBegin ) {
-                itPreviousCoords = itCoords;
+            if ( !processingLastNode && index == 0 ) {
+                previousIndex = index;
+                previousCoords = coords;
                 previousX = x;
                 previousY = y;
             }
@@ -165,8 +187,8 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
 
             if ( lineString.tessellate() ) {
 
-                mirrorCount = tessellateLineSegment( *itPreviousCoords, previousX, previousY,
-                                           *itCoords, x, y,
+                mirrorCount = tessellateLineSegment( previousCoords, previousX, previousY,
+                                           coords, x, y,
                                            polygons, viewport,
                                            f, mirrorCount, distance );
             }
@@ -175,10 +197,11 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
                 // special case for polys which cross dateline but have no Tesselation Flag
                 // the expected rendering is a screen coordinates straight line between
                 // points, but in projections with repeatX things are not smooth
-                mirrorCount = crossDateLine( *itPreviousCoords, *itCoords, polygons, viewport, mirrorCount, distance );
+                mirrorCount = crossDateLine( previousCoords, coords, polygons, viewport, mirrorCount, distance );
             }
 
-            itPreviousCoords = itCoords;
+            previousIndex = index;
+            previousCoords = coords;
             previousX = x;
             previousY = y;
         }
@@ -189,10 +212,10 @@ bool CylindricalProjectionPrivate::lineStringToPolygon( const GeoDataLineString
         if ( processingLastNode ) {
             break;
         }
-        ++itCoords;
+        ++index;
 
-        if ( itCoords == itEnd  && lineString.isClosed() ) {
-            itCoords = itBegin;
+        if ( index == nodeCount && lineString.isClosed() ) {
+            index = 0;
             processingLastNode = true;
         }
     }
@@ -102,6 +102,40 @@ bool EquirectProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                   || ( 0 <= x + 4 * radius && x + 4 * radius < width ) ) );
 }
 
+void EquirectProjection::screenCoordinates( int count,
+                                            const qreal *lons, const qreal *lats,
+                                            const qreal *altitudes,
+                                            const ViewportParams *viewport,
+                                            qreal *x, qreal *y, bool *visible,
+                                            bool *globeHidesPoint ) const
+{
+    Q_UNUSED( altitudes );
+
+    // Convenience variables
+    const int  radius = viewport->radius();
+    const qreal  width  = (qreal)(viewport->width());
+    const qreal  height = (qreal)(viewport->height());
+    const qreal  rad2Pixel = 2.0 * radius / M_PI;
+    const qreal  repeatDistance = 4 * radius;
+
+    const qreal centerLon = viewport->centerLongitude();
+    const qreal centerLat = viewport->centerLatitude();
+
+    for ( int i = 0; i < count; ++i ) {
+        x[i] = ( width  / 2.0 + rad2Pixel * ( lons[i] - centerLon ) );
+        y[i] = ( height / 2.0 - rad2Pixel * ( lats[i] - centerLat ) );
+
+        visible[i] = ( ( 0 <= y[i] && y[i] < height )
+                       && ( ( 0 <= x[i] && x[i] < width )
+                            || ( 0 <= x[i] - repeatDistance && x[i] - repeatDistance < width )
+                            || ( 0 <= x[i] + repeatDistance && x[i] + repeatDistance < width ) ) );
+    }
+
+    if ( globeHidesPoint ) {
+        qFill( globeHidesPoint, globeHidesPoint + count, false );
+    }
+}
+
 bool EquirectProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                                             const ViewportParams *viewport,
                                             qreal *x, qreal &y,
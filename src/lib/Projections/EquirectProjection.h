@@ -72,6 +72,13 @@ class EquirectProjection : public CylindricalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const;
 
+    void screenCoordinates( int count,
+                            const qreal *lons, const qreal *lats,
+                            const qreal *altitudes,
+                            const ViewportParams *viewport,
+                            qreal *x, qreal *y, bool *visible,
+                            bool *globeHidesPoint = 0 ) const;
+
     using CylindricalProjection::screenCoordinates;
 
     /**
@@ -129,6 +129,47 @@ bool MercatorProjection::screenCoordinates( const GeoDataCoordinates &geopoint,
                   || ( 0 <= x + 4 * radius && x + 4 * radius < width ) ) );
 }
 
+void MercatorProjection::screenCoordinates( int count,
+                                            const qreal *lons, const qreal *lats,
+                                            const qreal *altitudes,
+                                            const ViewportParams *viewport,
+                                            qreal *x, qreal *y, bool *visible,
+                                            bool *globeHidesPoint ) const
+{
+    Q_UNUSED( altitudes );
+
+    // Convenience variables
+    const int  radius = viewport->radius();
+    const qreal  width  = (qreal)(viewport->width());
+    const qreal  height = (qreal)(viewport->height());
+    const qreal  rad2Pixel = 2 * radius / M_PI;
+    const qreal  repeatDistance = 4 * radius;
+
+    const qreal minLatitude = minLat();
+    const qreal maxLatitude = maxLat();
+
+    // Calculate translation of center point
+    const qreal centerLon = viewport->centerLongitude();
+    const qreal centerY = atanh( sin( viewport->centerLatitude() ) );
+
+    for ( int i = 0; i < count; ++i ) {
+        const bool isLatValid = minLatitude <= lats[i] && lats[i] <= maxLatitude;
+        const qreal lat = qBound( minLatitude, lats[i], maxLatitude );
+
+        x[i] = ( width  / 2 + rad2Pixel * ( lons[i] - centerLon ) );
+        y[i] = ( height / 2 - rad2Pixel * ( atanh( sin( lat ) ) - centerY ) );
+
+        visible[i] = isLatValid && ( ( 0 <= y[i] && y[i] < height )
+                     && ( ( 0 <= x[i] && x[i] < width )
+                          || ( 0 <= x[i] - repeatDistance && x[i] - repeatDistance < width )
+                          || ( 0 <= x[i] + repeatDistance && x[i] + repeatDistance < width ) ) );
+    }
+
+    if ( globeHidesPoint ) {
+        qFill( globeHidesPoint, globeHidesPoint + count, false );
+    }
+}
+
 bool MercatorProjection::screenCoordinates( const GeoDataCoordinates &coordinates,
                                             const ViewportParams *viewport,
                                             qreal *x, qreal &y, int &pointRepeatNum,
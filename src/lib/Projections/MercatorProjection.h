@@ -71,6 +71,13 @@ class MercatorProjection : public CylindricalProjection
                             const QSizeF& size,
                             bool &globeHidesPoint ) const;
 
+    void screenCoordinates( int count,
+                            const qreal *lons, const qreal *lats,
+                            const qreal *altitudes,
+                            const ViewportParams *viewport,
+                            qreal *x, qreal *y, bool *visible,
+                            bool *globeHidesPoint = 0 ) const;
+
     using CylindricalProjection::screenCoordinates;
 
    /**
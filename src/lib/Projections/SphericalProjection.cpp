@@ -192,6 +192,84 @@ bool SphericalProjection::screenCoordinates( const GeoDataCoordinates &coordinat
 }
 
 
+void SphericalProjection::screenCoordinates( int count,
+                                             const qreal *lons, const qreal *lats,
+                                             const qreal *altitudes,
+                                             const ViewportParams *viewport,
+                                             qreal *x, qreal *y, bool *visible,
+                                             bool *globeHidesPoint ) const
+{
+    Q_D( const SphericalProjection );
+
+    // The unit vectors get calculated in blocks which stay in the cache
+    // until they have been projected.
+    static const int blockSize = 64;
+    qreal unitVectors[3 * blockSize];
+
+    for ( int start = 0; start < count; start += blockSize ) {
+        const int blockCount = qMin( blockSize, count - start );
+
+        // Same as Quaternion::fromSpherical(), but without the scalar part.
+        for ( int i = 0; i < blockCount; ++i ) {
+            const qreal cosLat = cos( lats[start + i] );
+            unitVectors[3 * i]     = cosLat * sin( lons[start + i] );
+            unitVectors[3 * i + 1] = sin( lats[start + i] );
+            unitVectors[3 * i + 2] = cosLat * cos( lons[start + i] );
+        }
+
+        d->projectUnitVectors( blockCount, unitVectors,
+                               altitudes ? altitudes + start : 0, viewport,
+                               x + start, y + start, visible + start,
+                               globeHidesPoint ? globeHidesPoint + start : 0 );
+    }
+}
+
+void SphericalProjectionPrivate::projectUnitVectors( int count, const qreal *unitVectors,
+                                                     const qreal *altitudes,
+                                                     const ViewportParams *viewport,
+                                                     qreal *x, qreal *y, bool *visible,
+                                                     bool *globeHidesPoint ) const
+{
+    const matrix &m = viewport->planetAxisMatrix();
+
+    const qreal radius = viewport->radius();
+    const qreal width  = viewport->width();
+    const qreal height = viewport->height();
+    const qreal imageHalfWidth  = width / 2;
+    const qreal imageHalfHeight = height / 2;
+    const qreal pixelsPerMeter = radius / EARTH_RADIUS;
+
+    // Same as screenCoordinates( const GeoDataCoordinates &, ... ), but without
+    // any branches so that the loop can be vectorized.
+    for ( int i = 0; i < count; ++i ) {
+        const qreal *v = unitVectors + 3 * i;
+        const qreal qx = m[0][0] * v[0] + m[1][0] * v[1] + m[2][0] * v[2];
+        const qreal qy = m[0][1] * v[0] + m[1][1] * v[1] + m[2][1] * v[2];
+        const qreal qz = m[0][2] * v[0] + m[1][2] * v[1] + m[2][2] * v[2];
+
+        const qreal altitude = altitudes ? altitudes[i] : 0.0;
+        const qreal pixelAltitude = pixelsPerMeter * ( altitude + EARTH_RADIUS );
+        const qreal earthCenteredX = pixelAltitude * qx;
+        const qreal earthCenteredY = pixelAltitude * qy;
+
+        // Points close to the ground are hidden on the other side of the earth,
+        // high points (e.g. satellites) only if they are "behind" the earth.
+        const bool hidden = qz < 0
+                            && ( altitude < 10000
+                                 || earthCenteredX * earthCenteredX
+                                    + earthCenteredY * earthCenteredY < radius * radius );
+
+        x[i] = imageHalfWidth  + earthCenteredX;
+        y[i] = imageHalfHeight - earthCenteredY;
+        visible[i] = !hidden
+                     && 0 <= x[i] && x[i] < width
+                     && 0 <= y[i] && y[i] < height;
+        if ( globeHidesPoint ) {
+            globeHidesPoint[i] = hidden;
+        }
+    }
+}
+
 bool SphericalProjection::geoCoordinates( const int x, const int y,
                                           const ViewportParams *viewport,
                                           qreal& lon, qreal& lat,
@@ -343,6 +421,15 @@ bool SphericalProjection::screenCoordinates( const GeoDataLineString &lineString
     return true;
 }
 
+// Returns the node at the given index of the flat coordinate arrays of a line string.
+static inline GeoDataCoordinates coordinatesAt( const qreal *longitudes, const qreal *latitudes,
+                                                const qreal *altitudes, const int *details,
+                                                int index )
+{
+    return GeoDataCoordinates( longitudes[index], latitudes[index], altitudes[index],
+                               GeoDataCoordinates::Radian, details[index] );
+}
+
 bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &lineString,
                                               const ViewportParams *viewport,
                                               QVector<QPolygonF *> &polygons ) const
@@ -364,8 +451,36 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
 
     polygons.append( new QPolygonF );
 
-    GeoDataLineString::ConstIterator itCoords = lineString.constBegin();
-    GeoDataLineString::ConstIterator itPreviousCoords = lineString.constBegin();
+    // The nodes are processed through the flat arrays of the line string
+    // which avoids touching one GeoDataCoordinates object per node.
+    // GeoDataCoordinates objects only get created for the nodes that need to
+    // be tessellated or that are located next to the horizon.
+    const int nodeCount = lineString.size();
+    const QVector<qreal> longitudeVector = lineString.longitudes();
+    const QVector<qreal> latitudeVector = lineString.latitudes();
+    const QVector<qreal> altitudeVector = lineString.altitudes();
+    const QVector<int> detailVector = lineString.details();
+    const qreal *longitudes = longitudeVector.constData();
+    const qreal *latitudes = latitudeVector.constData();
+    const qreal *altitudes = altitudeVector.constData();
+    const int *details = detailVector.constData();
+
+    const qreal angularResolution = viewport->angularResolution();
+
+    // Project all nodes in one go.
+    QVector<qreal> screenX( nodeCount );
+    QVector<qreal> screenY( nodeCount );
+    QVector<bool> visible( nodeCount );
+    QVector<bool> hidden( nodeCount );
+    q->screenCoordinates( nodeCount, longitudes, latitudes, altitudes, viewport,
+                          screenX.data(), screenY.data(), visible.data(), hidden.data() );
+
+    int index = 0;
+    int previousIndex = 0;
+
+    GeoDataCoordinates currentCoords;
+    GeoDataCoordinates previousCoords;
+    int previousCoordsIndex = -1;
 
     // Some projections display the earth in a way so that there is a
     // foreside and a backside.
@@ -388,16 +503,13 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
     bool horizonOrphan = false;
     GeoDataCoordinates horizonOrphanCoords;
 
-    GeoDataLineString::ConstIterator itBegin = lineString.constBegin();
-    GeoDataLineString::ConstIterator itEnd = lineString.constEnd();
-
     bool processingLastNode = false;
 
     // We use a while loop to be able to cover linestrings as well as linear rings:
     // Linear rings require to tessellate the path from the last node to the first node
     // which isn't really convenient to achieve with a for loop ...
 
-    const bool isLong = lineString.size() > 50;
+    const bool isLong = nodeCount > 50;
     const int maximumDetail = ( viewport->radius() > 5000 ) ? 5 :
                               ( viewport->radius() > 2500 ) ? 4 :
                               ( viewport->radius() > 1000 ) ? 3 :
@@ -405,22 +517,29 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
                               ( viewport->radius() >   50 ) ? 1 :
                                                               0;
 
-    while ( itCoords != itEnd )
+    while ( index < nodeCount )
     {
 
         // Optimization for line strings with a big amount of nodes
-        bool skipNode = itCoords != itBegin && isLong && !processingLastNode &&
-                ( (*itCoords).detail() > maximumDetail
-                  || viewport->resolves( *itPreviousCoords, *itCoords ) );
+        // (the manhattan length check matches ViewportParams::resolves())
+        bool skipNode = index != 0 && isLong && !processingLastNode &&
+                ( details[index] > maximumDetail
+                  || ( fabs( longitudes[index] - longitudes[previousIndex] )
+                       + fabs( latitudes[index] - latitudes[previousIndex] ) < angularResolution ) );
 
         if ( !skipNode ) {
 
-            q->screenCoordinates( *itCoords, viewport, x, y, globeHidesPoint );
+            // Like screenCoordinates() keep the previous position for hidden points
+            globeHidesPoint = hidden[index];
+            if ( !globeHidesPoint ) {
+                x = screenX[index];
+                y = screenY[index];
+            }
 
             // Initializing variables that store the values of the previous iteration
-            if ( !processingLastNode && itCoords == itBegin ) {
+            if ( !processingLastNode && index == 0 ) {
                 previousGlobeHidesPoint = globeHidesPoint;
-                itPreviousCoords = itCoords;
+                previousIndex = index;
                 previousX = x;
                 previousY = y;
             }
@@ -428,10 +547,18 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
             // Check for the "horizon case" (which is present e.g. for the spherical projection
             const bool isAtHorizon = ( globeHidesPoint || previousGlobeHidesPoint ) &&
                                      ( globeHidesPoint !=  previousGlobeHidesPoint );
-     
+
+            const bool needsCoordinates = isAtHorizon || lineString.tessellate();
+            if ( needsCoordinates ) {
+                currentCoords = coordinatesAt( longitudes, latitudes, altitudes, details, index );
+                if ( previousCoordsIndex != previousIndex ) {
+                    previousCoords = coordinatesAt( longitudes, latitudes, altitudes, details, previousIndex );
+                }
+            }
+
             if ( isAtHorizon ) {
                 // Handle the "horizon case"
-                horizonCoords = findHorizon( *itPreviousCoords, *itCoords, viewport, f );
+                horizonCoords = findHorizon( previousCoords, currentCoords, viewport, f );
 
                 if ( lineString.isClosed() ) {
                     if ( horizonPair ) {
@@ -467,8 +594,8 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
 
                 if ( !isAtHorizon ) {
 
-                    tessellateLineSegment( *itPreviousCoords, previousX, previousY,
-                                           *itCoords, x, y,
+                    tessellateLineSegment( previousCoords, previousX, previousY,
+                                           currentCoords, x, y,
                                            polygons, viewport,
                                            f );
 
@@ -478,12 +605,12 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
                     // current or previous point in the line. 
                     if ( previousGlobeHidesPoint ) {
                         tessellateLineSegment( horizonCoords, horizonX, horizonY,
-                                               *itCoords, x, y,
+                                               currentCoords, x, y,
                                                polygons, viewport,
                                                f );
                     }
                     else {
-                        tessellateLineSegment( *itPreviousCoords, previousX, previousY,
+                        tessellateLineSegment( previousCoords, previousX, previousY,
                                                horizonCoords, horizonX, horizonY,
                                                polygons, viewport,
                                                f );
@@ -510,7 +637,11 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
             }
 
             previousGlobeHidesPoint = globeHidesPoint;
-            itPreviousCoords = itCoords;
+            previousIndex = index;
+            if ( needsCoordinates ) {
+                previousCoords = currentCoords;
+                previousCoordsIndex = index;
+            }
             previousX = x;
             previousY = y;
         }
@@ -521,10 +652,10 @@ bool SphericalProjectionPrivate::lineStringToPolygon( const GeoDataLineString &l
         if ( processingLastNode ) {
             break;
         }
-        ++itCoords;
+        ++index;
 
-        if ( itCoords == itEnd  && lineString.isClosed() ) {
-            itCoords = itBegin;
+        if ( index == nodeCount && lineString.isClosed() ) {
+            index = 0;
             processingLastNode = true;
         }
     }
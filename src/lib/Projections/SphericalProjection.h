@@ -83,6 +83,13 @@ class SphericalProjection : public AbstractProjection
                             const ViewportParams *viewport,
                             QVector<QPolygonF*> &polygons ) const;
 
+    virtual void screenCoordinates( int count,
+                            const qreal *lons, const qreal *lats,
+                            const qreal *altitudes,
+                            const ViewportParams *viewport,
+                            qreal *x, qreal *y, bool *visible,
+                            bool *globeHidesPoint = 0 ) const;
+
     using AbstractProjection::screenCoordinates;
 
     /**
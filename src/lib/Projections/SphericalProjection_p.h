@@ -30,6 +30,14 @@ class SphericalProjectionPrivate : public AbstractProjectionPrivate
                               const ViewportParams *viewport,
                               QVector<QPolygonF*> &polygons ) const;
 
+    // Projects the unit vectors (x, y, z triples) of count points onto the screen.
+    // altitudes and globeHidesPoint may be 0.
+    void projectUnitVectors( int count, const qreal *unitVectors,
+                             const qreal *altitudes,
+                             const ViewportParams *viewport,
+                             qreal *x, qreal *y, bool *visible,
+                             bool *globeHidesPoint ) const;
+
     void horizonToPolygon( const ViewportParams *viewport,
                            const GeoDataCoordinates & disappearCoords,
                            const GeoDataCoordinates & reappearCoords,
@@ -252,6 +252,7 @@ void QtMarbleConfigDialog::readSettings()
     // Cache
     d->w_cacheSettings->kcfg_volatileTileCacheLimit->setValue( volatileTileCacheLimit() );
     d->w_cacheSettings->kcfg_persistentTileCacheLimit->setValue( persistentTileCacheLimit() );
+    d->w_cacheSettings->kcfg_packedTileCache->setChecked( packedTileCache() );
     d->w_cacheSettings->kcfg_proxyUrl->setText( proxyUrl() );
     d->w_cacheSettings->kcfg_proxyPort->setValue( proxyPort() );
     d->w_cacheSettings->kcfg_proxyUser->setText( proxyUser() );
@@ -353,6 +354,7 @@ void QtMarbleConfigDialog::writeSettings()
     d->m_settings.beginGroup( "Cache" );
     d->m_settings.setValue( "volatileTileCacheLimit", d->w_cacheSettings->kcfg_volatileTileCacheLimit->value() );
     d->m_settings.setValue( "persistentTileCacheLimit", d->w_cacheSettings->kcfg_persistentTileCacheLimit->value() );
+    d->m_settings.setValue( "packedTileCache", d->w_cacheSettings->kcfg_packedTileCache->isChecked() );
     d->m_settings.setValue( "proxyUrl", d->w_cacheSettings->kcfg_proxyUrl->text() );
     d->m_settings.setValue( "proxyPort", d->w_cacheSettings->kcfg_proxyPort->value() );
     d->m_settings.setValue( "proxyType", d->w_cacheSettings->kcfg_proxyType->currentIndex() );
@@ -477,6 +479,11 @@ int QtMarbleConfigDialog::persistentTileCacheLimit() const
     return d->m_settings.value( "Cache/persistentTileCacheLimit", 0 ).toInt(); // default to unlimited
 }
 
+bool QtMarbleConfigDialog::packedTileCache() const
+{
+    return d->m_settings.value( "Cache/packedTileCache", false ).toBool();
+}
+
 QString QtMarbleConfigDialog::proxyUrl() const
 {
     return d->m_settings.value( "Cache/proxyUrl", "" ).toString();
@@ -55,6 +55,7 @@ class MARBLE_EXPORT QtMarbleConfigDialog : public QDialog
     // Cache Settings
     int volatileTileCacheLimit() const;
     int persistentTileCacheLimit() const;
+    bool packedTileCache() const;
     QString proxyUrl() const;
     int proxyPort() const;
 
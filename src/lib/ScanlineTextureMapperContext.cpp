@@ -168,7 +168,18 @@ void ScanlineTextureMapperContext::pixelValueApproxF( const qreal lon, const qre
 
         const bool alwaysCheckTileRange =
                 isOutOfTileRangeF( itLon, itLat, itStepLon, itStepLat, n );
-        
+
+        if ( !alwaysCheckTileRange ) {
+            // the whole span is located on the current tile, so let the tile
+            // interpolate all pixels in one go
+            const qreal scale = 1.0 / ( 1 << m_deltaLevel );
+            m_tile->pixelsF( ( itLon + itStepLon + m_vTileStartX ) * scale,
+                             ( itLat + itStepLat + m_vTileStartY ) * scale,
+                             itStepLon * scale, itStepLat * scale,
+                             scanLine, n - 1 );
+            return;
+        }
+
         for ( int j=1; j < n; ++j ) {
             qreal posX = itLon + itStepLon * j;
             qreal posY = itLat + itStepLat * j;
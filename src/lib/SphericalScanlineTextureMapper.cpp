@@ -14,6 +14,7 @@
 
 #include <cmath>
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QRunnable>
 
 #include "MarbleGlobal.h"
@@ -32,32 +33,54 @@
 
 using namespace Marble;
 
+/*
+ * Maps chunks of scanlines until all chunks of the frame are taken.
+ *
+ * The jobs share a counter of the next unmapped scanline, so a job that
+ * finishes its chunk early (e.g. close to the limb, where scanlines are short)
+ * just takes the next chunk instead of idling until the other jobs are done.
+ */
 class SphericalScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, QAtomicInt *nextRow, int rowChunkSize, int yBottom, int xLeft, int xRight );
 
     virtual void run();
 
 private:
+    int nextChunk( int *yEnd );
+
     StackedTileLoader *const m_tileLoader;
     const int m_tileLevel;
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    int const m_yTop;
+    QAtomicInt *const m_nextRow;
+    int const m_rowChunkSize;
     int const m_yBottom;
+    int const m_xDirtyLeft;
+    int const m_xDirtyRight;
 };
 
-SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, QAtomicInt *nextRow, int rowChunkSize, int yBottom, int xLeft, int xRight )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_nextRow( nextRow ),
+      m_rowChunkSize( rowChunkSize ),
+      m_yBottom( yBottom ),
+      m_xDirtyLeft( xLeft ),
+      m_xDirtyRight( xRight )
+{
+}
+
+SphericalScanlineTextureMapper::SphericalScanlineTextureMapper( int rowChunkSize )
+    : TextureMapperInterface(),
+      m_rowChunkSize( rowChunkSize )
 {
+    Q_ASSERT( rowChunkSize > 0 && rowChunkSize % 2 == 0 );
 }
 
 QRect SphericalScanlineTextureMapper::rect( const ViewportParams *viewport ) const
@@ -68,7 +91,7 @@ QRect SphericalScanlineTextureMapper::rect( const ViewportParams *viewport ) con
                 2 * radius, 2 * radius);
 }
 
-void SphericalScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
+void SphericalScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, const QRect &dirtyRect )
 {
     // Reset backend
     tileLoader->resetTilehash();
@@ -86,12 +109,19 @@ void SphericalScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTil
     const int yBottom = ( yTop == 0 ) ? imageHeight - skip
                                       : yTop + radius + radius - skip;
 
-    const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = ( yBottom - yTop ) / numThreads;
+    // Only the dirty rows need to be painted again
+    const int yDirtyTop = qMax( yTop, dirtyRect.top() );
+    const int yDirtyBottom = qMax( yDirtyTop, qMin( yBottom, dirtyRect.bottom() + 1 ) );
+
+    // ... and only the dirty columns of them
+    const int xDirtyLeft  = qBound( 0, dirtyRect.left(), canvasImage->width() );
+    const int xDirtyRight = qBound( xDirtyLeft, dirtyRect.right() + 1, canvasImage->width() );
+
+    QAtomicInt nextRow( yDirtyTop );
+    const int numChunks = ( yDirtyBottom - yDirtyTop + m_rowChunkSize - 1 ) / m_rowChunkSize;
+    const int numThreads = qMin( m_threadPool.maxThreadCount(), numChunks );
     for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = yTop + (i + 1) * yStep;
-        QRunnable *const job = new RenderJob( tileLoader, tileZoomLevel, canvasImage, viewport, mapQuality, yStart, yEnd );
+        QRunnable *const job = new RenderJob( tileLoader, tileZoomLevel, canvasImage, viewport, mapQuality, &nextRow, m_rowChunkSize, yDirtyBottom, xDirtyLeft, xDirtyRight );
         m_threadPool.start( job );
     }
 
@@ -100,6 +130,18 @@ void SphericalScanlineTextureMapper::mapTexture( QImage *canvasImage, StackedTil
     tileLoader->cleanupTilehash();
 }
 
+/*
+ * Takes the next chunk of scanlines. Returns its first scanline, which is
+ * not less than m_yBottom if all chunks are taken already.
+ */
+int SphericalScanlineTextureMapper::RenderJob::nextChunk( int *yEnd )
+{
+    const int yStart = m_nextRow->fetchAndAddRelaxed( m_rowChunkSize );
+    *yEnd = qMin( yStart + m_rowChunkSize, m_yBottom );
+
+    return yStart;
+}
+
 void SphericalScanlineTextureMapper::RenderJob::run()
 {
     const int imageHeight = m_canvasImage->height();
@@ -131,8 +173,9 @@ void SphericalScanlineTextureMapper::RenderJob::run()
     qreal  lon = 0.0;
     qreal  lat = 0.0;
 
-    // Scanline based algorithm to texture map a sphere
-    for ( int y = m_yTop; y < m_yBottom ; ++y ) {
+    // Scanline based algorithm to texture map a sphere, a chunk of scanlines at a time
+    int yEnd = 0;
+    for ( int y = nextChunk( &yEnd ); y < m_yBottom ; y = ( y + 1 < yEnd ) ? y + 1 : nextChunk( &yEnd ) ) {
 
         // Evaluate coordinates for the 3D position vector of the current pixel
         const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
@@ -160,12 +203,17 @@ void SphericalScanlineTextureMapper::RenderJob::run()
         const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
                                                        : imageWidth;
 
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xLeft;
+        // Only the dirty columns get painted. The interpolation intervals
+        // start at the same columns as the ones of the whole scanline.
+        const int xPaintedLeft  = qMax( xLeft, m_xDirtyLeft );
+        const int xPaintedRight = qMax( xPaintedLeft, qMin( xRight, m_xDirtyRight ) );
+        const int xIpOffset = ( imageWidth / 2 - rx > 0 ) ? 0 : 1;
+
+        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xPaintedLeft;
 
-        const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
-                                                         : 1;
-        const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
-                                                         : n * (int)( xRight / n - 1 ) + 1; 
+        const int xIpLeft  = ( xPaintedLeft < xIpOffset ) ? xIpOffset
+                                                          : xIpOffset + n * (int)( ( xPaintedLeft - xIpOffset ) / n + 1 );
+        const int xIpRight = xIpOffset + n * (int)( xPaintedRight / n - 1 );
 
         // Decrease pole distortion due to linear approximation ( y-axis )
         bool crossingPoleArea = false;
@@ -178,7 +226,7 @@ void SphericalScanlineTextureMapper::RenderJob::run()
 
         int ncount = 0;
 
-        for ( int x = xLeft; x < xRight; ++x ) {
+        for ( int x = xPaintedLeft; x < xPaintedRight; ++x ) {
             // Prepare for interpolation
 
             const int leftInterval = xIpLeft + ncount * n;
@@ -247,13 +295,13 @@ void SphericalScanlineTextureMapper::RenderJob::run()
         }
 
         // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) { 
+        if ( interlaced && y + 1 < yEnd ) { 
 
             const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-            memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize, 
-                    m_canvasImage->scanLine( y ) + xLeft * pixelByteSize, 
-                    ( xRight - xLeft ) * pixelByteSize );
+            memcpy( m_canvasImage->scanLine( y + 1 ) + xPaintedLeft * pixelByteSize, 
+                    m_canvasImage->scanLine( y ) + xPaintedLeft * pixelByteSize, 
+                    ( xPaintedRight - xPaintedLeft ) * pixelByteSize );
             ++y;
         }
     }
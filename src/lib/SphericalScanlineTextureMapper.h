@@ -16,6 +16,7 @@
 #include "TextureMapperInterface.h"
 
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 #include <QtCore/QThreadPool>
 #include <QtGui/QImage>
@@ -36,15 +37,25 @@ class StackedTileLoader;
  * @author Torsten Rahn <rahn@kde.org>
  */
 
-class SphericalScanlineTextureMapper : public TextureMapperInterface
+class MARBLE_EXPORT SphericalScanlineTextureMapper : public TextureMapperInterface
 {
  public:
+    enum { DefaultRowChunkSize = 16 };
+
+    /**
+     * @param rowChunkSize  the number of scanlines that a render job maps at
+     *                      once. Needs to be even so that interlaced rendering
+     *                      copies scanlines within the chunk only.
+     */
+    explicit SphericalScanlineTextureMapper( int rowChunkSize = DefaultRowChunkSize );
+
     QRect rect( const ViewportParams *viewport ) const;
 
-    void mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+    void mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, const QRect &dirtyRect );
 
  private:
     class RenderJob;
+    const int m_rowChunkSize;
     QThreadPool m_threadPool;
 };
 
@@ -16,6 +16,11 @@
 #include "MarbleDebug.h"
 #include "TextureTile.h"
 
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#define MARBLE_STACKEDTILE_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace Marble;
 
 static const uint **jumpTableFromQImage32( const QImage &img )
@@ -56,15 +61,17 @@ static const uchar **jumpTableFromQImage8( const QImage &img )
 }
 
 
-StackedTile::StackedTile( const TileId &id, const QImage &resultImage, QVector<QSharedPointer<TextureTile> > const &tiles ) :
+StackedTile::StackedTile( const TileId &id, const QImage &resultImage, QVector<QSharedPointer<TextureTile> > const &tiles,
+                          const QImage &unshadedImage ) :
       Tile( id ),
       m_resultImage( resultImage ),
+      m_unshadedImage( unshadedImage.isNull() ? resultImage : unshadedImage ),
       m_depth( resultImage.depth() ),
       m_isGrayscale( resultImage.isGrayscale() ),
       m_tiles( tiles ),
       jumpTable8( jumpTableFromQImage8( m_resultImage ) ),
       jumpTable32( jumpTableFromQImage32( m_resultImage ) ),
-      m_byteCount( calcByteCount( resultImage, tiles ) ),
+      m_byteCount( calcByteCount( m_resultImage, m_unshadedImage, tiles ) ),
       m_isUsed( false )
 {
     Q_ASSERT( !tiles.isEmpty() );
@@ -212,10 +219,128 @@ uint StackedTile::pixelF( qreal x, qreal y, const QRgb& topLeftValue ) const
     return topLeftValue;
 }
 
-int StackedTile::calcByteCount( const QImage &resultImage, const QVector<QSharedPointer<TextureTile> > &tiles )
+// Linear interpolation of two 32-bit colors with a weight in the range 0..256,
+// processing two channels at a time.
+static inline uint blend256( uint a, uint b, uint weightB )
+{
+    const uint weightA = 256 - weightB;
+    const uint rb = ( ( ( a & 0x00ff00ff ) * weightA + ( b & 0x00ff00ff ) * weightB ) >> 8 ) & 0x00ff00ff;
+    const uint ag = ( ( ( a >> 8 ) & 0x00ff00ff ) * weightA + ( ( b >> 8 ) & 0x00ff00ff ) * weightB ) & 0xff00ff00;
+
+    return rb | ag;
+}
+
+#ifdef MARBLE_STACKEDTILE_SSE2
+static inline uint bilinear256( uint topLeft, uint topRight, uint bottomLeft, uint bottomRight,
+                                uint weightX, uint weightY )
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    // widen the channels of the left and right pixels to 16 bits
+    const __m128i top = _mm_unpacklo_epi8( _mm_unpacklo_epi32( _mm_cvtsi32_si128( topLeft ),
+                                                                 _mm_cvtsi32_si128( topRight ) ), zero );
+    const __m128i bottom = _mm_unpacklo_epi8( _mm_unpacklo_epi32( _mm_cvtsi32_si128( bottomLeft ),
+                                                                    _mm_cvtsi32_si128( bottomRight ) ), zero );
+
+    // interpolation in y-direction: the sums fit into unsigned 16 bits
+    const __m128i vertical = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( top, _mm_set1_epi16( 256 - weightY ) ),
+                                                            _mm_mullo_epi16( bottom, _mm_set1_epi16( weightY ) ) ), 8 );
+
+    // interpolation in x-direction
+    const __m128i weights = _mm_set_epi16( weightX, weightX, weightX, weightX,
+                                           256 - weightX, 256 - weightX, 256 - weightX, 256 - weightX );
+    const __m128i products = _mm_mullo_epi16( vertical, weights );
+    const __m128i horizontal = _mm_srli_epi16( _mm_add_epi16( products, _mm_srli_si128( products, 8 ) ), 8 );
+
+    return _mm_cvtsi128_si32( _mm_packus_epi16( horizontal, zero ) );
+}
+#else
+static inline uint bilinear256( uint topLeft, uint topRight, uint bottomLeft, uint bottomRight,
+                                uint weightX, uint weightY )
+{
+    return blend256( blend256( topLeft, bottomLeft, weightY ),
+                     blend256( topRight, bottomRight, weightY ), weightX );
+}
+#endif
+
+void StackedTile::pixelsF( qreal x, qreal y, qreal stepX, qreal stepY, QRgb *scanLine, int n ) const
+{
+    if ( n <= 0 )
+        return;
+
+    const int maxX = m_resultImage.width() - 1;
+    const int maxY = m_resultImage.height() - 1;
+
+    // positions in fixed point arithmetic with 8 fractional bits
+    int posX = (int)( x * 256.0 );
+    int posY = (int)( y * 256.0 );
+    const int fixedStepX = (int)( stepX * 256.0 );
+    const int fixedStepY = (int)( stepY * 256.0 );
+
+    if ( m_depth == 32 ) {
+        for ( int i = 0; i < n; ++i ) {
+            const int iX = qBound( 0, posX >> 8, maxX );
+            const int iY = qBound( 0, posY >> 8, maxY );
+            const int iX1 = qMin( iX + 1, maxX );
+            const uint *const topLine = jumpTable32[ iY ];
+            const uint *const bottomLine = jumpTable32[ qMin( iY + 1, maxY ) ];
+
+            // like pixelF(), the result is an opaque color
+            scanLine[i] = 0xff000000 | bilinear256( topLine[ iX ], topLine[ iX1 ],
+                                                    bottomLine[ iX ], bottomLine[ iX1 ],
+                                                    posX & 0xff, posY & 0xff );
+            posX += fixedStepX;
+            posY += fixedStepY;
+        }
+    }
+    else if ( m_depth == 8 && m_isGrayscale ) {
+        for ( int i = 0; i < n; ++i ) {
+            const int iX = qBound( 0, posX >> 8, maxX );
+            const int iY = qBound( 0, posY >> 8, maxY );
+            const int iX1 = qMin( iX + 1, maxX );
+            const uchar *const topLine = jumpTable8[ iY ];
+            const uchar *const bottomLine = jumpTable8[ qMin( iY + 1, maxY ) ];
+            const uint weightX = posX & 0xff;
+            const uint weightY = posY & 0xff;
+
+            const uint left = topLine[ iX ] * ( 256 - weightY ) + bottomLine[ iX ] * weightY;
+            const uint right = topLine[ iX1 ] * ( 256 - weightY ) + bottomLine[ iX1 ] * weightY;
+
+            scanLine[i] = qRgb( 0, 0, ( left * ( 256 - weightX ) + right * weightX ) >> 16 );
+            posX += fixedStepX;
+            posY += fixedStepY;
+        }
+    }
+    else if ( m_depth == 8 ) {
+        for ( int i = 0; i < n; ++i ) {
+            const int iX = qBound( 0, posX >> 8, maxX );
+            const int iY = qBound( 0, posY >> 8, maxY );
+            const int iX1 = qMin( iX + 1, maxX );
+            const int iY1 = qMin( iY + 1, maxY );
+
+            scanLine[i] = 0xff000000 | bilinear256( pixel( iX, iY ), pixel( iX1, iY ),
+                                                    pixel( iX, iY1 ), pixel( iX1, iY1 ),
+                                                    posX & 0xff, posY & 0xff );
+            posX += fixedStepX;
+            posY += fixedStepY;
+        }
+    }
+    else {
+        for ( int i = 0; i < n; ++i ) {
+            scanLine[i] = pixelF( x + i * stepX, y + i * stepY );
+        }
+    }
+}
+
+int StackedTile::calcByteCount( const QImage &resultImage, const QImage &unshadedImage,
+                                const QVector<QSharedPointer<TextureTile> > &tiles )
 {
     int byteCount = resultImage.numBytes();
 
+    // both images share their data if no sun shading was applied
+    if ( unshadedImage.cacheKey() != resultImage.cacheKey() )
+        byteCount += unshadedImage.numBytes();
+
     QVector<QSharedPointer<TextureTile> >::const_iterator pos = tiles.constBegin();
     QVector<QSharedPointer<TextureTile> >::const_iterator const end = tiles.constEnd();
     for (; pos != end; ++pos )
@@ -264,3 +389,8 @@ QImage const * StackedTile::resultImage() const
     return &m_resultImage;
 }
 
+QImage const * StackedTile::unshadedImage() const
+{
+    return &m_unshadedImage;
+}
+
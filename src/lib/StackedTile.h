@@ -56,7 +56,8 @@ class TextureTile;
 class StackedTile : public Tile
 {
  public:
-    explicit StackedTile( TileId const &id, QImage const &resultImage, QVector<QSharedPointer<TextureTile> > const &tiles );
+    explicit StackedTile( TileId const &id, QImage const &resultImage, QVector<QSharedPointer<TextureTile> > const &tiles,
+                          QImage const &unshadedImage = QImage() );
     virtual ~StackedTile();
 
     void setUsed( bool used );
@@ -77,6 +78,15 @@ class StackedTile : public Tile
 */
     QImage const * resultImage() const;
 
+/*!
+    \brief Returns the merged stack of Tiles before sun shading got applied
+    \return A non-zero pointer to the unshaded QImage
+
+    This allows for updating the sun shading without merging the stack of
+    Tiles again. If no sun shading was applied, this is the result image.
+*/
+    QImage const * unshadedImage() const;
+
 /*!
     \brief Returns the color value of the result tile at the given integer position.
     \return The uint that describes the color value of the given pixel 
@@ -99,10 +109,26 @@ class StackedTile : public Tile
     // This method passes the top left pixel (if known already) for better performance
     uint pixelF( qreal x, qreal y, const QRgb& pixel ) const; 
 
+/*!
+    \brief Samples a linear span of subpixel positions of the result tile.
+
+    Writes the bilinearly interpolated color values of the \p n positions
+    (x + i * stepX, y + i * stepY) with 0 <= i < n to \p scanLine. All positions
+    need to be located on the tile.
+
+    This is considerably faster than calling pixelF() for each position, since
+    it uses fixed point arithmetic and SSE2, if available.
+
+    Note: for gray scale images the color value of a single pixel is described
+    via a uchar (1 byte) while for RGB(A) images uint (4 bytes) are used.
+*/
+    void pixelsF( qreal x, qreal y, qreal stepX, qreal stepY, QRgb *scanLine, int n ) const;
+
  private:
     Q_DISABLE_COPY( StackedTile )
 
     const QImage m_resultImage;
+    const QImage m_unshadedImage;
     const int m_depth;
     const bool m_isGrayscale;
     const QVector<QSharedPointer<TextureTile> > m_tiles;
@@ -111,7 +137,8 @@ class StackedTile : public Tile
     const int m_byteCount;
     bool m_isUsed;
 
-    static int calcByteCount( const QImage &resultImage, const QVector<QSharedPointer<TextureTile> > &tiles );
+    static int calcByteCount( const QImage &resultImage, const QImage &unshadedImage,
+                              const QVector<QSharedPointer<TextureTile> > &tiles );
 };
 
 }
@@ -32,39 +32,317 @@
 #include "TileLoaderHelper.h"
 #include "MarbleGlobal.h"
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QCache>
 #include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QReadWriteLock>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 #include <QtGui/QImage>
 
 
 namespace Marble
 {
 
+/**
+ * One stripe of the tile hash, guarded by its own lock.
+ *
+ * Tiles are distributed over several shards so that the mapper threads,
+ * which each work on a different part of the viewport, rarely contend
+ * for the same lock. The tile cache is shared by all shards, such that
+ * the least recently used tile gets evicted first.
+ */
+class StackedTileCacheShard
+{
+public:
+    QHash <TileId, StackedTile*>  m_tilesOnDisplay;
+    QReadWriteLock m_lock;
+
+    // tiles currently being decoded in the background
+    QSet<TileId> m_pendingTiles;
+    QSet<TileId> m_outdatedPendingTiles;
+
+    // cached or pending tiles which got shaded for an outdated sun position
+    QSet<TileId> m_outdatedShadingTiles;
+};
+
 class StackedTileLoaderPrivate
 {
 public:
-    StackedTileLoaderPrivate( MergedLayerDecorator *mergedLayerDecorator )
-        : m_layerDecorator( mergedLayerDecorator )
+    enum { ShardCount = 16 };
+
+    StackedTileLoaderPrivate( MergedLayerDecorator *mergedLayerDecorator, StackedTileLoader *parent )
+        : q( parent ),
+          m_layerDecorator( mergedLayerDecorator ),
+          m_asynchronousLoading( false ),
+          m_generation( 0 ),
+          m_hits( 0 ),
+          m_misses( 0 ),
+          m_contentions( 0 ),
+          m_loads( 0 )
     {
-        m_tileCache.setMaxCost( 20000 * 1024 ); // Cache size measured in bytes
+        setCacheLimit( 20000 * 1024 ); // Cache size measured in bytes
+        m_decodePool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() / 2 ) );
     }
 
+    StackedTileCacheShard &shard( const TileId &stackedTileId );
+    void lockForRead( StackedTileCacheShard &shard );
+    void lockForWrite( StackedTileCacheShard &shard );
+    void setCacheLimit( quint64 bytes );
+
+    StackedTile *findPlaceholderTile( const TileId &stackedTileId );
+    void enqueueDecode( StackedTileCacheShard &shard, const TileId &stackedTileId );
+    void reportDecodedTile( int generation, StackedTile *stackedTile );
+    void integrateDecodedTiles();
+    StackedTile *updateShading( StackedTile *stackedTile );
+
+    StackedTileLoader *const q;
     MergedLayerDecorator *const m_layerDecorator;
-    QHash <TileId, StackedTile*>  m_tilesOnDisplay;
+    StackedTileCacheShard m_shards[ShardCount];
+    quint64 m_cacheLimit;
+
+    // Guarded by m_tileCacheMutex, which may be locked while holding a shard
+    // lock, but not the other way round. It is only needed for tiles which
+    // are not displayed.
+    QMutex m_tileCacheMutex;
     QCache <TileId, StackedTile>  m_tileCache;
-    QReadWriteLock m_cacheLock;
+
+    bool m_asynchronousLoading;
+    QThreadPool m_decodePool;
+
+    // The following members are guarded by m_decodedTilesMutex
+    QMutex m_decodedTilesMutex;
+    QList<StackedTile *> m_decodedTiles;
+    int m_generation;
+
+    QAtomicInt m_hits;
+    QAtomicInt m_misses;
+    QAtomicInt m_contentions;
+    QAtomicInt m_loads;
+};
+
+/**
+ * Decodes a single stacked tile in a thread of the decode pool and hands it
+ * back to the loader, which integrates it in the GUI thread.
+ */
+class StackedTileDecodeJob : public QRunnable
+{
+public:
+    StackedTileDecodeJob( StackedTileLoaderPrivate *loader, const TileId &stackedTileId, int generation )
+        : m_loader( loader ),
+          m_stackedTileId( stackedTileId ),
+          m_generation( generation )
+    {
+    }
+
+    virtual void run()
+    {
+        StackedTile *const stackedTile = m_loader->m_layerDecorator->loadTile( m_stackedTileId );
+        Q_ASSERT( stackedTile );
+        m_loader->m_loads.fetchAndAddRelaxed( 1 );
+        m_loader->reportDecodedTile( m_generation, stackedTile );
+    }
+
+private:
+    StackedTileLoaderPrivate *const m_loader;
+    const TileId m_stackedTileId;
+    const int m_generation;
 };
 
+StackedTileCacheShard &StackedTileLoaderPrivate::shard( const TileId &stackedTileId )
+{
+    // Neighboring tiles only differ in the low bits of qHash(), so use
+    // Fibonacci hashing to spread them over the shards.
+    const uint hash = qHash( stackedTileId ) * 2654435761U;
+    return m_shards[ ( hash >> 16 ) % ShardCount ];
+}
+
+void StackedTileLoaderPrivate::lockForRead( StackedTileCacheShard &shard )
+{
+    if ( !shard.m_lock.tryLockForRead() ) {
+        m_contentions.fetchAndAddRelaxed( 1 );
+        shard.m_lock.lockForRead();
+    }
+}
+
+void StackedTileLoaderPrivate::lockForWrite( StackedTileCacheShard &shard )
+{
+    if ( !shard.m_lock.tryLockForWrite() ) {
+        m_contentions.fetchAndAddRelaxed( 1 );
+        shard.m_lock.lockForWrite();
+    }
+}
+
+void StackedTileLoaderPrivate::setCacheLimit( quint64 bytes )
+{
+    m_cacheLimit = bytes;
+
+    QMutexLocker locker( &m_tileCacheMutex );
+    m_tileCache.setMaxCost( bytes );
+}
+
+StackedTile *StackedTileLoaderPrivate::findPlaceholderTile( const TileId &stackedTileId )
+{
+    // must not be called with any shard locked, since the ancestors
+    // are usually contained in different shards
+
+    for ( int level = stackedTileId.zoomLevel() - 1; level >= 0; --level ) {
+        const int deltaLevel = stackedTileId.zoomLevel() - level;
+        const TileId ancestorId( 0, level, stackedTileId.x() >> deltaLevel, stackedTileId.y() >> deltaLevel );
+
+        StackedTileCacheShard &ancestorShard = shard( ancestorId );
+        QImage toScale;
+        QVector<QSharedPointer<TextureTile> > tiles;
+
+        // copy the (implicitly shared) image, since the ancestor may get
+        // deleted as soon as the locks are released
+        lockForRead( ancestorShard );
+        const StackedTile *ancestor = ancestorShard.m_tilesOnDisplay.value( ancestorId, 0 );
+        if ( ancestor ) {
+            toScale = *ancestor->resultImage();
+            tiles = ancestor->tiles();
+        } else {
+            QMutexLocker cacheLocker( &m_tileCacheMutex );
+            ancestor = m_tileCache.object( ancestorId );
+            if ( ancestor ) {
+                toScale = *ancestor->resultImage();
+                tiles = ancestor->tiles();
+            }
+        }
+        ancestorShard.m_lock.unlock();
+
+        if ( !ancestor ) {
+            continue;
+        }
+
+        // which rect to scale?
+        const int restTileX = stackedTileId.x() % ( 1 << deltaLevel );
+        const int restTileY = stackedTileId.y() % ( 1 << deltaLevel );
+        const int partWidth = qMax( 1, toScale.width() >> deltaLevel );
+        const int partHeight = qMax( 1, toScale.height() >> deltaLevel );
+        const int startX = restTileX * partWidth;
+        const int startY = restTileY * partHeight;
+        const QImage part = toScale.copy( startX, startY, partWidth, partHeight ).scaled( toScale.size() );
+
+        return new StackedTile( stackedTileId, part, tiles );
+    }
+
+    return 0;
+}
+
+void StackedTileLoaderPrivate::enqueueDecode( StackedTileCacheShard &shard, const TileId &stackedTileId )
+{
+    // must be called with the shard locked for writing
+
+    if ( shard.m_pendingTiles.contains( stackedTileId ) ) {
+        return;
+    }
+
+    shard.m_pendingTiles.insert( stackedTileId );
+
+    m_decodedTilesMutex.lock();
+    const int generation = m_generation;
+    m_decodedTilesMutex.unlock();
+
+    m_decodePool.start( new StackedTileDecodeJob( this, stackedTileId, generation ) );
+}
+
+void StackedTileLoaderPrivate::reportDecodedTile( int generation, StackedTile *stackedTile )
+{
+    QMutexLocker locker( &m_decodedTilesMutex );
+
+    if ( generation != m_generation ) {
+        // the loader was cleared in the meantime
+        delete stackedTile;
+        return;
+    }
+
+    const bool wasEmpty = m_decodedTiles.isEmpty();
+    m_decodedTiles.append( stackedTile );
+
+    if ( wasEmpty ) {
+        QMetaObject::invokeMethod( q, "integrateDecodedTiles", Qt::QueuedConnection );
+    }
+}
+
+void StackedTileLoaderPrivate::integrateDecodedTiles()
+{
+    m_decodedTilesMutex.lock();
+    const QList<StackedTile *> decodedTiles = m_decodedTiles;
+    m_decodedTiles.clear();
+    m_decodedTilesMutex.unlock();
+
+    QList<TileId> loadedTiles;
+
+    foreach ( StackedTile *stackedTile, decodedTiles ) {
+        const TileId stackedTileId = stackedTile->id();
+        StackedTileCacheShard &tileShard = shard( stackedTileId );
+        QWriteLocker locker( &tileShard.m_lock );
+
+        tileShard.m_pendingTiles.remove( stackedTileId );
+
+        if ( tileShard.m_outdatedPendingTiles.remove( stackedTileId ) ) {
+            // the tile was updated while it was being decoded, so decode it once more
+            delete stackedTile;
+            enqueueDecode( tileShard, stackedTileId );
+            continue;
+        }
+
+        if ( tileShard.m_outdatedShadingTiles.remove( stackedTileId ) ) {
+            stackedTile = updateShading( stackedTile );
+        }
+
+        StackedTile *const placeholder = tileShard.m_tilesOnDisplay.value( stackedTileId, 0 );
+        if ( placeholder ) {
+            stackedTile->setUsed( true );
+            tileShard.m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+            delete placeholder;
+        } else {
+            // Even if the placeholder has been evicted from the cache already,
+            // it may still be on the canvas of the texture layer, so the tile
+            // gets cached and announced anyway.
+            QMutexLocker cacheLocker( &m_tileCacheMutex );
+            m_tileCache.insert( stackedTileId, stackedTile, stackedTile->numBytes() );
+        }
+
+        loadedTiles.append( stackedTileId );
+    }
+
+    foreach ( const TileId &stackedTileId, loadedTiles ) {
+        emit q->tileLoaded( stackedTileId );
+    }
+}
+
+StackedTile *StackedTileLoaderPrivate::updateShading( StackedTile *stackedTile )
+{
+    StackedTile *const shadedTile = m_layerDecorator->updateShading( *stackedTile );
+    if ( !shadedTile ) {
+        return stackedTile;
+    }
+
+    shadedTile->setUsed( stackedTile->used() );
+    delete stackedTile;
+
+    return shadedTile;
+}
+
 StackedTileLoader::StackedTileLoader( MergedLayerDecorator *mergedLayerDecorator, QObject *parent )
     : QObject( parent ),
-      d( new StackedTileLoaderPrivate( mergedLayerDecorator ) )
+      d( new StackedTileLoaderPrivate( mergedLayerDecorator, this ) )
 {
 }
 
 StackedTileLoader::~StackedTileLoader()
 {
-    qDeleteAll( d->m_tilesOnDisplay );
+    d->m_decodePool.waitForDone();
+    qDeleteAll( d->m_decodedTiles );
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        qDeleteAll( d->m_shards[i].m_tilesOnDisplay );
+    }
     delete d;
 }
 
@@ -90,11 +368,16 @@ QSize StackedTileLoader::tileSize() const
 
 void StackedTileLoader::resetTilehash()
 {
-    QHash<TileId, StackedTile*>::const_iterator it = d->m_tilesOnDisplay.constBegin();
-    QHash<TileId, StackedTile*>::const_iterator const end = d->m_tilesOnDisplay.constEnd();
-    for (; it != end; ++it ) {
-        Q_ASSERT( it.value()->used() && "contained in m_tilesOnDisplay should imply used()" );
-        it.value()->setUsed( false );
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        StackedTileCacheShard &shard = d->m_shards[i];
+        QWriteLocker locker( &shard.m_lock );
+
+        QHash<TileId, StackedTile*>::const_iterator it = shard.m_tilesOnDisplay.constBegin();
+        QHash<TileId, StackedTile*>::const_iterator const end = shard.m_tilesOnDisplay.constEnd();
+        for (; it != end; ++it ) {
+            Q_ASSERT( it.value()->used() && "contained in m_tilesOnDisplay should imply used()" );
+            it.value()->setUsed( false );
+        }
     }
 }
 
@@ -103,62 +386,134 @@ void StackedTileLoader::cleanupTilehash()
     // Make sure that tiles which haven't been used during the last
     // rendering of the map at all get removed from the tile hash.
 
-    QHashIterator<TileId, StackedTile*> it( d->m_tilesOnDisplay );
-    while ( it.hasNext() ) {
-        it.next();
-        if ( !it.value()->used() ) {
-            // If insert call result is false then the cache is too small to store the tile
-            // but the item will get deleted nevertheless and the pointer we have
-            // doesn't get set to zero (so don't delete it in this case or it will crash!)
-            d->m_tileCache.insert( it.key(), it.value(), it.value()->numBytes() );
-            d->m_tilesOnDisplay.remove( it.key() );
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        StackedTileCacheShard &shard = d->m_shards[i];
+        QWriteLocker locker( &shard.m_lock );
+
+        QMutexLocker cacheLocker( &d->m_tileCacheMutex );
+
+        QHashIterator<TileId, StackedTile*> it( shard.m_tilesOnDisplay );
+        while ( it.hasNext() ) {
+            it.next();
+            if ( !it.value()->used() ) {
+                // If insert call result is false then the cache is too small to store the tile
+                // but the item will get deleted nevertheless and the pointer we have
+                // doesn't get set to zero (so don't delete it in this case or it will crash!)
+                d->m_tileCache.insert( it.key(), it.value(), it.value()->numBytes() );
+                shard.m_tilesOnDisplay.remove( it.key() );
+            }
         }
     }
 }
 
 const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
 {
+    StackedTileCacheShard &shard = d->shard( stackedTileId );
+
     // check if the tile is in the hash
-    d->m_cacheLock.lockForRead();
-    StackedTile * stackedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
-    d->m_cacheLock.unlock();
+    d->lockForRead( shard );
+    StackedTile * stackedTile = shard.m_tilesOnDisplay.value( stackedTileId, 0 );
+    shard.m_lock.unlock();
     if ( stackedTile ) {
+        d->m_hits.fetchAndAddRelaxed( 1 );
         stackedTile->setUsed( true );
         return stackedTile;
     }
     // here ends the performance critical section of this method
 
-    d->m_cacheLock.lockForWrite();
+    d->lockForWrite( shard );
 
     // has another thread loaded our tile due to a race condition?
-    stackedTile = d->m_tilesOnDisplay.value( stackedTileId, 0 );
+    stackedTile = shard.m_tilesOnDisplay.value( stackedTileId, 0 );
     if ( stackedTile ) {
         Q_ASSERT( stackedTile->used() && "other thread should have marked tile as used" );
-        d->m_cacheLock.unlock();
+        shard.m_lock.unlock();
+        d->m_hits.fetchAndAddRelaxed( 1 );
         return stackedTile;
     }
 
     // the tile was not in the hash so check if it is in the cache
+    d->m_tileCacheMutex.lock();
     stackedTile = d->m_tileCache.take( stackedTileId );
+    d->m_tileCacheMutex.unlock();
     if ( stackedTile ) {
         Q_ASSERT( !stackedTile->used() && "tiles in m_tileCache are invisible and should thus be marked as unused" );
+        if ( shard.m_outdatedShadingTiles.remove( stackedTileId ) ) {
+            stackedTile = d->updateShading( stackedTile );
+        }
         stackedTile->setUsed( true );
-        d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
-        d->m_cacheLock.unlock();
+        shard.m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+        shard.m_lock.unlock();
+        d->m_hits.fetchAndAddRelaxed( 1 );
         return stackedTile;
     }
 
+    d->m_misses.fetchAndAddRelaxed( 1 );
+
     // tile (valid) has not been found in hash or cache, so load it from disk
     // and place it in the hash from where it will get transferred to the cache
 
+    if ( d->m_asynchronousLoading ) {
+        // avoid blocking the render thread on disk i/o: show a scaled version of
+        // a resident lower level tile and decode the tile in the background
+        shard.m_lock.unlock();
+        StackedTile *const placeholder = d->findPlaceholderTile( stackedTileId );
+        d->lockForWrite( shard );
+
+        // has another thread inserted our tile in the meantime?
+        stackedTile = shard.m_tilesOnDisplay.value( stackedTileId, 0 );
+        if ( !stackedTile ) {
+            d->m_tileCacheMutex.lock();
+            stackedTile = d->m_tileCache.take( stackedTileId );
+            d->m_tileCacheMutex.unlock();
+            if ( stackedTile ) {
+                if ( shard.m_outdatedShadingTiles.remove( stackedTileId ) ) {
+                    stackedTile = d->updateShading( stackedTile );
+                }
+                stackedTile->setUsed( true );
+                shard.m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+            }
+        }
+        if ( stackedTile ) {
+            shard.m_lock.unlock();
+            delete placeholder;
+            return stackedTile;
+        }
+
+        if ( placeholder ) {
+            mDebug() << "decode tile in background:" << stackedTileId;
+
+            placeholder->setUsed( true );
+            shard.m_tilesOnDisplay[ stackedTileId ] = placeholder;
+            d->enqueueDecode( shard, stackedTileId );
+            shard.m_lock.unlock();
+
+            return placeholder;
+        }
+    }
+
     mDebug() << "load tile from disk:" << stackedTileId;
 
+    // decode without blocking the other tiles of the shard
+    shard.m_lock.unlock();
     stackedTile = d->m_layerDecorator->loadTile( stackedTileId );
     Q_ASSERT( stackedTile );
+    d->m_loads.fetchAndAddRelaxed( 1 );
+    d->lockForWrite( shard );
+
+    // has another thread inserted our tile in the meantime?
+    StackedTile *const insertedTile = shard.m_tilesOnDisplay.value( stackedTileId, 0 );
+    if ( insertedTile ) {
+        shard.m_lock.unlock();
+        delete stackedTile;
+        return insertedTile;
+    }
+
     stackedTile->setUsed( true );
 
-    d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
-    d->m_cacheLock.unlock();
+    shard.m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+    shard.m_outdatedShadingTiles.remove( stackedTileId );
+    shard.m_lock.unlock();
 
     emit tileLoaded( stackedTileId );
 
@@ -167,53 +522,175 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
 
 quint64 StackedTileLoader::volatileCacheLimit() const
 {
-    return d->m_tileCache.maxCost() / 1024;
+    return d->m_cacheLimit / 1024;
 }
 
 QList<TileId> StackedTileLoader::visibleTiles() const
 {
-    return d->m_tilesOnDisplay.keys();
+    QList<TileId> result;
+
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        QReadLocker locker( &d->m_shards[i].m_lock );
+        result += d->m_shards[i].m_tilesOnDisplay.keys();
+    }
+
+    return result;
 }
 
 int StackedTileLoader::tileCount() const
 {
-    return d->m_tileCache.count() + d->m_tilesOnDisplay.count();
+    int count = 0;
+
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        QReadLocker locker( &d->m_shards[i].m_lock );
+        count += d->m_shards[i].m_tilesOnDisplay.count();
+    }
+
+    QMutexLocker locker( &d->m_tileCacheMutex );
+    return count + d->m_tileCache.count();
 }
 
 void StackedTileLoader::setVolatileCacheLimit( quint64 kiloBytes )
 {
     mDebug() << QString("Setting tile cache to %1 kilobytes.").arg( kiloBytes );
-    d->m_tileCache.setMaxCost( kiloBytes * 1024 );
+    d->setCacheLimit( kiloBytes * 1024 );
+}
+
+int StackedTileLoader::cacheHits() const
+{
+    return d->m_hits;
+}
+
+int StackedTileLoader::cacheMisses() const
+{
+    return d->m_misses;
+}
+
+int StackedTileLoader::lockContentions() const
+{
+    return d->m_contentions;
+}
+
+int StackedTileLoader::tileLoads() const
+{
+    return d->m_loads;
+}
+
+void StackedTileLoader::resetStatistics()
+{
+    d->m_hits = 0;
+    d->m_misses = 0;
+    d->m_contentions = 0;
+    d->m_loads = 0;
 }
 
 void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImage )
 {
     const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
+    StackedTileCacheShard &shard = d->shard( stackedTileId );
+    QWriteLocker locker( &shard.m_lock );
+
+    if ( shard.m_pendingTiles.contains( stackedTileId ) ) {
+        // the placeholder does not contain the texture tiles yet,
+        // so let the decode job pick up the new tile instead
+        shard.m_outdatedPendingTiles.insert( stackedTileId );
+        return;
+    }
 
-    StackedTile * displayedTile = d->m_tilesOnDisplay.take( stackedTileId );
+    StackedTile * displayedTile = shard.m_tilesOnDisplay.take( stackedTileId );
     if ( displayedTile ) {
-        Q_ASSERT( !d->m_tileCache.contains( stackedTileId ) );
 
         StackedTile *const stackedTile = d->m_layerDecorator->updateTile( *displayedTile, tileId, tileImage );
         stackedTile->setUsed( true );
-        d->m_tilesOnDisplay.insert( stackedTileId, stackedTile );
+        shard.m_tilesOnDisplay.insert( stackedTileId, stackedTile );
 
         delete displayedTile;
         displayedTile = 0;
 
+        locker.unlock();
         emit tileLoaded( stackedTileId );
     } else {
+        QMutexLocker cacheLocker( &d->m_tileCacheMutex );
         d->m_tileCache.remove( stackedTileId );
     }
 }
 
+void StackedTileLoader::updateShading()
+{
+    mDebug() << Q_FUNC_INFO;
+
+    // Cached tiles get shaded once they get displayed again. The outdated
+    // tiles are collected anew on each update, so that tiles evicted from
+    // the cache meanwhile get dropped.
+    QSet<TileId> cachedTiles[StackedTileLoaderPrivate::ShardCount];
+    d->m_tileCacheMutex.lock();
+    foreach ( const TileId &stackedTileId, d->m_tileCache.keys() ) {
+        cachedTiles[&d->shard( stackedTileId ) - d->m_shards].insert( stackedTileId );
+    }
+    d->m_tileCacheMutex.unlock();
+
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        StackedTileCacheShard &shard = d->m_shards[i];
+        QWriteLocker locker( &shard.m_lock );
+
+        QMutableHashIterator<TileId, StackedTile*> it( shard.m_tilesOnDisplay );
+        while ( it.hasNext() ) {
+            it.next();
+            if ( shard.m_pendingTiles.contains( it.key() ) ) {
+                // the placeholder gets replaced by the decoded tile, see below
+                continue;
+            }
+
+            it.setValue( d->updateShading( it.value() ) );
+            // it may have been displayed since the cache got looked at
+            cachedTiles[i].remove( it.key() );
+        }
+
+        // shade decoded tiles once they get displayed
+        shard.m_outdatedShadingTiles = cachedTiles[i];
+        shard.m_outdatedShadingTiles.unite( shard.m_pendingTiles );
+    }
+}
+
+void StackedTileLoader::setAsynchronousLoading( bool enabled )
+{
+    d->m_asynchronousLoading = enabled;
+}
+
+bool StackedTileLoader::asynchronousLoading() const
+{
+    return d->m_asynchronousLoading;
+}
+
 void StackedTileLoader::clear()
 {
     mDebug() << Q_FUNC_INFO;
 
-    qDeleteAll( d->m_tilesOnDisplay );
-    d->m_tilesOnDisplay.clear();
+    // discard the results of running decode jobs
+    d->m_decodedTilesMutex.lock();
+    ++d->m_generation;
+    qDeleteAll( d->m_decodedTiles );
+    d->m_decodedTiles.clear();
+    d->m_decodedTilesMutex.unlock();
+
+    // wait for running decode jobs, since they access the layer decorator
+    d->m_decodePool.waitForDone();
+
+    for ( int i = 0; i < StackedTileLoaderPrivate::ShardCount; ++i ) {
+        StackedTileCacheShard &shard = d->m_shards[i];
+        QWriteLocker locker( &shard.m_lock );
+
+        shard.m_pendingTiles.clear();
+        shard.m_outdatedPendingTiles.clear();
+        shard.m_outdatedShadingTiles.clear();
+
+        qDeleteAll( shard.m_tilesOnDisplay );
+        shard.m_tilesOnDisplay.clear();
+    }
+
+    d->m_tileCacheMutex.lock();
     d->m_tileCache.clear(); // clear the tile cache in physical memory
+    d->m_tileCacheMutex.unlock();
 
     emit cleared();
 }
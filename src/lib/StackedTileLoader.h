@@ -31,6 +31,7 @@
 #include "GeoSceneTextureTile.h"
 #include "TileId.h"
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 class QImage;
 class QString;
@@ -56,7 +57,7 @@ class StackedTileLoaderPrivate;
  * @author Torsten Rahn <rahn@kde.org>
  **/
 
-class StackedTileLoader : public QObject
+class MARBLE_EXPORT StackedTileLoader : public QObject
 {
     Q_OBJECT
 
@@ -121,6 +122,33 @@ class StackedTileLoader : public QObject
          */
         void setVolatileCacheLimit( quint64 kiloBytes );
 
+        /**
+         * @brief Returns the number of tiles found in the tile hash or the cache
+         *        since the last call of resetStatistics().
+         */
+        int cacheHits() const;
+
+        /**
+         * @brief Returns the number of tiles that had to be loaded
+         *        since the last call of resetStatistics().
+         */
+        int cacheMisses() const;
+
+        /**
+         * @brief Returns how often a thread had to wait for another thread
+         *        to access the tile cache since the last call of resetStatistics().
+         */
+        int lockContentions() const;
+
+        /**
+         * @brief Returns the number of tiles decoded from the tile images,
+         *        in the foreground or in the background, since the last call
+         *        of resetStatistics().
+         */
+        int tileLoads() const;
+
+        void resetStatistics();
+
         /**
          * Effectively triggers a reload of all tiles that are currently in use
          * and clears the tile cache in physical memory.
@@ -131,10 +159,38 @@ class StackedTileLoader : public QObject
          */
         void updateTile(TileId const & tileId, QImage const &tileImage );
 
+        /**
+         * @brief Updates the sun shading of all tiles.
+         *
+         * Other than clear(), this neither reloads the tiles from disk nor
+         * merges their texture layers again. Only the tiles whose shading
+         * actually changed get replaced. Displayed tiles are updated right
+         * away, cached tiles once they get displayed again.
+         */
+        void updateShading();
+
+        /**
+         * @brief Enables or disables asynchronous loading of tiles.
+         *
+         * In asynchronous mode, a tile that is neither displayed nor cached is
+         * not decoded by the calling thread. Instead, the best resident tile of
+         * a lower level gets scaled up and returned as a placeholder, while the
+         * tile is decoded in the background. Once the decoded tile replaces the
+         * placeholder, tileLoaded() is emitted.
+         *
+         * If no lower level tile is resident, the tile is loaded synchronously.
+         */
+        void setAsynchronousLoading( bool enabled );
+
+        bool asynchronousLoading() const;
+
     Q_SIGNALS:
         void tileLoaded( TileId const &tileId );
         void cleared();
 
+    private:
+        Q_PRIVATE_SLOT( d, void integrateDecodedTiles() )
+
     private:
         Q_DISABLE_COPY( StackedTileLoader )
 
@@ -13,6 +13,7 @@
 #define MARBLE_TEXTUREMAPPERINTERFACE_H
 
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 class QImage;
 class QRect;
@@ -27,7 +28,7 @@ class TextureColorizer;
 class ViewportParams;
 
 
-class TextureMapperInterface
+class MARBLE_EXPORT TextureMapperInterface
 {
 public:
     TextureMapperInterface();
@@ -35,7 +36,11 @@ public:
 
     virtual QRect rect( const ViewportParams *viewport ) const = 0;
 
-    virtual void mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality ) = 0;
+    /**
+     * Maps the texture onto @p canvasImage. Only the rows of the canvas
+     * which intersect @p dirtyRect get painted, all others are left untouched.
+     */
+    virtual void mapTexture( QImage *canvasImage, StackedTileLoader *tileLoader, const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, const QRect &dirtyRect ) = 0;
 };
 
 }
@@ -0,0 +1,924 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include "TileArchive.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QtAlgorithms>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <io.h>
+#elif defined(Q_OS_UNIX)
+#include <errno.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#endif
+
+#include "MarbleDebug.h"
+
+namespace Marble
+{
+
+// File layout, all numbers in big endian as written by QDataStream:
+//
+// archive: header record*
+// header:  quint32 archiveMagic, quint32 formatVersion
+// record:  quint32 recordMagic, QByteArray name, quint32 lastModified, QByteArray data
+//
+// A record with a null QByteArray as data marks the removal of a tile.
+//
+// index:   quint32 indexMagic, quint32 formatVersion, qint64 archiveEnd, quint32 count,
+//          count * ( quint64 nameHash, qint64 dataOffset, quint32 dataSize, quint32 lastModified )
+
+static const quint32 archiveMagic = 0x4d544152; // "MTAR"
+static const quint32 indexMagic = 0x4d544958;   // "MTIX"
+static const quint32 recordMagic = 0x54494c45;  // "TILE"
+static const quint32 formatVersion = 1;
+static const qint64 headerSize = 8;
+static const quint32 removedSize = 0xffffffff;  // size of a null QByteArray in QDataStream
+
+static quint64 nameHash( const QByteArray &name )
+{
+    // 64 bit FNV-1a
+    quint64 hash = Q_UINT64_C( 14695981039346656037 );
+    for ( int i = 0; i < name.size(); ++i ) {
+        hash ^= quint8( name.at( i ) );
+        hash *= Q_UINT64_C( 1099511628211 );
+    }
+
+    return hash;
+}
+
+// Returns the tile level a tile name starts with
+static int tileLevel( const QByteArray &name, bool *ok )
+{
+    return QString::fromUtf8( name ).section( '/', 0, 0 ).toInt( ok );
+}
+
+struct TileArchiveEntry
+{
+    qint64 offset;
+    quint32 size;
+    quint32 lastModified;
+};
+
+class TileArchivePrivate
+{
+ public:
+    explicit TileArchivePrivate( const QString &filePath );
+
+    QString indexFilePath() const;
+
+    bool openFile();
+    bool loadIndex();
+    bool saveIndex();
+    void scan( qint64 from );
+    bool readRecord( QDataStream &stream, QByteArray *name, quint32 *lastModified, quint32 *size );
+
+    bool lockFile( bool lock );
+    bool isReplaced() const;
+    void sync();
+
+    bool append( const QByteArray &name, const QByteArray &data, quint32 lastModified );
+    bool read( qint64 offset, char *data, qint64 size );
+    bool rewrite( const QSet<quint64> &dropped, int maximumTileLevel );
+    void unmap();
+
+    void setError( const QString &message );
+
+    QFile m_file;
+    // Other processes may use the same archive. Their modifications are
+    // serialized by a lock on this file, which, other than the archive file,
+    // doesn't get replaced by compact().
+    QFile m_lockFile;
+    uchar *m_map;
+    qint64 m_mapSize;
+    qint64 m_end;
+    QHash<quint64, TileArchiveEntry> m_index;
+    bool m_indexDirty;
+    QString m_errorMsg;
+    QMutex m_mutex;
+};
+
+// Holds the lock which serializes the modifications of an archive between processes
+class TileArchiveFileLocker
+{
+ public:
+    explicit TileArchiveFileLocker( TileArchivePrivate *archive )
+        : m_archive( archive ),
+          m_locked( archive->lockFile( true ) )
+    {
+    }
+
+    ~TileArchiveFileLocker()
+    {
+        if ( m_locked ) {
+            m_archive->lockFile( false );
+        }
+    }
+
+ private:
+    TileArchivePrivate *const m_archive;
+    const bool m_locked;
+};
+
+TileArchivePrivate::TileArchivePrivate( const QString &filePath )
+    : m_file( filePath ),
+      m_lockFile( filePath + ".lock" ),
+      m_map( 0 ),
+      m_mapSize( 0 ),
+      m_end( headerSize ),
+      m_indexDirty( false )
+{
+}
+
+QString TileArchivePrivate::indexFilePath() const
+{
+    return m_file.fileName() + ".index";
+}
+
+bool TileArchivePrivate::openFile()
+{
+    // archives installed into the system path are usually read-only
+    if ( !m_file.open( QIODevice::ReadWrite ) && !m_file.open( QIODevice::ReadOnly ) ) {
+        setError( QString( "%1: %2" ).arg( m_file.fileName() ).arg( m_file.errorString() ) );
+        return false;
+    }
+
+    QDataStream stream( &m_file );
+    if ( m_file.size() == 0 && m_file.isWritable() ) {
+        stream << archiveMagic << formatVersion;
+        m_file.flush();
+    } else {
+        quint32 magic = 0;
+        quint32 version = 0;
+        stream >> magic >> version;
+        if ( magic != archiveMagic || version != formatVersion ) {
+            setError( QString( "%1: not a tile archive of version %2" ).arg( m_file.fileName() ).arg( formatVersion ) );
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_index.clear();
+    m_end = headerSize;
+    m_indexDirty = false;
+
+    if ( loadIndex() ) {
+        // recover tiles stored after the index was saved
+        scan( m_end );
+    } else {
+        scan( headerSize );
+    }
+
+    return true;
+}
+
+bool TileArchivePrivate::loadIndex()
+{
+    QFile file( indexFilePath() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &file );
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 end = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> end >> count;
+
+    if ( stream.status() != QDataStream::Ok || magic != indexMagic || version != formatVersion
+         || end < headerSize || end > m_file.size() ) {
+        return false;
+    }
+
+    m_index.reserve( count );
+    for ( quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i ) {
+        quint64 hash;
+        TileArchiveEntry entry;
+        stream >> hash >> entry.offset >> entry.size >> entry.lastModified;
+        if ( entry.offset < headerSize || entry.offset + entry.size > end ) {
+            break;
+        }
+        m_index.insert( hash, entry );
+    }
+
+    if ( stream.status() != QDataStream::Ok || quint32( m_index.size() ) != count ) {
+        mDebug() << "Ignoring damaged tile archive index" << file.fileName();
+        m_index.clear();
+        return false;
+    }
+
+    m_end = end;
+    return true;
+}
+
+bool TileArchivePrivate::saveIndex()
+{
+    QFile file( indexFilePath() );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        setError( QString( "%1: %2" ).arg( file.fileName() ).arg( file.errorString() ) );
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream << indexMagic << formatVersion << m_end << quint32( m_index.size() );
+
+    QHash<quint64, TileArchiveEntry>::const_iterator it = m_index.constBegin();
+    QHash<quint64, TileArchiveEntry>::const_iterator const end = m_index.constEnd();
+    for (; it != end; ++it ) {
+        stream << it.key() << it.value().offset << it.value().size << it.value().lastModified;
+    }
+
+    file.close();
+    if ( file.error() != QFile::NoError ) {
+        setError( QString( "%1: %2" ).arg( file.fileName() ).arg( file.errorString() ) );
+        QFile::remove( file.fileName() );
+        return false;
+    }
+
+    m_indexDirty = false;
+    return true;
+}
+
+void TileArchivePrivate::scan( qint64 from )
+{
+    const qint64 fileSize = m_file.size();
+    qint64 position = from;
+
+    m_file.seek( position );
+    QDataStream stream( &m_file );
+
+    while ( position < fileSize ) {
+        QByteArray name;
+        quint32 lastModified = 0;
+        quint32 size = 0;
+        if ( !readRecord( stream, &name, &lastModified, &size ) ) {
+            break;
+        }
+
+        const qint64 offset = m_file.pos();
+        if ( size == removedSize ) {
+            m_index.remove( nameHash( name ) );
+            position = offset;
+            continue;
+        }
+
+        if ( offset + size > fileSize ) {
+            break;
+        }
+
+        TileArchiveEntry entry;
+        entry.offset = offset;
+        entry.size = size;
+        entry.lastModified = lastModified;
+        m_index.insert( nameHash( name ), entry );
+
+        position = offset + size;
+        if ( !m_file.seek( position ) ) {
+            break;
+        }
+    }
+
+    if ( position < fileSize ) {
+        // left behind by an interrupted write
+        mDebug() << "Discarding" << fileSize - position << "bytes at the end of" << m_file.fileName();
+        m_file.resize( position );
+    }
+
+    m_indexDirty = m_indexDirty || position != from;
+    m_end = position;
+}
+
+bool TileArchivePrivate::readRecord( QDataStream &stream, QByteArray *name, quint32 *lastModified, quint32 *size )
+{
+    quint32 magic = 0;
+    stream >> magic >> *name >> *lastModified >> *size;
+
+    return stream.status() == QDataStream::Ok && magic == recordMagic;
+}
+
+bool TileArchivePrivate::lockFile( bool lock )
+{
+    if ( !m_lockFile.isOpen() ) {
+        // read-only archives are never modified
+        return false;
+    }
+
+#if defined(Q_OS_WIN)
+    HANDLE const handle = (HANDLE) _get_osfhandle( m_lockFile.handle() );
+    OVERLAPPED overlapped;
+    memset( &overlapped, 0, sizeof( overlapped ) );
+    const BOOL result = lock ? LockFileEx( handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped )
+                             : UnlockFileEx( handle, 0, 1, 0, &overlapped );
+    return result != 0;
+#elif defined(Q_OS_UNIX)
+    int result = 0;
+    do {
+        result = flock( m_lockFile.handle(), lock ? LOCK_EX : LOCK_UN );
+    } while ( result != 0 && errno == EINTR );
+    return result == 0;
+#else
+    Q_UNUSED( lock );
+    return true;
+#endif
+}
+
+bool TileArchivePrivate::isReplaced() const
+{
+#if defined(Q_OS_UNIX)
+    struct stat openedFile;
+    struct stat namedFile;
+    if ( fstat( m_file.handle(), &openedFile ) != 0
+         || stat( QFile::encodeName( m_file.fileName() ).constData(), &namedFile ) != 0 ) {
+        return false;
+    }
+
+    return openedFile.st_dev != namedFile.st_dev || openedFile.st_ino != namedFile.st_ino;
+#else
+    // an open file can't be replaced on Windows
+    return false;
+#endif
+}
+
+void TileArchivePrivate::sync()
+{
+    if ( isReplaced() ) {
+        // another process compacted the archive
+        unmap();
+        m_file.close();
+        if ( !openFile() ) {
+            m_index.clear();
+        }
+        return;
+    }
+
+    const qint64 fileSize = m_file.size();
+    if ( fileSize < m_end ) {
+        // another process cleared the archive
+        unmap();
+        m_index.clear();
+        m_indexDirty = true;
+        scan( headerSize );
+    } else if ( fileSize > m_end ) {
+        // another process appended tiles
+        scan( m_end );
+    }
+}
+
+bool TileArchivePrivate::append( const QByteArray &name, const QByteArray &data, quint32 lastModified )
+{
+    if ( !m_file.isOpen() || !m_file.isWritable() ) {
+        setError( QString( "%1: archive is not writable" ).arg( m_file.fileName() ) );
+        return false;
+    }
+
+    if ( !m_file.seek( m_end ) ) {
+        setError( QString( "%1: %2" ).arg( m_file.fileName() ).arg( m_file.errorString() ) );
+        return false;
+    }
+
+    QDataStream stream( &m_file );
+    stream << recordMagic << name << lastModified << data;
+    m_file.flush();
+
+    if ( m_file.error() != QFile::NoError ) {
+        setError( QString( "%1: %2" ).arg( m_file.fileName() ).arg( m_file.errorString() ) );
+        m_file.unsetError();
+        m_file.resize( m_end );
+        return false;
+    }
+
+    const qint64 end = m_file.pos();
+    if ( data.isNull() ) {
+        m_index.remove( nameHash( name ) );
+    } else {
+        TileArchiveEntry entry;
+        entry.offset = end - data.size();
+        entry.size = data.size();
+        entry.lastModified = lastModified;
+        m_index.insert( nameHash( name ), entry );
+    }
+
+    m_end = end;
+    m_indexDirty = true;
+
+    return true;
+}
+
+bool TileArchivePrivate::read( qint64 offset, char *data, qint64 size )
+{
+    if ( offset + size > m_mapSize && m_end > m_mapSize ) {
+        // the archive has grown since it was mapped
+        unmap();
+        m_map = m_file.map( 0, m_end );
+        m_mapSize = m_map ? m_end : 0;
+    }
+
+    if ( offset + size <= m_mapSize ) {
+        qMemCopy( data, m_map + offset, size );
+        return true;
+    }
+
+    // mapping fails e.g. for huge archives on 32 bit systems
+    return m_file.seek( offset ) && m_file.read( data, size ) == size;
+}
+
+void TileArchivePrivate::unmap()
+{
+    if ( m_map ) {
+        m_file.unmap( m_map );
+        m_map = 0;
+        m_mapSize = 0;
+    }
+}
+
+void TileArchivePrivate::setError( const QString &message )
+{
+    m_errorMsg = message;
+    mDebug() << message;
+}
+
+TileArchive::TileArchive( const QString &filePath )
+    : d( new TileArchivePrivate( filePath ) )
+{
+}
+
+TileArchive::~TileArchive()
+{
+    if ( d->m_file.isOpen() && d->m_file.isWritable() && d->m_indexDirty ) {
+        TileArchiveFileLocker fileLocker( d );
+        d->sync();
+        d->saveIndex();
+    }
+
+    d->unmap();
+    d->m_file.close();
+    d->m_lockFile.close();
+
+    delete d;
+}
+
+bool TileArchive::open()
+{
+    QMutexLocker locker( &d->m_mutex );
+
+    if ( d->m_file.isOpen() ) {
+        return true;
+    }
+
+    const QString directory = QFileInfo( d->m_file.fileName() ).absolutePath();
+    if ( !QDir( directory ).exists() ) {
+        QDir::root().mkpath( directory );
+    }
+
+    if ( !d->m_lockFile.open( QIODevice::ReadWrite ) ) {
+        mDebug() << "Opening tile archive" << d->m_file.fileName() << "read-only";
+    }
+
+    TileArchiveFileLocker fileLocker( d );
+    if ( !d->openFile() ) {
+        return false;
+    }
+
+    mDebug() << "Opened tile archive" << d->m_file.fileName() << "with" << d->m_index.size() << "tiles";
+
+    return true;
+}
+
+bool TileArchive::isOpen() const
+{
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_file.isOpen();
+}
+
+QString TileArchive::filePath() const
+{
+    return d->m_file.fileName();
+}
+
+int TileArchive::count() const
+{
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_index.size();
+}
+
+qint64 TileArchive::size() const
+{
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_file.isOpen() ? d->m_end : 0;
+}
+
+bool TileArchive::contains( const QString &name ) const
+{
+    const quint64 hash = nameHash( name.toUtf8() );
+
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_index.contains( hash );
+}
+
+QDateTime TileArchive::lastModified( const QString &name ) const
+{
+    const quint64 hash = nameHash( name.toUtf8() );
+
+    QMutexLocker locker( &d->m_mutex );
+    QHash<quint64, TileArchiveEntry>::const_iterator const it = d->m_index.constFind( hash );
+    if ( it == d->m_index.constEnd() ) {
+        return QDateTime();
+    }
+
+    return QDateTime::fromTime_t( it.value().lastModified );
+}
+
+QByteArray TileArchive::data( const QString &name ) const
+{
+    const QByteArray key = name.toUtf8();
+    const quint64 hash = nameHash( key );
+
+    // the name as it precedes the lastModified and size fields of the record
+    QByteArray expectedName;
+    QDataStream stream( &expectedName, QIODevice::WriteOnly );
+    stream << key;
+
+    QMutexLocker locker( &d->m_mutex );
+
+    QHash<quint64, TileArchiveEntry>::const_iterator const it = d->m_index.constFind( hash );
+    if ( it == d->m_index.constEnd() ) {
+        return QByteArray();
+    }
+
+    const TileArchiveEntry entry = it.value();
+    const qint64 nameOffset = entry.offset - qint64( 2 * sizeof( quint32 ) ) - expectedName.size();
+
+    QByteArray storedName;
+    storedName.resize( expectedName.size() );
+    if ( nameOffset < headerSize || !d->read( nameOffset, storedName.data(), storedName.size() )
+         || storedName != expectedName ) {
+        // hash collision
+        return QByteArray();
+    }
+
+    QByteArray result;
+    result.resize( entry.size );
+    if ( !d->read( entry.offset, result.data(), entry.size ) ) {
+        d->setError( QString( "%1: %2" ).arg( d->m_file.fileName() ).arg( d->m_file.errorString() ) );
+        return QByteArray();
+    }
+
+    return result;
+}
+
+bool TileArchive::insert( const QString &name, const QByteArray &data )
+{
+    // a null QByteArray would mark the tile as removed
+    const QByteArray nonNullData = data.isNull() ? QByteArray( "" ) : data;
+
+    QMutexLocker locker( &d->m_mutex );
+    TileArchiveFileLocker fileLocker( d );
+    d->sync();
+    return d->append( name.toUtf8(), nonNullData, QDateTime::currentDateTime().toTime_t() );
+}
+
+bool TileArchive::remove( const QString &name )
+{
+    const QByteArray key = name.toUtf8();
+
+    QMutexLocker locker( &d->m_mutex );
+    TileArchiveFileLocker fileLocker( d );
+    d->sync();
+    if ( !d->m_index.contains( nameHash( key ) ) ) {
+        return false;
+    }
+
+    return d->append( key, QByteArray(), QDateTime::currentDateTime().toTime_t() );
+}
+
+void TileArchive::clear()
+{
+    QMutexLocker locker( &d->m_mutex );
+
+    if ( !d->m_file.isOpen() || !d->m_file.isWritable() ) {
+        return;
+    }
+
+    TileArchiveFileLocker fileLocker( d );
+    d->unmap();
+    QFile::remove( d->indexFilePath() );
+    d->m_file.resize( headerSize );
+    d->m_index.clear();
+    d->m_end = headerSize;
+    d->m_indexDirty = false;
+}
+
+bool TileArchivePrivate::rewrite( const QSet<quint64> &dropped, int maximumTileLevel )
+{
+    const QString fileName = m_file.fileName();
+    QFile compacted( fileName + ".compact" );
+    if ( !compacted.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        setError( QString( "%1: %2" ).arg( compacted.fileName() ).arg( compacted.errorString() ) );
+        return false;
+    }
+
+    QDataStream out( &compacted );
+    out << archiveMagic << formatVersion;
+
+    QHash<quint64, TileArchiveEntry> index;
+    index.reserve( m_index.size() );
+
+    m_file.seek( headerSize );
+    QDataStream in( &m_file );
+    qint64 position = headerSize;
+
+    while ( position < m_end ) {
+        QByteArray name;
+        quint32 lastModified = 0;
+        quint32 size = 0;
+        if ( !readRecord( in, &name, &lastModified, &size ) ) {
+            break;
+        }
+
+        const qint64 offset = m_file.pos();
+        if ( size == removedSize ) {
+            position = offset;
+            continue;
+        }
+        position = offset + size;
+
+        // only the latest version of each tile is in the index
+        const quint64 hash = nameHash( name );
+        QHash<quint64, TileArchiveEntry>::const_iterator const it = m_index.constFind( hash );
+        bool keep = it != m_index.constEnd() && it.value().offset == offset && !dropped.contains( hash );
+
+        if ( keep && maximumTileLevel >= 0 ) {
+            bool ok = false;
+            const int level = tileLevel( name, &ok );
+            keep = !ok || level <= maximumTileLevel;
+        }
+
+        if ( keep ) {
+            const QByteArray data = m_file.read( size );
+            out << recordMagic << name << lastModified << data;
+
+            TileArchiveEntry entry;
+            entry.offset = compacted.pos() - size;
+            entry.size = size;
+            entry.lastModified = lastModified;
+            index.insert( hash, entry );
+        }
+
+        if ( !m_file.seek( position ) ) {
+            break;
+        }
+    }
+
+    compacted.close();
+    if ( position < m_end || compacted.error() != QFile::NoError ) {
+        setError( QString( "%1: compacting failed" ).arg( fileName ) );
+        QFile::remove( compacted.fileName() );
+        return false;
+    }
+
+    unmap();
+    m_file.close();
+
+    // never leave an index behind which doesn't match the archive
+    QFile::remove( indexFilePath() );
+
+    const bool replaced = QFile::remove( fileName ) && compacted.rename( fileName );
+    if ( !replaced ) {
+        setError( QString( "%1: %2" ).arg( fileName ).arg( compacted.errorString() ) );
+    }
+
+    if ( !m_file.open( QIODevice::ReadWrite ) ) {
+        setError( QString( "%1: %2" ).arg( fileName ).arg( m_file.errorString() ) );
+        m_index.clear();
+        return false;
+    }
+
+    if ( !replaced ) {
+        // continue with the old archive
+        m_index.clear();
+        m_indexDirty = false;
+        scan( headerSize );
+        return false;
+    }
+
+    m_index = index;
+    m_end = m_file.size();
+    saveIndex();
+
+    return true;
+}
+
+bool TileArchive::compact( int maximumTileLevel )
+{
+    QMutexLocker locker( &d->m_mutex );
+
+    if ( !d->m_file.isOpen() || !d->m_file.isWritable() ) {
+        return false;
+    }
+
+    TileArchiveFileLocker fileLocker( d );
+    d->sync();
+    return d->rewrite( QSet<quint64>(), maximumTileLevel );
+}
+
+bool TileArchive::shrink( qint64 maximumSize, int baseTileLevel, const QDateTime &youngest )
+{
+    QMutexLocker locker( &d->m_mutex );
+
+    if ( !d->m_file.isOpen() || !d->m_file.isWritable() ) {
+        return false;
+    }
+
+    TileArchiveFileLocker fileLocker( d );
+    d->sync();
+
+    if ( d->m_end <= maximumSize ) {
+        return true;
+    }
+
+    // The tile levels are only known from the names stored in the records,
+    // so walk all records to find the tiles which may be removed.
+    QList<QPair<quint32, quint64> > candidates; // (lastModified, name hash)
+    QHash<quint64, qint64> recordSizes;
+    qint64 liveSize = headerSize;
+    const quint32 youngestTime = youngest.isValid() ? youngest.toTime_t() : 0xffffffff;
+
+    d->m_file.seek( headerSize );
+    QDataStream in( &d->m_file );
+    qint64 position = headerSize;
+
+    while ( position < d->m_end ) {
+        QByteArray name;
+        quint32 lastModified = 0;
+        quint32 size = 0;
+        if ( !d->readRecord( in, &name, &lastModified, &size ) ) {
+            break;
+        }
+
+        const qint64 offset = d->m_file.pos();
+        const qint64 recordStart = position;
+        position = size == removedSize ? offset : offset + size;
+
+        const quint64 hash = nameHash( name );
+        QHash<quint64, TileArchiveEntry>::const_iterator const it = d->m_index.constFind( hash );
+        if ( size != removedSize && it != d->m_index.constEnd() && it.value().offset == offset ) {
+            liveSize += position - recordStart;
+
+            bool ok = false;
+            const int level = tileLevel( name, &ok );
+            if ( ok && level > baseTileLevel && lastModified <= youngestTime ) {
+                candidates.append( qMakePair( lastModified, hash ) );
+                recordSizes.insert( hash, position - recordStart );
+            }
+        }
+
+        if ( !d->m_file.seek( position ) ) {
+            break;
+        }
+    }
+
+    // remove the oldest tiles first
+    qSort( candidates );
+
+    QSet<quint64> dropped;
+    for ( int i = 0; i < candidates.size() && liveSize > maximumSize; ++i ) {
+        dropped.insert( candidates.at( i ).second );
+        liveSize -= recordSizes.value( candidates.at( i ).second );
+    }
+
+    return d->rewrite( dropped, -1 ) && d->m_end <= maximumSize;
+}
+
+bool TileArchive::flush()
+{
+    QMutexLocker locker( &d->m_mutex );
+
+    if ( !d->m_file.isOpen() || !d->m_file.isWritable() ) {
+        return false;
+    }
+
+    TileArchiveFileLocker fileLocker( d );
+    d->sync();
+    return !d->m_indexDirty || d->saveIndex();
+}
+
+QString TileArchive::lastErrorMessage() const
+{
+    QMutexLocker locker( &d->m_mutex );
+    return d->m_errorMsg;
+}
+
+QString TileArchive::fileName()
+{
+    return QString( "tiles.marbletiles" );
+}
+
+class TileArchiveRegistry
+{
+ public:
+    ~TileArchiveRegistry()
+    {
+        qDeleteAll( m_archives );
+    }
+
+    QMutex m_mutex;
+    QHash<QString, TileArchive *> m_archives;
+    QSet<QString> m_missing;
+};
+
+Q_GLOBAL_STATIC( TileArchiveRegistry, tileArchiveRegistry )
+
+TileArchive *TileArchive::archive( const QString &directory )
+{
+    const QString path = QDir::cleanPath( directory );
+    TileArchiveRegistry *const registry = tileArchiveRegistry();
+
+    QMutexLocker locker( &registry->m_mutex );
+
+    TileArchive *archive = registry->m_archives.value( path, 0 );
+    if ( archive || registry->m_missing.contains( path ) ) {
+        return archive;
+    }
+
+    const QString filePath = path + '/' + fileName();
+    if ( QFile::exists( filePath ) ) {
+        archive = new TileArchive( filePath );
+        if ( archive->open() ) {
+            registry->m_archives.insert( path, archive );
+            return archive;
+        }
+        delete archive;
+    }
+
+    registry->m_missing.insert( path );
+    return 0;
+}
+
+TileArchive *TileArchive::create( const QString &directory )
+{
+    const QString path = QDir::cleanPath( directory );
+    TileArchiveRegistry *const registry = tileArchiveRegistry();
+
+    QMutexLocker locker( &registry->m_mutex );
+
+    TileArchive *archive = registry->m_archives.value( path, 0 );
+    if ( archive ) {
+        return archive;
+    }
+
+    archive = new TileArchive( path + '/' + fileName() );
+    if ( !archive->open() ) {
+        delete archive;
+        return 0;
+    }
+
+    registry->m_missing.remove( path );
+    registry->m_archives.insert( path, archive );
+    return archive;
+}
+
+TileArchive *TileArchive::archiveForFile( const QString &filePath, QString *name )
+{
+    const QString path = QDir::cleanPath( filePath );
+    TileArchiveRegistry *const registry = tileArchiveRegistry();
+
+    QMutexLocker locker( &registry->m_mutex );
+
+    if ( registry->m_archives.isEmpty() ) {
+        return 0;
+    }
+
+    for ( int slash = path.lastIndexOf( '/' ); slash > 0; slash = path.lastIndexOf( '/', slash - 1 ) ) {
+        TileArchive *const archive = registry->m_archives.value( path.left( slash ), 0 );
+        if ( archive ) {
+            if ( name ) {
+                *name = path.mid( slash + 1 );
+            }
+            return archive;
+        }
+    }
+
+    return 0;
+}
+
+}
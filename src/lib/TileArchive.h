@@ -0,0 +1,171 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#ifndef MARBLE_TILEARCHIVE_H
+#define MARBLE_TILEARCHIVE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class TileArchivePrivate;
+
+/**
+ * @short A single file container for the tiles of a map theme.
+ *
+ * Instead of storing every tile in a file of its own, the tiles of a map theme
+ * can be packed into one archive file named fileName() in the theme directory.
+ * This avoids the inode pressure and the directory walks which come with
+ * millions of small files.
+ *
+ * Tiles are addressed by their file name relative to the theme directory, as
+ * returned by GeoSceneTiled::relativeTileFileName() without the theme prefix.
+ * New tiles are appended to the archive. Replaced or removed tiles leave unused
+ * space behind, which is reclaimed by compact().
+ *
+ * The in-memory index only holds a 64 bit hash of each name, so that
+ * contains() and lastModified() may in theory report a colliding name. data()
+ * always verifies the name stored in the archive.
+ *
+ * The index is saved next to the archive by flush() and when the archive gets
+ * destroyed. Tiles appended after the last flush() are recovered by scanning
+ * the end of the archive when it is opened again.
+ *
+ * All methods are thread-safe. Several processes may use the same archive, as
+ * long as it is writable: their modifications are serialized by a lock on the
+ * file fileName() + ".lock", and each process picks up the tiles the others
+ * stored before it modifies the archive itself.
+ */
+class MARBLE_EXPORT TileArchive
+{
+ public:
+    /**
+     * Creates an archive object for the archive file at @p filePath.
+     * The file is neither opened nor created before open() is called.
+     */
+    explicit TileArchive( const QString &filePath );
+
+    /**
+     * Saves the index and closes the archive.
+     */
+    ~TileArchive();
+
+    /**
+     * Opens the archive file, creating it if it does not exist yet.
+     * Returns false on failure, see lastErrorMessage().
+     */
+    bool open();
+
+    bool isOpen() const;
+
+    QString filePath() const;
+
+    /**
+     * Returns the number of tiles in the archive.
+     */
+    int count() const;
+
+    /**
+     * Returns the size of the archive file in bytes.
+     */
+    qint64 size() const;
+
+    bool contains( const QString &name ) const;
+
+    /**
+     * Returns the time at which tile @p name was stored, or an invalid
+     * QDateTime if the archive does not contain the tile.
+     */
+    QDateTime lastModified( const QString &name ) const;
+
+    /**
+     * Returns the data of tile @p name, or a null QByteArray if the archive
+     * does not contain the tile.
+     */
+    QByteArray data( const QString &name ) const;
+
+    /**
+     * Stores @p data as tile @p name, replacing any previous version.
+     * Returns true if the data was written successfully.
+     */
+    bool insert( const QString &name, const QByteArray &data );
+
+    /**
+     * Removes tile @p name from the archive.
+     */
+    bool remove( const QString &name );
+
+    /**
+     * Removes all tiles from the archive.
+     */
+    void clear();
+
+    /**
+     * Rewrites the archive without the space of replaced or removed tiles.
+     * If @p maximumTileLevel is not negative, tiles whose name starts with a
+     * tile level above @p maximumTileLevel are dropped as well.
+     */
+    bool compact( int maximumTileLevel = -1 );
+
+    /**
+     * Removes the tiles with a tile level above @p baseTileLevel, least
+     * recently stored first, until the archive takes at most @p maximumSize
+     * bytes, and compacts it. Tiles stored after @p youngest are kept.
+     * Returns true if the archive fits into @p maximumSize afterwards.
+     */
+    bool shrink( qint64 maximumSize, int baseTileLevel, const QDateTime &youngest = QDateTime() );
+
+    /**
+     * Saves the index next to the archive to speed up the next open().
+     */
+    bool flush();
+
+    QString lastErrorMessage() const;
+
+    /**
+     * The name of the archive file inside a theme directory.
+     */
+    static QString fileName();
+
+    /**
+     * Returns the shared archive of the theme directory @p directory if it
+     * contains an archive file, otherwise 0. The result is cached, so this is
+     * cheap to call for each tile.
+     */
+    static TileArchive *archive( const QString &directory );
+
+    /**
+     * Returns the shared archive of the theme directory @p directory, creating
+     * the archive file if needed. Returns 0 if the archive cannot be created.
+     */
+    static TileArchive *create( const QString &directory );
+
+    /**
+     * Returns the shared archive which a file at @p filePath should be stored
+     * in instead, or 0 if there is none. Only archives which were already
+     * returned by archive() or create() are considered. On success @p name
+     * is set to the name of the tile within the archive.
+     */
+    static TileArchive *archiveForFile( const QString &filePath, QString *name );
+
+ private:
+    Q_DISABLE_COPY( TileArchive )
+
+    TileArchivePrivate *const d;
+};
+
+}
+
+#endif
@@ -14,9 +14,13 @@
 
 #include <cmath>
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QDir>
 #include <QtCore/QRect>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
 #include <QtCore/QSize>
+#include <QtCore/QThreadPool>
 #include <QtCore/QVector>
 #include <QtGui/QApplication>
 #include <QtGui/QImage>
@@ -26,6 +30,7 @@
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
 #include "MarbleDebug.h"
+#include "TileArchive.h"
 #include "TileLoaderHelper.h"
 
 namespace Marble
@@ -42,20 +47,57 @@ class TileCreatorPrivate
          m_tileFormat( "jpg" ),
          m_resume( false ),
          m_verify( false ),
-         m_source( source )
+         m_pack( false ),
+         m_source( source ),
+         m_createdTilesCount( 0 ),
+         m_failed( 0 )
      {
         if ( m_dem == "true" ) {
             m_tileQuality = 70;
         } else {
             m_tileQuality = 85;
         }
+
+        for ( int cnt = 0; cnt <= 255; ++cnt ) {
+            m_grayScalePalette.insert( cnt, qRgb( cnt, cnt, cnt ) );
+        }
+
+        m_threadPool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() ) );
+
+        // Limit the amount of tiles that are queued or in flight at the same time
+        // so that the memory consumption stays bounded for huge source images.
+        m_maxPendingJobs = 2 * m_threadPool.maxThreadCount();
+        m_pendingJobs.release( m_maxPendingJobs );
     }
 
     ~TileCreatorPrivate()
     {
+        m_threadPool.waitForDone();
         delete m_source;
     }
 
+    QString tileName( int tileLevel, int n, int m ) const
+    {
+        return m_targetDir + ( QString("%1/%2/%2_%3.%4")
+                               .arg( tileLevel )
+                               .arg( n, tileDigits, 10, QChar('0') )
+                               .arg( m, tileDigits, 10, QChar('0') ) )
+                               .arg( m_tileFormat );
+    }
+
+    // Queues a job on the thread pool, blocks while too many jobs are pending.
+    void startJob( QRunnable *job );
+
+    // Returns true once all queued jobs are finished, waits at most msecs.
+    bool waitForJobs( int msecs );
+
+    void finishJob();
+
+    void saveTile( QImage tile, const QString &tileName );
+    void mergeTile( int tileLevel, int n, int m );
+    void recompressTile( const QString &tileName );
+    void packTiles( int maxTileLevel );
+
  public:
     QString  m_dem;
     QString  m_targetDir;
@@ -64,10 +106,303 @@ class TileCreatorPrivate
     int      m_tileQuality;
     bool     m_resume;
     bool     m_verify;
+    bool     m_pack;
 
     TileCreatorSource  *m_source;
+
+    QVector<QRgb> m_grayScalePalette;
+
+    QThreadPool m_threadPool;
+    QSemaphore  m_pendingJobs;
+    int         m_maxPendingJobs;
+    QAtomicInt  m_createdTilesCount;
+    QAtomicInt  m_failed;
 };
 
+class TileCreatorSaveJob : public QRunnable
+{
+public:
+    TileCreatorSaveJob( TileCreatorPrivate *creator, const QImage &tile, const QString &tileName )
+        : m_creator( creator ),
+          m_tile( tile ),
+          m_tileName( tileName )
+    {
+    }
+
+    virtual void run()
+    {
+        m_creator->saveTile( m_tile, m_tileName );
+        m_creator->finishJob();
+    }
+
+private:
+    TileCreatorPrivate *const m_creator;
+    const QImage m_tile;
+    const QString m_tileName;
+};
+
+class TileCreatorMergeJob : public QRunnable
+{
+public:
+    TileCreatorMergeJob( TileCreatorPrivate *creator, int tileLevel, int n, int m )
+        : m_creator( creator ),
+          m_tileLevel( tileLevel ),
+          m_n( n ),
+          m_m( m )
+    {
+    }
+
+    virtual void run()
+    {
+        m_creator->mergeTile( m_tileLevel, m_n, m_m );
+        m_creator->finishJob();
+    }
+
+private:
+    TileCreatorPrivate *const m_creator;
+    const int m_tileLevel;
+    const int m_n;
+    const int m_m;
+};
+
+class TileCreatorRecompressJob : public QRunnable
+{
+public:
+    TileCreatorRecompressJob( TileCreatorPrivate *creator, const QString &tileName )
+        : m_creator( creator ),
+          m_tileName( tileName )
+    {
+    }
+
+    virtual void run()
+    {
+        m_creator->recompressTile( m_tileName );
+        m_creator->finishJob();
+    }
+
+private:
+    TileCreatorPrivate *const m_creator;
+    const QString m_tileName;
+};
+
+void TileCreatorPrivate::startJob( QRunnable *job )
+{
+    m_pendingJobs.acquire();
+    m_threadPool.start( job );
+}
+
+void TileCreatorPrivate::finishJob()
+{
+    m_createdTilesCount.fetchAndAddRelaxed( 1 );
+    m_pendingJobs.release();
+}
+
+bool TileCreatorPrivate::waitForJobs( int msecs )
+{
+    if ( !m_pendingJobs.tryAcquire( m_maxPendingJobs, msecs ) ) {
+        return false;
+    }
+    m_pendingJobs.release( m_maxPendingJobs );
+    return true;
+}
+
+void TileCreatorPrivate::saveTile( QImage tile, const QString &tileName )
+{
+    if ( m_cancelled )
+        return;
+
+    if ( m_dem == "true" ) {
+        tile = tile.convertToFormat(QImage::Format_Indexed8,
+                                    m_grayScalePalette,
+                                    Qt::ThresholdDither);
+    }
+
+    bool  ok = tile.save( tileName, m_tileFormat.toAscii().data(), m_tileFormat == "jpg" ? 100 : m_tileQuality );
+    if ( !ok )
+        mDebug() << "Error while writing Tile: " << tileName;
+
+    mDebug() << tileName << "size" << QFile( tileName ).size();
+
+    if ( m_verify ) {
+        QImage writtenTile(tileName);
+        Q_ASSERT( writtenTile.size() == tile.size() );
+        for ( int i=0; i < writtenTile.size().width(); ++i) {
+            for ( int j=0; j < writtenTile.size().height(); ++j) {
+                if ( writtenTile.pixel( i, j ) != tile.pixel( i, j ) ) {
+                    unsigned int  pixel = tile.pixel( i, j);
+                    unsigned int  writtenPixel = writtenTile.pixel( i, j);
+                    qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
+                    QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
+                    qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
+                    QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
+                    qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
+                    Q_ASSERT(false);
+                }
+            }
+        }
+    }
+}
+
+void TileCreatorPrivate::mergeTile( int tileLevel, int n, int m )
+{
+    if ( m_cancelled || m_failed )
+        return;
+
+    QString newTileName = tileName( tileLevel, n, m );
+
+    if ( QFile::exists( newTileName ) && m_resume ) {
+        //mDebug() << newTileName << "exists already";
+        return;
+    }
+
+    QImage  img_topleft( tileName( tileLevel + 1, 2*n, 2*m ) );
+    QImage  img_topright( tileName( tileLevel + 1, 2*n, 2*m+1 ) );
+    QImage  img_bottomleft( tileName( tileLevel + 1, 2*n+1, 2*m ) );
+    QImage  img_bottomright( tileName( tileLevel + 1, 2*n+1, 2*m+1 ) );
+
+    QSize const expectedSize( c_defaultTileSize, c_defaultTileSize );
+    if ( img_topleft.size() != expectedSize ||
+         img_topright.size() != expectedSize ||
+         img_bottomleft.size() != expectedSize ||
+         img_bottomright.size() != expectedSize ) {
+        mDebug() << "Tile write failure. Missing write permissions?";
+        m_failed = 1;
+        return;
+    }
+    QImage  tile = img_topleft;
+
+    if ( m_dem == "true" ) {
+
+        tile.setColorTable( m_grayScalePalette );
+        uchar* destLine;
+
+        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
+            destLine = tile.scanLine( y );
+            const uchar* srcLine = img_topleft.scanLine( 2 * y );
+            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
+                destLine[x] = srcLine[ 2*x ];
+        }
+        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
+            destLine = tile.scanLine( y );
+            const uchar* srcLine = img_topright.scanLine( 2 * y );
+            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
+                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
+        }
+        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
+            destLine = tile.scanLine( y );
+            const uchar* srcLine = img_bottomleft.scanLine( 2 * ( y - c_defaultTileSize / 2 ) );
+            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
+                destLine[ x ] = srcLine[ 2 * x ];
+        }
+        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
+            destLine = tile.scanLine( y );
+            const uchar* srcLine = img_bottomright.scanLine( 2 * ( y - c_defaultTileSize/2 ) );
+            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
+                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
+        }
+    }
+    else {
+
+        // tile.depth() != 8
+
+        img_topleft = img_topleft.convertToFormat( QImage::Format_ARGB32 );
+        img_topright = img_topright.convertToFormat( QImage::Format_ARGB32 );
+        img_bottomleft = img_bottomleft.convertToFormat( QImage::Format_ARGB32 );
+        img_bottomright = img_bottomright.convertToFormat( QImage::Format_ARGB32 );
+        tile = img_topleft;
+
+        QRgb* destLine;
+
+        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
+            destLine = (QRgb*) tile.scanLine( y );
+            const QRgb* srcLine = (QRgb*) img_topleft.scanLine( 2 * y );
+            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
+                destLine[x] = srcLine[ 2 * x ];
+        }
+        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
+            destLine = (QRgb*) tile.scanLine( y );
+            const QRgb* srcLine = (QRgb*) img_topright.scanLine( 2 * y );
+            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
+                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
+        }
+        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
+            destLine = (QRgb*) tile.scanLine( y );
+            const QRgb* srcLine = (QRgb*) img_bottomleft.scanLine( 2 * ( y-c_defaultTileSize/2 ) );
+            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
+                destLine[x] = srcLine[ 2 * x ];
+        }
+        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
+            destLine = (QRgb*) tile.scanLine( y );
+            const QRgb* srcLine = (QRgb*) img_bottomright.scanLine( 2 * ( y-c_defaultTileSize / 2 ) );
+            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
+                destLine[x] = srcLine[ 2*( x-c_defaultTileSize / 2 ) ];
+        }
+    }
+
+    mDebug() << newTileName;
+
+    // Saving at 100% JPEG quality to have a high-quality
+    // version to create the remaining needed tiles from.
+    bool  ok = tile.save( newTileName, m_tileFormat.toAscii().data(), m_tileFormat == "jpg" ? 100 : m_tileQuality );
+    if ( ! ok )
+        mDebug() << "Error while writing Tile: " << newTileName;
+}
+
+void TileCreatorPrivate::recompressTile( const QString &tileName )
+{
+    if ( m_cancelled )
+        return;
+
+    QImage tile( tileName );
+
+    bool ok;
+
+    ok = tile.save( tileName, m_tileFormat.toAscii().data(), m_tileQuality );
+
+    if ( !ok )
+        mDebug() << "Error while writing Tile: " << tileName;
+}
+
+void TileCreatorPrivate::packTiles( int maxTileLevel )
+{
+    TileArchive *const archive = TileArchive::create( m_targetDir );
+    if ( !archive ) {
+        mDebug() << "Error while creating tile archive in" << m_targetDir;
+        return;
+    }
+
+    for ( int tileLevel = 0; tileLevel <= maxTileLevel; ++tileLevel ) {
+        const int nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
+        const int mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
+
+        for ( int n = 0; n < nmax; ++n ) {
+            for ( int m = 0; m < mmax; ++m ) {
+                if ( m_cancelled )
+                    return;
+
+                const QString fileName = tileName( tileLevel, n, m );
+                QFile file( fileName );
+                if ( !file.open( QIODevice::ReadOnly ) ) {
+                    mDebug() << "Error while reading Tile: " << fileName;
+                    continue;
+                }
+
+                if ( archive->insert( fileName.mid( m_targetDir.length() ), file.readAll() ) ) {
+                    file.remove();
+                } else {
+                    mDebug() << "Error while packing Tile: " << archive->lastErrorMessage();
+                }
+            }
+
+            QDir( m_targetDir ).rmdir( QString( "%1/%2" ).arg( tileLevel ).arg( n, tileDigits, 10, QChar('0') ) );
+        }
+
+        QDir( m_targetDir ).rmdir( QString( "%1" ).arg( tileLevel ) );
+    }
+
+    archive->flush();
+}
+
 class TileCreatorSourceImage : public TileCreatorSource
 {
 public:
@@ -222,11 +557,6 @@ void TileCreator::run()
 
     mDebug() << "Installing tiles to: " << d->m_targetDir;
 
-    QVector<QRgb> grayScalePalette;
-    for ( int cnt = 0; cnt <= 255; ++cnt ) {
-        grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
-    }
-
     QSize fullImageSize = d->m_source->fullImageSize();
     int  imageWidth  = fullImageSize.width();
     int  imageHeight = fullImageSize.height();
@@ -275,10 +605,13 @@ void TileCreator::run()
     int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
     int  nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel );
 
-    // Loading each row at highest spatial resolution and cropping tiles
-    int      percentCompleted = 0;
-    int      createdTilesCount = 0;
-    QString  tileName;
+    // The tiles are cut from the source in this thread, as the source
+    // caches the current row and isn't thread-safe. Converting, encoding
+    // and writing the tiles as well as building the lower levels happens
+    // on the thread pool. Each level only depends on the next higher one,
+    // so the pool gets drained before a level is started.
+    d->m_createdTilesCount = 0;
+    d->m_failed = 0;
 
     // Creating directory structure for the highest level
     QString  dirName( d->m_targetDir
@@ -299,18 +632,17 @@ void TileCreator::run()
 
             mDebug() << "** tile" << m << "x" << n;
 
-            if ( d->m_cancelled ) 
+            if ( d->m_cancelled ) {
+                d->m_threadPool.waitForDone();
                 return;
+            }
 
-            tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                       .arg( maxTileLevel )
-                                       .arg( n, tileDigits, 10, QChar('0') )
-                                       .arg( m, tileDigits, 10, QChar('0') ) )
-                                       .arg( d->m_tileFormat );
+            const QString tileName = d->tileName( maxTileLevel, n, m );
 
             if ( QFile::exists( tileName ) && d->m_resume ) {
 
                 //mDebug() << tileName << "exists already";
+                d->m_createdTilesCount.fetchAndAddRelaxed( 1 );
 
             } else {
 
@@ -318,49 +650,19 @@ void TileCreator::run()
 
                 if ( tile.isNull() ) {
                     mDebug() << "Read-Error! Null QImage!";
+                    d->m_threadPool.waitForDone();
                     return;
                 }
 
-                if ( d->m_dem == "true" ) {
-                    tile = tile.convertToFormat(QImage::Format_Indexed8,
-                                                grayScalePalette,
-                                                Qt::ThresholdDither);
-                }
-
-                bool  ok = tile.save( tileName, d->m_tileFormat.toAscii().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                if ( !ok )
-                    mDebug() << "Error while writing Tile: " << tileName;
-
-                mDebug() << tileName << "size" << QFile( tileName ).size();
-
-                if ( d->m_verify ) {
-                    QImage writtenTile(tileName);
-                    Q_ASSERT( writtenTile.size() == tile.size() );
-                    for ( int i=0; i < writtenTile.size().width(); ++i) {
-                        for ( int j=0; j < writtenTile.size().height(); ++j) {
-                            if ( writtenTile.pixel( i, j ) != tile.pixel( i, j ) ) {
-                                unsigned int  pixel = tile.pixel( i, j);
-                                unsigned int  writtenPixel = writtenTile.pixel( i, j);
-                                qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
-                                QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
-                                qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
-                                QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
-                                qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
-                                Q_ASSERT(false);
-                            }
-                        }
-                    }
-                }
-
+                d->startJob( new TileCreatorSaveJob( d, tile, tileName ) );
             }
+        }
 
-            percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount) 
-                                        / (qreal)(totalTileCount) );	
-            createdTilesCount++;
+        emit progress( (int) ( 90 * (qreal)( d->m_createdTilesCount ) / (qreal)( totalTileCount ) ) );
+    }
 
-            mDebug() << "percentCompleted" << percentCompleted;
-            emit progress( percentCompleted );
-        }
+    while ( !d->waitForJobs( 200 ) ) {
+        emit progress( (int) ( 90 * (qreal)( d->m_createdTilesCount ) / (qreal)( totalTileCount ) ) );
     }
 
     mDebug() << "tileLevel: " << maxTileLevel << " successfully created.";
@@ -388,142 +690,27 @@ void TileCreator::run()
             int   mmaxit = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
             for ( int m = 0; m < mmaxit; ++m ) {
 
-                if ( d->m_cancelled )
-                    return;
+                if ( d->m_cancelled || d->m_failed )
+                    break;
 
-                QString newTileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                           .arg( tileLevel )
-                                           .arg( n, tileDigits, 10, QChar('0') )
-                                           .arg( m, tileDigits, 10, QChar('0') ) )
-                                           .arg( d->m_tileFormat );
+                d->startJob( new TileCreatorMergeJob( d, tileLevel, n, m ) );
+            }
 
-                if ( QFile::exists( newTileName ) && d->m_resume ) {
-                    //mDebug() << newTileName << "exists already";
-                } else {
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topleft( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topright( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomleft( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomright( tileName );
-
-                    QSize const expectedSize( c_defaultTileSize, c_defaultTileSize );
-                    if ( img_topleft.size() != expectedSize ||
-                         img_topright.size() != expectedSize ||
-                         img_bottomleft.size() != expectedSize ||
-                         img_bottomright.size() != expectedSize ) {
-                        mDebug() << "Tile write failure. Missing write permissions?";
-                        emit progress( 100 );
-                        return;
-                    }
-                    QImage  tile = img_topleft;
-
-                    if ( d->m_dem == "true" ) {
-
-                        tile.setColorTable( grayScalePalette );
-                        uchar* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2*x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomleft.scanLine( 2 * ( y - c_defaultTileSize / 2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[ x ] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomright.scanLine( 2 * ( y - c_defaultTileSize/2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                    }
-                    else {
-
-                        // tile.depth() != 8
-
-                        img_topleft = img_topleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_topright = img_topright.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomleft = img_bottomleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomright = img_bottomright.convertToFormat( QImage::Format_ARGB32 );
-                        tile = img_topleft;
-
-                        QRgb* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomleft.scanLine( 2 * ( y-c_defaultTileSize/2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomright.scanLine( 2 * ( y-c_defaultTileSize / 2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2*( x-c_defaultTileSize / 2 ) ];
-                        }
-                    }
+            emit progress( (int) ( 90 * (qreal)( d->m_createdTilesCount ) / (qreal)( totalTileCount ) ) );
+        }
 
-                    mDebug() << newTileName;
+        while ( !d->waitForJobs( 200 ) ) {
+            emit progress( (int) ( 90 * (qreal)( d->m_createdTilesCount ) / (qreal)( totalTileCount ) ) );
+        }
 
-                    // Saving at 100% JPEG quality to have a high-quality
-                    // version to create the remaining needed tiles from.
-                    bool  ok = tile.save( newTileName, d->m_tileFormat.toAscii().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                    if ( ! ok )
-                        mDebug() << "Error while writing Tile: " << newTileName;
-                }
+        if ( d->m_cancelled )
+            return;
 
-                percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount)
-                                            / (qreal)(totalTileCount) );	
-                createdTilesCount++;
-						
-                emit progress( percentCompleted );
-                mDebug() << "percentCompleted" << percentCompleted;
-            }
+        if ( d->m_failed ) {
+            emit progress( 100 );
+            return;
         }
+
         mDebug() << "tileLevel: " << tileLevel << " successfully created.";
     }
     mDebug() << "Tile creation completed.";
@@ -531,7 +718,7 @@ void TileCreator::run()
     if ( d->m_tileFormat == "jpg" && d->m_tileQuality != 100 ) {
 
         // Applying correct lower JPEG compression now that we created all tiles
-        int savedTilesCount = 0;
+        d->m_createdTilesCount = 0;
 
         tileLevel = 0;
         while ( tileLevel <= maxTileLevel ) {
@@ -540,42 +727,36 @@ void TileCreator::run()
                 int mmaxit =  TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
                 for ( int m = 0; m < mmaxit; ++m) {
 
-                    if ( d->m_cancelled )
+                    if ( d->m_cancelled ) {
+                        d->m_threadPool.waitForDone();
                         return;
+                    }
 
-                    savedTilesCount++;
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel )
-                                            .arg( n, tileDigits, 10, QChar('0') )
-                                            .arg( m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage tile( tileName );
-
-                    bool ok;
-
-                    ok = tile.save( tileName, d->m_tileFormat.toAscii().data(), d->m_tileQuality );
-
-                    if ( !ok )
-                        mDebug() << "Error while writing Tile: " << tileName;
-                    // Don't exceed 99% as this would cancel the thread unexpectedly
-                    percentCompleted = 90 + (int)( 9 * (qreal)(savedTilesCount)
-                                                / (qreal)(totalTileCount) );
-                    emit progress( percentCompleted );
-                    mDebug() << "percentCompleted" << percentCompleted;
-                    //mDebug() << "Saving Tile #" << savedTilesCount
-                    //         << " of " << totalTileCount
-                    //         << " Percent: " << percentCompleted;
+                    d->startJob( new TileCreatorRecompressJob( d, d->tileName( tileLevel, n, m ) ) );
                 }
+
+                // Don't exceed 99% as this would cancel the thread unexpectedly
+                emit progress( 90 + (int)( 9 * (qreal)( d->m_createdTilesCount ) / (qreal)( totalTileCount ) ) );
             }
             tileLevel++;
         }
+
+        while ( !d->waitForJobs( 200 ) ) {
+            emit progress( 90 + (int)( 9 * (qreal)( d->m_createdTilesCount ) / (qreal)( totalTileCount ) ) );
+        }
+
+        if ( d->m_cancelled )
+            return;
     }
 
-    percentCompleted = 100;
-    emit progress( percentCompleted );
+    if ( d->m_pack ) {
+        d->packTiles( maxTileLevel );
 
-    mDebug() << "percentCompleted: " << percentCompleted;
+        if ( d->m_cancelled )
+            return;
+    }
+
+    emit progress( 100 );
 }
 
 void TileCreator::setTileFormat(const QString& format)
@@ -618,6 +799,16 @@ bool TileCreator::verifyExactResult() const
     return d->m_verify;
 }
 
+void TileCreator::setPackTiles( bool pack )
+{
+    d->m_pack = pack;
+}
+
+bool TileCreator::packTiles() const
+{
+    return d->m_pack;
+}
+
 
 }
 
@@ -76,10 +76,17 @@ class MARBLE_EXPORT TileCreator : public QThread
     void setTileQuality( int quality );
     void setResume( bool resume );
     void setVerifyExactResult( bool verify );
+
+    /**
+     * If @p pack is true, the created tiles are moved into a single
+     * TileArchive in the target directory instead of one file per tile.
+     */
+    void setPackTiles( bool pack );
     QString tileFormat() const;
     int tileQuality() const;
     bool resume() const;
     bool verifyExactResult() const;
+    bool packTiles() const;
 
  protected:
     virtual void run();
@@ -34,6 +34,7 @@
 #include "HttpDownloadManager.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "TileArchive.h"
 #include "TileLoaderHelper.h"
 
 Q_DECLARE_METATYPE( Marble::DownloadUsage )
@@ -56,8 +57,6 @@ TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const Plugin
 //     - if expired: create TextureTile, state is set to Expired by default, trigger dl,
 QImage TileLoader::loadTileImage( GeoSceneTextureTile const *textureLayer, TileId const & tileId, DownloadUsage const usage )
 {
-    QString const fileName = tileFileName( textureLayer, tileId );
-
     TileStatus status = tileStatus( textureLayer, tileId );
     if ( status != Missing ) {
         // check if an update should be triggered
@@ -70,7 +69,7 @@ QImage TileLoader::loadTileImage( GeoSceneTextureTile const *textureLayer, TileI
             triggerDownload( textureLayer, tileId, usage );
         }
 
-        QImage const image( fileName );
+        QImage const image = tileImage( textureLayer, tileId );
         if ( !image.isNull() ) {
             // file is there, so create and return a tile object in any case
             return image;
@@ -178,8 +177,7 @@ bool TileLoader::baseTilesAvailable( GeoSceneTiled const & texture )
     for ( int column = 0; result && column < levelZeroColumns; ++column ) {
         for ( int row = 0; result && row < levelZeroRows; ++row ) {
             const TileId id( 0, 0, column, row );
-            const QString tilepath = tileFileName( &texture, id );
-            result &= QFile::exists( tilepath );
+            result &= tileLastModified( &texture, id ).isValid();
             if (!result) {
                 mDebug() << "Base tile " << texture.relativeTileFileName( id ) << " is missing for source dir " << texture.sourceDir();
             }
@@ -191,13 +189,11 @@ bool TileLoader::baseTilesAvailable( GeoSceneTiled const & texture )
 
 TileLoader::TileStatus TileLoader::tileStatus( GeoSceneTiled const *textureLayer, const TileId &tileId )
 {
-    QString const fileName = tileFileName( textureLayer, tileId );
-    QFileInfo fileInfo( fileName );
-    if ( !fileInfo.exists() ) {
+    const QDateTime lastModified = tileLastModified( textureLayer, tileId );
+    if ( !lastModified.isValid() ) {
         return Missing;
     }
 
-    const QDateTime lastModified = fileInfo.lastModified();
     const int expireSecs = textureLayer->expire();
     const bool isExpired = lastModified.secsTo( QDateTime::currentDateTime() ) >= expireSecs;
     return isExpired ? Expired : Available;
@@ -229,6 +225,79 @@ QString TileLoader::tileFileName( GeoSceneTiled const * textureLayer, TileId con
     return dirInfo.isAbsolute() ? fileName : MarbleDirs::path( fileName );
 }
 
+QString TileLoader::tileArchiveName( GeoSceneTiled const * textureLayer, TileId const & tileId )
+{
+    // all storage layouts place the tiles below the theme directory
+    return textureLayer->relativeTileFileName( tileId ).mid( textureLayer->themeStr().length() + 1 );
+}
+
+TileArchive *TileLoader::localTileArchive( GeoSceneTiled const * textureLayer )
+{
+    QString const themeStr = textureLayer->themeStr();
+    QFileInfo const dirInfo( themeStr );
+    return TileArchive::archive( dirInfo.isAbsolute() ? themeStr : MarbleDirs::localPath() + '/' + themeStr );
+}
+
+TileArchive *TileLoader::systemTileArchive( GeoSceneTiled const * textureLayer )
+{
+    QString const themeStr = textureLayer->themeStr();
+    QFileInfo const dirInfo( themeStr );
+    return dirInfo.isAbsolute() ? 0 : TileArchive::archive( MarbleDirs::systemPath() + '/' + themeStr );
+}
+
+// Tiles are looked up in the local tile archive first, which also receives the
+// downloads if it exists, then in the tile files and finally in the read-only
+// tile archive of the system path. This way the most recent version of a tile
+// is found first.
+QDateTime TileLoader::tileLastModified( GeoSceneTiled const * textureLayer, TileId const & tileId )
+{
+    QString const archiveName = tileArchiveName( textureLayer, tileId );
+
+    if ( TileArchive *const archive = localTileArchive( textureLayer ) ) {
+        QDateTime const lastModified = archive->lastModified( archiveName );
+        if ( lastModified.isValid() ) {
+            return lastModified;
+        }
+    }
+
+    QFileInfo const fileInfo( tileFileName( textureLayer, tileId ) );
+    if ( fileInfo.exists() ) {
+        return fileInfo.lastModified();
+    }
+
+    if ( TileArchive *const archive = systemTileArchive( textureLayer ) ) {
+        return archive->lastModified( archiveName );
+    }
+
+    return QDateTime();
+}
+
+QImage TileLoader::tileImage( GeoSceneTiled const * textureLayer, TileId const & tileId )
+{
+    QString const archiveName = tileArchiveName( textureLayer, tileId );
+
+    if ( TileArchive *const archive = localTileArchive( textureLayer ) ) {
+        QByteArray const data = archive->data( archiveName );
+        if ( !data.isNull() ) {
+            return QImage::fromData( data );
+        }
+    }
+
+    QImage const image( tileFileName( textureLayer, tileId ) );
+    if ( !image.isNull() ) {
+        return image;
+    }
+
+    if ( TileArchive *const archive = systemTileArchive( textureLayer ) ) {
+        QByteArray const data = archive->data( archiveName );
+        if ( !data.isNull() ) {
+            return QImage::fromData( data );
+        }
+    }
+
+    return QImage();
+}
+
 void TileLoader::triggerDownload( GeoSceneTiled const *textureLayer, TileId const &id, DownloadUsage const usage )
 {
     QUrl const sourceUrl = textureLayer->downloadUrl( id );
@@ -245,9 +314,8 @@ QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTile * textureLaye
         int const deltaLevel = id.zoomLevel() - level;
         TileId const replacementTileId( id.mapThemeIdHash(), level,
                                         id.x() >> deltaLevel, id.y() >> deltaLevel );
-        QString const fileName = tileFileName( textureLayer, replacementTileId );
-        mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << fileName;
-        QImage toScale( fileName );
+        mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << tileArchiveName( textureLayer, replacementTileId );
+        QImage toScale = tileImage( textureLayer, replacementTileId );
 
         if ( level == 0 && toScale.isNull() ) {
             mDebug() << "No level zero tile installed in map theme dir. Falling back to a transparent image for now.";
@@ -28,8 +28,10 @@
 #include "GeoDataContainer.h"
 #include "PluginManager.h"
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 class QByteArray;
+class QDateTime;
 class QImage;
 class QUrl;
 
@@ -40,8 +42,9 @@ class GeoDataDocument;
 class GeoSceneTiled;
 class GeoSceneTextureTile;
 class GeoSceneVectorTile;
+class TileArchive;
 
-class TileLoader: public QObject
+class MARBLE_EXPORT TileLoader: public QObject
 {
     Q_OBJECT
 
@@ -87,6 +90,11 @@ class TileLoader: public QObject
 
  private:
     static QString tileFileName( GeoSceneTiled const * textureLayer, TileId const & );
+    static QString tileArchiveName( GeoSceneTiled const * textureLayer, TileId const & );
+    static TileArchive *localTileArchive( GeoSceneTiled const * textureLayer );
+    static TileArchive *systemTileArchive( GeoSceneTiled const * textureLayer );
+    static QDateTime tileLastModified( GeoSceneTiled const * textureLayer, TileId const & );
+    static QImage tileImage( GeoSceneTiled const * textureLayer, TileId const & );
     void triggerDownload( GeoSceneTiled const *textureLayer, TileId const &, DownloadUsage const );
     QImage scaledLowerLevelTile( GeoSceneTextureTile const * textureLayer, TileId const & ) const;
 
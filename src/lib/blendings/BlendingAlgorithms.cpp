@@ -62,6 +62,33 @@ void GrayscaleBlending::blend( QImage * const bottom, TextureTile const * const
 
 }
 
+IndependentChannelBlending::IndependentChannelBlending()
+    : m_lookupTableMutex(),
+      m_lookupTable()
+{
+}
+
+// The table is indexed by bottom intensity * 256 + top intensity.
+// Tiles get blended by several threads, so it's built under the mutex.
+uchar const * IndependentChannelBlending::lookupTable() const
+{
+    QMutexLocker locker( &m_lookupTableMutex );
+
+    if ( m_lookupTable.isEmpty() ) {
+        m_lookupTable.resize( 256 * 256 );
+        uchar * entry = m_lookupTable.data();
+        for ( int bottom = 0; bottom < 256; ++bottom ) {
+            for ( int top = 0; top < 256; ++top ) {
+                qreal const result = blendChannel( bottom / 255.0, top / 255.0 );
+                // same conversion as qRgb() applies in blendGeneric()
+                *entry++ = static_cast<int>( result * 255.0 ) & 0xff;
+            }
+        }
+    }
+
+    return m_lookupTable.constData();
+}
+
 // pre-conditions:
 // - bottom and top image have the same size
 // - bottom image format is ARGB32_Premultiplied
@@ -71,7 +98,36 @@ void IndependentChannelBlending::blend( QImage * const bottom,
     QImage const * const topImage = top->image();
     Q_ASSERT( topImage );
     Q_ASSERT( bottom->size() == topImage->size() );
-    Q_ASSERT( bottom->format() == QImage::Format_ARGB32_Premultiplied );
+
+    if ( bottom->format() != QImage::Format_ARGB32_Premultiplied ) {
+        blendGeneric( bottom, top );
+        return;
+    }
+
+    uchar const * const table = lookupTable();
+
+    int const width = bottom->width();
+    int const height = bottom->height();
+    QImage const topImagePremult = topImage->convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    for ( int y = 0; y < height; ++y ) {
+        QRgb * bottomLine = reinterpret_cast<QRgb *>( bottom->scanLine( y ) );
+        QRgb const * topLine = reinterpret_cast<QRgb const *>( topImagePremult.scanLine( y ) );
+        for ( int x = 0; x < width; ++x ) {
+            QRgb const bottomPixel = bottomLine[x];
+            QRgb const topPixel = topLine[x];
+            bottomLine[x] = qRgb( table[ ( qRed( bottomPixel ) << 8 ) | qRed( topPixel ) ],
+                                  table[ ( qGreen( bottomPixel ) << 8 ) | qGreen( topPixel ) ],
+                                  table[ ( qBlue( bottomPixel ) << 8 ) | qBlue( topPixel ) ] );
+        }
+    }
+}
+
+void IndependentChannelBlending::blendGeneric( QImage * const bottom,
+                                               TextureTile const * const top ) const
+{
+    QImage const * const topImage = top->image();
+    Q_ASSERT( topImage );
+    Q_ASSERT( bottom->size() == topImage->size() );
 
     int const width = bottom->width();
     int const height = bottom->height();
@@ -16,6 +16,8 @@
 #ifndef MARBLE_BLENDING_ALGORITHMS_H
 #define MARBLE_BLENDING_ALGORITHMS_H
 
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
 #include <QtCore/QtGlobal>
 
 #include "Blending.h"
@@ -32,8 +34,23 @@ class OverpaintBlending: public Blending
 class IndependentChannelBlending: public Blending
 {
  public:
+    IndependentChannelBlending();
+
+    // As all channels have 8 bits, blendChannel() gets evaluated once for
+    // every possible pair of input values and the results are kept in a
+    // lookup table, which is then used to blend the images row by row.
     virtual void blend( QImage * const bottom, TextureTile const * const top ) const;
+
+    // Reference implementation which calls blendChannel() for every
+    // channel of every pixel.
+    void blendGeneric( QImage * const bottom, TextureTile const * const top ) const;
+
  private:
+    uchar const * lookupTable() const;
+
+    mutable QMutex m_lookupTableMutex;
+    mutable QVector<uchar> m_lookupTable;
+
     // bottomColorIntensity: intensity of one color channel (of one pixel) of the bottom image
     // topColorIntensity: intensity of one color channel (of one pixel) of the top image
     // return: intensity of the color channel (of a given pixel) of the result image
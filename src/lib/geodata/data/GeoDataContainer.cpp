@@ -274,15 +274,15 @@ void GeoDataContainer::unpack( QDataStream& stream )
             case GeoDataFolderId:
                 {
                 GeoDataFolder *folder = new GeoDataFolder;
+                append( folder );
                 folder->unpack( stream );
-                p()->m_vector.append( folder );
                 }
                 break;
             case GeoDataPlacemarkId:
                 {
                 GeoDataPlacemark *placemark = new GeoDataPlacemark;
+                append( placemark );
                 placemark->unpack( stream );
-                p()->m_vector.append( placemark );
                 }
                 break;
             case GeoDataNetworkLinkId:
@@ -28,7 +28,8 @@ class GeoDataCoordinatesPrivate
     * needs this name. Maybe we can rename it to our scheme later on.
     */
     GeoDataCoordinatesPrivate()
-        : m_lon( 0 ),
+        : m_q( 0.0, 0.0, 0.0, 1.0 ),
+          m_lon( 0 ),
           m_lat( 0 ),
           m_altitude( 0 ),
           m_detail( 0 ),
@@ -70,7 +71,7 @@ class GeoDataCoordinatesPrivate
     * initialize the reference with the value of the other
     */
     GeoDataCoordinatesPrivate( const GeoDataCoordinatesPrivate &other )
-        : m_q( Quaternion::fromSpherical( other.m_lon, other.m_lat ) ),
+        : m_q( other.m_q ),
           m_lon( other.m_lon ),
           m_lat( other.m_lat ),
           m_altitude( other.m_altitude ),
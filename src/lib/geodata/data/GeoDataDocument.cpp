@@ -159,24 +159,30 @@ QList<GeoDataStyleMap> GeoDataDocument::styleMaps() const
 
 void GeoDataDocument::pack( QDataStream& stream ) const
 {
-    GeoDataContainer::pack( stream );
-
+    // Styles go first, so that features can refer to them while being unpacked
     stream << p()->m_styleHash.size();
-    
-    
-    for( QMap<QString, GeoDataStyle>::const_iterator iterator 
-          = p()->m_styleHash.constBegin(); 
-        iterator != p()->m_styleHash.constEnd(); 
+    for( QMap<QString, GeoDataStyle>::const_iterator iterator
+          = p()->m_styleHash.constBegin();
+        iterator != p()->m_styleHash.constEnd();
+        ++iterator ) {
+        iterator.value().pack( stream );
+    }
+
+    stream << p()->m_styleMapHash.size();
+    for( QMap<QString, GeoDataStyleMap>::const_iterator iterator
+          = p()->m_styleMapHash.constBegin();
+        iterator != p()->m_styleMapHash.constEnd();
         ++iterator ) {
         iterator.value().pack( stream );
     }
+
+    GeoDataContainer::pack( stream );
 }
 
 
 void GeoDataDocument::unpack( QDataStream& stream )
 {
     detach();
-    GeoDataContainer::unpack( stream );
 
     int size = 0;
 
@@ -184,8 +190,17 @@ void GeoDataDocument::unpack( QDataStream& stream )
     for( int i = 0; i < size; i++ ) {
         GeoDataStyle style;
         style.unpack( stream );
-        p()->m_styleHash.insert( style.styleId(), style );
+        addStyle( style );
     }
+
+    stream >> size;
+    for( int i = 0; i < size; i++ ) {
+        GeoDataStyleMap styleMap;
+        styleMap.unpack( stream );
+        addStyleMap( styleMap );
+    }
+
+    GeoDataContainer::unpack( stream );
 }
 
 }
@@ -100,11 +100,42 @@ GeoDataSimpleArrayData* GeoDataExtendedData::simpleArrayData( const QString& key
 void GeoDataExtendedData::pack( QDataStream& stream ) const
 {
     GeoDataObject::pack( stream );
+
+    stream << d->hash.size();
+    QHash< QString, GeoDataData >::const_iterator it = d->hash.constBegin();
+    for ( ; it != d->hash.constEnd(); ++it ) {
+        it.value().pack( stream );
+    }
+
+    stream << d->arrayHash.size();
+    QHash< QString, GeoDataSimpleArrayData* >::const_iterator arrayIt = d->arrayHash.constBegin();
+    for ( ; arrayIt != d->arrayHash.constEnd(); ++arrayIt ) {
+        stream << arrayIt.key();
+        arrayIt.value()->pack( stream );
+    }
 }
 
 void GeoDataExtendedData::unpack( QDataStream& stream )
 {
     GeoDataObject::unpack( stream );
+
+    int size = 0;
+    stream >> size;
+    for ( int i = 0; i < size; ++i ) {
+        GeoDataData data;
+        data.unpack( stream );
+        d->hash.insert( data.name(), data );
+    }
+
+    stream >> size;
+    for ( int i = 0; i < size; ++i ) {
+        QString key;
+        stream >> key;
+        GeoDataSimpleArrayData *values = new GeoDataSimpleArrayData;
+        values->unpack( stream );
+        delete d->arrayHash.value( key );
+        d->arrayHash.insert( key, values );
+    }
 }
 
 }
@@ -14,6 +14,7 @@
 #include "GeoDataFeature_p.h"
 
 #include <QtCore/QDataStream>
+#include <QtCore/QMutex>
 #include <QtCore/QSize>
 #include <QtGui/QPixmap>
 
@@ -38,6 +39,8 @@ QColor GeoDataFeaturePrivate::s_defaultLabelColor = QColor( Qt::black );
 bool GeoDataFeaturePrivate::s_defaultStyleInitialized = false;
 GeoDataStyle* GeoDataFeaturePrivate::s_defaultStyle[GeoDataFeature::LastIndex];
 QMap<QString, GeoDataFeature::GeoDataVisualCategory> GeoDataFeaturePrivate::s_visualCategories;
+QAtomicInt GeoDataFeaturePrivate::s_visualCategoriesInitialized( 0 );
+static QMutex s_visualCategoriesMutex;
 
 GeoDataFeature::GeoDataFeature()
     :d( new GeoDataFeaturePrivate() )
@@ -763,6 +766,13 @@ void GeoDataFeature::detach()
     d->ref.ref();
 }
 
+// How pack() stores the style of a feature
+enum StyleStorage {
+    NoStyle,
+    DocumentStyle,
+    InlineStyle
+};
+
 void GeoDataFeature::pack( QDataStream& stream ) const
 {
     GeoDataObject::pack( stream );
@@ -776,6 +786,24 @@ void GeoDataFeature::pack( QDataStream& stream ) const
     stream << d->m_role;
     stream << d->m_popularity;
     stream << d->m_zoomLevel;
+
+    stream << d->m_descriptionCDATA;
+    stream << d->m_styleUrl;
+    stream << int( d->m_visualCategory );
+    d->m_extendedData.pack( stream );
+    d->m_timeSpan.pack( stream );
+    d->m_timeStamp.pack( stream );
+
+    // Document wide styles are referenced by their id, inline styles are copied
+    if ( !d->m_style ) {
+        stream << qint8( NoStyle );
+    } else if ( d->m_style->parent() == this ) {
+        stream << qint8( InlineStyle );
+        d->m_style->pack( stream );
+    } else {
+        stream << qint8( DocumentStyle );
+        stream << d->m_style->styleId();
+    }
 }
 
 void GeoDataFeature::unpack( QDataStream& stream )
@@ -792,12 +820,47 @@ void GeoDataFeature::unpack( QDataStream& stream )
     stream >> d->m_role;
     stream >> d->m_popularity;
     stream >> d->m_zoomLevel;
+
+    stream >> d->m_descriptionCDATA;
+    stream >> d->m_styleUrl;
+    int visualCategory;
+    stream >> visualCategory;
+    d->m_visualCategory = GeoDataVisualCategory( visualCategory );
+    d->m_extendedData.unpack( stream );
+    d->m_timeSpan.unpack( stream );
+    d->m_timeStamp.unpack( stream );
+
+    qint8 styleStorage;
+    stream >> styleStorage;
+    d->m_style = 0;
+    if ( styleStorage == InlineStyle ) {
+        GeoDataStyle *style = new GeoDataStyle;
+        style->unpack( stream );
+        setStyle( style );
+    } else if ( styleStorage == DocumentStyle ) {
+        QString styleId;
+        stream >> styleId;
+        // Containers append their features before unpacking them, so the
+        // styles of the document are known already
+        for ( GeoDataObject *object = parent(); object; object = object->parent() ) {
+            if ( object->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+                d->m_style = &static_cast<GeoDataDocument*>( object )->style( styleId );
+                break;
+            }
+        }
+    }
 }
 
 GeoDataFeature::GeoDataVisualCategory GeoDataFeature::OsmVisualCategory(const QString &keyValue )
 {
-    if( GeoDataFeaturePrivate::s_visualCategories.isEmpty() ) {
-        GeoDataFeaturePrivate::initializeOsmVisualCategories();
+    // OSM files may be parsed by several threads at the same time. The
+    // acquire makes the map filled by another thread visible to this one.
+    if ( !GeoDataFeaturePrivate::s_visualCategoriesInitialized.testAndSetAcquire( 1, 1 ) ) {
+        QMutexLocker locker( &s_visualCategoriesMutex );
+        if( GeoDataFeaturePrivate::s_visualCategories.isEmpty() ) {
+            GeoDataFeaturePrivate::initializeOsmVisualCategories();
+        }
+        GeoDataFeaturePrivate::s_visualCategoriesInitialized.fetchAndStoreRelease( 1 );
     }
     return GeoDataFeaturePrivate::s_visualCategories.value( keyValue );
 }
@@ -212,6 +212,7 @@ class GeoDataFeaturePrivate
     static bool          s_defaultStyleInitialized;
 
     static QMap<QString, GeoDataFeature::GeoDataVisualCategory> s_visualCategories;
+    static QAtomicInt    s_visualCategoriesInitialized;
 };
 
 } // namespace Marble
@@ -220,7 +220,9 @@ GeoDataLatLonAltBox GeoDataLatLonAltBox::fromLineString(  const GeoDataLineStrin
         return GeoDataLatLonAltBox();
     }
 
-    const qreal altitude = lineString.first().altitude();
+    const QVector<qreal> altitudeVector = lineString.altitudes();
+    const qreal *altitudes = altitudeVector.constData();
+    const qreal altitude = altitudes[0];
 
     GeoDataLatLonAltBox temp ( GeoDataLatLonBox::fromLineString( lineString ), altitude, altitude );
 
@@ -234,13 +236,11 @@ GeoDataLatLonAltBox GeoDataLatLonAltBox::fromLineString(  const GeoDataLineStrin
         return temp;
     }
 
-    QVector<GeoDataCoordinates>::ConstIterator it( lineString.constBegin() );
-    QVector<GeoDataCoordinates>::ConstIterator itEnd( lineString.constEnd() );
+    const int count = lineString.size();
 
-    for ( ; it != itEnd; ++it )
+    for ( int i = 0; i < count; ++i )
     {
-        // Get coordinates and normalize them to the desired range.
-        const qreal altitude = (it)->altitude();
+        const qreal altitude = altitudes[i];
 
         // Determining the maximum and minimum latitude
         if ( altitude > maxAltitude ) maxAltitude = altitude;
@@ -563,8 +563,14 @@ GeoDataLatLonBox GeoDataLatLonBox::fromLineString(  const GeoDataLineString& lin
         return GeoDataLatLonBox();
     }
 
-    qreal lon, lat;
-    lineString.first().geoCoordinates( lon, lat );
+    const QVector<qreal> longitudeVector = lineString.longitudes();
+    const QVector<qreal> latitudeVector = lineString.latitudes();
+    const qreal *longitudes = longitudeVector.constData();
+    const qreal *latitudes = latitudeVector.constData();
+    const int count = lineString.size();
+
+    qreal lon = longitudes[0];
+    qreal lat = latitudes[0];
     GeoDataCoordinates::normalizeLonLat( lon, lat );
 
     qreal north = lat;
@@ -599,14 +605,14 @@ GeoDataLatLonBox GeoDataLatLonBox::fromLineString(  const GeoDataLineString& lin
     int currentSign = ( lon < 0 ) ? -1 : +1;
     int previousSign = currentSign;
 
-    QVector<GeoDataCoordinates>::ConstIterator it( lineString.constBegin() );
-    QVector<GeoDataCoordinates>::ConstIterator itEnd( lineString.constEnd() );
+    int i = 0;
 
     bool processingLastNode = false;
 
-    while( it != itEnd ) {
+    while( i < count ) {
         // Get coordinates and normalize them to the desired range.
-        (it)->geoCoordinates( lon, lat );
+        lon = longitudes[i];
+        lat = latitudes[i];
         GeoDataCoordinates::normalizeLonLat( lon, lat );
 
         // Determining the maximum and minimum latitude
@@ -664,10 +670,10 @@ GeoDataLatLonBox GeoDataLatLonBox::fromLineString(  const GeoDataLineString& lin
         if ( processingLastNode ) {
             break;
         }
-        ++it;
+        ++i;
 
-        if( lineString.isClosed() && it == itEnd ) {
-                it = lineString.constBegin();
+        if( lineString.isClosed() && i == count ) {
+                i = 0;
                 processingLastNode = true;
         }
     }
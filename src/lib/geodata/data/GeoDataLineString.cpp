@@ -21,6 +21,9 @@
 
 namespace Marble
 {
+
+QAtomicInt GeoDataLineStringPrivate::s_revisionCounter;
+
 GeoDataLineString::GeoDataLineString( TessellationFlags f )
   : GeoDataGeometry( new GeoDataLineStringPrivate( f ) )
 {
@@ -126,108 +129,248 @@ GeoDataCoordinates GeoDataLineStringPrivate::findDateLine( const GeoDataCoordina
     return findDateLine( previousCoords, interpolatedCoords, recursionCounter );
 }
 
+void GeoDataLineStringPrivate::appendCompact( const GeoDataCoordinates &coordinates )
+{
+    m_longitudes.append( coordinates.longitude() );
+    m_latitudes.append( coordinates.latitude() );
+    m_altitudes.append( coordinates.altitude() );
+    m_details.append( coordinates.detail() );
+}
+
+void GeoDataLineStringPrivate::expand()
+{
+    if ( !m_compact ) {
+        return;
+    }
+
+    const int count = m_longitudes.size();
+    m_vector.reserve( count );
+    for ( int i = 0; i < count; ++i ) {
+        m_vector.append( coordinatesAt( i ) );
+    }
+
+    m_compact = false;
+    delete m_compactVector.fetchAndStoreRelaxed( 0 );
+    m_longitudes.clear();
+    m_latitudes.clear();
+    m_altitudes.clear();
+    m_details.clear();
+}
+
+const QVector<GeoDataCoordinates> &GeoDataLineStringPrivate::vector()
+{
+    if ( !m_compact ) {
+        return m_vector;
+    }
+
+    QVector<GeoDataCoordinates> *vector = cached( m_compactVector );
+    if ( !vector ) {
+        const int count = m_longitudes.size();
+        vector = new QVector<GeoDataCoordinates>;
+        vector->reserve( count );
+        for ( int i = 0; i < count; ++i ) {
+            vector->append( coordinatesAt( i ) );
+        }
+        vector = publish( m_compactVector, vector );
+    }
+
+    return *vector;
+}
+
+const GeoDataLineStringPrivate::EdgeIndex *GeoDataLineStringPrivate::edgeIndex()
+{
+    EdgeIndex *index = cached( m_edgeIndex );
+    if ( index ) {
+        return index->offsets.isEmpty() ? 0 : index;
+    }
+
+    // A compact ring shares its arrays with the index
+    index = new EdgeIndex;
+    if ( m_compact ) {
+        index->longitudes = m_longitudes;
+        index->latitudes = m_latitudes;
+    } else {
+        const int count = m_vector.size();
+        index->longitudes.resize( count );
+        index->latitudes.resize( count );
+        for ( int i = 0; i < count; ++i ) {
+            index->longitudes[i] = m_vector.at( i ).longitude();
+            index->latitudes[i] = m_vector.at( i ).latitude();
+        }
+    }
+
+    const int count = index->longitudes.size();
+    const qreal *lons = index->longitudes.constData();
+
+    qreal west = count > 0 ? lons[0] : 0.0;
+    qreal east = west;
+    for ( int i = 1; i < count; ++i ) {
+        west = qMin( west, lons[i] );
+        east = qMax( east, lons[i] );
+    }
+
+    // About two edges per bucket for an evenly spread ring
+    const int bucketCount = qBound( 1, count / 2, 65536 );
+    index->west = west;
+    index->width = east > west ? ( east - west ) / bucketCount : 1.0;
+    index->offsets.fill( 0, bucketCount + 1 );
+
+    // Each edge is listed in every bucket it spans, so rings with many long
+    // edges would need far more memory than the nodes themselves
+    qint64 total = 0;
+    int j = count - 1;
+    for ( int i = 0; i < count; ++i ) {
+        total += index->bucket( qMax( lons[i], lons[j] ) ) - index->bucket( qMin( lons[i], lons[j] ) ) + 1;
+        j = i;
+    }
+    if ( total > maximumEdgeBucketEntries * qint64( count ) ) {
+        // An empty index remembers that the ring can't be indexed
+        index->longitudes.clear();
+        index->latitudes.clear();
+        index->offsets.clear();
+        publish( m_edgeIndex, index );
+        return 0;
+    }
+
+    // Count the edges per bucket first, then fill them in
+    j = count - 1;
+    for ( int i = 0; i < count; ++i ) {
+        const int first = index->bucket( qMin( lons[i], lons[j] ) );
+        const int last = index->bucket( qMax( lons[i], lons[j] ) );
+        for ( int bucket = first; bucket <= last; ++bucket ) {
+            ++index->offsets[bucket + 1];
+        }
+        j = i;
+    }
+
+    for ( int bucket = 0; bucket < bucketCount; ++bucket ) {
+        index->offsets[bucket + 1] += index->offsets[bucket];
+    }
+
+    QVector<int> position = index->offsets;
+    index->edges.resize( index->offsets.last() );
+    j = count - 1;
+    for ( int i = 0; i < count; ++i ) {
+        const int first = index->bucket( qMin( lons[i], lons[j] ) );
+        const int last = index->bucket( qMax( lons[i], lons[j] ) );
+        for ( int bucket = first; bucket <= last; ++bucket ) {
+            index->edges[position[bucket]++] = i;
+        }
+        j = i;
+    }
+
+    index = publish( m_edgeIndex, index );
+    return index->offsets.isEmpty() ? 0 : index;
+}
+
 bool GeoDataLineString::isEmpty() const
 {
-    return p()->m_vector.isEmpty();
+    return p()->size() == 0;
 }
 
 int GeoDataLineString::size() const
 {
-    return p()->m_vector.size();
+    return p()->size();
 }
 
 GeoDataCoordinates& GeoDataLineString::at( int pos )
 {
     GeoDataGeometry::detach();
-    p()->m_dirtyRange = true;
-    p()->m_dirtyBox = true;
+    p()->expand();
+    p()->invalidate();
     return p()->m_vector[ pos ];
 }
 
-const GeoDataCoordinates& GeoDataLineString::at( int pos ) const
+GeoDataCoordinates GeoDataLineString::at( int pos ) const
+{
+    return p()->coordinatesAt( pos );
+}
+
+GeoDataCoordinates GeoDataLineString::coordinatesAt( int pos ) const
 {
-    return p()->m_vector.at( pos );
+    return p()->coordinatesAt( pos );
 }
 
 GeoDataCoordinates& GeoDataLineString::operator[]( int pos )
 {
     GeoDataGeometry::detach();
-    p()->m_dirtyRange = true;
-    p()->m_dirtyBox = true;
+    p()->expand();
+    p()->invalidate();
     return p()->m_vector[ pos ];
 }
 
-const GeoDataCoordinates& GeoDataLineString::operator[]( int pos ) const
+GeoDataCoordinates GeoDataLineString::operator[]( int pos ) const
 {
-    return p()->m_vector[ pos ];
+    return p()->coordinatesAt( pos );
 }
 
 GeoDataCoordinates& GeoDataLineString::last()
 {
     GeoDataGeometry::detach();
-    p()->m_dirtyRange = true;
-    p()->m_dirtyBox = true;
+    p()->expand();
+    p()->invalidate();
     return p()->m_vector.last();
 }
 
 GeoDataCoordinates& GeoDataLineString::first()
 {
     GeoDataGeometry::detach();
+    p()->expand();
+    p()->invalidate();
     return p()->m_vector.first();
 }
 
-const GeoDataCoordinates& GeoDataLineString::last() const
+GeoDataCoordinates GeoDataLineString::last() const
 {
-    return p()->m_vector.last();
+    return p()->coordinatesAt( p()->size() - 1 );
 }
 
-const GeoDataCoordinates& GeoDataLineString::first() const
+GeoDataCoordinates GeoDataLineString::first() const
 {
-    return p()->m_vector.first();
+    return p()->coordinatesAt( 0 );
 }
 
 QVector<GeoDataCoordinates>::Iterator GeoDataLineString::begin()
 {
     GeoDataGeometry::detach();
+    p()->expand();
+    p()->invalidate();
     return p()->m_vector.begin();
 }
 
 QVector<GeoDataCoordinates>::Iterator GeoDataLineString::end()
 {
     GeoDataGeometry::detach();
+    p()->expand();
+    p()->invalidate();
     return p()->m_vector.end();
 }
 
 QVector<GeoDataCoordinates>::ConstIterator GeoDataLineString::constBegin() const
 {
-    return p()->m_vector.constBegin();
+    return p()->vector().constBegin();
 }
 
 QVector<GeoDataCoordinates>::ConstIterator GeoDataLineString::constEnd() const
 {
-    return p()->m_vector.constEnd();
+    return p()->vector().constEnd();
 }
 
 void GeoDataLineString::append ( const GeoDataCoordinates& value )
 {
     GeoDataGeometry::detach();
     GeoDataLineStringPrivate* d = p();
-    delete d->m_rangeCorrected;
-    d->m_rangeCorrected = 0;
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
-    d->m_vector.append( value );
+    d->invalidate();
+    if ( d->m_compact ) {
+        d->appendCompact( value );
+    } else {
+        d->m_vector.append( value );
+    }
 }
 
 GeoDataLineString& GeoDataLineString::operator << ( const GeoDataCoordinates& value )
 {
-    GeoDataGeometry::detach();
-    GeoDataLineStringPrivate* d = p();
-    delete d->m_rangeCorrected;
-    d->m_rangeCorrected = 0;
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
-    d->m_vector.append( value );
+    append( value );
     return *this;
 }
 
@@ -235,31 +378,154 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataLineString& val
 {
     GeoDataGeometry::detach();
     GeoDataLineStringPrivate* d = p();
-    delete d->m_rangeCorrected;
-    d->m_rangeCorrected = 0;
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
+    d->invalidate();
 
-    QVector<GeoDataCoordinates>::const_iterator itCoords = value.constBegin();
-    QVector<GeoDataCoordinates>::const_iterator itEnd = value.constEnd();
+    const GeoDataLineStringPrivate* other = value.p();
+    const int count = other->size();
 
-    for( ; itCoords != itEnd; ++itCoords ) {
-        d->m_vector.append( *itCoords );
+    if ( d->m_compact ) {
+        for ( int i = 0; i < count; ++i ) {
+            d->appendCompact( other->coordinatesAt( i ) );
+        }
+    }
+    else {
+        d->m_vector.reserve( d->m_vector.size() + count );
+        for ( int i = 0; i < count; ++i ) {
+            d->m_vector.append( other->coordinatesAt( i ) );
+        }
     }
 
     return *this;
 }
 
+void GeoDataLineString::reserve( int size )
+{
+    GeoDataGeometry::detach();
+    GeoDataLineStringPrivate* d = p();
+
+    if ( d->m_compact ) {
+        d->m_longitudes.reserve( size );
+        d->m_latitudes.reserve( size );
+        d->m_altitudes.reserve( size );
+        d->m_details.reserve( size );
+    }
+    else {
+        d->m_vector.reserve( size );
+    }
+}
+
 void GeoDataLineString::clear()
 {
     GeoDataGeometry::detach();
     GeoDataLineStringPrivate* d = p();
-    delete d->m_rangeCorrected;
-    d->m_rangeCorrected = 0;
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
+    d->invalidate();
 
     d->m_vector.clear();
+    d->m_longitudes.clear();
+    d->m_latitudes.clear();
+    d->m_altitudes.clear();
+    d->m_details.clear();
+}
+
+void GeoDataLineString::setCompactStorage( bool compact )
+{
+    GeoDataLineStringPrivate* d = p();
+    if ( compact == d->m_compact ) {
+        return;
+    }
+
+    GeoDataGeometry::detach();
+    d = p();
+
+    if ( compact ) {
+        const int count = d->m_vector.size();
+        d->m_longitudes.reserve( count );
+        d->m_latitudes.reserve( count );
+        d->m_altitudes.reserve( count );
+        d->m_details.reserve( count );
+        for ( int i = 0; i < count; ++i ) {
+            d->appendCompact( d->m_vector.at( i ) );
+        }
+        d->m_vector.clear();
+        d->m_compact = true;
+    }
+    else {
+        d->expand();
+    }
+}
+
+int GeoDataLineString::revision() const
+{
+    return p()->m_revision;
+}
+
+bool GeoDataLineString::hasCompactStorage() const
+{
+    return p()->m_compact;
+}
+
+QVector<qreal> GeoDataLineString::longitudes() const
+{
+    const GeoDataLineStringPrivate *const d = p();
+    if ( d->m_compact ) {
+        return d->m_longitudes;
+    }
+
+    const int count = d->m_vector.size();
+    QVector<qreal> result( count );
+    for ( int i = 0; i < count; ++i ) {
+        result[i] = d->m_vector.at( i ).longitude();
+    }
+
+    return result;
+}
+
+QVector<qreal> GeoDataLineString::latitudes() const
+{
+    const GeoDataLineStringPrivate *const d = p();
+    if ( d->m_compact ) {
+        return d->m_latitudes;
+    }
+
+    const int count = d->m_vector.size();
+    QVector<qreal> result( count );
+    for ( int i = 0; i < count; ++i ) {
+        result[i] = d->m_vector.at( i ).latitude();
+    }
+
+    return result;
+}
+
+QVector<qreal> GeoDataLineString::altitudes() const
+{
+    const GeoDataLineStringPrivate *const d = p();
+    if ( d->m_compact ) {
+        return d->m_altitudes;
+    }
+
+    const int count = d->m_vector.size();
+    QVector<qreal> result( count );
+    for ( int i = 0; i < count; ++i ) {
+        result[i] = d->m_vector.at( i ).altitude();
+    }
+
+    return result;
+}
+
+QVector<int> GeoDataLineString::details() const
+{
+    const GeoDataLineStringPrivate *const d = p();
+    if ( d->m_compact ) {
+        return d->m_details;
+    }
+
+    const int count = d->m_vector.size();
+    QVector<int> result( count );
+    for ( int i = 0; i < count; ++i ) {
+        result[i] = d->m_vector.at( i ).detail();
+    }
+
+    return result;
 }
 
 bool GeoDataLineString::isClosed() const
@@ -304,23 +570,21 @@ GeoDataLineString GeoDataLineString::toNormalized() const
     GeoDataLineString normalizedLineString;
 
     normalizedLineString.setTessellationFlags( tessellationFlags() );
+    normalizedLineString.setCompactStorage( hasCompactStorage() );
 
     qreal lon;
     qreal lat;
 
     // FIXME: Think about how we can avoid unnecessary copies
     //        if the linestring stays the same.
-    QVector<GeoDataCoordinates>::const_iterator end = p()->m_vector.constEnd();
-    for( QVector<GeoDataCoordinates>::const_iterator itCoords
-          = p()->m_vector.constBegin();
-         itCoords != end;
-         ++itCoords ) {
-
-        itCoords->geoCoordinates( lon, lat );
-        qreal alt = itCoords->altitude();
+    const int count = size();
+    for( int i = 0; i < count; ++i ) {
+        GeoDataCoordinates normalizedCoords = p()->coordinatesAt( i );
+
+        normalizedCoords.geoCoordinates( lon, lat );
+        qreal alt = normalizedCoords.altitude();
         GeoDataCoordinates::normalizeLonLat( lon, lat );
 
-        GeoDataCoordinates normalizedCoords( *itCoords );
         normalizedCoords.set( lon, lat, alt );
         normalizedLineString << normalizedCoords;
     }
@@ -330,16 +594,13 @@ GeoDataLineString GeoDataLineString::toNormalized() const
 
 GeoDataLineString GeoDataLineString::toRangeCorrected() const
 {
-    if ( p()->m_dirtyRange ) {
-
-        delete p()->m_rangeCorrected;
-
-        GeoDataLineString poleCorrected = toPoleCorrected();
-        p()->m_rangeCorrected = new GeoDataLineString( poleCorrected );
-        p()->m_dirtyRange = false;
+    GeoDataLineString *rangeCorrected = GeoDataLineStringPrivate::cached( p()->m_rangeCorrected );
+    if ( !rangeCorrected ) {
+        rangeCorrected = GeoDataLineStringPrivate::publish( p()->m_rangeCorrected,
+                                                            new GeoDataLineString( toPoleCorrected() ) );
     }
 
-    return *p()->m_rangeCorrected;
+    return *rangeCorrected;
 }
 
 QVector<GeoDataLineString*> GeoDataLineString::toDateLineCorrected() const
@@ -367,28 +628,34 @@ GeoDataLineString GeoDataLineString::toPoleCorrected() const
 void GeoDataLineStringPrivate::toPoleCorrected( const GeoDataLineString& q, GeoDataLineString& poleCorrected )
 {
     poleCorrected.setTessellationFlags( q.tessellationFlags() );
+    poleCorrected.setCompactStorage( m_compact );
+
+    const int count = size();
+    if ( count == 0 ) {
+        return;
+    }
+
+    const GeoDataCoordinates firstCoords = coordinatesAt( 0 );
+    const GeoDataCoordinates lastCoords = coordinatesAt( count - 1 );
 
     GeoDataCoordinates previousCoords;
     GeoDataCoordinates currentCoords;
 
     if ( q.isClosed() ) {
-        if ( !( m_vector.first().isPole() ) &&
-              ( m_vector.last().isPole() ) ) {
-                qreal firstLongitude = ( m_vector.first() ).longitude();
-                GeoDataCoordinates modifiedCoords( m_vector.last() );
+        if ( !( firstCoords.isPole() ) &&
+              ( lastCoords.isPole() ) ) {
+                qreal firstLongitude = firstCoords.longitude();
+                GeoDataCoordinates modifiedCoords( lastCoords );
                 modifiedCoords.setLongitude( firstLongitude );
                 poleCorrected << modifiedCoords;
         }
     }
 
-    QVector<GeoDataCoordinates>::const_iterator itCoords = m_vector.constBegin();
-    QVector<GeoDataCoordinates>::const_iterator itEnd = m_vector.constEnd();
+    for( int i = 0; i < count; ++i ) {
 
-    for( ; itCoords != itEnd; ++itCoords ) {
+        currentCoords  = coordinatesAt( i );
 
-        currentCoords  = *itCoords;
-
-        if ( itCoords == m_vector.constBegin() ) {
+        if ( i == 0 ) {
             previousCoords = currentCoords;
         }
 
@@ -420,10 +687,10 @@ void GeoDataLineStringPrivate::toPoleCorrected( const GeoDataLineString& q, GeoD
     }
 
     if ( q.isClosed() ) {
-        if (  ( m_vector.first().isPole() ) &&
-             !( m_vector.last().isPole() ) ) {
-                qreal lastLongitude = ( m_vector.last() ).longitude();
-                GeoDataCoordinates modifiedCoords( m_vector.first() );
+        if (  ( firstCoords.isPole() ) &&
+             !( lastCoords.isPole() ) ) {
+                qreal lastLongitude = lastCoords.longitude();
+                GeoDataCoordinates modifiedCoords( firstCoords );
                 modifiedCoords.setLongitude( lastLongitude );
                 poleCorrected << modifiedCoords;
         }
@@ -436,11 +703,7 @@ void GeoDataLineStringPrivate::toDateLineCorrected(
                            )
 {
     const bool isClosed = q.isClosed();
-
-    const QVector<GeoDataCoordinates>::const_iterator itStartPoint = q.constBegin();
-    const QVector<GeoDataCoordinates>::const_iterator itEndPoint = q.constEnd();
-    QVector<GeoDataCoordinates>::const_iterator itPoint = itStartPoint;
-    QVector<GeoDataCoordinates>::const_iterator itPreviousPoint = itPoint;
+    const int count = size();
 
     TessellationFlags f = q.tessellationFlags();
 
@@ -455,12 +718,15 @@ void GeoDataLineStringPrivate::toDateLineCorrected(
 
     bool unfinished = false;
 
-    for (; itPoint != itEndPoint; ++itPoint ) {
-        currentLon = itPoint->longitude();
+    GeoDataCoordinates previousPoint;
+
+    for ( int i = 0; i < count; ++i ) {
+        const GeoDataCoordinates point = coordinatesAt( i );
+        currentLon = point.longitude();
 
         int currentSign = ( currentLon < 0.0 ) ? -1 : +1 ;
 
-        if( itPoint == q.constBegin() ) {
+        if( i == 0 ) {
             previousSign = currentSign;
             previousLon  = currentLon;
         }
@@ -473,7 +739,7 @@ void GeoDataLineStringPrivate::toDateLineCorrected(
             GeoDataCoordinates previousTemp;
             GeoDataCoordinates currentTemp;
 
-            interpolateDateLine( *itPreviousPoint, *itPoint,
+            interpolateDateLine( previousPoint, point,
                                  previousTemp, currentTemp, q.tessellationFlags() );
 
             *dateLineCorrected << previousTemp;
@@ -507,16 +773,16 @@ void GeoDataLineStringPrivate::toDateLineCorrected(
             }
 
             *dateLineCorrected << currentTemp;
-            *dateLineCorrected << *itPoint;
+            *dateLineCorrected << point;
 
         }
         else {
-            *dateLineCorrected << *itPoint;
+            *dateLineCorrected << point;
         }
 
         previousSign = currentSign;
         previousLon  = currentLon;
-        itPreviousPoint = itPoint;
+        previousPoint = point;
     }
 
     // If the line string doesn't cross the dateline an even number of times
@@ -532,15 +798,16 @@ void GeoDataLineStringPrivate::toDateLineCorrected(
 const GeoDataLatLonAltBox& GeoDataLineString::latLonAltBox() const
 {
     // GeoDataLatLonAltBox::fromLineString is very expensive
-    // that's why we recreate it only if the m_dirtyBox
-    // is TRUE.
+    // that's why we recreate it only after the nodes
+    // have changed.
     // DO NOT REMOVE THIS CONSTRUCT OR MARBLE WILL BE SLOW.
-    if ( p()->m_dirtyBox ) {
-        p()->m_latLonAltBox = GeoDataLatLonAltBox::fromLineString( *this );
+    GeoDataLatLonAltBox *box = GeoDataLineStringPrivate::cached( p()->m_boundingBox );
+    if ( !box ) {
+        box = GeoDataLineStringPrivate::publish( p()->m_boundingBox,
+                                                 new GeoDataLatLonAltBox( GeoDataLatLonAltBox::fromLineString( *this ) ) );
     }
-    p()->m_dirtyBox = false;
 
-    return p()->m_latLonAltBox;
+    return *box;
 }
 
 qreal GeoDataLineString::length( qreal planetRadius, int offset ) const
@@ -550,12 +817,15 @@ qreal GeoDataLineString::length( qreal planetRadius, int offset ) const
     }
 
     qreal length = 0.0;
-    QVector<GeoDataCoordinates> const & vector = p()->m_vector;
+    const QVector<qreal> longitudeVector = longitudes();
+    const QVector<qreal> latitudeVector = latitudes();
+    const qreal *lons = longitudeVector.constData();
+    const qreal *lats = latitudeVector.constData();
     int const start = qMax(offset+1, 1);
-    int const end = p()->m_vector.size();
+    int const end = size();
     for( int i=start; i<end; ++i )
     {
-        length += distanceSphere( vector[i-1], vector[i] );
+        length += distanceSphere( lons[i-1], lats[i-1], lons[i], lats[i] );
     }
 
     return planetRadius * length;
@@ -565,10 +835,8 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( QVector<GeoData
 {
     GeoDataGeometry::detach();
     GeoDataLineStringPrivate* d = p();
-    delete d->m_rangeCorrected;
-    d->m_rangeCorrected = 0;
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
+    d->expand();
+    d->invalidate();
     return d->m_vector.erase( pos );
 }
 
@@ -577,10 +845,8 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( QVector<GeoData
 {
     GeoDataGeometry::detach();
     GeoDataLineStringPrivate* d = p();
-    delete d->m_rangeCorrected;
-    d->m_rangeCorrected = 0;
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
+    d->expand();
+    d->invalidate();
     return d->m_vector.erase( begin, end );
 }
 
@@ -588,8 +854,8 @@ void GeoDataLineString::remove ( int i )
 {
     GeoDataGeometry::detach();
     GeoDataLineStringPrivate* d = p();
-    d->m_dirtyRange = true;
-    d->m_dirtyBox = true;
+    d->expand();
+    d->invalidate();
     d->m_vector.remove( i );
 }
 
@@ -600,12 +866,9 @@ void GeoDataLineString::pack( QDataStream& stream ) const
     stream << size();
     stream << (qint32)(p()->m_tessellationFlags);
 
-    for( QVector<GeoDataCoordinates>::const_iterator iterator
-          = p()->m_vector.constBegin();
-         iterator != p()->m_vector.constEnd();
-         ++iterator ) {
-        mDebug() << "innerRing: size" << p()->m_vector.size();
-        GeoDataCoordinates coord = ( *iterator );
+    const int count = size();
+    for( int i = 0; i < count; ++i ) {
+        GeoDataCoordinates coord = p()->coordinatesAt( i );
         coord.pack( stream );
     }
 
@@ -621,12 +884,18 @@ void GeoDataLineString::unpack( QDataStream& stream )
     stream >> size;
     stream >> tessellationFlags;
 
-    p()->m_tessellationFlags = (TessellationFlags)(tessellationFlags);
+    GeoDataLineStringPrivate* d = p();
+    d->m_tessellationFlags = (TessellationFlags)(tessellationFlags);
+    d->invalidate();
 
     for(qint32 i = 0; i < size; i++ ) {
         GeoDataCoordinates coord;
         coord.unpack( stream );
-        p()->m_vector.append( coord );
+        if ( d->m_compact ) {
+            d->appendCompact( coord );
+        } else {
+            d->m_vector.append( coord );
+        }
     }
 }
 
@@ -202,6 +202,71 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 
 
 
+/*!
+    \brief Returns a number that changes whenever the nodes get modified.
+
+    Caches of data derived from the nodes can compare it to find out whether
+    they are outdated. Copies of a LineString share the revision until one
+    of them is modified.
+*/
+    int revision() const;
+
+
+/*!
+    \brief Sets whether the nodes of the LineString are stored in compact form.
+
+    In compact mode the longitude, latitude, altitude and detail level of
+    the nodes are kept in flat arrays instead of one GeoDataCoordinates object
+    per node. This reduces the memory footprint of large line strings (like
+    coastlines or country borders) considerably.
+
+    The non-const methods that hand out references or iterators to
+    GeoDataCoordinates objects (at(), first(), begin(), ...) convert the
+    LineString back to the regular storage. Their const counterparts return
+    copies of the nodes and keep the compact storage, except for constBegin()
+    and constEnd(), which need a copy of all nodes as GeoDataCoordinates
+    objects. Code that deals with large line strings should therefore prefer
+    size(), coordinatesAt() and the flat accessors like longitudes().
+*/
+    void setCompactStorage( bool compact );
+
+
+/*!
+    \brief Returns whether the nodes of the LineString are stored in compact form.
+*/
+    bool hasCompactStorage() const;
+
+
+/*!
+    \brief Returns the longitudes of all nodes in radian as a flat array.
+
+    The array holds size() values. A LineString with compact storage shares
+    its array with the result, otherwise it gets built on each call.
+*/
+    QVector<qreal> longitudes() const;
+
+
+/*!
+    \brief Returns the latitudes of all nodes in radian as a flat array.
+    \see longitudes()
+*/
+    QVector<qreal> latitudes() const;
+
+
+/*!
+    \brief Returns the altitudes of all nodes in meters as a flat array.
+    \see longitudes()
+*/
+    QVector<qreal> altitudes() const;
+
+
+/*!
+    \brief Returns the detail levels of all nodes as a flat array.
+    \see longitudes()
+*/
+    QVector<int> details() const;
+
+
     // "Reimplementation" of QVector API
 /*!
     \brief Returns whether the LineString has no nodes at all.
@@ -225,10 +290,18 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 
 
 /*!
-    \brief Returns a reference to the coordinates of a node at a given position.
+    \brief Returns a copy of the coordinates of a node at a given position.
     This method does not detach the returned coordinate object from the line string.
 */
-    const GeoDataCoordinates& at( int pos ) const;
+    GeoDataCoordinates at( int pos ) const;
+
+
+/*!
+    \brief Returns a copy of the coordinates of a node at a given position.
+    Same as the const at(), but also available to non-const LineStrings
+    without converting a LineString with compact storage.
+*/
+    GeoDataCoordinates coordinatesAt( int pos ) const;
 
 
 /*!
@@ -239,10 +312,10 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 
 
 /*!
-    \brief Returns a reference to the coordinates of a node at a given position.
+    \brief Returns a copy of the coordinates of a node at a given position.
     This method does not detach the returned coordinate object from the line string.
 */
-    const GeoDataCoordinates& operator[]( int pos ) const;
+    GeoDataCoordinates operator[]( int pos ) const;
 
 
 /*!
@@ -253,10 +326,10 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 
 
 /*!
-    \brief Returns a reference to the first node in the LineString.
+    \brief Returns a copy of the first node in the LineString.
     This method does not detach the returned coordinate object from the line string.
 */
-    const GeoDataCoordinates& first() const;
+    GeoDataCoordinates first() const;
 
 
 /*!
@@ -267,10 +340,10 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
 
 
 /*!
-    \brief Returns a reference to the last node in the LineString.
+    \brief Returns a copy of the last node in the LineString.
     This method does not detach the returned coordinate object from the line string.
 */
-    const GeoDataCoordinates& last() const;
+    GeoDataCoordinates last() const;
 
 
 /*!
@@ -291,6 +364,13 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     GeoDataLineString& operator << ( const GeoDataLineString& lineString );
 
 
+/*!
+    \brief Reserves memory for at least @p size nodes.
+    Use this before appending a known number of nodes to avoid reallocations.
+*/
+    void reserve( int size );
+
+
 /*!
     \brief Returns an iterator that points to the begin of the LineString.
 */
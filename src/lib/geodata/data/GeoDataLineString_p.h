@@ -11,8 +11,14 @@
 #ifndef MARBLE_GEODATALINESTRINGPRIVATE_H
 #define MARBLE_GEODATALINESTRINGPRIVATE_H
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
+
 #include "GeoDataGeometry_p.h"
 
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
+
 #include "GeoDataTypes.h"
 
 namespace Marble
@@ -23,33 +29,45 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
   public:
     GeoDataLineStringPrivate( TessellationFlags f )
         :  m_rangeCorrected( 0 ),
-           m_dirtyRange( true ),
-           m_dirtyBox( true ),
-           m_tessellationFlags( f )
+           m_boundingBox( 0 ),
+           m_tessellationFlags( f ),
+           m_compact( false ),
+           m_compactVector( 0 ),
+           m_edgeIndex( 0 ),
+           m_containsCount( 0 ),
+           m_revision( s_revisionCounter.fetchAndAddRelaxed( 1 ) )
     {
     }
 
     GeoDataLineStringPrivate()
          : m_rangeCorrected( 0 ),
-           m_dirtyRange( true ),
-           m_dirtyBox( true )
+           m_boundingBox( 0 ),
+           m_compact( false ),
+           m_compactVector( 0 ),
+           m_edgeIndex( 0 ),
+           m_containsCount( 0 ),
+           m_revision( s_revisionCounter.fetchAndAddRelaxed( 1 ) )
     {
     }
 
     ~GeoDataLineStringPrivate()
     {
-        delete m_rangeCorrected;
+        clearCaches();
     }
 
     void operator=( const GeoDataLineStringPrivate &other)
     {
         GeoDataGeometryPrivate::operator=( other );
+        clearCaches();
         m_vector = other.m_vector;
-        m_rangeCorrected = 0;
-        m_dirtyRange = true;
-        m_latLonAltBox = other.m_latLonAltBox;
-        m_dirtyBox = other.m_dirtyBox;
         m_tessellationFlags = other.m_tessellationFlags;
+        m_compact = other.m_compact;
+        m_longitudes = other.m_longitudes;
+        m_latitudes = other.m_latitudes;
+        m_altitudes = other.m_altitudes;
+        m_details = other.m_details;
+        m_containsCount = 0;
+        m_revision = other.m_revision;
     }
 
 
@@ -85,15 +103,138 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
                        const GeoDataCoordinates & currentCoords,
                        int recursionCounter );
 
+    /**
+     * Returns the number of nodes, regardless of the storage mode.
+     */
+    int size() const
+    {
+        return m_compact ? m_longitudes.size() : m_vector.size();
+    }
+
+    /**
+     * Returns a copy of the node at position @p i, regardless of the storage mode.
+     */
+    GeoDataCoordinates coordinatesAt( int i ) const
+    {
+        if ( !m_compact ) {
+            return m_vector.at( i );
+        }
+        return GeoDataCoordinates( m_longitudes.at( i ), m_latitudes.at( i ), m_altitudes.at( i ),
+                                   GeoDataCoordinates::Radian, m_details.at( i ) );
+    }
+
+    void appendCompact( const GeoDataCoordinates &coordinates );
+
+    // Converts the compact arrays into GeoDataCoordinates objects and leaves the compact mode.
+    void expand();
+
+    // Returns the nodes as GeoDataCoordinates objects without leaving the compact mode.
+    const QVector<GeoDataCoordinates> &vector();
+
+    /**
+     * The edges of a ring grouped by the equally wide longitude slices they
+     * span, so that GeoDataLinearRing::contains() only tests the edges of one
+     * slice. Bucket b holds the indices edges[offsets[b]] up to
+     * edges[offsets[b+1]] of the edges' end nodes. A ring with too many long
+     * edges gets no buckets at all.
+     */
+    struct EdgeIndex
+    {
+        int bucket( qreal lon ) const
+        {
+            const int last = offsets.size() - 2;
+            return qBound( 0, int( ( lon - west ) / width ), last );
+        }
+
+        // The nodes, shared with the arrays of a compact ring
+        QVector<qreal> longitudes;
+        QVector<qreal> latitudes;
+
+        QVector<int> offsets;
+        QVector<int> edges;
+        qreal west;
+        qreal width;
+    };
+
+    // Returns the edge index, or 0 if the ring has too many long edges to be indexed.
+    const EdgeIndex *edgeIndex();
+
+    // Marks all cached data derived from the nodes as outdated.
+    void invalidate()
+    {
+        clearCaches();
+        m_revision = s_revisionCounter.fetchAndAddRelaxed( 1 );
+    }
+
+    void clearCaches()
+    {
+        delete m_rangeCorrected.fetchAndStoreRelaxed( 0 );
+        delete m_boundingBox.fetchAndStoreRelaxed( 0 );
+        delete m_compactVector.fetchAndStoreRelaxed( 0 );
+        delete m_edgeIndex.fetchAndStoreRelaxed( 0 );
+    }
+
+    /**
+     * Returns the cache stored in @p cache, or 0 if it hasn't been built yet.
+     * The const methods build the caches lazily while several threads may
+     * read the line string. The acquire makes the cache built by another
+     * thread visible to this one.
+     */
+    template<typename T>
+    static T *cached( QAtomicPointer<T> &cache )
+    {
+        return cache.fetchAndAddAcquire( 0 );
+    }
+
+    /**
+     * Stores the @p built cache, unless another thread was faster. Returns
+     * the cache that is stored in the end. The caches get built without any
+     * lock, so two threads may build the same one at worst.
+     */
+    template<typename T>
+    static T *publish( QAtomicPointer<T> &cache, T *built )
+    {
+        if ( cache.testAndSetOrdered( 0, built ) ) {
+            return built;
+        }
+
+        delete built;
+        return cached( cache );
+    }
+
+    // Hands out the revisions, so that no two line strings with different
+    // nodes share one
+    static QAtomicInt s_revisionCounter;
+
+    // The edge buckets may hold this many entries per node at most
+    static const int maximumEdgeBucketEntries = 8;
+
     QVector<GeoDataCoordinates> m_vector;
 
-    GeoDataLineString*          m_rangeCorrected;
-    bool                        m_dirtyRange;
+    // The lazily built caches, see cached() and publish()
+    QAtomicPointer<GeoDataLineString>   m_rangeCorrected;
+    QAtomicPointer<GeoDataLatLonAltBox> m_boundingBox;
 
-    bool                        m_dirtyBox; // tells whether there have been changes to the
-                                            // GeoDataPoints since the LatLonAltBox has 
-                                            // been calculated. Saves performance. 
     TessellationFlags           m_tessellationFlags;
+
+    // In compact mode the nodes live in the flat arrays below, and m_vector
+    // stays empty. The arrays are empty otherwise.
+    bool                        m_compact;
+    QVector<qreal>              m_longitudes;
+    QVector<qreal>              m_latitudes;
+    QVector<qreal>              m_altitudes;
+    QVector<int>                m_details;
+
+    // The nodes of a compact line string as GeoDataCoordinates objects, only
+    // built for constBegin() and constEnd()
+    QAtomicPointer<QVector<GeoDataCoordinates> > m_compactVector;
+
+    QAtomicPointer<EdgeIndex>   m_edgeIndex;
+    // The edges only get indexed for rings that are queried repeatedly. The
+    // count is raised by const methods running in several threads at once.
+    QAtomicInt                  m_containsCount;
+
+    int                         m_revision;
 };
 
 } // namespace Marble
@@ -18,6 +18,10 @@
 namespace Marble
 {
 
+// Rings need some nodes and some queries before indexing their edges pays off
+static const int minimumIndexedSize = 32;
+static const int minimumIndexedQueries = 4;
+
 GeoDataLinearRing::GeoDataLinearRing( TessellationFlags f )
     : GeoDataLineString( new GeoDataLinearRingPrivate( f ) )
 {
@@ -41,21 +45,26 @@ qreal GeoDataLinearRing::length( qreal planetRadius, int offset ) const
 {
     qreal  length = GeoDataLineString::length( planetRadius, offset );
 
-    return length + planetRadius * distanceSphere( last(), first() );
+    const int last = size() - 1;
+    if ( last < 0 ) {
+        return length;
+    }
+
+    const GeoDataCoordinates firstNode = coordinatesAt( 0 );
+    const GeoDataCoordinates lastNode = coordinatesAt( last );
+    return length + planetRadius * distanceSphere( lastNode.longitude(), lastNode.latitude(),
+                                                   firstNode.longitude(), firstNode.latitude() );
 }
 
 GeoDataLineString GeoDataLinearRing::toRangeCorrected() const
 {
-    if ( p()->m_dirtyRange ) {
-
-        delete p()->m_rangeCorrected;
-
-        GeoDataLinearRing poleCorrected = toPoleCorrected();
-        p()->m_rangeCorrected = new GeoDataLinearRing( poleCorrected );
-        p()->m_dirtyRange = false;
+    GeoDataLineString *rangeCorrected = GeoDataLineStringPrivate::cached( p()->m_rangeCorrected );
+    if ( !rangeCorrected ) {
+        rangeCorrected = GeoDataLineStringPrivate::publish( p()->m_rangeCorrected,
+                                                            static_cast<GeoDataLineString*>( new GeoDataLinearRing( toPoleCorrected() ) ) );
     }
 
-    return *p()->m_rangeCorrected;
+    return *rangeCorrected;
 }
 
 bool GeoDataLinearRing::contains( const GeoDataCoordinates &coordinates ) const
@@ -67,15 +76,50 @@ bool GeoDataLinearRing::contains( const GeoDataCoordinates &coordinates ) const
 
     int const points = size();
     bool inside = false; // also true for points = 0
-    int j = points - 1;
 
-    for ( int i=0; i<points; ++i ) {
-        GeoDataCoordinates const & one = at( i );
-        GeoDataCoordinates const & two = at( j );
+    const qreal lon = coordinates.longitude();
+    const qreal lat = coordinates.latitude();
+
+    GeoDataLineStringPrivate *const d = p();
+    bool isIndexed = points >= minimumIndexedSize;
+    if ( isIndexed && d->m_containsCount < minimumIndexedQueries ) {
+        isIndexed = d->m_containsCount.fetchAndAddRelaxed( 1 ) + 1 >= minimumIndexedQueries;
+    }
 
-        if ( ( one.longitude() < coordinates.longitude() && two.longitude() >= coordinates.longitude() ) ||
-             ( two.longitude() < coordinates.longitude() && one.longitude() >= coordinates.longitude() ) ) {
-            if ( one.latitude() + ( coordinates.longitude() - one.longitude()) / ( two.longitude() - one.longitude()) * ( two.latitude()-one.latitude() ) < coordinates.latitude() ) {
+    // The index gets built once, and only changes along with the nodes
+    const GeoDataLineStringPrivate::EdgeIndex *const index = isIndexed ? d->edgeIndex() : 0;
+    if ( index ) {
+        const qreal *lons = index->longitudes.constData();
+        const qreal *lats = index->latitudes.constData();
+
+        // Only the edges spanning the longitude can be crossed
+        const int bucket = index->bucket( lon );
+        const int *edge = index->edges.constData() + index->offsets.at( bucket );
+        const int *const end = index->edges.constData() + index->offsets.at( bucket + 1 );
+        for ( ; edge != end; ++edge ) {
+            const int i = *edge;
+            const int j = i > 0 ? i - 1 : points - 1;
+            if ( ( lons[i] < lon && lons[j] >= lon ) ||
+                 ( lons[j] < lon && lons[i] >= lon ) ) {
+                if ( lats[i] + ( lon - lons[i] ) / ( lons[j] - lons[i] ) * ( lats[j] - lats[i] ) < lat ) {
+                    inside = !inside;
+                }
+            }
+        }
+
+        return inside;
+    }
+
+    const QVector<qreal> longitudeVector = longitudes();
+    const QVector<qreal> latitudeVector = latitudes();
+    const qreal *lons = longitudeVector.constData();
+    const qreal *lats = latitudeVector.constData();
+
+    int j = points - 1;
+    for ( int i=0; i<points; ++i ) {
+        if ( ( lons[i] < lon && lons[j] >= lon ) ||
+             ( lons[j] < lon && lons[i] >= lon ) ) {
+            if ( lats[i] + ( lon - lons[i] ) / ( lons[j] - lons[i] ) * ( lats[j] - lats[i] ) < lat ) {
                 inside = !inside;
             }
         }
@@ -16,6 +16,8 @@
 #include "GeoDataLinearRing.h"
 #include "GeoDataPoint.h"
 #include "GeoDataPolygon.h"
+#include "GeoDataMultiTrack.h"
+#include "GeoDataTrack.h"
 
 #include "MarbleDebug.h"
 
@@ -238,35 +240,49 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
                 {
                 GeoDataPoint *point = new GeoDataPoint;
                 point->unpack( stream );
-                p()->m_vector.append( point );
+                append( point );
                 }
                 break;
             case GeoDataLineStringId:
                 {
                 GeoDataLineString *lineString = new GeoDataLineString;
                 lineString->unpack( stream );
-                p()->m_vector.append( lineString );
+                append( lineString );
                 }
                 break;
             case GeoDataLinearRingId:
                 {
                 GeoDataLinearRing *linearRing = new GeoDataLinearRing;
                 linearRing->unpack( stream );
-                p()->m_vector.append( linearRing );
+                append( linearRing );
                 }
                 break;
             case GeoDataPolygonId:
                 {
                 GeoDataPolygon *polygon = new GeoDataPolygon;
                 polygon->unpack( stream );
-                p()->m_vector.append( polygon );
+                append( polygon );
                 }
                 break;
             case GeoDataMultiGeometryId:
                 {
                 GeoDataMultiGeometry *multiGeometry = new GeoDataMultiGeometry;
                 multiGeometry->unpack( stream );
-                p()->m_vector.append( multiGeometry );
+                append( multiGeometry );
+                }
+                break;
+            case GeoDataTrackId:
+                {
+                GeoDataTrack *track = new GeoDataTrack;
+                track->unpack( stream );
+                append( track );
+                }
+                break;
+            case GeoDataMultiTrackId:
+                {
+                GeoDataMultiTrack *multiTrack = new GeoDataMultiTrack;
+                multiTrack->unpack( stream );
+                append( multiTrack );
                 }
                 break;
             case GeoDataModelId:
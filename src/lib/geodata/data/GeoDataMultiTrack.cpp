@@ -238,7 +238,7 @@ void GeoDataMultiTrack::unpack( QDataStream& stream )
                 {
                 GeoDataTrack *track = new GeoDataTrack;
                 track->unpack( stream );
-                p()->m_vector.append( track );
+                append( track );
                 }
                 break;
             case GeoDataModelId:
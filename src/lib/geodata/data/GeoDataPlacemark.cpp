@@ -18,6 +18,7 @@
 #include "GeoDataPlacemark_p.h"
 
 #include "GeoDataMultiGeometry.h"
+#include "GeoDataMultiTrack.h"
 #include "GeoDataCoordinates.h"
 
 // Qt
@@ -270,10 +271,30 @@ void GeoDataPlacemark::unpack( QDataStream& stream )
             p()->m_geometry = multiGeometry;
             }
             break;
+        case GeoDataTrackId:
+            {
+            GeoDataTrack* track = new GeoDataTrack;
+            track->unpack( stream );
+            delete p()->m_geometry;
+            p()->m_geometry = track;
+            }
+            break;
+        case GeoDataMultiTrackId:
+            {
+            GeoDataMultiTrack* multiTrack = new GeoDataMultiTrack;
+            multiTrack->unpack( stream );
+            delete p()->m_geometry;
+            p()->m_geometry = multiTrack;
+            }
+            break;
         case GeoDataModelId:
             break;
         default: break;
     };
+
+    if ( p()->m_geometry ) {
+        p()->m_geometry->setParent( this );
+    }
 }
 
 }
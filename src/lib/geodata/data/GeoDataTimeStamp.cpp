@@ -75,6 +75,7 @@ void GeoDataTimeStamp::pack( QDataStream& stream ) const
     GeoDataTimePrimitive::pack( stream );
 
     stream << d->m_when;
+    stream << int( d->m_resolution );
 }
 
 void GeoDataTimeStamp::unpack( QDataStream& stream )
@@ -82,6 +83,9 @@ void GeoDataTimeStamp::unpack( QDataStream& stream )
     GeoDataTimePrimitive::unpack( stream );
 
     stream >> d->m_when;
+    int resolution;
+    stream >> resolution;
+    d->m_resolution = GeoDataTimeStamp::TimeResolution( resolution );
 }
 
 }
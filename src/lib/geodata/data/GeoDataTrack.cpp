@@ -12,27 +12,140 @@
 
 #include "GeoDataLatLonAltBox.h"
 #include "GeoDataTypes.h"
-#include "MarbleDebug.h"
 #include "Quaternion.h"
 
 #include "GeoDataLineString.h"
 
-#include <QtCore/QMap>
-#include <QtCore/QLinkedList>
+#include <QtCore/QDataStream>
+#include <QtCore/QVector>
+#include <QtCore/QtAlgorithms>
 #include "GeoDataExtendedData.h"
 
 namespace Marble {
 
+/**
+ * One timed point of the track in a compact, sorted layout used for lookups
+ * by time. @p index refers back to the position in the public point lists.
+ */
+struct TrackPoint
+{
+    qint64 when;
+    qreal lon;
+    qreal lat;
+    qreal alt;
+    int index;
+};
+
+static bool operator<( const TrackPoint &point, qint64 when )
+{
+    return point.when < when;
+}
+
+static bool operator<( qint64 when, const TrackPoint &point )
+{
+    return when < point.when;
+}
+
+static bool lessThanWhen( const TrackPoint &a, const TrackPoint &b )
+{
+    return a.when < b.when;
+}
+
+static qint64 toMSecs( const QDateTime &dateTime )
+{
+#if QT_VERSION < 0x040700
+    return qint64( dateTime.toTime_t() ) * 1000 + dateTime.time().msec();
+#else
+    return dateTime.toMSecsSinceEpoch();
+#endif
+}
+
 class GeoDataTrackPrivate
 {
 public:
     GeoDataTrackPrivate()
         : m_lineString( new GeoDataLineString() ),
           m_lineStringNeedsUpdate( false ),
+          m_pointsNeedUpdate( false ),
           m_interpolate( false )
     {
     }
 
+    /**
+     * Rebuilds the time sorted point index from m_when and m_coordinates.
+     * Points without a valid time value are skipped. The sort is stable, so
+     * points sharing a time value keep their order of insertion.
+     */
+    void updatePoints()
+    {
+        if ( !m_pointsNeedUpdate ) {
+            return;
+        }
+
+        const int size = qMin( m_when.size(), m_coordinates.size() );
+        m_points.clear();
+        m_points.reserve( size );
+
+        bool sorted = true;
+        for ( int i = 0; i < size; ++i ) {
+            const QDateTime &when = m_when.at( i );
+            if ( !when.isValid() ) {
+                continue;
+            }
+
+            const GeoDataCoordinates &coordinates = m_coordinates.at( i );
+            TrackPoint point;
+            point.when = toMSecs( when );
+            coordinates.geoCoordinates( point.lon, point.lat, point.alt );
+            point.index = i;
+
+            sorted = sorted && ( m_points.isEmpty() || !( point.when < m_points.last().when ) );
+            m_points.append( point );
+        }
+
+        if ( !sorted ) {
+            qStableSort( m_points.begin(), m_points.end(), lessThanWhen );
+        }
+
+        m_pointsNeedUpdate = false;
+    }
+
+    /**
+     * Returns the coordinates at time @p when, given the position @p next of the
+     * first point in m_points whose time value is not less than @p when.
+     */
+    GeoDataCoordinates coordinatesAt( int next, qint64 when ) const
+    {
+        if ( next < m_points.size() && m_points.at( next ).when == when ) {
+            // exact match found
+            return m_coordinates.at( m_points.at( next ).index );
+        }
+
+        if ( !m_interpolate ) {
+            return GeoDataCoordinates();
+        }
+
+        // No tracked point happened before or after "when"
+        if ( next == 0 || next == m_points.size() ) {
+            return GeoDataCoordinates();
+        }
+
+        const TrackPoint &previousPoint = m_points.at( next - 1 );
+        const TrackPoint &nextPoint = m_points.at( next );
+
+        const qreal t = qreal( when - previousPoint.when ) / qreal( nextPoint.when - previousPoint.when );
+
+        const Quaternion interpolated = Quaternion::slerp( Quaternion::fromSpherical( previousPoint.lon, previousPoint.lat ),
+                                                           Quaternion::fromSpherical( nextPoint.lon, nextPoint.lat ),
+                                                           t );
+        qreal lon, lat;
+        interpolated.getSpherical( lon, lat );
+
+        const qreal alt = previousPoint.alt + ( nextPoint.alt - previousPoint.alt ) * t;
+
+        return GeoDataCoordinates( lon, lat, alt );
+    }
+
     void equalizeWhenSize()
     {
         while ( m_when.size() < m_coordinates.size() ) {
@@ -47,6 +160,9 @@ public:
     QList<QDateTime> m_when;
     QList<GeoDataCoordinates> m_coordinates;
 
+    QVector<TrackPoint> m_points;
+    bool m_pointsNeedUpdate;
+
     GeoDataExtendedData m_extendedData;
 
     bool m_interpolate;
@@ -113,58 +229,70 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
         return GeoDataCoordinates();
     }
 
-    if ( d->m_when.contains( when ) ) {
-        //exact match found
-        int index = d->m_when.indexOf( when );
-        if ( index < d->m_coordinates.size() ) {
+    if ( !when.isValid() ) {
+        // only points without time information can match
+        const int index = d->m_when.indexOf( when );
+        if ( index >= 0 && index < d->m_coordinates.size() ) {
             return d->m_coordinates.at( index );
         }
-    }
-
-    if ( !interpolate() ) {
         return GeoDataCoordinates();
     }
 
-    typedef QMap<QDateTime, GeoDataCoordinates> PointMap;
-    PointMap pointMap;
-    for ( int i = 0; i < qMin( d->m_when.size(), d->m_coordinates.size() ); ++i) {
-        if ( d->m_when.at( i ).isValid() ) {
-            pointMap[ d->m_when.at( i ) ] = d->m_coordinates.at( i );
-        }
-    }
+    d->updatePoints();
 
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator nextEntry = const_cast<const PointMap&>(pointMap).upperBound( when );
+    const qint64 msecs = toMSecs( when );
+    const QVector<TrackPoint>::const_iterator next = qLowerBound( d->m_points.constBegin(), d->m_points.constEnd(), msecs );
 
-    // No tracked point happened before "when"
-    if ( nextEntry == pointMap.constBegin() ) {
-        mDebug() << "No tracked point before " << when;
-        return GeoDataCoordinates();
+    return d->coordinatesAt( next - d->m_points.constBegin(), msecs );
+}
+
+QVector<GeoDataCoordinates> GeoDataTrack::coordinatesAt( const QVector<QDateTime> &when ) const
+{
+    QVector<GeoDataCoordinates> result;
+    result.reserve( when.size() );
+
+    if ( d->m_when.isEmpty() ) {
+        result.fill( GeoDataCoordinates(), when.size() );
+        return result;
     }
 
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator previousEntry = nextEntry - 1;
-    GeoDataCoordinates previousCoord = previousEntry.value();
+    d->updatePoints();
+
+    const QVector<TrackPoint>::const_iterator begin = d->m_points.constBegin();
+    const QVector<TrackPoint>::const_iterator end = d->m_points.constEnd();
 
-    QDateTime previousWhen = previousEntry.key();
-    QDateTime nextWhen = nextEntry.key();
-    GeoDataCoordinates nextCoord = nextEntry.value();
+    // Playback samples are usually ascending and close to each other, so walk
+    // forward from the previous position and only fall back to a binary search
+    // for jumps.
+    static const int maxLinearSteps = 8;
+    QVector<TrackPoint>::const_iterator next = begin;
+    qint64 previousMSecs = 0;
+
+    foreach ( const QDateTime &dateTime, when ) {
+        if ( !dateTime.isValid() ) {
+            result.append( coordinatesAt( dateTime ) );
+            continue;
+        }
 
-#if QT_VERSION < 0x040700	
-    int interval = 1000 * previousWhen.secsTo( nextWhen );
-    int position = 1000 * previousWhen.secsTo( when );
-#else	
-    int interval = previousWhen.msecsTo( nextWhen );
-    int position = previousWhen.msecsTo( when );
-#endif	
-    qreal t = (qreal)position / (qreal)interval;
+        const qint64 msecs = toMSecs( dateTime );
+        if ( msecs < previousMSecs ) {
+            next = begin;
+        }
+        previousMSecs = msecs;
 
-    Quaternion interpolated;
-    interpolated.slerp( previousCoord.quaternion(), nextCoord.quaternion(), t );
-    qreal lon, lat;
-    interpolated.getSpherical( lon, lat );
+        int steps = 0;
+        while ( next != end && next->when < msecs && steps < maxLinearSteps ) {
+            ++next;
+            ++steps;
+        }
+        if ( steps == maxLinearSteps ) {
+            next = qLowerBound( next, end, msecs );
+        }
 
-    qreal alt = previousCoord.altitude() + ( nextCoord.altitude() - previousCoord.altitude() ) * t;
+        result.append( d->coordinatesAt( next - begin, msecs ) );
+    }
 
-    return GeoDataCoordinates( lon, lat, alt );
+    return result;
 }
 
 GeoDataCoordinates GeoDataTrack::coordinatesAt( int index ) const
@@ -176,27 +304,32 @@ void GeoDataTrack::addPoint( const QDateTime &when, const GeoDataCoordinates &co
 {
     d->equalizeWhenSize();
     d->m_lineStringNeedsUpdate = true;
-    int i=0;
-    while ( i < d->m_when.size() ) {
-        if ( d->m_when.at( i ) > when ) {
-            break;
-        }
-        ++i;
+    d->m_pointsNeedUpdate = true;
+
+    if ( d->m_when.isEmpty() || !( when < d->m_when.last() ) ) {
+        // tracks are usually recorded in chronological order
+        d->m_when.append( when );
+        d->m_coordinates.append( coord );
+        return;
     }
-    d->m_when.insert(i, when );
-    d->m_coordinates.insert(i, coord );
+
+    const int i = qUpperBound( d->m_when.constBegin(), d->m_when.constEnd(), when ) - d->m_when.constBegin();
+    d->m_when.insert( i, when );
+    d->m_coordinates.insert( i, coord );
 }
 
 void GeoDataTrack::appendCoordinates( const GeoDataCoordinates &coord )
 {
     d->equalizeWhenSize();
     d->m_lineStringNeedsUpdate = true;
+    d->m_pointsNeedUpdate = true;
     d->m_coordinates.append( coord );
 }
 
 void GeoDataTrack::appendAltitude( qreal altitude )
 {
     d->m_lineStringNeedsUpdate = true;
+    d->m_pointsNeedUpdate = true;
     Q_ASSERT( !d->m_coordinates.isEmpty() );
     if ( d->m_coordinates.isEmpty() ) return;
     GeoDataCoordinates coordinates = d->m_coordinates.takeLast();
@@ -206,6 +339,7 @@ void GeoDataTrack::appendAltitude( qreal altitude )
 
 void GeoDataTrack::appendWhen( const QDateTime &when )
 {
+    d->m_pointsNeedUpdate = true;
     d->m_when.append( when );
 }
 
@@ -214,6 +348,7 @@ void GeoDataTrack::clear()
     d->m_when.clear();
     d->m_coordinates.clear();
     d->m_lineStringNeedsUpdate = true;
+    d->m_pointsNeedUpdate = true;
 }
 
 void GeoDataTrack::removeBefore( const QDateTime &when )
@@ -223,6 +358,7 @@ void GeoDataTrack::removeBefore( const QDateTime &when )
         return;
     }
     d->equalizeWhenSize();
+    d->m_pointsNeedUpdate = true;
 
     while ( !d->m_when.isEmpty() && d->m_when.first() < when ) {
         d->m_when.takeFirst();
@@ -237,6 +373,8 @@ void GeoDataTrack::removeAfter( const QDateTime &when )
         return;
     }
     d->equalizeWhenSize();
+    d->m_pointsNeedUpdate = true;
+
     while ( !d->m_when.isEmpty() && d->m_when.last() > when ) {
         d->m_when.takeLast();
         d->m_coordinates.takeLast();
@@ -282,15 +420,37 @@ const GeoDataLatLonAltBox& GeoDataTrack::latLonAltBox() const
     return lineString()->latLonAltBox();
 }
 
-//TODO
 void GeoDataTrack::pack( QDataStream& stream ) const
 {
     GeoDataGeometry::pack( stream );
+
+    stream << d->m_interpolate;
+    stream << d->m_when;
+    stream << d->m_coordinates.size();
+    foreach ( const GeoDataCoordinates &coordinates, d->m_coordinates ) {
+        coordinates.pack( stream );
+    }
+    d->m_extendedData.pack( stream );
 }
-//TODO
+
 void GeoDataTrack::unpack( QDataStream& stream )
 {
     GeoDataGeometry::unpack( stream );
+
+    stream >> d->m_interpolate;
+    stream >> d->m_when;
+    int size = 0;
+    stream >> size;
+    d->m_coordinates.clear();
+    for ( int i = 0; i < size; ++i ) {
+        GeoDataCoordinates coordinates;
+        coordinates.unpack( stream );
+        d->m_coordinates.append( coordinates );
+    }
+    d->m_extendedData.unpack( stream );
+
+    d->m_lineStringNeedsUpdate = true;
+    d->m_pointsNeedUpdate = true;
 }
 
 }
@@ -16,6 +16,7 @@
 
 #include <QtCore/QDateTime>
 #include <QtCore/QList>
+#include <QtCore/QVector>
 
 namespace Marble {
 
@@ -111,6 +112,16 @@ public:
      */
     GeoDataCoordinates coordinatesAt( const QDateTime &when ) const;
 
+    /**
+     * Return the coordinates at each of the time values in @p when, as
+     * coordinatesAt( const QDateTime& ) would. This is considerably faster
+     * for many samples, especially if @p when is in chronological order as
+     * it is during playback.
+     *
+     * @see coordinatesAt, interpolate
+     */
+    QVector<GeoDataCoordinates> coordinatesAt( const QVector<QDateTime> &when ) const;
+
     /**
      * Return coordinates at specified index. This is useful when the track contains
      * coordinates without time information.
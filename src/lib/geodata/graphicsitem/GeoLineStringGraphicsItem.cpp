@@ -22,12 +22,17 @@ namespace Marble
 GeoLineStringGraphicsItem::GeoLineStringGraphicsItem( const GeoDataFeature *feature, const GeoDataLineString* lineString )
         : GeoGraphicsItem( feature ),
           m_lineString( lineString ),
-          m_penWidth( 1 )
+          m_penWidth( 1 ),
+          m_levelOfDetail( lineString ),
+          m_detail( LevelOfDetailCache::MaximumDetail )
 {
 }
 
 void GeoLineStringGraphicsItem::setLineString( const GeoDataLineString* lineString )
 {
+    if ( lineString != m_lineString ) {
+        m_levelOfDetail = LevelOfDetailCache( lineString );
+    }
     m_lineString = lineString;
 }
 
@@ -38,6 +43,8 @@ const GeoDataLatLonAltBox& GeoLineStringGraphicsItem::latLonAltBox() const
 
 void GeoLineStringGraphicsItem::setViewport( const ViewportParams *viewport )
 {
+    m_detail = LevelOfDetailCache::detailLevel( viewport );
+
     if ( style() ) {
         if ( style()->lineStyle().physicalWidth() != 0.0 ) {
             if ( float( viewport->radius() ) / EARTH_RADIUS * style()->lineStyle().physicalWidth() < style()->lineStyle().width() )
@@ -103,7 +110,7 @@ void GeoLineStringGraphicsItem::paint( GeoPainter* painter ) const
             label_position_flags |= LineCenter;
     }
 
-    painter->drawPolyline( *m_lineString, feature()->name(), label_position_flags );
+    painter->drawPolyline( *m_levelOfDetail.lineString( m_detail ), feature()->name(), label_position_flags );
 
     painter->restore();
 }
@@ -12,6 +12,7 @@
 #define MARBLE_GEOLINESTRINGGRAPHICSITEM_H
 
 #include "GeoGraphicsItem.h"
+#include "LevelOfDetailCache.h"
 #include "marble_export.h"
 
 namespace Marble
@@ -36,6 +37,10 @@ public:
 protected:
     const GeoDataLineString *m_lineString;
     qreal m_penWidth;
+
+private:
+    LevelOfDetailCache m_levelOfDetail;
+    int m_detail;
 };
 
 }
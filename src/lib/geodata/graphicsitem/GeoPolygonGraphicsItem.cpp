@@ -22,14 +22,18 @@ namespace Marble
 GeoPolygonGraphicsItem::GeoPolygonGraphicsItem( const GeoDataFeature *feature, const GeoDataPolygon* polygon )
         : GeoGraphicsItem( feature ),
           m_polygon( polygon ),
-          m_ring( 0 )
+          m_ring( 0 ),
+          m_levelOfDetail( polygon ),
+          m_detail( LevelOfDetailCache::MaximumDetail )
 {
 }
 
 GeoPolygonGraphicsItem::GeoPolygonGraphicsItem( const GeoDataFeature *feature, const GeoDataLinearRing* ring )
         : GeoGraphicsItem( feature ),
           m_polygon( 0 ),
-          m_ring( ring )
+          m_ring( ring ),
+          m_levelOfDetail( ring ),
+          m_detail( LevelOfDetailCache::MaximumDetail )
 {
 }
 
@@ -46,7 +50,7 @@ const GeoDataLatLonAltBox& GeoPolygonGraphicsItem::latLonAltBox() const
 
 void GeoPolygonGraphicsItem::setViewport( const ViewportParams *viewport )
 {
-    Q_UNUSED( viewport )
+    m_detail = LevelOfDetailCache::detailLevel( viewport );
 }
 
 void GeoPolygonGraphicsItem::paint( GeoPainter* painter ) const
@@ -98,9 +102,9 @@ void GeoPolygonGraphicsItem::paint( GeoPainter* painter ) const
     }
 
     if ( m_polygon ) {
-        painter->drawPolygon( *m_polygon );
+        painter->drawPolygon( *m_levelOfDetail.polygon( m_detail ) );
     } else if ( m_ring ) {
-        painter->drawPolygon( *m_ring );
+        painter->drawPolygon( *m_levelOfDetail.linearRing( m_detail ) );
     }
 
     painter->restore();
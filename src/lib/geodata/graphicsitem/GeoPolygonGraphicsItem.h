@@ -12,6 +12,7 @@
 #define MARBLE_GEOPOLYGONGRAPHICSITEM_H
 
 #include "GeoGraphicsItem.h"
+#include "LevelOfDetailCache.h"
 #include "marble_export.h"
 
 namespace Marble
@@ -35,6 +36,10 @@ public:
 protected:
     const GeoDataPolygon *const m_polygon;
     const GeoDataLinearRing *const m_ring;
+
+private:
+    LevelOfDetailCache m_levelOfDetail;
+    int m_detail;
 };
 
 }
@@ -0,0 +1,448 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include "LevelOfDetailCache.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QStack>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include <limits>
+
+#include "GeoDataLinearRing.h"
+#include "GeoDataPolygon.h"
+#include "GeoDataTypes.h"
+#include "MarbleGlobal.h"
+#include "MarbleMath.h"
+#include "MathHelper.h"
+#include "ViewportParams.h"
+
+namespace Marble
+{
+
+// Simplifying smaller geometries does not pay off
+static const int minimumNodeCount = 64;
+
+static int nodeCount( const GeoDataGeometry *geometry )
+{
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+        const GeoDataPolygon *polygon = static_cast<const GeoDataPolygon*>( geometry );
+        int count = polygon->outerBoundary().size();
+        foreach ( const GeoDataLinearRing &ring, polygon->innerBoundaries() ) {
+            count += ring.size();
+        }
+        return count;
+    }
+
+    return static_cast<const GeoDataLineString*>( geometry )->size();
+}
+
+/**
+ * Returns whether the painter draws great circle arcs between the nodes of
+ * @p geometry. The deviation of the copies gets measured in the planes of the
+ * flat projections, so it is only bounded for straight segments.
+ */
+static bool isTessellated( const GeoDataGeometry *geometry )
+{
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+        const GeoDataPolygon *polygon = static_cast<const GeoDataPolygon*>( geometry );
+        if ( polygon->outerBoundary().tessellate() ) {
+            return true;
+        }
+        foreach ( const GeoDataLinearRing &ring, polygon->innerBoundaries() ) {
+            if ( ring.tessellate() ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    return static_cast<const GeoDataLineString*>( geometry )->tessellate();
+}
+
+/**
+ * Returns the revisions of all line strings of @p geometry, which change
+ * whenever one of their nodes does.
+ */
+static QVector<int> revisions( const GeoDataGeometry *geometry )
+{
+    QVector<int> result;
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+        const GeoDataPolygon *polygon = static_cast<const GeoDataPolygon*>( geometry );
+        result.append( polygon->outerBoundary().revision() );
+        foreach ( const GeoDataLinearRing &ring, polygon->innerBoundaries() ) {
+            result.append( ring.revision() );
+        }
+    } else {
+        result.append( static_cast<const GeoDataLineString*>( geometry )->revision() );
+    }
+
+    return result;
+}
+
+class LevelOfDetailCacheData
+{
+ public:
+    LevelOfDetailCacheData() :
+        m_isBuilding( false )
+    {
+    }
+
+    ~LevelOfDetailCacheData()
+    {
+        qDeleteAll( m_levels );
+        qDeleteAll( m_builtLevels );
+    }
+
+    /// The copies handed out to the painting thread, and the revisions of their source
+    QVector<GeoDataGeometry*> m_levels;
+    QVector<int> m_sourceRevisions;
+
+    /// Guards the members below, which are written by LevelOfDetailBuilder
+    QMutex m_mutex;
+    QVector<GeoDataGeometry*> m_builtLevels;
+    QVector<int> m_builtSourceRevisions;
+    bool m_isBuilding;
+};
+
+class LevelOfDetailBuilder : public QRunnable
+{
+ public:
+    LevelOfDetailBuilder( const QSharedPointer<LevelOfDetailCacheData> &data, const GeoDataGeometry *geometry );
+
+    void run();
+
+ private:
+    struct Ring
+    {
+        QVector<qreal> m_longitudes;
+        QVector<qreal> m_latitudes;
+        QVector<qreal> m_altitudes;
+        TessellationFlags m_tessellationFlags;
+        bool m_isClosed;
+    };
+
+    /// A range of nodes for the Douglas-Peucker algorithm
+    struct Range
+    {
+        int first;
+        int last;
+        qreal significance;
+    };
+
+    static Ring ring( const GeoDataLineString &lineString );
+    static qreal nodeDistance( int i, int first, int last, const qreal *lon, const qreal *lat, const qreal *mercatorLat );
+    static QVector<int> detailLevels( const Ring &ring );
+    static void fill( GeoDataLineString *lineString, const Ring &ring, const QVector<int> &details, int detail );
+
+    const QSharedPointer<LevelOfDetailCacheData> m_data;
+    const char *const m_nodeType;
+    const TessellationFlags m_tessellationFlags;
+    const QVector<int> m_sourceRevisions;
+    QVector<Ring> m_rings;
+};
+
+LevelOfDetailBuilder::LevelOfDetailBuilder( const QSharedPointer<LevelOfDetailCacheData> &data, const GeoDataGeometry *geometry ) :
+    m_data( data ),
+    m_nodeType( geometry->nodeType() ),
+    m_tessellationFlags( m_nodeType == GeoDataTypes::GeoDataPolygonType
+                         ? static_cast<const GeoDataPolygon*>( geometry )->tessellationFlags()
+                         : static_cast<const GeoDataLineString*>( geometry )->tessellationFlags() ),
+    m_sourceRevisions( revisions( geometry ) )
+{
+    // Copy the nodes, since the geometry may change or go away while building
+    if ( m_nodeType == GeoDataTypes::GeoDataPolygonType ) {
+        const GeoDataPolygon *polygon = static_cast<const GeoDataPolygon*>( geometry );
+        m_rings.append( ring( polygon->outerBoundary() ) );
+        foreach ( const GeoDataLinearRing &innerBoundary, polygon->innerBoundaries() ) {
+            m_rings.append( ring( innerBoundary ) );
+        }
+    } else {
+        m_rings.append( ring( *static_cast<const GeoDataLineString*>( geometry ) ) );
+    }
+}
+
+void LevelOfDetailBuilder::run()
+{
+    QVector< QVector<int> > details;
+    foreach ( const Ring &nodes, m_rings ) {
+        details.append( detailLevels( nodes ) );
+    }
+
+    QVector<GeoDataGeometry*> levels;
+    for ( int detail = 0; detail < LevelOfDetailCache::MaximumDetail; ++detail ) {
+        if ( m_nodeType == GeoDataTypes::GeoDataPolygonType ) {
+            GeoDataPolygon *polygon = new GeoDataPolygon( m_tessellationFlags );
+            fill( &polygon->outerBoundary(), m_rings.at( 0 ), details.at( 0 ), detail );
+            for ( int i = 1; i < m_rings.size(); ++i ) {
+                GeoDataLinearRing innerBoundary( m_rings.at( i ).m_tessellationFlags );
+                fill( &innerBoundary, m_rings.at( i ), details.at( i ), detail );
+                // Holes which collapse are smaller than a pixel
+                if ( innerBoundary.size() >= 3 ) {
+                    polygon->appendInnerBoundary( innerBoundary );
+                }
+            }
+            levels.append( polygon );
+        } else if ( m_nodeType == GeoDataTypes::GeoDataLinearRingType ) {
+            GeoDataLinearRing *linearRing = new GeoDataLinearRing( m_tessellationFlags );
+            fill( linearRing, m_rings.at( 0 ), details.at( 0 ), detail );
+            levels.append( linearRing );
+        } else {
+            GeoDataLineString *lineString = new GeoDataLineString( m_tessellationFlags );
+            fill( lineString, m_rings.at( 0 ), details.at( 0 ), detail );
+            levels.append( lineString );
+        }
+    }
+
+    QMutexLocker locker( &m_data->m_mutex );
+    qDeleteAll( m_data->m_builtLevels );
+    m_data->m_builtLevels = levels;
+    m_data->m_builtSourceRevisions = m_sourceRevisions;
+    m_data->m_isBuilding = false;
+}
+
+LevelOfDetailBuilder::Ring LevelOfDetailBuilder::ring( const GeoDataLineString &lineString )
+{
+    // Compact line strings share their arrays with the ring
+    Ring result;
+    result.m_longitudes = lineString.longitudes();
+    result.m_latitudes = lineString.latitudes();
+    result.m_altitudes = lineString.altitudes();
+    result.m_tessellationFlags = lineString.tessellationFlags();
+    result.m_isClosed = lineString.isClosed();
+
+    return result;
+}
+
+/**
+ * Returns the distance of (x, y) to the segment from (x1, y1) to (x2, y2) in
+ * the plane spanned by longitude and latitude.
+ */
+static qreal segmentDistance( qreal x, qreal y, qreal x1, qreal y1, qreal x2, qreal y2 )
+{
+    const qreal dx = x2 - x1;
+    const qreal dy = y2 - y1;
+    const qreal lengthSquared = dx * dx + dy * dy;
+
+    qreal t = 0.0;
+    if ( lengthSquared > 0.0 ) {
+        t = qBound<qreal>( 0.0, ( ( x - x1 ) * dx + ( y - y1 ) * dy ) / lengthSquared, 1.0 );
+    }
+
+    const qreal distanceX = x1 + t * dx - x;
+    const qreal distanceY = y1 + t * dy - y;
+    return sqrt( distanceX * distanceX + distanceY * distanceY );
+}
+
+/**
+ * Returns the distance of node @p i to the segment from node @p first to
+ * node @p last. The Mercator projection stretches latitudes by 1 / cos( lat ),
+ * so the larger one of the distances in the plane spanned by longitude and
+ * latitude and in the Mercator plane counts.
+ */
+qreal LevelOfDetailBuilder::nodeDistance( int i, int first, int last, const qreal *lon, const qreal *lat, const qreal *mercatorLat )
+{
+    return qMax( segmentDistance( lon[i], lat[i], lon[first], lat[first], lon[last], lat[last] ),
+                 segmentDistance( lon[i], mercatorLat[i], lon[first], mercatorLat[first], lon[last], mercatorLat[last] ) );
+}
+
+QVector<int> LevelOfDetailBuilder::detailLevels( const Ring &ring )
+{
+    const int count = ring.m_longitudes.size();
+    const qreal *const lon = ring.m_longitudes.constData();
+    const qreal *const lat = ring.m_latitudes.constData();
+    const qreal maximum = std::numeric_limits<qreal>::max();
+
+    // The Mercator projection cuts off the map where the latitudes reach the
+    // longitudes in length
+    const qreal maximumMercatorLat = 85.05113 * DEG2RAD;
+    QVector<qreal> mercatorLatitudes( count );
+    for ( int i = 0; i < count; ++i ) {
+        mercatorLatitudes[i] = atanh( sin( qBound( -maximumMercatorLat, lat[i], maximumMercatorLat ) ) );
+    }
+    const qreal *const mercatorLat = mercatorLatitudes.constData();
+
+    // The significance of a node is the tolerance of the Douglas-Peucker
+    // algorithm below which the node is kept. It never exceeds the one of the
+    // node that split the range, so that each level is a subset of the next.
+    QVector<qreal> significance( count, 0.0 );
+    if ( count == 0 ) {
+        return QVector<int>();
+    }
+    significance[0] = maximum;
+    significance[count - 1] = maximum;
+
+    QStack<Range> ranges;
+
+    if ( ring.m_isClosed && count > 2 ) {
+        // Split rings at the node farthest from the first one
+        int farthest = 1;
+        qreal farthestDistance = 0.0;
+        for ( int i = 1; i < count; ++i ) {
+            const qreal distance = segmentDistance( lon[i], lat[i], lon[0], lat[0], lon[0], lat[0] );
+            if ( distance > farthestDistance ) {
+                farthest = i;
+                farthestDistance = distance;
+            }
+        }
+        significance[farthest] = maximum;
+        const Range first = { 0, farthest, maximum };
+        const Range second = { farthest, count - 1, maximum };
+        ranges.push( first );
+        ranges.push( second );
+    } else {
+        const Range range = { 0, count - 1, maximum };
+        ranges.push( range );
+    }
+
+    while ( !ranges.isEmpty() ) {
+        const Range range = ranges.pop();
+        if ( range.last - range.first < 2 ) {
+            continue;
+        }
+
+        int farthest = range.first + 1;
+        qreal farthestDistance = -1.0;
+        for ( int i = range.first + 1; i < range.last; ++i ) {
+            const qreal distance = nodeDistance( i, range.first, range.last, lon, lat, mercatorLat );
+            if ( distance > farthestDistance ) {
+                farthest = i;
+                farthestDistance = distance;
+            }
+        }
+
+        const qreal farthestSignificance = qMin( farthestDistance, range.significance );
+        significance[farthest] = farthestSignificance;
+        const Range first = { range.first, farthest, farthestSignificance };
+        const Range second = { farthest, range.last, farthestSignificance };
+        ranges.push( first );
+        ranges.push( second );
+    }
+
+    // Keep the nodes next to the date line, as the painter splits lines there
+    for ( int i = 1; i < count; ++i ) {
+        if ( fabs( lon[i] - lon[i - 1] ) > M_PI ) {
+            significance[i - 1] = maximum;
+            significance[i] = maximum;
+        }
+    }
+
+    // Half a pixel at a radius of 256 * 4^detail pixels. The flat projections
+    // map a radian to less than radius pixels.
+    QVector<int> details( count, LevelOfDetailCache::MaximumDetail );
+    for ( int i = 0; i < count; ++i ) {
+        qreal tolerance = 0.5 / 256;
+        for ( int detail = 0; detail < LevelOfDetailCache::MaximumDetail; ++detail, tolerance /= 4 ) {
+            if ( significance.at( i ) >= tolerance ) {
+                details[i] = detail;
+                break;
+            }
+        }
+    }
+
+    return details;
+}
+
+void LevelOfDetailBuilder::fill( GeoDataLineString *lineString, const Ring &ring, const QVector<int> &details, int detail )
+{
+    int count = 0;
+    for ( int i = 0; i < details.size(); ++i ) {
+        if ( details.at( i ) <= detail ) {
+            ++count;
+        }
+    }
+
+    lineString->reserve( count );
+    for ( int i = 0; i < details.size(); ++i ) {
+        if ( details.at( i ) <= detail ) {
+            lineString->append( GeoDataCoordinates( ring.m_longitudes.at( i ), ring.m_latitudes.at( i ), ring.m_altitudes.at( i ),
+                                                    GeoDataCoordinates::Radian, details.at( i ) ) );
+        }
+    }
+}
+
+LevelOfDetailCache::LevelOfDetailCache() :
+    m_geometry( 0 )
+{
+}
+
+LevelOfDetailCache::LevelOfDetailCache( const GeoDataLineString *lineString ) :
+    m_geometry( lineString ),
+    d( lineString ? new LevelOfDetailCacheData : 0 )
+{
+}
+
+LevelOfDetailCache::LevelOfDetailCache( const GeoDataPolygon *polygon ) :
+    m_geometry( polygon ),
+    d( polygon ? new LevelOfDetailCacheData : 0 )
+{
+}
+
+int LevelOfDetailCache::detailLevel( const ViewportParams *viewport )
+{
+    int detail = 0;
+    for ( qreal radius = 256; radius < viewport->radius() && detail < MaximumDetail; radius *= 4 ) {
+        ++detail;
+    }
+
+    return detail;
+}
+
+const GeoDataLineString *LevelOfDetailCache::lineString( int detail ) const
+{
+    return static_cast<const GeoDataLineString*>( geometry( detail ) );
+}
+
+const GeoDataLinearRing *LevelOfDetailCache::linearRing( int detail ) const
+{
+    return static_cast<const GeoDataLinearRing*>( geometry( detail ) );
+}
+
+const GeoDataPolygon *LevelOfDetailCache::polygon( int detail ) const
+{
+    return static_cast<const GeoDataPolygon*>( geometry( detail ) );
+}
+
+const GeoDataGeometry *LevelOfDetailCache::geometry( int detail ) const
+{
+    if ( !d || detail >= MaximumDetail ) {
+        return m_geometry;
+    }
+
+    if ( nodeCount( m_geometry ) < minimumNodeCount || isTessellated( m_geometry ) ) {
+        return m_geometry;
+    }
+
+    const QVector<int> sourceRevisions = revisions( m_geometry );
+    if ( d->m_sourceRevisions != sourceRevisions ) {
+        QMutexLocker locker( &d->m_mutex );
+        if ( !d->m_builtLevels.isEmpty() ) {
+            // Take over the copies on this thread, as the old ones may be in use here
+            qDeleteAll( d->m_levels );
+            d->m_levels = d->m_builtLevels;
+            d->m_sourceRevisions = d->m_builtSourceRevisions;
+            d->m_builtLevels.clear();
+        }
+
+        if ( d->m_sourceRevisions != sourceRevisions ) {
+            if ( !d->m_isBuilding ) {
+                d->m_isBuilding = true;
+                QThreadPool::globalInstance()->start( new LevelOfDetailBuilder( d, m_geometry ) );
+            }
+            return m_geometry;
+        }
+    }
+
+    return d->m_levels.at( detail );
+}
+
+}
@@ -0,0 +1,90 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#ifndef MARBLE_LEVELOFDETAILCACHE_H
+#define MARBLE_LEVELOFDETAILCACHE_H
+
+#include <QtCore/QSharedPointer>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoDataGeometry;
+class GeoDataLineString;
+class GeoDataLinearRing;
+class GeoDataPolygon;
+class LevelOfDetailCacheData;
+class ViewportParams;
+
+/**
+ * @short Simplified copies of a line string or polygon for small zoom levels.
+ *
+ * Every node of the geometry gets a detail level between 0 (most important)
+ * and MaximumDetail (least important) by the Douglas-Peucker algorithm, just
+ * like GeoDataCoordinates::detail() describes it. The copy for detail level
+ * @c d only keeps the nodes of detail @c d or less. Its deviation from the
+ * original is less than half a pixel at a radius of 256 * 4^d pixels. This
+ * holds for the Mercator projection, too, as the deviation gets measured in
+ * its plane as well, which is stretched by about six times at 80 degrees.
+ * Tessellated geometries are drawn along great circles, for which this
+ * bound does not hold, so they are never simplified.
+ *
+ * The copies get built in the global thread pool the first time they are
+ * asked for, and again whenever the revision of the geometry changes.
+ * Until then, the original geometry is returned.
+ */
+class MARBLE_EXPORT LevelOfDetailCache
+{
+ public:
+    enum {
+        MaximumDetail = 5
+    };
+
+    /**
+     * Creates an empty cache which always returns the original geometry.
+     */
+    LevelOfDetailCache();
+
+    explicit LevelOfDetailCache( const GeoDataLineString *lineString );
+    explicit LevelOfDetailCache( const GeoDataPolygon *polygon );
+
+    /**
+     * Returns the detail level which is precise enough for @p viewport.
+     */
+    static int detailLevel( const ViewportParams *viewport );
+
+    /**
+     * Returns the line string to draw at @p detail level.
+     */
+    const GeoDataLineString *lineString( int detail ) const;
+
+    /**
+     * Returns the ring to draw at @p detail level, if the cache was created
+     * for a GeoDataLinearRing.
+     */
+    const GeoDataLinearRing *linearRing( int detail ) const;
+
+    /**
+     * Returns the polygon to draw at @p detail level.
+     */
+    const GeoDataPolygon *polygon( int detail ) const;
+
+ private:
+    const GeoDataGeometry *geometry( int detail ) const;
+
+    const GeoDataGeometry *m_geometry;
+    QSharedPointer<LevelOfDetailCacheData> d;
+};
+
+}
+
+#endif
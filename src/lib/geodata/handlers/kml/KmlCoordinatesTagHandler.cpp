@@ -21,8 +21,7 @@
 
 #include "KmlCoordinatesTagHandler.h"
 
-#include <QtCore/QStringList>
-#include <QtCore/QRegExp>
+#include <QtCore/QString>
 
 #include "MarbleDebug.h"
 #include "KmlElementDictionary.h"
@@ -46,6 +45,127 @@ KML_DEFINE_TAG_HANDLER( coordinates )
 
 static const bool kmlStrictSpecs = false;
 
+/**
+ * Converts the number in [begin, end) like QString::toDouble() does, but
+ * without creating a string for it. Numbers with at most 15 significant
+ * digits and no exponent, which covers virtually all coordinates, are
+ * converted exactly by a single division. Anything else is left to
+ * QString::toDouble().
+ */
+static qreal parseDouble( const QChar *begin, const QChar *end )
+{
+    static const qreal powersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+        1e21, 1e22
+    };
+
+    const QChar *it = begin;
+    bool negative = false;
+    if ( it != end && ( *it == QLatin1Char( '-' ) || *it == QLatin1Char( '+' ) ) ) {
+        negative = *it == QLatin1Char( '-' );
+        ++it;
+    }
+
+    quint64 mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool hasPoint = false;
+    for ( ; it != end; ++it ) {
+        const ushort c = it->unicode();
+        if ( c >= '0' && c <= '9' ) {
+            hasDigits = true;
+            if ( mantissa != 0 || c != '0' ) {
+                ++significantDigits;
+            }
+            if ( significantDigits > 15 ) {
+                break;
+            }
+            mantissa = 10 * mantissa + ( c - '0' );
+            if ( hasPoint ) {
+                --exponent;
+            }
+        } else if ( c == '.' && !hasPoint ) {
+            hasPoint = true;
+        } else {
+            break;
+        }
+    }
+
+    if ( it != end || !hasDigits || exponent < -22 ) {
+        return QString::fromRawData( begin, end - begin ).toDouble();
+    }
+
+    const qreal value = qreal( mantissa ) / powersOfTen[-exponent];
+    return negative ? -value : value;
+}
+
+/**
+ * Splits the text of a coordinates element into tuples in a single pass.
+ * Tuples are separated by whitespace, their components by commas. Unless
+ * the KML specification is followed strictly, whitespace around the commas
+ * is allowed as well.
+ */
+class CoordinatesTokenizer
+{
+public:
+    explicit CoordinatesTokenizer( const QString &text )
+        : m_it( text.constData() ),
+          m_end( text.constData() + text.size() )
+    {
+    }
+
+    /**
+     * Reads the next tuple and returns false if there is none. Sets @p count
+     * to the number of its components, of which up to three are converted
+     * into @p values unless it is 0.
+     */
+    bool next( qreal *values, int &count )
+    {
+        skipSpaces( m_it );
+        if ( m_it == m_end ) {
+            return false;
+        }
+
+        count = 0;
+        while ( true ) {
+            const QChar *start = m_it;
+            while ( m_it != m_end && *m_it != QLatin1Char( ',' ) && !m_it->isSpace() ) {
+                ++m_it;
+            }
+            if ( values && count < 3 ) {
+                values[count] = parseDouble( start, m_it );
+            }
+            ++count;
+
+            const QChar *separator = m_it;
+            if ( !kmlStrictSpecs ) {
+                skipSpaces( separator );
+            }
+            if ( separator == m_end || *separator != QLatin1Char( ',' ) ) {
+                return true;
+            }
+
+            m_it = separator + 1;
+            if ( !kmlStrictSpecs ) {
+                skipSpaces( m_it );
+            }
+        }
+    }
+
+private:
+    void skipSpaces( const QChar *&it ) const
+    {
+        while ( it != m_end && it->isSpace() ) {
+            ++it;
+        }
+    }
+
+    const QChar *m_it;
+    const QChar *const m_end;
+};
+
 // We can't use KML_DEFINE_TAG_HANDLER_GX22 because the name of the tag ("coord")
 // and the TagHandler ("KmlcoordinatesTagHandler") don't match
 static GeoTagHandlerRegistrar s_handlercoordkmlTag_nameSpaceGx22(GeoParser::QualifiedName(kmlTag_coord, kmlTag_nameSpaceGx22 ),
@@ -64,70 +184,39 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
      || parentItem.represents( kmlTag_MultiGeometry )
      || parentItem.represents( kmlTag_LinearRing )
      || parentItem.represents( kmlTag_LatLonQuad ) ) {
-        QStringList  coordinatesLines;// = parser.readElementText().trimmed().split( QRegExp("\\s"), QString::SkipEmptyParts );
-        // Splitting using the "\\s" regexp is slow, split manually instead.
-        QString text = parser.readElementText().trimmed();
-
-        if ( !kmlStrictSpecs ) {
-            // Removing spaces before and after commas
-            for ( int i = 1; i < text.size() - 1; ++i ) {
-                if ( text[i] == ',' ) {
-                    // Before
-                    int l = i - 1;
-                    while ( l > 0 && text[l].isSpace() ) {
-                        --l;
-                    }
+        const QString text = parser.readElementText();
+        const bool isPoint = parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>();
 
-                    // After
-                    int r = i + 1;
-                    while ( r < text.size() && text[r].isSpace() ) {
-                        ++r;
-                    }
-
-                    text.remove( l + 1, r - l - 1 ).insert( l + 1, ',' );
-                }
+        if ( parentItem.represents( kmlTag_LineString ) || parentItem.represents( kmlTag_LinearRing ) ) {
+            // Counting the tuples is much cheaper than reallocating the nodes
+            CoordinatesTokenizer counter( text );
+            int tupleCount = 0;
+            int componentCount;
+            while ( counter.next( 0, componentCount ) ) {
+                ++tupleCount;
             }
+            parentItem.nodeAs<GeoDataLineString>()->reserve( tupleCount );
         }
 
-        int index = 0;
-        bool inside = true;
-        int const size = text.size();
-        for ( int i=0; i<size; ++i ) {
-            if ( text[i].isSpace() ) {
-                if ( inside ) {
-                    coordinatesLines.append( text.mid( index, i-index ) );
-                    inside = false;
-                }
-                index = i+1;
-            } else {
-                inside = true;
-            }
-        }
-        coordinatesLines.append( text.mid( index ) );
+        CoordinatesTokenizer tokenizer( text );
+        qreal values[3];
+        int componentCount;
         int coordinatesIndex = 0;
-        Q_FOREACH( const QString& line, coordinatesLines ) {
-            QStringList coordinates = line.trimmed().split( ',' );
-            if ( parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>() ) {
+        while ( tokenizer.next( values, componentCount ) ) {
+            if ( isPoint ) {
                 GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( coordinates.at( 0 ).toDouble(),
-                              coordinates.at( 1 ).toDouble(), 0.0, GeoDataCoordinates::Degree );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( coordinates.at( 0 ).toDouble(),
-                               coordinates.at( 1 ).toDouble(),
-                               coordinates.at( 2 ).toDouble(),
-                               GeoDataCoordinates::Degree );
+                if ( componentCount == 2 ) {
+                    coord.set( values[0], values[1], 0.0, GeoDataCoordinates::Degree );
+                } else if( componentCount == 3 ) {
+                    coord.set( values[0], values[1], values[2], GeoDataCoordinates::Degree );
                 }
                 parentItem.nodeAs<GeoDataPlacemark>()->setCoordinate( coord );
             } else {
                 GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble() );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble(),
-                              coordinates.at( 2 ).toDouble() );
+                if ( componentCount == 2 ) {
+                    coord.set( DEG2RAD * values[0], DEG2RAD * values[1] );
+                } else if( componentCount == 3 ) {
+                    coord.set( DEG2RAD * values[0], DEG2RAD * values[1], values[2] );
                 }
 
                 if ( parentItem.represents( kmlTag_LineString ) ) {
@@ -173,20 +262,25 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
     }
 
     if( parentItem.represents( kmlTag_Track ) ) {
-        QString input = parser.readElementText().trimmed();
-        if ( !kmlStrictSpecs ) {
-            input = input.replace( QRegExp( "\\s*,\\s*" ), "," );
+        // gx:coord separates the components by spaces, so each of them is a tuple of its own
+        const QString text = parser.readElementText();
+        CoordinatesTokenizer tokenizer( text );
+        qreal values[3];
+        int componentCount = 0;
+        qreal tuple[3];
+        int tupleSize;
+        while ( tokenizer.next( tuple, tupleSize ) ) {
+            if ( componentCount < 3 ) {
+                values[componentCount] = tupleSize == 1 ? tuple[0] : 0.0;
+            }
+            ++componentCount;
         }
-        QStringList coordinates = input.split( ' ' );
 
         GeoDataCoordinates coord;
-        if ( coordinates.size() == 2 ) {
-            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                       DEG2RAD * coordinates.at( 1 ).toDouble() );
-        } else if( coordinates.size() == 3 ) {
-            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                       DEG2RAD * coordinates.at( 1 ).toDouble(),
-                       coordinates.at( 2 ).toDouble() );
+        if ( componentCount == 2 ) {
+            coord.set( DEG2RAD * values[0], DEG2RAD * values[1] );
+        } else if( componentCount == 3 ) {
+            coord.set( DEG2RAD * values[0], DEG2RAD * values[1], values[2] );
         }
         parentItem.nodeAs<GeoDataTrack>()->appendCoordinates( coord );
     }
@@ -17,10 +17,12 @@
 
 #include "GeoSceneTiled.h"
 
+#include <geodata_export.h>
+
 namespace Marble
 {
 
-class GeoSceneTextureTile : public GeoSceneTiled
+class GEODATA_EXPORT GeoSceneTextureTile : public GeoSceneTiled
 {
  public:
 
@@ -13,18 +13,22 @@
 #include "TextureLayer.h"
 
 #include <QtCore/qmath.h>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QTimer>
 
+#include "AbstractProjection.h"
 #include "SphericalScanlineTextureMapper.h"
 #include "EquirectScanlineTextureMapper.h"
 #include "MercatorScanlineTextureMapper.h"
 #include "TileScalingTextureMapper.h"
+#include "FrameProfiler.h"
 #include "GeoPainter.h"
 #include "GeoSceneGroup.h"
 #include "GeoSceneTypes.h"
 #include "MergedLayerDecorator.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "ScanlineTextureMapperContext.h"
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
 #include "SunLocator.h"
@@ -37,6 +41,9 @@ namespace Marble
 
 const int REPAINT_SCHEDULING_INTERVAL = 1000;
 
+// Resampling the rotated globe again and again blurs the texture
+const int MAXIMUM_CANVAS_ROTATIONS = 8;
+
 class TextureLayer::Private
 {
 public:
@@ -46,8 +53,16 @@ public:
              TextureLayer *parent );
 
     void requestDelayedRepaint();
+    void repaintDamagedCanvas();
     void updateTextureLayers();
     void updateTile( const TileId &tileId, const QImage &tileImage );
+    void updateShading();
+    void invalidateCanvas();
+    void damageTile( const TileId &stackedTileId );
+    bool updateCanvasState( MapQuality mapQuality );
+    bool panCanvas( MapQuality mapQuality );
+    bool rotateCanvas( MapQuality mapQuality );
+    QRect tileRows( const TileId &stackedTileId ) const;
 
 public:
     TextureLayer  *const m_parent;
@@ -60,9 +75,39 @@ public:
     QVector<const GeoSceneTextureTile *> m_textures;
     const GeoSceneGroup *m_textureLayerSettings;
     QString m_runtimeTrace;
+    FrameProfiler *m_frameProfiler;
     // For scheduling repaints
     QTimer           m_repaintTimer;
 
+    // The mapped texture is kept across frames, such that a repaint
+    // caused by other layers or by a single new tile does not need to
+    // map the whole texture again.
+    QImage m_canvasImage;
+    const ViewportParams *m_viewport;
+    Projection m_canvasProjection;
+    QSize m_canvasSize;
+    int m_canvasRadius;
+    Quaternion m_canvasPlanetAxis;
+    qreal m_canvasCenterLon;
+    qreal m_canvasCenterLat;
+    // the fraction of a pixel the canvas got panned too far horizontally
+    qreal m_canvasOffsetError;
+    // how often the globe got rotated since it was mapped completely
+    int m_canvasRotations;
+    int m_canvasTileLevel;
+    MapQuality m_canvasMapQuality;
+
+    // The following members are guarded by m_canvasMutex, since tiles
+    // get loaded by the mapper threads while the texture is being mapped.
+    QMutex m_canvasMutex;
+    bool m_canvasValid;
+    // the viewport the canvas got mapped for, which may differ from
+    // m_viewport until the next repaint
+    ViewportParams m_canvasViewport;
+    QRegion m_canvasDamage;
+    bool m_isRendering;
+    // whether a repaint of the invalid canvas got queued already
+    bool m_canvasRepaintPending;
 };
 
 TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
@@ -77,7 +122,26 @@ TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
     , m_tileZoomLevel( -1 )
     , m_texcolorizer( 0 )
     , m_textureLayerSettings( 0 )
+    , m_frameProfiler( 0 )
     , m_repaintTimer()
+    , m_canvasImage()
+    , m_viewport( 0 )
+    , m_canvasProjection( Spherical )
+    , m_canvasSize()
+    , m_canvasRadius( 0 )
+    , m_canvasPlanetAxis()
+    , m_canvasCenterLon( 0.0 )
+    , m_canvasCenterLat( 0.0 )
+    , m_canvasOffsetError( 0.0 )
+    , m_canvasRotations( 0 )
+    , m_canvasTileLevel( -1 )
+    , m_canvasMapQuality( NormalQuality )
+    , m_canvasMutex()
+    , m_canvasValid( false )
+    , m_canvasViewport()
+    , m_canvasDamage()
+    , m_isRendering( false )
+    , m_canvasRepaintPending( false )
 {
 }
 
@@ -88,6 +152,18 @@ void TextureLayer::Private::requestDelayedRepaint()
     }
 }
 
+void TextureLayer::Private::repaintDamagedCanvas()
+{
+    QMutexLocker locker( &m_canvasMutex );
+    if ( !m_canvasRepaintPending )
+        return; // the canvas got repainted meanwhile
+
+    m_canvasRepaintPending = false;
+    locker.unlock();
+
+    emit m_parent->repaintNeeded();
+}
+
 void TextureLayer::Private::updateTextureLayers()
 {
     QVector<GeoSceneTextureTile const *> result;
@@ -106,8 +182,10 @@ void TextureLayer::Private::updateTextureLayers()
         }
     }
 
-    m_layerDecorator.setTextureLayers( result );
+    // clear before changing the texture layers since background decode jobs
+    // might still access them
     m_tileLoader.clear();
+    m_layerDecorator.setTextureLayers( result );
 
     emit m_parent->repaintNeeded();
 }
@@ -122,6 +200,362 @@ void TextureLayer::Private::updateTile( const TileId &tileId, const QImage &tile
     requestDelayedRepaint();
 }
 
+void TextureLayer::Private::updateShading()
+{
+    // no need to reload the tiles from disk
+    m_tileLoader.updateShading();
+
+    invalidateCanvas();
+    emit m_parent->repaintNeeded();
+}
+
+void TextureLayer::Private::invalidateCanvas()
+{
+    QMutexLocker locker( &m_canvasMutex );
+    m_canvasValid = false;
+}
+
+void TextureLayer::Private::damageTile( const TileId &stackedTileId )
+{
+    QMutexLocker locker( &m_canvasMutex );
+
+    // tiles loaded while mapping the texture are on the canvas already
+    if ( m_isRendering )
+        return;
+
+    // the whole texture gets mapped at the next repaint, which is shared by
+    // all tiles loaded until the event loop gets to it
+    if ( !m_canvasValid ) {
+        if ( m_canvasRepaintPending || !m_tileLoader.asynchronousLoading() )
+            return;
+
+        m_canvasRepaintPending = true;
+        locker.unlock();
+        // queued, since this may run in a mapper thread
+        QMetaObject::invokeMethod( m_parent, "repaintDamagedCanvas", Qt::QueuedConnection );
+        return;
+    }
+
+    const QRect rows = tileRows( stackedTileId );
+    if ( rows.isEmpty() )
+        return;
+
+    m_canvasDamage |= rows;
+    locker.unlock();
+
+    if ( m_tileLoader.asynchronousLoading() ) {
+        emit m_parent->repaintNeeded( rows );
+    }
+}
+
+bool TextureLayer::Private::updateCanvasState( MapQuality mapQuality )
+{
+    const bool sameMapping = m_canvasValid
+            && m_canvasProjection == m_viewport->projection()
+            && m_canvasSize == m_viewport->size()
+            && m_canvasRadius == m_viewport->radius()
+            && m_canvasTileLevel == m_tileZoomLevel
+            && m_canvasMapQuality == mapQuality;
+    const bool unchanged = sameMapping && m_canvasPlanetAxis == m_viewport->planetAxis();
+    const bool panned = sameMapping && !unchanged && ( panCanvas( mapQuality ) || rotateCanvas( mapQuality ) );
+
+    if ( !unchanged && !panned ) {
+        m_canvasOffsetError = 0.0;
+        m_canvasRotations = 0;
+    }
+
+    m_canvasProjection = m_viewport->projection();
+    m_canvasSize = m_viewport->size();
+    m_canvasRadius = m_viewport->radius();
+    m_canvasPlanetAxis = m_viewport->planetAxis();
+    m_canvasCenterLon = m_viewport->centerLongitude();
+    m_canvasCenterLat = m_viewport->centerLatitude();
+    m_canvasTileLevel = m_tileZoomLevel;
+    m_canvasMapQuality = mapQuality;
+    m_canvasValid = true;
+
+    m_canvasViewport.setProjection( m_canvasProjection );
+    m_canvasViewport.setSize( m_canvasSize );
+    m_canvasViewport.setRadius( m_canvasRadius );
+    m_canvasViewport.centerOn( m_canvasCenterLon, m_canvasCenterLat );
+
+    return !unchanged && !panned;
+}
+
+/**
+ * Moves the pixels of the 32 bit @p image by @p dx columns and @p dy rows.
+ * The uncovered pixels keep their old values.
+ */
+static void scrollImage( QImage *image, int dx, int dy )
+{
+    const int width = image->width();
+    const int height = image->height();
+    const int srcX = qMax( 0, -dx );
+    const int dstX = qMax( 0, dx );
+    const int byteCount = ( width - qAbs( dx ) ) * sizeof( QRgb );
+
+    // copy in the order which doesn't overwrite rows still to be copied
+    if ( dy > 0 ) {
+        for ( int y = height - 1; y >= dy; --y ) {
+            memmove( (QRgb*)( image->scanLine( y ) ) + dstX,
+                     (QRgb*)( image->scanLine( y - dy ) ) + srcX,
+                     byteCount );
+        }
+    } else {
+        for ( int y = 0; y < height + dy; ++y ) {
+            memmove( (QRgb*)( image->scanLine( y ) ) + dstX,
+                     (QRgb*)( image->scanLine( y - dy ) ) + srcX,
+                     byteCount );
+        }
+    }
+}
+
+bool TextureLayer::Private::panCanvas( MapQuality mapQuality )
+{
+    // Only the cylindrical projections move the texture as a whole when the
+    // center changes. In the spherical projection, the texture gets distorted
+    // towards the horizon, so it needs to be mapped again.
+    const Projection projection = m_viewport->projection();
+    if ( projection != Equirectangular && projection != Mercator )
+        return false;
+
+    // print quality is expected to be exact, and the colorizer needs to
+    // process the whole canvas anyway
+    if ( mapQuality == PrintQuality || m_texcolorizer )
+        return false;
+
+    if ( m_canvasImage.size() != m_viewport->size()
+         || m_canvasImage.format() != ScanlineTextureMapperContext::optimalCanvasImageFormat( m_viewport ) )
+        return false;
+
+    const int width = m_canvasImage.width();
+    const int height = m_canvasImage.height();
+    const int radius = m_viewport->radius();
+
+    // Both projections use 4 * radius pixels around the equator. The fraction
+    // of a pixel which can't be scrolled is carried over to the next pan, such
+    // that the canvas doesn't drift away from the mapped texture.
+    const qreal rad2Pixel = (qreal)( 2 * radius ) / M_PI;
+    const qreal period = 4 * radius;
+    qreal dxF = ( m_canvasCenterLon - m_viewport->centerLongitude() ) * rad2Pixel + m_canvasOffsetError;
+    while ( dxF >  period / 2 ) dxF -= period;
+    while ( dxF < -period / 2 ) dxF += period;
+    const int dx = qRound( dxF );
+
+    int dy = 0;
+    if ( projection == Mercator ) {
+        dy = MercatorScanlineTextureMapper::yCenterOffset( m_viewport->centerLatitude(), radius )
+           - MercatorScanlineTextureMapper::yCenterOffset( m_canvasCenterLat, radius );
+    } else {
+        dy = EquirectScanlineTextureMapper::yCenterOffset( m_viewport->centerLatitude(), radius )
+           - EquirectScanlineTextureMapper::yCenterOffset( m_canvasCenterLat, radius );
+    }
+
+    if ( qAbs( dx ) >= width || qAbs( dy ) >= height )
+        return false;
+
+    m_canvasOffsetError = dxF - dx;
+
+    if ( dx == 0 && dy == 0 )
+        return true;
+
+    scrollImage( &m_canvasImage, dx, dy );
+
+    // damageTile() measures the damage on the canvas of the previous frame,
+    // so it moves along with the pixels
+    const QRect canvasRect( QPoint( 0, 0 ), m_viewport->size() );
+    m_canvasDamage.translate( dx, dy );
+    m_canvasDamage &= canvasRect;
+
+    if ( dx > 0 ) {
+        m_canvasDamage |= QRect( 0, 0, dx, height );
+    } else if ( dx < 0 ) {
+        m_canvasDamage |= QRect( width + dx, 0, -dx, height );
+    }
+
+    if ( dy > 0 ) {
+        m_canvasDamage |= QRect( 0, 0, width, dy );
+    } else if ( dy < 0 ) {
+        m_canvasDamage |= QRect( 0, height + dy, width, -dy );
+    }
+
+    return true;
+}
+
+bool TextureLayer::Private::rotateCanvas( MapQuality mapQuality )
+{
+    // Moving the pixels of the globe to their rotated position is only
+    // approximate, as they get resampled. So it is only done during
+    // animations, which get mapped completely at a better quality once they
+    // are finished.
+    if ( m_viewport->projection() != Spherical || mapQuality != LowQuality || m_texcolorizer )
+        return false;
+
+    if ( m_canvasImage.size() != m_viewport->size()
+         || m_canvasImage.format() != ScanlineTextureMapperContext::optimalCanvasImageFormat( m_viewport ) )
+        return false;
+
+    if ( m_canvasRotations >= MAXIMUM_CANVAS_ROTATIONS )
+        return false;
+
+    const int width = m_canvasImage.width();
+    const int height = m_canvasImage.height();
+    const qint64 radius = m_viewport->radius();
+    const qreal inverseRadius = 1.0 / (qreal)( radius );
+
+    // The mappers turn a pixel into a point on the sphere by the planet axis.
+    // Turning that point back by the planet axis of the previous frame gives
+    // the pixel it has been mapped to before.
+    matrix planetAxisMatrix;
+    m_viewport->planetAxis().toMatrix( planetAxisMatrix );
+    matrix canvasAxisMatrix;
+    m_canvasPlanetAxis.inverse().toMatrix( canvasAxisMatrix );
+
+    const QImage previousImage = m_canvasImage.copy();
+
+    const int yTop = qMax<int>( 0, height / 2 - radius );
+    const int yBottom = qMin<int>( height, height / 2 + radius );
+
+    // The pixels which have been hidden behind the horizon get mapped again,
+    // left and right of the center separately. They are gathered in bands of
+    // rows, since each rect gets mapped on its own.
+    const int bandHeight = 16;
+    QRegion damage;
+    for ( int bandTop = yTop; bandTop < yBottom; bandTop += bandHeight ) {
+        const int bandBottom = qMin( bandTop + bandHeight, yBottom );
+        int leftMin = width;
+        int leftMax = -1;
+        int rightMin = width;
+        int rightMax = -1;
+
+        for ( int y = bandTop; y < bandBottom; ++y ) {
+            // same as in SphericalScanlineTextureMapper
+            const qreal qy = inverseRadius * (qreal)( height / 2 - y );
+            const qreal qr = 1.0 - qy * qy;
+            const int rx = (int)sqrt( (qreal)( radius * radius - ( ( y - height / 2 ) * ( y - height / 2 ) ) ) );
+            const int xLeft = qMax( 0, width / 2 - rx );
+            const int xRight = qMin( width, width / 2 + rx );
+
+            QRgb *const scanLine = (QRgb*)( m_canvasImage.scanLine( y ) );
+            for ( int x = xLeft; x < xRight; ++x ) {
+                const qreal qx = (qreal)( x - width / 2 ) * inverseRadius;
+                const qreal qr2z = qr - qx * qx;
+                const qreal qz = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
+
+                Quaternion position( 0.0, qx, qy, qz );
+                position.rotateAroundAxis( planetAxisMatrix );
+                position.rotateAroundAxis( canvasAxisMatrix );
+
+                bool covered = false;
+                if ( position.v[Q_Z] > 0.0 ) {
+                    const int previousX = width / 2 + qRound( radius * position.v[Q_X] );
+                    const int previousY = height / 2 - qRound( radius * position.v[Q_Y] );
+                    if ( previousY >= 0 && previousY < height ) {
+                        const int previousRx = (int)sqrt( (qreal)( radius * radius - ( ( previousY - height / 2 ) * ( previousY - height / 2 ) ) ) );
+                        if ( previousX >= qMax( 0, width / 2 - previousRx ) && previousX < qMin( width, width / 2 + previousRx ) ) {
+                            scanLine[x] = ( (const QRgb*)( previousImage.scanLine( previousY ) ) )[previousX];
+                            covered = true;
+                        }
+                    }
+                }
+
+                if ( !covered ) {
+                    if ( x < width / 2 ) {
+                        leftMin = qMin( leftMin, x );
+                        leftMax = qMax( leftMax, x );
+                    } else {
+                        rightMin = qMin( rightMin, x );
+                        rightMax = qMax( rightMax, x );
+                    }
+                }
+            }
+        }
+
+        if ( leftMax >= 0 ) {
+            damage |= QRect( QPoint( leftMin, bandTop ), QPoint( leftMax, bandBottom - 1 ) );
+        }
+        if ( rightMax >= 0 ) {
+            damage |= QRect( QPoint( rightMin, bandTop ), QPoint( rightMax, bandBottom - 1 ) );
+        }
+    }
+
+    // the tiles damaged meanwhile have moved in an arbitrary way
+    if ( !m_canvasDamage.isEmpty() ) {
+        damage |= QRect( QPoint( 0, yTop ), QPoint( width - 1, yBottom - 1 ) );
+    }
+
+    m_canvasDamage = damage;
+    ++m_canvasRotations;
+
+    return true;
+}
+
+QRect TextureLayer::Private::tileRows( const TileId &stackedTileId ) const
+{
+    // The texture mappers paint whole rows, so only the vertical
+    // extent of the tile on the screen is of interest.
+    const ViewportParams *const viewport = &m_canvasViewport;
+    const QRect canvasRect( QPoint( 0, 0 ), viewport->size() );
+
+    const int level = stackedTileId.zoomLevel();
+    const int columns = m_layerDecorator.tileColumnCount( level );
+    const int rows = m_layerDecorator.tileRowCount( level );
+
+    const qreal deltaLon = 2 * M_PI / columns;
+    const qreal west = stackedTileId.x() * deltaLon - M_PI;
+
+    qreal north = 0.0;
+    qreal south = 0.0;
+    if ( m_layerDecorator.tileProjection() == GeoSceneTiled::Mercator ) {
+        north = atan( sinh( ( 1.0 - 2.0 * stackedTileId.y() / rows ) * M_PI ) );
+        south = atan( sinh( ( 1.0 - 2.0 * ( stackedTileId.y() + 1 ) / rows ) * M_PI ) );
+    } else {
+        north = ( 0.5 - (qreal)stackedTileId.y() / rows ) * M_PI;
+        south = north - M_PI / rows;
+    }
+    const qreal deltaLat = north - south;
+
+    // sample the border of the tile
+    const int n = 8;
+    const int count = 4 * ( n + 1 );
+    qreal lons[count];
+    qreal lats[count];
+    for ( int i = 0; i <= n; ++i ) {
+        lons[4*i]   = west + i * deltaLon / n;
+        lats[4*i]   = north;
+        lons[4*i+1] = west + i * deltaLon / n;
+        lats[4*i+1] = south;
+        lons[4*i+2] = west;
+        lats[4*i+2] = north - i * deltaLat / n;
+        lons[4*i+3] = west + deltaLon;
+        lats[4*i+3] = north - i * deltaLat / n;
+    }
+
+    qreal x[count];
+    qreal y[count];
+    bool visible[count];
+    bool globeHidesPoint[count];
+    viewport->currentProjection()->screenCoordinates( count, lons, lats, 0, viewport,
+                                                      x, y, visible, globeHidesPoint );
+
+    qreal top = y[0];
+    qreal bottom = y[0];
+    for ( int i = 0; i < count; ++i ) {
+        if ( globeHidesPoint[i] ) {
+            // the visible part of the tile is bounded by the horizon
+            return canvasRect;
+        }
+        top = qMin( top, y[i] );
+        bottom = qMax( bottom, y[i] );
+    }
+
+    // the border of the tile may bulge between the samples on the globe
+    const qreal segment = qMax( deltaLon, deltaLat ) / n;
+    const int margin = 2 + (int)( viewport->radius() * segment * segment / 8.0 );
+
+    return QRect( 0, (int)top - margin, canvasRect.width(), (int)( bottom - top ) + 1 + 2 * margin ) & canvasRect;
+}
+
 
 
 TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
@@ -138,6 +572,12 @@ TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
     d->m_repaintTimer.setInterval( REPAINT_SCHEDULING_INTERVAL );
     connect( &d->m_repaintTimer, SIGNAL(timeout()),
              this, SIGNAL(repaintNeeded()) );
+
+    // tiles get loaded by the mapper threads, see Private::damageTile()
+    connect( &d->m_tileLoader, SIGNAL(tileLoaded(TileId)),
+             this, SLOT(damageTile(TileId)), Qt::DirectConnection );
+    connect( &d->m_tileLoader, SIGNAL(cleared()),
+             this, SLOT(invalidateCanvas()) );
 }
 
 TextureLayer::~TextureLayer()
@@ -203,7 +643,14 @@ bool TextureLayer::setViewport( const ViewportParams *viewport )
         emit tileLevelChanged( d->m_tileZoomLevel );
     }
 
-    d->m_runtimeTrace = QString("Cache: %1 ").arg(d->m_tileLoader.tileCount());
+    d->m_viewport = viewport;
+
+    d->m_runtimeTrace = QString("Cache: %1 Hits: %2 Misses: %3 Contentions: %4 ")
+                        .arg( d->m_tileLoader.tileCount() )
+                        .arg( d->m_tileLoader.cacheHits() )
+                        .arg( d->m_tileLoader.cacheMisses() )
+                        .arg( d->m_tileLoader.lockContentions() );
+    d->m_tileLoader.resetStatistics();
     return true;
 }
 
@@ -216,7 +663,48 @@ bool TextureLayer::render( GeoPainter *painter, const QSize &viewportSize ) cons
         return false;
 
     const QRect rect( QPoint( 0, 0 ), viewportSize );
-    painter->mapTexture( &d->m_tileLoader, d->m_tileZoomLevel, rect, d->m_texcolorizer );
+    const QRect dirtyRect = painter->hasClipping() ? painter->clipRegion().boundingRect() & rect
+                                                   : rect;
+
+    QMutexLocker locker( &d->m_canvasMutex );
+    if ( d->updateCanvasState( painter->mapQuality() ) ) {
+        d->m_canvasDamage = rect;
+    }
+    // The mappers map only the columns of each rect, e.g. the strip uncovered
+    // by a pan or the horizon of a rotated globe
+    const QRegion textureDirtyRegion = d->m_canvasDamage;
+    d->m_canvasDamage = QRegion();
+    d->m_isRendering = true;
+    d->m_canvasRepaintPending = false;
+    locker.unlock();
+
+    FrameProfiler *const profiler = d->m_frameProfiler && d->m_frameProfiler->isRecording() ? d->m_frameProfiler : 0;
+    const int start = profiler ? profiler->elapsed() : 0;
+
+    const bool canvasUpdated = painter->mapTexture( &d->m_tileLoader, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer,
+                                                    &d->m_canvasImage, textureDirtyRegion );
+
+    if ( profiler ) {
+        // the statistics of the tile loader got reset in setViewport()
+        profiler->addEvent( "Texture mapping", "texture", start, profiler->elapsed() - start );
+        qint64 mappedPixels = 0;
+        foreach ( const QRect &dirty, textureDirtyRegion.rects() ) {
+            mappedPixels += dirty.width() * dirty.height();
+        }
+        profiler->addCounter( "Mapped texture pixels", mappedPixels );
+        profiler->addCounter( "Tile cache hits", d->m_tileLoader.cacheHits() );
+        profiler->addCounter( "Tile cache misses", d->m_tileLoader.cacheMisses() );
+        profiler->addCounter( "Tile cache lock contentions", d->m_tileLoader.lockContentions() );
+        profiler->addCounter( "Tile loads", d->m_tileLoader.tileLoads() );
+        profiler->addCounter( "Tiles in memory", d->m_tileLoader.tileCount() );
+    }
+
+    locker.relock();
+    d->m_isRendering = false;
+    if ( !canvasUpdated ) {
+        // the texture got mapped into the paint device directly
+        d->m_canvasValid = false;
+    }
 
     return true;
 }
@@ -226,26 +714,32 @@ QString TextureLayer::runtimeTrace() const
     return d->m_runtimeTrace;
 }
 
+void TextureLayer::setFrameProfiler( FrameProfiler *profiler )
+{
+    d->m_frameProfiler = profiler;
+}
+
 void TextureLayer::setShowRelief( bool show )
 {
     if ( d->m_texcolorizer ) {
         d->m_texcolorizer->setShowRelief( show );
+        d->invalidateCanvas();
     }
 }
 
 void TextureLayer::setShowSunShading( bool show )
 {
     disconnect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                this, SLOT(reset()) );
+                this, SLOT(updateShading()) );
 
     if ( show ) {
         connect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                 this,       SLOT(reset()) );
+                 this,       SLOT(updateShading()) );
     }
 
     d->m_layerDecorator.setShowSunShading( show );
 
-    reset();
+    d->updateShading();
 }
 
 void TextureLayer::setShowCityLights( bool show )
@@ -267,6 +761,21 @@ void TextureLayer::setVolatileCacheLimit( quint64 kilobytes )
     d->m_tileLoader.setVolatileCacheLimit( kilobytes );
 }
 
+void TextureLayer::setAsynchronousTileLoading( bool enabled )
+{
+    if ( d->m_tileLoader.asynchronousLoading() == enabled )
+        return;
+
+    // Private::damageTile() requests a repaint as soon as a tile
+    // decoded in the background replaces its placeholder
+    d->m_tileLoader.setAsynchronousLoading( enabled );
+}
+
+bool TextureLayer::asynchronousTileLoading() const
+{
+    return d->m_tileLoader.asynchronousLoading();
+}
+
 void TextureLayer::reset()
 {
     mDebug() << Q_FUNC_INFO;
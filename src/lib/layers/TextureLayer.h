@@ -19,15 +19,16 @@
 #include "GeoDataDocument.h"
 
 #include <QtCore/QSize>
+#include <QtGui/QRegion>
 
 class QImage;
-class QRegion;
 class QRect;
 
 namespace Marble
 {
 
 class GeoPainter;
+class FrameProfiler;
 class GeoSceneGroup;
 class HttpDownloadManager;
 class PluginManager;
@@ -69,11 +70,19 @@ class TextureLayer : public QObject, public LayerInterface
 
     qint64 volatileCacheLimit() const;
 
+    bool asynchronousTileLoading() const;
+
     int preferredRadiusCeil( int radius ) const;
     int preferredRadiusFloor( int radius ) const;
 
     virtual QString runtimeTrace() const;
 
+    /**
+     * @brief Records the texture mapping time and the tile cache statistics of
+     *        each frame in @p profiler, as long as it is enabled.
+     */
+    void setFrameProfiler( FrameProfiler *profiler );
+
     bool setViewport( const ViewportParams *viewport );
 
     bool render( GeoPainter *painter, const QSize &viewportSize ) const;
@@ -91,6 +100,8 @@ public Q_SLOTS:
 
     void setVolatileCacheLimit( quint64 kilobytes );
 
+    void setAsynchronousTileLoading( bool enabled );
+
     void reset();
 
     void reload();
@@ -99,12 +110,16 @@ public Q_SLOTS:
 
  Q_SIGNALS:
     void tileLevelChanged( int );
-    void repaintNeeded();
+    void repaintNeeded( const QRegion &dirtyRegion = QRegion() );
 
  private:
     Q_PRIVATE_SLOT( d, void requestDelayedRepaint() )
+    Q_PRIVATE_SLOT( d, void repaintDamagedCanvas() )
     Q_PRIVATE_SLOT( d, void updateTextureLayers() )
     Q_PRIVATE_SLOT( d, void updateTile( const TileId &tileId, const QImage &tileImage ) )
+    Q_PRIVATE_SLOT( d, void updateShading() )
+    Q_PRIVATE_SLOT( d, void invalidateCanvas() )
+    Q_PRIVATE_SLOT( d, void damageTile( const TileId &stackedTileId ) )
 
  private:
     class Private;
@@ -621,6 +621,7 @@ void MarblePart::writeSettings()
                                                volatileTileCacheLimit() / 1024 );
     MarbleSettings::setPersistentTileCacheLimit( m_controlView->marbleModel()->
                                                  persistentTileCacheLimit() / 1024 );
+    MarbleSettings::setPackedTileCache( m_controlView->marbleModel()->packedTileCache() );
 
     // Time
     MarbleSettings::setDateTime( m_controlView->marbleModel()->clockDateTime() );
@@ -1479,6 +1480,7 @@ void MarblePart::updateSettings()
     // Cache
     m_controlView->marbleModel()->
         setPersistentTileCacheLimit( MarbleSettings::persistentTileCacheLimit() * 1024 );
+    m_controlView->marbleModel()->setPackedTileCache( MarbleSettings::packedTileCache() );
     m_controlView->marbleWidget()->
         setVolatileTileCacheLimit( MarbleSettings::volatileTileCacheLimit() * 1024 );
 
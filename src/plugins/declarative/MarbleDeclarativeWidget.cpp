@@ -21,6 +21,7 @@
 #include "MapThemeManager.h"
 #include "AbstractFloatItem.h"
 #include "AbstractDataPlugin.h"
+#include "FrameProfiler.h"
 #include "RenderPlugin.h"
 #include "MarbleMap.h"
 #include "MarbleDirs.h"
@@ -419,4 +420,24 @@ bool MarbleWidget::containsFloatItem( const QString & name )
     return false;
 }
 
+bool MarbleWidget::frameProfilingEnabled() const
+{
+    return m_marbleWidget->frameProfiler()->isEnabled();
+}
+
+void MarbleWidget::setFrameProfilingEnabled( bool enabled )
+{
+    m_marbleWidget->setFrameProfilingEnabled( enabled );
+}
+
+QString MarbleWidget::frameProfileCsv() const
+{
+    return m_marbleWidget->frameProfileCsv();
+}
+
+QString MarbleWidget::frameProfileChromeTrace() const
+{
+    return m_marbleWidget->frameProfileChromeTrace();
+}
+
 #include "MarbleDeclarativeWidget.moc"
@@ -50,6 +50,7 @@ class MarbleWidget : public QGraphicsProxyWidget
     Q_PROPERTY( QString projection READ projection WRITE setProjection NOTIFY projectionChanged )
     Q_PROPERTY( bool inputEnabled READ inputEnabled WRITE setInputEnabled )
     Q_PROPERTY( bool workOffline READ workOffline WRITE setWorkOffline NOTIFY workOfflineChanged )
+    Q_PROPERTY( bool frameProfilingEnabled READ frameProfilingEnabled WRITE setFrameProfilingEnabled )
     Q_PROPERTY( QStringList activeFloatItems READ activeFloatItems WRITE setActiveFloatItems )
     Q_PROPERTY( QStringList activeRenderPlugins READ activeRenderPlugins WRITE setActiveRenderPlugins )
     Q_PROPERTY( QObject* mapThemeModel READ mapThemeModel NOTIFY mapThemeModelChanged )
@@ -189,6 +190,18 @@ public Q_SLOTS:
 
     void setDataPluginDelegate( const QString &plugin, QDeclarativeComponent* delegate );
 
+    /** Returns true if the timings of the layers get recorded for each frame */
+    bool frameProfilingEnabled() const;
+
+    /** Toggle recording the timings of the layers for each frame */
+    void setFrameProfilingEnabled( bool enabled );
+
+    /** Returns the profiled frames as comma separated values */
+    QString frameProfileCsv() const;
+
+    /** Returns the profiled frames in the JSON format of the Chrome trace viewer */
+    QString frameProfileChromeTrace() const;
+
 protected:
     virtual bool event ( QEvent * event );
 
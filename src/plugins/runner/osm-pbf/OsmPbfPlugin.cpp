@@ -0,0 +1,75 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include "OsmPbfPlugin.h"
+#include "OsmPbfRunner.h"
+
+#include <google/protobuf/stubs/common.h>
+
+namespace Marble
+{
+
+OsmPbfPlugin::OsmPbfPlugin( QObject *parent ) :
+    ParseRunnerPlugin( parent )
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+}
+
+QString OsmPbfPlugin::name() const
+{
+    return tr( "Osm PBF File Parser" );
+}
+
+QString OsmPbfPlugin::nameId() const
+{
+    return "OsmPbf";
+}
+
+QString OsmPbfPlugin::version() const
+{
+    return "1.0";
+}
+
+QString OsmPbfPlugin::description() const
+{
+    return tr( "Create GeoDataDocument from binary Osm Files" );
+}
+
+QString OsmPbfPlugin::copyrightYears() const
+{
+    return "2026";
+}
+
+QList<PluginAuthor> OsmPbfPlugin::pluginAuthors() const
+{
+    return QList<PluginAuthor>()
+            << PluginAuthor( "agent", "agent@local" );
+}
+
+QString OsmPbfPlugin::fileFormatDescription() const
+{
+    return tr( "OpenStreetMap Binary Data" );
+}
+
+QStringList OsmPbfPlugin::fileExtensions() const
+{
+    return QStringList() << "pbf" << "osm.pbf";
+}
+
+ParsingRunner* OsmPbfPlugin::newRunner() const
+{
+    return new OsmPbfRunner;
+}
+
+}
+
+Q_EXPORT_PLUGIN2( OsmPbfPlugin, Marble::OsmPbfPlugin )
+
+#include "OsmPbfPlugin.moc"
@@ -0,0 +1,355 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include "OsmPbfRunner.h"
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataPolygon.h"
+#include "GeoDataStyle.h"
+#include "MarbleDebug.h"
+#include "OsmGlobals.h"
+#include "PbfBlockDecoder.h"
+
+#include "fileformat.pb.h"
+#include "osmformat.pb.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtEndian>
+
+namespace Marble
+{
+
+// Limits from the .osm.pbf specification
+static const quint32 maximumBlobHeaderSize = 64 * 1024;
+static const int maximumBlobSize = 32 * 1024 * 1024;
+
+OsmPbfRunner::OsmPbfRunner( QObject *parent ) :
+    ParsingRunner( parent ),
+    m_document( 0 )
+{
+}
+
+OsmPbfRunner::~OsmPbfRunner()
+{
+}
+
+void OsmPbfRunner::parseFile( const QString &fileName, DocumentRole role )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        qWarning( "File does not exist!" );
+        emit parsingFinished( 0 );
+        return;
+    }
+
+    QString errorString;
+    QByteArray type;
+    QByteArray blob;
+    if ( !readBlob( &file, type, blob, errorString ) ) {
+        emit parsingFinished( 0, errorString );
+        return;
+    }
+
+    if ( type != "OSMHeader" ) {
+        emit parsingFinished( 0, QString( "Unexpected blob type %1 instead of OSMHeader" ).arg( QString( type ) ) );
+        return;
+    }
+
+    if ( !checkHeader( blob, errorString ) ) {
+        emit parsingFinished( 0, errorString );
+        return;
+    }
+
+    m_document = new GeoDataDocument;
+
+    GeoDataPolyStyle backgroundPolyStyle;
+    backgroundPolyStyle.setFill( true );
+    backgroundPolyStyle.setOutline( false );
+    backgroundPolyStyle.setColor( osm::OsmGlobals::backgroundColor );
+    GeoDataStyle backgroundStyle;
+    backgroundStyle.setPolyStyle( backgroundPolyStyle );
+    backgroundStyle.setStyleId( "background" );
+    m_document->addStyle( backgroundStyle );
+
+    // The queue must outlive the pool, which waits for pending decoders
+    // when it is destroyed. The runner occupies a thread of the global
+    // pool already, so the decoders get a pool of their own.
+    PbfBlockQueue queue;
+    QThreadPool pool;
+
+    // Reading ahead is limited, otherwise all of a large file would end
+    // up in memory before the first block is assembled.
+    const int maximumPendingBlocks = 2 * pool.maxThreadCount();
+
+    int blocksRead = 0;
+    int blocksAdded = 0;
+    bool atEnd = false;
+    while ( !atEnd || blocksAdded < blocksRead ) {
+        while ( !atEnd && blocksRead - blocksAdded < maximumPendingBlocks ) {
+            if ( file.atEnd() ) {
+                atEnd = true;
+            } else if ( !readBlob( &file, type, blob, errorString ) ) {
+                atEnd = true;
+            } else if ( type == "OSMData" ) {
+                pool.start( new PbfBlockDecoder( &queue, blocksRead, blob ) );
+                ++blocksRead;
+            } else {
+                // Unknown blob types are to be skipped
+                mDebug() << "Skipping blob of type" << type;
+            }
+        }
+
+        if ( !errorString.isEmpty() ) {
+            break;
+        }
+
+        if ( blocksAdded < blocksRead ) {
+            PbfBlock *const block = queue.take( blocksAdded );
+            ++blocksAdded;
+
+            errorString = block->errorString;
+            if ( errorString.isEmpty() ) {
+                addBlock( *block );
+            }
+            delete block;
+
+            if ( !errorString.isEmpty() ) {
+                break;
+            }
+        }
+    }
+
+    pool.waitForDone();
+    m_nodes.clear();
+    m_ways.clear();
+    m_relations.clear();
+
+    GeoDataDocument *const document = m_document;
+    m_document = 0;
+
+    if ( !errorString.isEmpty() ) {
+        delete document;
+        emit parsingFinished( 0, errorString );
+        return;
+    }
+
+    document->setDocumentRole( role );
+    document->setFileName( fileName );
+
+    emit parsingFinished( document );
+}
+
+bool OsmPbfRunner::readBlob( QIODevice *device, QByteArray &type, QByteArray &blob, QString &errorString )
+{
+    const QByteArray size = device->read( 4 );
+    if ( size.size() != 4 ) {
+        errorString = "Unexpected end of file";
+        return false;
+    }
+
+    const quint32 headerSize = qFromBigEndian<quint32>( reinterpret_cast<const uchar *>( size.constData() ) );
+    if ( headerSize > maximumBlobHeaderSize ) {
+        errorString = QString( "Invalid blob header size %1" ).arg( headerSize );
+        return false;
+    }
+
+    const QByteArray header = device->read( headerSize );
+    OSMPBF::BlobHeader blobHeader;
+    if ( header.size() != int( headerSize ) || !blobHeader.ParseFromArray( header.constData(), header.size() ) ) {
+        errorString = "Unable to parse blob header";
+        return false;
+    }
+
+    if ( blobHeader.datasize() < 0 || blobHeader.datasize() > maximumBlobSize ) {
+        errorString = QString( "Invalid blob size %1" ).arg( blobHeader.datasize() );
+        return false;
+    }
+
+    type = QByteArray( blobHeader.type().data(), blobHeader.type().size() );
+    blob = device->read( blobHeader.datasize() );
+    if ( blob.size() != blobHeader.datasize() ) {
+        errorString = "Unable to read blob";
+        return false;
+    }
+
+    return true;
+}
+
+bool OsmPbfRunner::checkHeader( const QByteArray &blob, QString &errorString )
+{
+    QByteArray data;
+    if ( !PbfBlockDecoder::uncompress( blob, data, errorString ) ) {
+        return false;
+    }
+
+    OSMPBF::HeaderBlock headerBlock;
+    if ( !headerBlock.ParseFromArray( data.constData(), data.size() ) ) {
+        errorString = "Unable to parse header block";
+        return false;
+    }
+
+    for ( int i = 0; i < headerBlock.required_features_size(); ++i ) {
+        const std::string &feature = headerBlock.required_features( i );
+        if ( feature != "OsmSchema-V0.6" && feature != "DenseNodes" ) {
+            errorString = QString( "Support for feature %1 not implemented" ).arg( QString::fromUtf8( feature.c_str() ) );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void OsmPbfRunner::addBlock( const PbfBlock &block )
+{
+    foreach ( const PbfNode &node, block.nodes ) {
+        m_nodes.appendNode( node.id, node.lon, node.lat );
+    }
+
+    // Same as OsmTagTagHandler: only tagged nodes which are named or
+    // belong to a visual category become placemarks
+    foreach ( const PbfTaggedNode &node, block.taggedNodes ) {
+        GeoDataPlacemark *placemark = 0;
+        foreach ( const PbfTags::value_type &tag, node.tags ) {
+            if ( tag.first == "created_by" ) {
+                continue;
+            }
+
+            if ( tag.first == "name" ) {
+                if ( !placemark ) {
+                    placemark = createPoi( GeoDataCoordinates( node.node.lon, node.node.lat, 0, GeoDataCoordinates::Degree ) );
+                }
+                placemark->setName( tag.second );
+                continue;
+            }
+
+            if ( GeoDataFeature::OsmVisualCategory( tag.first + '=' + tag.second ) ) {
+                if ( !placemark ) {
+                    placemark = createPoi( GeoDataCoordinates( node.node.lon, node.node.lat, 0, GeoDataCoordinates::Degree ) );
+                }
+                placemark->setVisible( true );
+            }
+
+            if ( placemark ) {
+                osm::OsmGlobals::addVisualCategory( m_document, placemark, tag.first, tag.second );
+            }
+        }
+    }
+
+    foreach ( const PbfWay &way, block.ways ) {
+        bool isArea = false;
+        foreach ( const PbfTags::value_type &tag, way.tags ) {
+            isArea = isArea || osm::OsmGlobals::tagNeedArea( tag.first + '=' + tag.second );
+        }
+
+        GeoDataLineString *polyline = 0;
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        if ( isArea ) {
+            GeoDataPolygon *polygon = new GeoDataPolygon;
+            placemark->setGeometry( polygon );
+            polyline = &polygon->outerBoundary();
+        } else {
+            polyline = new GeoDataLineString;
+            placemark->setGeometry( polyline );
+        }
+
+        foreach ( qint64 id, way.nodes ) {
+            const GeoDataCoordinates coordinates = m_nodes.coordinates( id );
+            if ( coordinates.isValid() ) {
+                polyline->append( coordinates );
+            }
+        }
+
+        placemark->setVisible( false );
+        m_document->append( placemark );
+        m_ways.appendLine( way.id, polyline );
+
+        addTags( placemark, way.tags );
+    }
+
+    // Relations only refer to ways and other relations, and all ways
+    // precede them in the file
+    if ( !block.relations.isEmpty() && m_nodes.count() > 0 ) {
+        m_nodes.clear();
+    }
+
+    foreach ( const PbfRelation &relation, block.relations ) {
+        GeoDataPolygon *polygon = new GeoDataPolygon;
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        placemark->setGeometry( polygon );
+        placemark->setVisible( false );
+        m_document->append( placemark );
+        m_relations.appendPolygon( relation.id, polygon );
+
+        // Same as OsmMemberTagHandler
+        foreach ( const PbfMember &member, relation.members ) {
+            if ( member.type == PbfMember::Way ) {
+                GeoDataLineString *line = m_ways.line( member.id );
+                if ( !line ) {
+                    continue;
+                }
+
+                if ( member.role == "outer" || member.role.isEmpty() ) {
+                    osm::OsmGlobals::appendOuterWay( polygon, *line );
+                } else if ( member.role == "inner" ) {
+                    polygon->appendInnerBoundary( GeoDataLinearRing( *line ) );
+                }
+            } else if ( member.type == PbfMember::Relation ) {
+                if ( member.role == "outer" ) {
+                    mDebug() << "Parsed relation with a relation outer member";
+                } else if ( member.role == "inner" || member.role == "subarea" || member.role.isEmpty() ) {
+                    if ( GeoDataPolygon *p = m_relations.polygon( member.id ) ) {
+                        polygon->appendInnerBoundary( p->outerBoundary() );
+                    }
+                }
+            }
+        }
+
+        addTags( placemark, relation.tags );
+    }
+}
+
+GeoDataPlacemark *OsmPbfRunner::createPoi( const GeoDataCoordinates &coordinates )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setGeometry( new GeoDataPoint( coordinates ) );
+    placemark->setVisible( false );
+    placemark->setZoomLevel( 18 );
+    m_document->append( placemark );
+    return placemark;
+}
+
+void OsmPbfRunner::addTags( GeoDataPlacemark *placemark, const PbfTags &tags )
+{
+    foreach ( const PbfTags::value_type &tag, tags ) {
+        if ( tag.first == "created_by" ) {
+            continue;
+        }
+
+        if ( tag.first == "name" ) {
+            placemark->setName( tag.second );
+            continue;
+        }
+
+        if ( tag.first == "building" && tag.second == "yes" && placemark->visualCategory() == GeoDataFeature::Default ) {
+            placemark->setVisualCategory( GeoDataFeature::Building );
+            placemark->setVisible( true );
+        }
+
+        osm::OsmGlobals::addVisualCategory( m_document, placemark, tag.first, tag.second );
+    }
+}
+
+}
+
+#include "OsmPbfRunner.moc"
@@ -0,0 +1,60 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#ifndef MARBLE_OSMPBFRUNNER_H
+#define MARBLE_OSMPBFRUNNER_H
+
+#include "ParsingRunner.h"
+
+#include "OsmNodeFactory.h"
+#include "OsmWayFactory.h"
+#include "OsmRelationFactory.h"
+#include "PbfBlockDecoder.h"
+
+class QIODevice;
+
+namespace Marble
+{
+
+class GeoDataPlacemark;
+
+/**
+ * Reads OpenStreetMap data in the binary .osm.pbf format.
+ *
+ * The blobs of the file are decompressed and decoded in parallel, while the
+ * runner thread reads ahead a limited number of blobs and assembles the
+ * decoded blocks in file order into the document.
+ */
+class OsmPbfRunner : public ParsingRunner
+{
+    Q_OBJECT
+public:
+    explicit OsmPbfRunner( QObject *parent = 0 );
+    ~OsmPbfRunner();
+
+    virtual void parseFile( const QString &fileName, DocumentRole role );
+
+private:
+    static bool readBlob( QIODevice *device, QByteArray &type, QByteArray &blob, QString &errorString );
+    static bool checkHeader( const QByteArray &blob, QString &errorString );
+
+    void addBlock( const PbfBlock &block );
+    GeoDataPlacemark *createPoi( const GeoDataCoordinates &coordinates );
+    void addTags( GeoDataPlacemark *placemark, const PbfTags &tags );
+
+    GeoDataDocument *m_document;
+    osm::OsmNodeFactory m_nodes;
+    osm::OsmWayFactory m_ways;
+    osm::OsmRelationFactory m_relations;
+};
+
+}
+
+#endif
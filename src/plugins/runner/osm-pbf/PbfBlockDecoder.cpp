@@ -0,0 +1,254 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+// The blob handling follows PbfParser of the osm-addresses tool.
+
+#include "PbfBlockDecoder.h"
+
+#include "fileformat.pb.h"
+#include "osmformat.pb.h"
+
+#include <QtCore/QtEndian>
+#include <QtCore/QMutexLocker>
+
+#include <cstring>
+
+namespace Marble
+{
+
+PbfBlockQueue::PbfBlockQueue()
+{
+}
+
+PbfBlockQueue::~PbfBlockQueue()
+{
+    qDeleteAll( m_blocks );
+}
+
+void PbfBlockQueue::add( int index, PbfBlock *block )
+{
+    QMutexLocker locker( &m_mutex );
+    m_blocks.insert( index, block );
+    m_blockAdded.wakeAll();
+}
+
+PbfBlock *PbfBlockQueue::take( int index )
+{
+    QMutexLocker locker( &m_mutex );
+    while ( !m_blocks.contains( index ) ) {
+        m_blockAdded.wait( &m_mutex );
+    }
+
+    return m_blocks.take( index );
+}
+
+PbfBlockDecoder::PbfBlockDecoder( PbfBlockQueue *queue, int index, const QByteArray &blob ) :
+    m_queue( queue ),
+    m_index( index ),
+    m_blob( blob )
+{
+}
+
+void PbfBlockDecoder::run()
+{
+    PbfBlock *block = new PbfBlock;
+    if ( !decode( block ) ) {
+        block->nodes.clear();
+        block->taggedNodes.clear();
+        block->ways.clear();
+        block->relations.clear();
+    }
+
+    m_queue->add( m_index, block );
+}
+
+bool PbfBlockDecoder::uncompress( const QByteArray &blob, QByteArray &data, QString &errorString )
+{
+    OSMPBF::Blob message;
+    if ( !message.ParseFromArray( blob.constData(), blob.size() ) ) {
+        errorString = "Failed to parse blob";
+        return false;
+    }
+
+    if ( message.has_raw() ) {
+        data = QByteArray( message.raw().data(), message.raw().size() );
+    } else if ( message.has_zlib_data() ) {
+        // qUncompress() expects the uncompressed size in front of the zlib stream
+        const std::string &zlibData = message.zlib_data();
+        QByteArray compressed( 4 + zlibData.size(), Qt::Uninitialized );
+        qToBigEndian<quint32>( message.raw_size(), reinterpret_cast<uchar *>( compressed.data() ) );
+        memcpy( compressed.data() + 4, zlibData.data(), zlibData.size() );
+
+        data = qUncompress( compressed );
+        if ( data.size() != message.raw_size() ) {
+            errorString = "Failed to inflate blob";
+            return false;
+        }
+    } else if ( message.has_lzma_data() ) {
+        errorString = "No support for lzma compressed blobs implemented";
+        return false;
+    } else {
+        errorString = "Blob contains no data";
+        return false;
+    }
+
+    return true;
+}
+
+bool PbfBlockDecoder::decode( PbfBlock *block )
+{
+    QByteArray data;
+    if ( !uncompress( m_blob, data, block->errorString ) ) {
+        return false;
+    }
+
+    OSMPBF::PrimitiveBlock primitiveBlock;
+    if ( !primitiveBlock.ParseFromArray( data.constData(), data.size() ) ) {
+        block->errorString = "Failed to parse PrimitiveBlock";
+        return false;
+    }
+    data.clear();
+
+    // Every string is converted once, not once for each use
+    const OSMPBF::StringTable &stringTable = primitiveBlock.stringtable();
+    QVector<QString> strings( stringTable.s_size() );
+    for ( int i = 0; i < stringTable.s_size(); ++i ) {
+        strings[i] = QString::fromUtf8( stringTable.s( i ).data(), stringTable.s( i ).size() );
+    }
+
+    const qint64 granularity = primitiveBlock.granularity();
+    const qint64 latOffset = primitiveBlock.lat_offset();
+    const qint64 lonOffset = primitiveBlock.lon_offset();
+
+    for ( int g = 0; g < primitiveBlock.primitivegroup_size(); ++g ) {
+        const OSMPBF::PrimitiveGroup &group = primitiveBlock.primitivegroup( g );
+
+        for ( int i = 0; i < group.nodes_size(); ++i ) {
+            const OSMPBF::Node &inputNode = group.nodes( i );
+            PbfNode node;
+            node.id = inputNode.id();
+            node.lat = ( latOffset + granularity * inputNode.lat() ) * 1e-9;
+            node.lon = ( lonOffset + granularity * inputNode.lon() ) * 1e-9;
+            block->nodes.append( node );
+
+            if ( inputNode.keys_size() > 0 ) {
+                PbfTaggedNode taggedNode;
+                taggedNode.node = node;
+                for ( int tag = 0; tag < inputNode.keys_size() && tag < inputNode.vals_size(); ++tag ) {
+                    taggedNode.tags.append( qMakePair( strings.value( inputNode.keys( tag ) ),
+                                                       strings.value( inputNode.vals( tag ) ) ) );
+                }
+                block->taggedNodes.append( taggedNode );
+            }
+        }
+
+        if ( group.has_dense() ) {
+            const OSMPBF::DenseNodes &dense = group.dense();
+            if ( dense.lat_size() != dense.id_size() || dense.lon_size() != dense.id_size() ) {
+                block->errorString = "Inconsistent dense nodes";
+                return false;
+            }
+
+            block->nodes.reserve( block->nodes.size() + dense.id_size() );
+
+            // Ids and coordinates are delta coded. The tags of all nodes are
+            // stored in one array as key/value pairs, each node terminated by 0.
+            qint64 id = 0;
+            qint64 lat = 0;
+            qint64 lon = 0;
+            int keyValue = 0;
+            for ( int i = 0; i < dense.id_size(); ++i ) {
+                id += dense.id( i );
+                lat += dense.lat( i );
+                lon += dense.lon( i );
+
+                PbfNode node;
+                node.id = id;
+                node.lat = ( latOffset + granularity * lat ) * 1e-9;
+                node.lon = ( lonOffset + granularity * lon ) * 1e-9;
+                block->nodes.append( node );
+
+                if ( keyValue < dense.keys_vals_size() && dense.keys_vals( keyValue ) != 0 ) {
+                    PbfTaggedNode taggedNode;
+                    taggedNode.node = node;
+                    while ( keyValue + 1 < dense.keys_vals_size() && dense.keys_vals( keyValue ) != 0 ) {
+                        taggedNode.tags.append( qMakePair( strings.value( dense.keys_vals( keyValue ) ),
+                                                           strings.value( dense.keys_vals( keyValue + 1 ) ) ) );
+                        keyValue += 2;
+                    }
+                    block->taggedNodes.append( taggedNode );
+                }
+
+                // skip the terminating 0
+                ++keyValue;
+            }
+        }
+
+        for ( int i = 0; i < group.ways_size(); ++i ) {
+            const OSMPBF::Way &inputWay = group.ways( i );
+            PbfWay way;
+            way.id = inputWay.id();
+
+            way.nodes.reserve( inputWay.refs_size() );
+            qint64 ref = 0;
+            for ( int j = 0; j < inputWay.refs_size(); ++j ) {
+                ref += inputWay.refs( j );
+                way.nodes.append( ref );
+            }
+
+            for ( int tag = 0; tag < inputWay.keys_size() && tag < inputWay.vals_size(); ++tag ) {
+                way.tags.append( qMakePair( strings.value( inputWay.keys( tag ) ),
+                                            strings.value( inputWay.vals( tag ) ) ) );
+            }
+
+            block->ways.append( way );
+        }
+
+        for ( int i = 0; i < group.relations_size(); ++i ) {
+            const OSMPBF::Relation &inputRelation = group.relations( i );
+            PbfRelation relation;
+            relation.id = inputRelation.id();
+
+            qint64 memberId = 0;
+            const int memberCount = qMin( inputRelation.memids_size(), inputRelation.types_size() );
+            relation.members.reserve( memberCount );
+            for ( int j = 0; j < memberCount; ++j ) {
+                memberId += inputRelation.memids( j );
+
+                PbfMember member;
+                member.id = memberId;
+                member.role = j < inputRelation.roles_sid_size() ? strings.value( inputRelation.roles_sid( j ) ) : QString();
+                switch ( inputRelation.types( j ) ) {
+                case OSMPBF::Relation::NODE:
+                    member.type = PbfMember::Node;
+                    break;
+                case OSMPBF::Relation::WAY:
+                    member.type = PbfMember::Way;
+                    break;
+                case OSMPBF::Relation::RELATION:
+                    member.type = PbfMember::Relation;
+                    break;
+                }
+                relation.members.append( member );
+            }
+
+            for ( int tag = 0; tag < inputRelation.keys_size() && tag < inputRelation.vals_size(); ++tag ) {
+                relation.tags.append( qMakePair( strings.value( inputRelation.keys( tag ) ),
+                                                 strings.value( inputRelation.vals( tag ) ) ) );
+            }
+
+            block->relations.append( relation );
+        }
+    }
+
+    return true;
+}
+
+}
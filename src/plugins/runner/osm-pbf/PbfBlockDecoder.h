@@ -0,0 +1,137 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#ifndef MARBLE_PBFBLOCKDECODER_H
+#define MARBLE_PBFBLOCKDECODER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QRunnable>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+namespace Marble
+{
+
+typedef QVector<QPair<QString, QString> > PbfTags;
+
+struct PbfNode
+{
+    qint64 id;
+    qreal lon;
+    qreal lat;
+};
+
+struct PbfTaggedNode
+{
+    PbfNode node;
+    PbfTags tags;
+};
+
+struct PbfWay
+{
+    qint64 id;
+    QVector<qint64> nodes;
+    PbfTags tags;
+};
+
+struct PbfMember
+{
+    enum Type {
+        Node,
+        Way,
+        Relation
+    };
+
+    Type type;
+    qint64 id;
+    QString role;
+};
+
+struct PbfRelation
+{
+    qint64 id;
+    QVector<PbfMember> members;
+    PbfTags tags;
+};
+
+/**
+ * The OSM data of one PrimitiveBlock of a .osm.pbf file, converted to Qt types.
+ */
+struct PbfBlock
+{
+    /** All nodes of the block, with or without tags */
+    QVector<PbfNode> nodes;
+    /** The nodes which have tags */
+    QVector<PbfTaggedNode> taggedNodes;
+    QVector<PbfWay> ways;
+    QVector<PbfRelation> relations;
+    /** Empty unless the block could not be decoded */
+    QString errorString;
+};
+
+/**
+ * Collects the decoded blocks of a file, which may be finished in any order,
+ * for the thread that assembles them in file order.
+ */
+class PbfBlockQueue
+{
+ public:
+    PbfBlockQueue();
+    ~PbfBlockQueue();
+
+    /**
+     * Adds the decoded block @p index to the queue, taking ownership of @p block.
+     */
+    void add( int index, PbfBlock *block );
+
+    /**
+     * Waits until block @p index was added and returns it. The caller takes
+     * ownership of the block.
+     */
+    PbfBlock *take( int index );
+
+ private:
+    Q_DISABLE_COPY( PbfBlockQueue )
+
+    QMutex m_mutex;
+    QWaitCondition m_blockAdded;
+    QHash<int, PbfBlock *> m_blocks;
+};
+
+/**
+ * Decompresses and decodes one OSMData blob on a thread pool.
+ */
+class PbfBlockDecoder : public QRunnable
+{
+ public:
+    PbfBlockDecoder( PbfBlockQueue *queue, int index, const QByteArray &blob );
+
+    virtual void run();
+
+    /**
+     * Extracts the uncompressed content of the Blob message @p blob into @p data.
+     */
+    static bool uncompress( const QByteArray &blob, QByteArray &data, QString &errorString );
+
+ private:
+    bool decode( PbfBlock *block );
+
+    PbfBlockQueue *const m_queue;
+    const int m_index;
+    const QByteArray m_blob;
+};
+
+}
+
+#endif
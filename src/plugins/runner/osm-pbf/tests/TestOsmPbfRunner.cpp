@@ -0,0 +1,172 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataPolygon.h"
+#include "MarbleDebug.h"
+#include "OsmPbfRunner.h"
+
+using namespace Marble;
+
+// data/small.osm.pbf holds a header block and two data blocks:
+//
+// - a zlib compressed block with the dense nodes 1 to 9, where node 1 is
+//   named "Berlin", node 2 is a cafe and node 3 only has a created_by tag
+// - an uncompressed block with the closed building way 10 (nodes 4, 5, 6),
+//   the closed untagged way 11 (nodes 7, 8, 9) and the multipolygon
+//   relation 20 with way 11 as outer member and natural=water
+//
+// Coordinates are stored with the default granularity of 100 nanodegrees.
+
+class TestOsmPbfRunner : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void setResult( GeoDataDocument *document, const QString &error );
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void parseFile();
+    void truncatedFile();
+    void missingFile();
+
+private:
+    void parse( const QString &fileName );
+
+    GeoDataDocument *m_document;
+    QString m_error;
+    int m_resultCount;
+};
+
+void TestOsmPbfRunner::setResult( GeoDataDocument *document, const QString &error )
+{
+    m_document = document;
+    m_error = error;
+    ++m_resultCount;
+}
+
+void TestOsmPbfRunner::initTestCase()
+{
+    MarbleDebug::enable = true;
+}
+
+void TestOsmPbfRunner::init()
+{
+    m_document = 0;
+    m_error.clear();
+    m_resultCount = 0;
+}
+
+void TestOsmPbfRunner::cleanup()
+{
+    delete m_document;
+    m_document = 0;
+}
+
+void TestOsmPbfRunner::parse( const QString &fileName )
+{
+    OsmPbfRunner runner;
+    connect( &runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
+             this, SLOT(setResult(GeoDataDocument*,QString)) );
+    runner.parseFile( fileName, UserDocument );
+}
+
+void TestOsmPbfRunner::parseFile()
+{
+    const QString fileName = TESTSRCDIR "/data/small.osm.pbf";
+    parse( fileName );
+
+    QCOMPARE( m_resultCount, 1 );
+    QVERIFY2( m_document, m_error.toLatin1() );
+    QCOMPARE( m_document->fileName(), fileName );
+    QCOMPARE( m_document->documentRole(), UserDocument );
+
+    const QVector<GeoDataPlacemark *> placemarks = m_document->placemarkList();
+    QCOMPARE( placemarks.size(), 5 );
+
+    // the blocks are assembled in file order, nodes without a name or
+    // category don't become placemarks
+    const GeoDataPlacemark *const berlin = placemarks.at( 0 );
+    QCOMPARE( berlin->name(), QString( "Berlin" ) );
+    const GeoDataPoint *const point = dynamic_cast<const GeoDataPoint *>( berlin->geometry() );
+    QVERIFY( point );
+    QCOMPARE( point->coordinates().latitude( GeoDataCoordinates::Degree ), 52.5 );
+    QCOMPARE( point->coordinates().longitude( GeoDataCoordinates::Degree ), 13.4 );
+
+    const GeoDataPlacemark *const cafe = placemarks.at( 1 );
+    QCOMPARE( cafe->visualCategory(), GeoDataFeature::FoodCafe );
+    QVERIFY( cafe->isVisible() );
+
+    // building=yes needs an area
+    const GeoDataPlacemark *const building = placemarks.at( 2 );
+    QCOMPARE( building->visualCategory(), GeoDataFeature::Building );
+    const GeoDataPolygon *const buildingPolygon = dynamic_cast<const GeoDataPolygon *>( building->geometry() );
+    QVERIFY( buildingPolygon );
+    QCOMPARE( buildingPolygon->outerBoundary().size(), 4 );
+    QCOMPARE( buildingPolygon->outerBoundary().at( 1 ).longitude( GeoDataCoordinates::Degree ), 13.1 );
+
+    const GeoDataPlacemark *const way = placemarks.at( 3 );
+    const GeoDataLineString *const line = dynamic_cast<const GeoDataLineString *>( way->geometry() );
+    QVERIFY( line );
+    QVERIFY( !dynamic_cast<const GeoDataPolygon *>( way->geometry() ) );
+    QCOMPARE( line->size(), 4 );
+
+    // the relation refers to a way of the same block
+    const GeoDataPlacemark *const water = placemarks.at( 4 );
+    QCOMPARE( water->visualCategory(), GeoDataFeature::NaturalWater );
+    const GeoDataPolygon *const waterPolygon = dynamic_cast<const GeoDataPolygon *>( water->geometry() );
+    QVERIFY( waterPolygon );
+    QCOMPARE( waterPolygon->outerBoundary().size(), 4 );
+    QCOMPARE( waterPolygon->outerBoundary().at( 2 ).latitude( GeoDataCoordinates::Degree ), 53.1 );
+}
+
+void TestOsmPbfRunner::truncatedFile()
+{
+    QFile source( TESTSRCDIR "/data/small.osm.pbf" );
+    QVERIFY( source.open( QIODevice::ReadOnly ) );
+    const QByteArray data = source.readAll();
+
+    // cut off the last blob in the middle
+    QFile truncated( QDir::tempPath() + "/marble-testosmpbfrunner.osm.pbf" );
+    QVERIFY( truncated.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    truncated.write( data.left( data.size() - 10 ) );
+    truncated.close();
+
+    parse( truncated.fileName() );
+    truncated.remove();
+
+    QCOMPARE( m_resultCount, 1 );
+    QVERIFY( !m_document );
+    QVERIFY( !m_error.isEmpty() );
+}
+
+void TestOsmPbfRunner::missingFile()
+{
+    parse( TESTSRCDIR "/data/missing.osm.pbf" );
+
+    QCOMPARE( m_resultCount, 1 );
+    QVERIFY( !m_document );
+}
+
+QTEST_MAIN( TestOsmPbfRunner )
+
+#include "TestOsmPbfRunner.moc"
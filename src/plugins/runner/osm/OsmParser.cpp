@@ -10,11 +10,7 @@
 #include "OsmParser.h"
 #include "OsmElementDictionary.h"
 #include "GeoDataDocument.h"
-
-#include "OsmNodeFactory.h"
-#include "OsmWayFactory.h"
-#include "OsmRelationFactory.h"
-#include "OsmGlobals.h"
+#include "GeoDataPlacemark.h"
 
 namespace Marble {
 
@@ -25,10 +21,12 @@ OsmParser::OsmParser()
 
 OsmParser::~OsmParser()
 {
-    osm::OsmRelationFactory::clear();
-    osm::OsmWayFactory::clear();
-    osm::OsmNodeFactory::clear();
-    osm::OsmGlobals::cleanUpDummyPlacemarks();
+    qDeleteAll( m_dummyPlacemarks );
+}
+
+void OsmParser::addDummyPlacemark( GeoDataPlacemark *placemark )
+{
+    m_dummyPlacemarks << placemark;
 }
 
 bool OsmParser::isValidRootElement()
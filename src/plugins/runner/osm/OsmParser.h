@@ -11,21 +11,54 @@
 #define OSMPARSER_H
 
 #include "GeoParser.h"
+#include "GeoDataPoint.h"
+#include "OsmNodeFactory.h"
+#include "OsmWayFactory.h"
+#include "OsmRelationFactory.h"
+
+#include <QtCore/QList>
 
 namespace Marble {
 
+class GeoDataPlacemark;
+
+/**
+ * All state collected while parsing is owned by the parser, so that several
+ * files can be parsed concurrently.
+ */
 class OsmParser : public GeoParser
 {
 public:
     OsmParser();
     virtual ~OsmParser();
 
+    osm::OsmNodeFactory &nodes() { return m_nodes; }
+    osm::OsmWayFactory &ways() { return m_ways; }
+    osm::OsmRelationFactory &relations() { return m_relations; }
+
+    /**
+     * Returns the geometry which represents the node being parsed. It is
+     * reused for all nodes, so it must be copied to be kept.
+     */
+    GeoDataPoint *currentNode() { return &m_currentNode; }
+
+    /**
+     * Takes ownership of @p placemark, which got replaced in the document
+     * but is still referenced while parsing.
+     */
+    void addDummyPlacemark( GeoDataPlacemark *placemark );
+
 private:
     virtual bool isValidElement(const QString& tagName) const;
     virtual bool isValidRootElement();
 
     virtual GeoDocument* createDocument() const;
 
+    osm::OsmNodeFactory m_nodes;
+    osm::OsmWayFactory m_ways;
+    osm::OsmRelationFactory m_relations;
+    GeoDataPoint m_currentNode;
+    QList<GeoDataPlacemark *> m_dummyPlacemarks;
 };
 
 }
@@ -44,6 +44,11 @@ void OsmRunner::parseFile( const QString &fileName, DocumentRole role = UnknownD
         emit parsingFinished( 0, parser.errorString() );
         return;
     }
+
+    // Ways may follow relations in files merged by other tools, so the
+    // nodes are only released once the whole file is read
+    parser.nodes().clear();
+
     GeoDocument* document = parser.releaseDocument();
     Q_ASSERT( document );
     GeoDataDocument* doc = static_cast<GeoDataDocument*>( document );
@@ -11,6 +11,7 @@
 #include "OsmGlobals.h"
 #include "GeoDataStyle.h"
 #include "GeoDataPlacemark.h"
+#include "GeoDataPolygon.h"
 #include "GeoDataDocument.h"
 #include "GeoDataIconStyle.h"
 #include "MarbleGlobal.h"
@@ -20,69 +21,182 @@ namespace Marble
 {
 namespace osm
 {
-QList<QString> OsmGlobals::m_areaTags;
-
 QColor OsmGlobals::backgroundColor( 0xF1, 0xEE, 0xE8 );
-QList<GeoDataPlacemark*> OsmGlobals::dummyPlacemarks;
 
-bool OsmGlobals::tagNeedArea(const QString& keyValue)
+static QList<QString> setupAreaTags()
 {
-    if ( m_areaTags.count() < 1 )
-        setupAreaTags();
-    
-    return qBinaryFind( m_areaTags.constBegin(), m_areaTags.constEnd(), keyValue ) != m_areaTags.constEnd();
-}
+    QList<QString> areaTags;
 
-void OsmGlobals::setupAreaTags()
-{
     // All these tags can be found updated at
     // http://wiki.openstreetmap.org/wiki/Map_Features#Landuse
 
-    m_areaTags.append( "landuse=forest" );
-    m_areaTags.append( "natural=wood" );
-    m_areaTags.append( "area=yes" );
-    m_areaTags.append( "waterway=riverbank" );
-    m_areaTags.append( "building=yes" );
-    m_areaTags.append( "amenity=parking" );
-    m_areaTags.append( "leisure=park" );
+    areaTags.append( "landuse=forest" );
+    areaTags.append( "natural=wood" );
+    areaTags.append( "area=yes" );
+    areaTags.append( "waterway=riverbank" );
+    areaTags.append( "building=yes" );
+    areaTags.append( "amenity=parking" );
+    areaTags.append( "leisure=park" );
     
-    m_areaTags.append( "landuse=allotments" );
-    m_areaTags.append( "landuse=basin" );
-    m_areaTags.append( "landuse=brownfield" );
-    m_areaTags.append( "landuse=cemetery" );
-    m_areaTags.append( "landuse=commercial" );
-    m_areaTags.append( "landuse=construction" );
-    m_areaTags.append( "landuse=farm" );
-    m_areaTags.append( "landuse=farmland" );
-    m_areaTags.append( "landuse=farmyard" );
-    m_areaTags.append( "landuse=garages" );
-    m_areaTags.append( "landuse=greenfield" );
-    m_areaTags.append( "landuse=industrial" );
-    m_areaTags.append( "landuse=landfill" );
-    m_areaTags.append( "landuse=meadow" );
-    m_areaTags.append( "landuse=military" );
-    m_areaTags.append( "landuse=orchard" );
-    m_areaTags.append( "landuse=quarry" );
-    m_areaTags.append( "landuse=railway" );
-    m_areaTags.append( "landuse=reservoir" );
-    m_areaTags.append( "landuse=residential" );
-    m_areaTags.append( "landuse=retail" );
+    areaTags.append( "landuse=allotments" );
+    areaTags.append( "landuse=basin" );
+    areaTags.append( "landuse=brownfield" );
+    areaTags.append( "landuse=cemetery" );
+    areaTags.append( "landuse=commercial" );
+    areaTags.append( "landuse=construction" );
+    areaTags.append( "landuse=farm" );
+    areaTags.append( "landuse=farmland" );
+    areaTags.append( "landuse=farmyard" );
+    areaTags.append( "landuse=garages" );
+    areaTags.append( "landuse=greenfield" );
+    areaTags.append( "landuse=industrial" );
+    areaTags.append( "landuse=landfill" );
+    areaTags.append( "landuse=meadow" );
+    areaTags.append( "landuse=military" );
+    areaTags.append( "landuse=orchard" );
+    areaTags.append( "landuse=quarry" );
+    areaTags.append( "landuse=railway" );
+    areaTags.append( "landuse=reservoir" );
+    areaTags.append( "landuse=residential" );
+    areaTags.append( "landuse=retail" );
     
-    qSort( m_areaTags.begin(), m_areaTags.end() );
+    qSort( areaTags.begin(), areaTags.end() );
+
+    return areaTags;
+}
+
+// Q_GLOBAL_STATIC makes sure the tags are set up once, even if
+// several files are parsed concurrently
+Q_GLOBAL_STATIC_WITH_INITIALIZER( QList<QString>, s_areaTags, { *x = setupAreaTags(); } )
+
+bool OsmGlobals::tagNeedArea(const QString& keyValue)
+{
+    const QList<QString> &areaTags = *s_areaTags();
+    return qBinaryFind( areaTags.constBegin(), areaTags.constEnd(), keyValue ) != areaTags.constEnd();
 }
 
-void OsmGlobals::addDummyPlacemark( GeoDataPlacemark* placemark )
+void OsmGlobals::addVisualCategory( GeoDataDocument *document, GeoDataPlacemark *placemark,
+                                    const QString &key, const QString &value )
 {
-    dummyPlacemarks << placemark;
+    GeoDataFeature::GeoDataVisualCategory category;
+
+    if ( ( category = GeoDataFeature::OsmVisualCategory( key + '=' + value ) ) )
+    {
+        if( placemark->visualCategory() != GeoDataFeature::Default 
+         && placemark->visualCategory() != GeoDataFeature::Building )
+        {
+            GeoDataPlacemark* newPlacemark = new GeoDataPlacemark( *placemark );
+            newPlacemark->setVisualCategory( category );
+            newPlacemark->setStyle( 0 );
+            newPlacemark->setVisible( true );
+            document->append( newPlacemark );
+        }
+        else
+        {
+            //Remove assigned style (i.e. building style)
+            placemark->setStyle( 0 );
+            placemark->setVisualCategory( category );
+            placemark->setVisible( true );
+        }
+    }
+    else if ( ( category = GeoDataFeature::OsmVisualCategory( key ) ) )
+    {
+        if( placemark->visualCategory() != GeoDataFeature::Default )
+        {
+            GeoDataPlacemark* newPlacemark = new GeoDataPlacemark( *placemark );
+            newPlacemark->setVisualCategory( category );
+            newPlacemark->setStyle( 0 );
+            newPlacemark->setVisible( true );
+            document->append( newPlacemark );
+        }
+        else
+        {
+            //Remove assigned style (i.e. building style)
+            placemark->setStyle( 0 );
+            placemark->setVisualCategory( category );
+            placemark->setVisible( true );
+        }
+    }
 }
 
-void OsmGlobals::cleanUpDummyPlacemarks()
+void OsmGlobals::appendOuterWay( GeoDataPolygon *polygon, const GeoDataLineString &line )
 {
-    foreach( GeoDataFeature* placemark, dummyPlacemarks )
+    // Some of the ways that build the relation
+    // might be in opposite directions
+    // so the final linearRing would be wrong.
+    // It is needed to seek in the linearRing
+    // to know if the new way should be added
+    // at the beginning or end and in which order.
+    // Also the shared node (which will be in both
+    // geometries) has to be removed to avoid having
+    // it repeated.
+
+    GeoDataLinearRing envelope = polygon->outerBoundary();
+
+    // Case 0: envelope is empty
+    if ( envelope.isEmpty() )
     {
-        delete placemark;
+        envelope = line;
     }
-    dummyPlacemarks.clear();
+
+    // Case 1: line.first = envelope.first
+    else if ( line.first() == envelope.first() )
+    {
+        GeoDataLinearRing temp = GeoDataLinearRing( envelope.tessellationFlags() );
+
+        // Invert envelopes direction
+        for (int x = envelope.size()-1; x > -1; x--)
+        {
+            temp.append( GeoDataCoordinates ( envelope.at(x) ) );
+        }
+        envelope = temp;
+
+        // Now its the same as case 2
+        // envelope-last not to repeat the shared node
+        envelope.remove( envelope.size() - 1 );
+        envelope << line;
+    }
+
+    // Case 2: line.first = envelope.last
+    else if (line.first() == envelope.last() )
+    {
+        // envelope-last not to repeat the shared node
+        envelope.remove( envelope.size() - 1 );
+        envelope << line;
+    }
+
+    // Case 3: line.last = envelope.first
+    else if (line.last() == envelope.first() )
+    {
+        GeoDataLinearRing temp = GeoDataLinearRing( envelope.tessellationFlags() );
+
+        // Invert envelopes direction
+        for (int x = envelope.size()-1; x > -1; x--)
+        {
+            temp.append( GeoDataCoordinates ( envelope.at(x) ) );
+        }
+        envelope = temp;
+
+        // Now its the same as case 4
+        // size-2 not to repeat the shared node
+        for (int x = line.size()-2; x > -1; x--)
+        {
+            envelope.append( GeoDataCoordinates ( line.at(x) ) );
+        }
+    }
+
+    // Case 4: line.last = envelope.last
+    else if (line.last() == envelope.last() )
+    {
+        // size-2 not to repeat the shared node
+        for (int x = line.size()-2; x > -1; x--)
+        {
+            envelope.append( GeoDataCoordinates ( line.at(x) ) );
+        }
+    }
+
+    // Update the outer boundary
+    polygon->setOuterBoundary( envelope );
 }
 
 }
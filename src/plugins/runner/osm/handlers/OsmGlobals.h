@@ -21,6 +21,9 @@ namespace Marble
 {
 class GeoDataStyle;
 class GeoDataPlacemark;
+class GeoDataDocument;
+class GeoDataLineString;
+class GeoDataPolygon;
 
 namespace osm
 {
@@ -29,18 +32,26 @@ class OsmGlobals
 {
 public:
     static bool tagNeedArea( const QString& keyValue );
-    static void addDummyPlacemark( GeoDataPlacemark *placemark );
-    static void cleanUpDummyPlacemarks();
+
+    /**
+     * Assigns the visual category of the tag @p key = @p value to @p placemark.
+     * If the placemark has a category already, a copy of it with the new
+     * category is appended to @p document instead.
+     */
+    static void addVisualCategory( GeoDataDocument *document, GeoDataPlacemark *placemark,
+                                   const QString &key, const QString &value );
+
+    /**
+     * Joins the way @p line to the outer boundary of @p polygon at the
+     * node both have in common.
+     */
+    static void appendOuterWay( GeoDataPolygon *polygon, const GeoDataLineString &line );
 
     static QColor buildingColor;
     static QColor backgroundColor;
 
 private:
     static void setupCategories();
-    static void setupAreaTags();
-    
-    static QList<QString> m_areaTags;
-    static QList<GeoDataPlacemark*> dummyPlacemarks;
 };
 
 }
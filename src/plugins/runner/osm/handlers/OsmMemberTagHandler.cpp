@@ -13,8 +13,8 @@
 #include "OsmMemberTagHandler.h"
 
 #include "GeoParser.h"
-#include "OsmWayFactory.h"
-#include "OsmRelationFactory.h"
+#include "OsmParser.h"
+#include "OsmGlobals.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataParser.h"
@@ -56,84 +56,9 @@ GeoNode* OsmMemberTagHandler::parse( GeoParser& parser ) const
                 quint64 id = parser.attribute( "ref" ).toULongLong();
 
                 // With the id we get the way geometry
-                if ( GeoDataLineString *line =  osm::OsmWayFactory::line( id )  )
+                if ( GeoDataLineString *line =  static_cast<OsmParser &>( parser ).ways().line( id )  )
                 {
-                    // Some of the ways that build the relation
-                    // might be in opposite directions
-                    // so the final linearRing would be wrong.
-                    // It is needed to seek in the linearRing
-                    // to know if the new way should be added
-                    // at the beginning or end and in which order.
-                    // Also the shared node (which will be in both
-                    // geometries) has to be removed to avoid having
-                    // it repeated.
-
-                    GeoDataLinearRing envelope = polygon->outerBoundary();
-
-                    // Case 0: envelope is empty
-                    if ( envelope.isEmpty() )
-                    {
-                        envelope = *line;
-                    }
-
-                    // Case 1: line.first = envelope.first
-                    else if ( line->first() == envelope.first() )
-                    {
-                        GeoDataLinearRing temp = GeoDataLinearRing( envelope.tessellationFlags() );
-
-                        // Invert envelopes direction
-                        for (int x = envelope.size()-1; x > -1; x--)
-                        {
-                            temp.append( GeoDataCoordinates ( envelope.at(x) ) );
-                        }
-                        envelope = temp;
-
-                        // Now its the same as case 2
-                        // envelope-last not to repeat the shared node
-                        envelope.remove( envelope.size() - 1 );
-                        envelope << *line;
-                    }
-
-                    // Case 2: line.first = envelope.last
-                    else if (line->first() == envelope.last() )
-                    {
-                        // envelope-last not to repeat the shared node
-                        envelope.remove( envelope.size() - 1 );
-                        envelope << *line;
-                    }
-
-                    // Case 3: line.last = envelope.first
-                    else if (line->last() == envelope.first() )
-                    {
-                        GeoDataLinearRing temp = GeoDataLinearRing( envelope.tessellationFlags() );
-
-                        // Invert envelopes direction
-                        for (int x = envelope.size()-1; x > -1; x--)
-                        {
-                            temp.append( GeoDataCoordinates ( envelope.at(x) ) );
-                        }
-                        envelope = temp;
-
-                        // Now its the same as case 4
-                        // size-2 not to repeat the shared node
-                        for (int x = line->size()-2; x > -1; x--)
-                        {
-                            envelope.append( GeoDataCoordinates ( line->at(x) ) );
-                        }
-                    }
-
-                    // Case 4: line.last = envelope.last
-                    else if (line->last() == envelope.last() )
-                    {
-                        // size-2 not to repeat the shared node
-                        for (int x = line->size()-2; x > -1; x--)
-                        {
-                            envelope.append( GeoDataCoordinates ( line->at(x) ) );
-                        }
-                    }
-
-                    // Update the outer boundary
-                    polygon->setOuterBoundary( envelope );
+                    OsmGlobals::appendOuterWay( polygon, *line );
                 }
             }
 
@@ -145,7 +70,7 @@ GeoNode* OsmMemberTagHandler::parse( GeoParser& parser ) const
                 quint64 id = parser.attribute( "ref" ).toULongLong();
 
                 // With the id we get the way geometry
-                if ( GeoDataLineString *line = osm::OsmWayFactory::line( id ) )
+                if ( GeoDataLineString *line = static_cast<OsmParser &>( parser ).ways().line( id ) )
                 {
                     polygon->appendInnerBoundary( GeoDataLinearRing( *line ) );
                 }
@@ -171,7 +96,7 @@ GeoNode* OsmMemberTagHandler::parse( GeoParser& parser ) const
                 quint64 id = parser.attribute( "ref" ).toULongLong();
 
                 // With the id we get the relation geometry
-                if ( GeoDataPolygon *p =  osm::OsmRelationFactory::polygon( id ) )
+                if ( GeoDataPolygon *p =  static_cast<OsmParser &>( parser ).relations().polygon( id ) )
                 {
                     polygon->appendInnerBoundary( p->outerBoundary() );
                 }
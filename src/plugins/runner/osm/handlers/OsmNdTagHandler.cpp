@@ -11,7 +11,7 @@
 #include "OsmNdTagHandler.h"
 
 #include "GeoParser.h"
-#include "OsmNodeFactory.h"
+#include "OsmParser.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataParser.h"
@@ -39,9 +39,10 @@ GeoNode* OsmNdTagHandler::parse( GeoParser& parser ) const
         GeoDataLineString *s = parentItem.nodeAs<GeoDataLineString>();
         Q_ASSERT( s );
         quint64 id = parser.attribute( "ref" ).toULongLong();
-        if ( GeoDataPoint *p = osm::OsmNodeFactory::getPoint( id ) )
+        const GeoDataCoordinates coordinates = static_cast<OsmParser &>( parser ).nodes().coordinates( id );
+        if ( coordinates.isValid() )
         {
-            s->append( GeoDataCoordinates( p->coordinates().longitude(), p->coordinates().latitude() ) );
+            s->append( coordinates );
         }
 
         return 0;
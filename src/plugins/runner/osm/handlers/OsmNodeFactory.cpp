@@ -9,35 +9,69 @@
 //
 
 #include "OsmNodeFactory.h"
-#include "GeoDataPoint.h"
+
+#include <QtCore/QtAlgorithms>
 
 namespace Marble
 {
 namespace osm
 {
-QMap<quint64, GeoDataPoint *> OsmNodeFactory::m_points;
 
-// This is a class for keeping all the nodes accessible
-// for when needed by ways. Ways have only the ids of
-// nodes so with that id the GeoDataPoint is returned
+// Fixed point precision of the OSM database
+static const qreal coordinateScale = 1e7;
 
-void OsmNodeFactory::appendPoint( quint64 id, GeoDataPoint* p )
+OsmNodeFactory::OsmNodeFactory()
+    : m_sorted( true )
 {
-    m_points[id] = p;
 }
 
-GeoDataPoint* OsmNodeFactory::getPoint( quint64 id )
+void OsmNodeFactory::appendNode( quint64 id, qreal lon, qreal lat )
 {
-    return m_points.value( id );
+    // OSM files list their nodes by ascending id, so sorting is
+    // usually not needed at all
+    if ( m_sorted && !m_nodes.isEmpty() && id <= m_nodes.last().id ) {
+        m_sorted = false;
+    }
+
+    Node node;
+    node.id = id;
+    node.lon = qRound( lon * coordinateScale );
+    node.lat = qRound( lat * coordinateScale );
+    m_nodes.append( node );
 }
 
-void OsmNodeFactory::clear()
+GeoDataCoordinates OsmNodeFactory::coordinates( quint64 id )
 {
-    foreach( GeoDataPoint *p, m_points )
-    {
-        delete p;
+    if ( !m_sorted ) {
+        sort();
     }
-    m_points.clear();
+
+    // The last one wins if a node was listed more than once
+    QVector<Node>::const_iterator it = qUpperBound( m_nodes.constBegin(), m_nodes.constEnd(), id );
+    if ( it == m_nodes.constBegin() || ( --it )->id != id ) {
+        return GeoDataCoordinates();
+    }
+
+    return GeoDataCoordinates( it->lon / coordinateScale, it->lat / coordinateScale,
+                               0, GeoDataCoordinates::Degree );
+}
+
+int OsmNodeFactory::count() const
+{
+    return m_nodes.size();
+}
+
+void OsmNodeFactory::clear()
+{
+    // clear() would keep the capacity of the vector
+    m_nodes = QVector<Node>();
+    m_sorted = true;
+}
+
+void OsmNodeFactory::sort()
+{
+    qStableSort( m_nodes.begin(), m_nodes.end() );
+    m_sorted = true;
 }
 
 }
@@ -11,35 +11,61 @@
 #ifndef MARBLE_OSMNODEFACTORY_H
 #define MARBLE_OSMNODEFACTORY_H
 
-#include <QMap>
+#include <QtCore/QVector>
+
+#include "GeoDataCoordinates.h"
 
 namespace Marble
 {
 
-class GeoDataPoint;
-
 namespace osm
 {
 
 // This is a class for keeping all the nodes accessible
 // for when needed by ways. Ways have only the ids of
-// nodes so with that id the GeoDataPoint is returned
+// nodes so with that id the coordinates are returned.
+//
+// Each parser owns its own factory. Only the id and the position
+// of a node are kept, using the fixed point representation of
+// the OSM database (1e-7 degrees), i.e. 16 bytes per node.
 
 class OsmNodeFactory
 {
 public:
-    static void appendPoint( quint64 id, GeoDataPoint *p );
-    static GeoDataPoint *getPoint( quint64 id );
+    OsmNodeFactory();
+
+    void appendNode( quint64 id, qreal lon, qreal lat );
+
+    /**
+     * @brief Returns the coordinates of node @p id
+     * An invalid GeoDataCoordinates is returned if the node is unknown.
+     */
+    GeoDataCoordinates coordinates( quint64 id );
+
+    int count() const;
 
     /**
      * @brief Clean up nodes
-     * Removes all nodes from factory.
-     * This function must be called only after file loaded.
+     * Removes all nodes from factory and releases their memory.
      */
-    static void clear();
+    void clear();
 
 private:
-    static QMap<quint64, GeoDataPoint *> m_points;
+    struct Node
+    {
+        quint64 id;
+        qint32 lon;
+        qint32 lat;
+
+        friend bool operator<( const Node &a, const Node &b ) { return a.id < b.id; }
+        friend bool operator<( const Node &node, quint64 id ) { return node.id < id; }
+        friend bool operator<( quint64 id, const Node &node ) { return id < node.id; }
+    };
+
+    void sort();
+
+    QVector<Node> m_nodes;
+    bool m_sorted;
 };
 
 }
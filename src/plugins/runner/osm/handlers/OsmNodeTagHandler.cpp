@@ -13,7 +13,7 @@
 #include "GeoParser.h"
 #include "GeoDataPoint.h"
 #include "MarbleDebug.h"
-#include "OsmNodeFactory.h"
+#include "OsmParser.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataParser.h"
@@ -34,11 +34,18 @@ GeoNode* OsmNodeTagHandler::parse( GeoParser& parser ) const
 
     Q_ASSERT( parser.isStartElement() );
 
+    OsmParser &osmParser = static_cast<OsmParser &>( parser );
+
     qreal lon = parser.attribute( "lon" ).toDouble();
     qreal lat = parser.attribute( "lat" ).toDouble();
-
-    GeoDataPoint *point = new GeoDataPoint( GeoDataCoordinates( lon, lat, 0, GeoDataCoordinates::Degree ) );
-    osm::OsmNodeFactory::appendPoint( parser.attribute( "id" ).toULongLong(), point );
+    osmParser.nodes().appendNode( parser.attribute( "id" ).toULongLong(), lon, lat );
+
+    // Only nodes with tags turn into placemarks, see OsmTagTagHandler::createPOI().
+    // All other nodes are just positions for ways, so there is no need to keep
+    // a geometry for each of them.
+    GeoDataPoint *point = osmParser.currentNode();
+    point->setCoordinates( GeoDataCoordinates( lon, lat, 0, GeoDataCoordinates::Degree ) );
+    point->setParent( 0 );
     return point;
 }
 
@@ -13,7 +13,7 @@
 #include "OsmRelationTagHandler.h"
 
 #include "GeoParser.h"
-#include "OsmRelationFactory.h"
+#include "OsmParser.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataParser.h"
@@ -39,6 +39,8 @@ GeoNode* OsmRelationTagHandler::parse( GeoParser& parser ) const
     GeoDataDocument* doc = geoDataDoc( parser );
     Q_ASSERT( doc );
 
+    OsmParser &osmParser = static_cast<OsmParser &>( parser );
+
     GeoDataPolygon *polygon = new GeoDataPolygon();
     GeoDataPlacemark *placemark = new GeoDataPlacemark();
     placemark->setGeometry( polygon );
@@ -48,7 +50,7 @@ GeoNode* OsmRelationTagHandler::parse( GeoParser& parser ) const
     placemark->setVisible( false );
     doc->append( placemark );
 
-    osm::OsmRelationFactory::appendPolygon( parser.attribute( "id" ).toULongLong(), polygon );
+    osmParser.relations().appendPolygon( parser.attribute( "id" ).toULongLong(), polygon );
 
     return polygon;
 }
@@ -11,7 +11,7 @@
 #include "OsmTagTagHandler.h"
 
 #include "GeoParser.h"
-#include "OsmNodeFactory.h"
+#include "OsmParser.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataParser.h"
@@ -76,7 +76,7 @@ GeoNode* OsmTagTagHandler::parse( GeoParser& parser ) const
         //Convert area ways or relations to polygons
         if( !dynamic_cast<GeoDataPolygon*>( geometry ) && OsmGlobals::tagNeedArea( key + '=' + value ) )
         {
-            placemark = convertWayToPolygon( doc, placemark, geometry );
+            placemark = convertWayToPolygon( static_cast<OsmParser &>( parser ), doc, placemark, geometry );
         }
         if ( key == "building" && value == "yes" && placemark->visualCategory() == GeoDataFeature::Default )
         {
@@ -100,45 +100,7 @@ GeoNode* OsmTagTagHandler::parse( GeoParser& parser ) const
 
     if ( placemark )
     {
-        GeoDataFeature::GeoDataVisualCategory category;
-
-        if ( ( category = GeoDataFeature::OsmVisualCategory( key + '=' + value ) ) )
-        {
-            if( placemark->visualCategory() != GeoDataFeature::Default 
-             && placemark->visualCategory() != GeoDataFeature::Building )
-            {
-                GeoDataPlacemark* newPlacemark = new GeoDataPlacemark( *placemark );
-                newPlacemark->setVisualCategory( category );
-                newPlacemark->setStyle( 0 );
-                newPlacemark->setVisible( true );
-                doc->append( newPlacemark );
-            }
-            else
-            {
-                //Remove assigned style (i.e. building style)
-                placemark->setStyle( 0 );
-                placemark->setVisualCategory( category );
-                placemark->setVisible( true );
-            }
-        }
-        else if ( ( category = GeoDataFeature::OsmVisualCategory( key ) ) )
-        {
-            if( placemark->visualCategory() != GeoDataFeature::Default )
-            {
-                GeoDataPlacemark* newPlacemark = new GeoDataPlacemark( *placemark );
-                newPlacemark->setVisualCategory( category );
-                newPlacemark->setStyle( 0 );
-                newPlacemark->setVisible( true );
-                doc->append( newPlacemark );
-            }
-            else
-            {
-                //Remove assigned style (i.e. building style)
-                placemark->setStyle( 0 );
-                placemark->setVisualCategory( category );
-                placemark->setVisible( true );
-            }
-        }
+        OsmGlobals::addVisualCategory( doc, placemark, key, value );
     }
 
     return 0;
@@ -157,12 +119,12 @@ GeoDataPlacemark* OsmTagTagHandler::createPOI( GeoDataDocument* doc, GeoDataGeom
     return placemark;
 }
 
-GeoDataPlacemark *OsmTagTagHandler::convertWayToPolygon( GeoDataDocument *doc, GeoDataPlacemark *placemark, GeoDataGeometry *geometry ) const
+GeoDataPlacemark *OsmTagTagHandler::convertWayToPolygon( OsmParser &parser, GeoDataDocument *doc, GeoDataPlacemark *placemark, GeoDataGeometry *geometry ) const
 {
     GeoDataLineString *polyline = dynamic_cast<GeoDataLineString *>( geometry );
     Q_ASSERT( polyline );
     doc->remove( doc->childPosition( placemark ) );
-    OsmGlobals::addDummyPlacemark( placemark );
+    parser.addDummyPlacemark( placemark );
     GeoDataPlacemark *newPlacemark = new GeoDataPlacemark( *placemark );
     GeoDataPolygon *polygon = new GeoDataPolygon;
     polygon->setOuterBoundary( *polyline );
@@ -17,6 +17,7 @@ namespace Marble
 class GeoDataGeometry;
 class GeoDataPlacemark;
 class GeoDataDocument;
+class OsmParser;
 
 namespace osm
 {
@@ -27,7 +28,7 @@ public:
     virtual GeoNode* parse( GeoParser& ) const;
 
 private:
-    GeoDataPlacemark *convertWayToPolygon( GeoDataDocument *doc, GeoDataPlacemark *placemark, GeoDataGeometry *geometry ) const;
+    GeoDataPlacemark *convertWayToPolygon( OsmParser &parser, GeoDataDocument *doc, GeoDataPlacemark *placemark, GeoDataGeometry *geometry ) const;
     GeoDataPlacemark *createPOI( GeoDataDocument *doc, GeoDataGeometry *geometry ) const;
 };
 
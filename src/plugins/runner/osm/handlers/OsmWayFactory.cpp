@@ -17,8 +17,6 @@ namespace Marble
 {
 namespace osm
 {
-QMap<quint64, GeoDataLineString *> OsmWayFactory::m_lines;
-
 // This is a class for keeping all the ways accessible
 // for when needed by relations. Relations have only the ids of
 // ways so with that id the GeoDataLineString is returned
@@ -28,7 +26,7 @@ void OsmWayFactory::appendLine( quint64 id, GeoDataLineString* l )
     m_lines[id] = l;
 }
 
-GeoDataLineString* OsmWayFactory::line( quint64 id )
+GeoDataLineString* OsmWayFactory::line( quint64 id ) const
 {
     return m_lines.value( id );
 }
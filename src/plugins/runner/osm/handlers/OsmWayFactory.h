@@ -13,7 +13,7 @@
 #ifndef MARBLE_OSMWAYFACTORY_H
 #define MARBLE_OSMWAYFACTORY_H
 
-#include <QMap>
+#include <QtCore/QHash>
 
 namespace Marble
 {
@@ -30,18 +30,17 @@ namespace osm
 class OsmWayFactory
 {
 public:
-    static void appendLine( quint64 id, GeoDataLineString *l );
-    static GeoDataLineString *line( quint64 id );
+    void appendLine( quint64 id, GeoDataLineString *l );
+    GeoDataLineString *line( quint64 id ) const;
 
     /**
      * @brief Clean up ways
      * Removes all ways from factory.
-     * This function must be called only after file loaded.
      */
-    static void clear();
+    void clear();
 
 private:
-    static QMap<quint64, GeoDataLineString *> m_lines;
+    QHash<quint64, GeoDataLineString *> m_lines;
 };
 
 }
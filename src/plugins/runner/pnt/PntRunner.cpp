@@ -184,6 +184,10 @@ void PntRunner::parseFile( const QString &fileName, DocumentRole role = UnknownD
         }
 
         GeoDataLineString *polyline = static_cast<GeoDataLineString*>( placemark->geometry() );
+        if ( polyline->isEmpty() ) {
+            // Coastlines and borders consist of a huge number of nodes
+            polyline->setCompactStorage( true );
+        }
 
         // Transforming Range of Coordinates to iLat [0,ARCMINUTE] , iLon [0,2 * ARCMINUTE]
         polyline->append( GeoDataCoordinates( (qreal)(iLon) * INT2RAD, (qreal)(iLat) * INT2RAD,
@@ -0,0 +1,167 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtGui/QImage>
+#include <QtTest/QtTest>
+
+#include "blendings/BlendingAlgorithms.h"
+#include "TextureTile.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class BlendingAlgorithmsTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void tableMatchesGeneric_data();
+    void tableMatchesGeneric();
+
+    void benchmarkTable_data();
+    void benchmarkTable();
+
+    void benchmarkGeneric_data();
+    void benchmarkGeneric();
+
+ private:
+    static void addBlendingData();
+    static IndependentChannelBlending *createBlending( const QString &name );
+    static QImage randomImage( int size );
+};
+
+void BlendingAlgorithmsTest::addBlendingData()
+{
+    QTest::addColumn<QString>( "name" );
+
+    // only blendings which yield defined results for all input values
+    QTest::newRow( "Allanon" ) << "Allanon";
+    QTest::newRow( "Overlay" ) << "Overlay";
+    QTest::newRow( "Darken" ) << "Darken";
+    QTest::newRow( "Multiply" ) << "Multiply";
+    QTest::newRow( "Subtractive" ) << "Subtractive";
+    QTest::newRow( "Additive" ) << "Additive";
+    QTest::newRow( "HardLight" ) << "HardLight";
+    QTest::newRow( "Lighten" ) << "Lighten";
+    QTest::newRow( "Screen" ) << "Screen";
+    QTest::newRow( "Difference" ) << "Difference";
+}
+
+IndependentChannelBlending *BlendingAlgorithmsTest::createBlending( const QString &name )
+{
+    if ( name == "Allanon" )
+        return new AllanonBlending;
+    if ( name == "Overlay" )
+        return new OverlayBlending;
+    if ( name == "Darken" )
+        return new DarkenBlending;
+    if ( name == "Multiply" )
+        return new MultiplyBlending;
+    if ( name == "Subtractive" )
+        return new SubtractiveBlending;
+    if ( name == "Additive" )
+        return new AdditiveBlending;
+    if ( name == "HardLight" )
+        return new HardLightBlending;
+    if ( name == "Lighten" )
+        return new LightenBlending;
+    if ( name == "Screen" )
+        return new ScreenBlending;
+    if ( name == "Difference" )
+        return new DifferenceBlending;
+
+    return 0;
+}
+
+QImage BlendingAlgorithmsTest::randomImage( int size )
+{
+    QImage image( size, size, QImage::Format_ARGB32_Premultiplied );
+    for ( int y = 0; y < size; ++y ) {
+        QRgb *line = reinterpret_cast<QRgb *>( image.scanLine( y ) );
+        for ( int x = 0; x < size; ++x ) {
+            line[x] = qRgb( qrand() % 256, qrand() % 256, qrand() % 256 );
+        }
+    }
+
+    return image;
+}
+
+void BlendingAlgorithmsTest::tableMatchesGeneric_data()
+{
+    addBlendingData();
+}
+
+void BlendingAlgorithmsTest::tableMatchesGeneric()
+{
+    QFETCH( QString, name );
+
+    QScopedPointer<IndependentChannelBlending> blending( createBlending( name ) );
+    QVERIFY( blending );
+
+    const QImage bottom = randomImage( 64 );
+    const TextureTile top( TileId(), randomImage( 64 ), blending.data() );
+
+    QImage expected = bottom;
+    blending->blendGeneric( &expected, &top );
+
+    QImage result = bottom;
+    blending->blend( &result, &top );
+
+    QCOMPARE( result, expected );
+}
+
+void BlendingAlgorithmsTest::benchmarkTable_data()
+{
+    addBlendingData();
+}
+
+void BlendingAlgorithmsTest::benchmarkTable()
+{
+    QFETCH( QString, name );
+
+    QScopedPointer<IndependentChannelBlending> blending( createBlending( name ) );
+    QVERIFY( blending );
+
+    const QImage bottom = randomImage( 256 );
+    const TextureTile top( TileId(), randomImage( 256 ), blending.data() );
+
+    QBENCHMARK {
+        QImage result = bottom;
+        blending->blend( &result, &top );
+    }
+}
+
+void BlendingAlgorithmsTest::benchmarkGeneric_data()
+{
+    addBlendingData();
+}
+
+void BlendingAlgorithmsTest::benchmarkGeneric()
+{
+    QFETCH( QString, name );
+
+    QScopedPointer<IndependentChannelBlending> blending( createBlending( name ) );
+    QVERIFY( blending );
+
+    const QImage bottom = randomImage( 256 );
+    const TextureTile top( TileId(), randomImage( 256 ), blending.data() );
+
+    QBENCHMARK {
+        QImage result = bottom;
+        blending->blendGeneric( &result, &top );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::BlendingAlgorithmsTest )
+
+#include "BlendingAlgorithmsTest.moc"
@@ -0,0 +1,144 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtTest/QtTest>
+
+#include "DiscCache.h"
+
+namespace Marble
+{
+
+class DiscCacheTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void init();
+    void cleanup();
+
+    void evictLeastRecentlyUsed();
+    void persistedAccessOrder();
+    void missingFile();
+
+ private:
+    void insert( DiscCache *cache, const QString &key );
+
+    QString m_directory;
+};
+
+void DiscCacheTest::init()
+{
+    m_directory = QDir::tempPath() + QString( "/marble-disccachetest-%1" ).arg( QCoreApplication::applicationPid() );
+    QDir::root().mkpath( m_directory );
+}
+
+void DiscCacheTest::cleanup()
+{
+    foreach ( const QString &fileName, QDir( m_directory ).entryList( QDir::Files ) ) {
+        QFile::remove( m_directory + '/' + fileName );
+    }
+    QDir::root().rmdir( m_directory );
+}
+
+void DiscCacheTest::insert( DiscCache *cache, const QString &key )
+{
+    QVERIFY( cache->insert( key, QByteArray( 100, 'x' ) ) );
+
+    // the access times need to differ
+    QTest::qSleep( 20 );
+}
+
+void DiscCacheTest::evictLeastRecentlyUsed()
+{
+    DiscCache cache( m_directory );
+    cache.setCacheLimit( 1000 );
+
+    insert( &cache, "a" );
+    insert( &cache, "b" );
+    insert( &cache, "c" );
+
+    // reading an entry makes it the most recently used one
+    QByteArray data;
+    QVERIFY( cache.find( "a", data ) );
+    QCOMPARE( data, QByteArray( 100, 'x' ) );
+    QTest::qSleep( 20 );
+
+    // 95% of the limit are kept
+    cache.setCacheLimit( 250 );
+    QVERIFY( cache.exists( "a" ) );
+    QVERIFY( !cache.exists( "b" ) );
+    QVERIFY( cache.exists( "c" ) );
+    QVERIFY( !QFile::exists( m_directory + "/b" ) );
+
+    insert( &cache, "d" );
+    QVERIFY( cache.exists( "a" ) );
+    QVERIFY( !cache.exists( "c" ) );
+    QVERIFY( cache.exists( "d" ) );
+
+    // overwriting an entry counts as an access, too
+    insert( &cache, "a" );
+    insert( &cache, "e" );
+    QVERIFY( cache.exists( "a" ) );
+    QVERIFY( !cache.exists( "d" ) );
+    QVERIFY( cache.exists( "e" ) );
+}
+
+void DiscCacheTest::persistedAccessOrder()
+{
+    {
+        DiscCache cache( m_directory );
+        cache.setCacheLimit( 1000 );
+        insert( &cache, "a" );
+        insert( &cache, "b" );
+        insert( &cache, "c" );
+
+        QByteArray data;
+        QVERIFY( cache.find( "a", data ) );
+        QTest::qSleep( 20 );
+    }
+
+    // the order is restored from the access times of the saved index
+    DiscCache cache( m_directory );
+    QCOMPARE( cache.cacheLimit(), quint64( 1000 ) );
+    QVERIFY( cache.exists( "a" ) );
+    QVERIFY( cache.exists( "b" ) );
+    QVERIFY( cache.exists( "c" ) );
+
+    cache.setCacheLimit( 150 );
+    QVERIFY( cache.exists( "a" ) );
+    QVERIFY( !cache.exists( "b" ) );
+    QVERIFY( !cache.exists( "c" ) );
+}
+
+void DiscCacheTest::missingFile()
+{
+    DiscCache cache( m_directory );
+    cache.setCacheLimit( 1000 );
+    insert( &cache, "a" );
+    insert( &cache, "b" );
+
+    // A file deleted behind the back of the cache doesn't block eviction
+    QVERIFY( QFile::remove( m_directory + "/a" ) );
+    cache.setCacheLimit( 150 );
+    QVERIFY( !cache.exists( "a" ) );
+    QVERIFY( cache.exists( "b" ) );
+
+    QByteArray data;
+    QVERIFY( !cache.find( "a", data ) );
+}
+
+}
+
+QTEST_MAIN( Marble::DiscCacheTest )
+
+#include "DiscCacheTest.moc"
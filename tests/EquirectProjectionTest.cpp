@@ -0,0 +1,108 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtTest/QtTest>
+#include "EquirectProjection.h"
+#include "ViewportParams.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class EquirectProjectionTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void screenCoordinatesOfPoints_data();
+    void screenCoordinatesOfPoints();
+};
+
+void EquirectProjectionTest::screenCoordinatesOfPoints_data()
+{
+    QTest::addColumn<qreal>( "centerLon" );
+    QTest::addColumn<qreal>( "centerLat" );
+    QTest::addColumn<int>( "radius" );
+
+    addNamedRow( "equator" ) << 0.0 << 0.0 << 200;
+    addNamedRow( "date line" ) << 180.0 << 0.0 << 200;
+    addNamedRow( "west of date line" ) << -179.5 << 30.0 << 200;
+    addNamedRow( "repeated" ) << 0.0 << 0.0 << 100;
+    addNamedRow( "repeated date line" ) << 180.0 << -60.0 << 100;
+}
+
+void EquirectProjectionTest::screenCoordinatesOfPoints()
+{
+    QFETCH( qreal, centerLon );
+    QFETCH( qreal, centerLat );
+    QFETCH( int, radius );
+
+    ViewportParams viewport;
+    viewport.setProjection( Equirectangular );
+    viewport.setRadius( radius ); // the map repeats every 4 * radius pixels
+    viewport.setSize( QSize( 640, 480 ) );
+    viewport.centerOn( centerLon * DEG2RAD, centerLat * DEG2RAD );
+
+    QVector<GeoDataCoordinates> points;
+    for ( qreal lon = -177.5; lon < 180.0; lon += 5.0 ) {
+        for ( qreal lat = -87.5; lat < 90.0; lat += 5.0 ) {
+            points << GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+        }
+    }
+
+    // on both sides of the date line and at the poles
+    foreach ( qreal lon, QList<qreal>() << -180.0 << -179.9 << 179.9 << 180.0 ) {
+        points << GeoDataCoordinates( lon, -90.0, 0.0, GeoDataCoordinates::Degree );
+        points << GeoDataCoordinates( lon, -10.5, 0.0, GeoDataCoordinates::Degree );
+        points << GeoDataCoordinates( lon, 10.5, 0.0, GeoDataCoordinates::Degree );
+        points << GeoDataCoordinates( lon, 90.0, 0.0, GeoDataCoordinates::Degree );
+    }
+
+    const int count = points.size();
+    QVector<qreal> lons( count );
+    QVector<qreal> lats( count );
+    for ( int i = 0; i < count; ++i ) {
+        lons[i] = points.at( i ).longitude();
+        lats[i] = points.at( i ).latitude();
+    }
+
+    QVector<qreal> x( count );
+    QVector<qreal> y( count );
+    QVector<bool> visible( count );
+    QVector<bool> globeHidesPoint( count, true );
+
+    viewport.currentProjection()->screenCoordinates( count, lons.constData(), lats.constData(), 0,
+                                                     &viewport, x.data(), y.data(),
+                                                     visible.data(), globeHidesPoint.data() );
+
+    int visibleCount = 0;
+    for ( int i = 0; i < count; ++i ) {
+        qreal expectedX;
+        qreal expectedY;
+        bool expectedGlobeHidesPoint = true;
+        const bool expectedVisible = viewport.screenCoordinates( points.at( i ), expectedX, expectedY, expectedGlobeHidesPoint );
+
+        QCOMPARE( visible.at( i ), expectedVisible );
+        QVERIFY( !globeHidesPoint.at( i ) );
+        QVERIFY( !expectedGlobeHidesPoint );
+        QFUZZYCOMPARE( x.at( i ), expectedX, 1e-6 );
+        QFUZZYCOMPARE( y.at( i ), expectedY, 1e-6 );
+
+        visibleCount += visible.at( i ) ? 1 : 0;
+    }
+
+    QVERIFY( visibleCount > 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::EquirectProjectionTest )
+
+#include "EquirectProjectionTest.moc"
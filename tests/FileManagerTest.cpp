@@ -0,0 +1,235 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QtTest>
+
+#include "FileManager.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleDirs.h"
+#include "MarbleModel.h"
+
+namespace Marble
+{
+
+class FileManagerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void maximumLoaderCount();
+    void prioritizedOrder();
+    void removePendingFile();
+    void removeLoadedFile();
+    void batchedDocuments();
+
+ private:
+    QString writeFile( const QString &name );
+    void addFile( FileManager *manager, const QString &fileName, DocumentRole role = MapDocument );
+    static bool waitForFiles( const QSignalSpy &spy, int count );
+    static QStringList addedFiles( const QSignalSpy &spy );
+
+    QString m_directory;
+};
+
+void FileManagerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    m_directory = QDir::tempPath() + QString( "/marble-filemanagertest-%1" ).arg( QCoreApplication::applicationPid() );
+    QDir::root().mkpath( m_directory );
+}
+
+void FileManagerTest::cleanupTestCase()
+{
+    foreach ( const QString &fileName, QDir( m_directory ).entryList( QDir::Files ) ) {
+        QFile::remove( m_directory + '/' + fileName );
+    }
+    QDir::root().rmdir( m_directory );
+}
+
+QString FileManagerTest::writeFile( const QString &name )
+{
+    const QString fileName = m_directory + '/' + name + ".kml";
+    QFile file( fileName );
+    file.open( QIODevice::WriteOnly | QIODevice::Truncate );
+    file.write( QString( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                         "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+                         "<Document><Placemark><name>%1</name>"
+                         "<Point><coordinates>13.4,52.5</coordinates></Point>"
+                         "</Placemark></Document></kml>" ).arg( name ).toUtf8() );
+
+    return fileName;
+}
+
+void FileManagerTest::addFile( FileManager *manager, const QString &fileName, DocumentRole role )
+{
+    manager->addFile( fileName, fileName, new GeoDataStyle, role );
+}
+
+bool FileManagerTest::waitForFiles( const QSignalSpy &spy, int count )
+{
+    for ( int i = 0; i < 500 && spy.count() < count; ++i ) {
+        QTest::qWait( 10 );
+    }
+
+    return spy.count() == count;
+}
+
+QStringList FileManagerTest::addedFiles( const QSignalSpy &spy )
+{
+    QStringList result;
+    for ( int i = 0; i < spy.count(); ++i ) {
+        result << spy.at( i ).at( 0 ).toString();
+    }
+
+    return result;
+}
+
+void FileManagerTest::maximumLoaderCount()
+{
+    MarbleModel model;
+    FileManager manager( &model );
+
+    QVERIFY( manager.maximumLoaderCount() >= 1 );
+
+    manager.setMaximumLoaderCount( 0 );
+    QCOMPARE( manager.maximumLoaderCount(), 1 );
+
+    manager.setMaximumLoaderCount( 1 );
+    QSignalSpy spy( &manager, SIGNAL(fileAdded(QString)) );
+
+    const QString first = writeFile( "first" );
+    const QString second = writeFile( "second" );
+    const QString third = writeFile( "third" );
+    addFile( &manager, first );
+    addFile( &manager, second );
+    addFile( &manager, third );
+
+    // the loaders are children of the manager, only one of them runs
+    QCOMPARE( manager.findChildren<QThread*>().size(), 3 );
+    int running = 0;
+    foreach ( const QThread *loader, manager.findChildren<QThread*>() ) {
+        running += loader->isRunning() || loader->isFinished() ? 1 : 0;
+    }
+    QCOMPARE( running, 1 );
+
+    QVERIFY( waitForFiles( spy, 3 ) );
+    QCOMPARE( addedFiles( spy ), QStringList() << first << second << third );
+    QCOMPARE( manager.size(), 3 );
+}
+
+void FileManagerTest::prioritizedOrder()
+{
+    MarbleModel model;
+    FileManager manager( &model );
+    manager.setMaximumLoaderCount( 1 );
+    QSignalSpy spy( &manager, SIGNAL(fileAdded(QString)) );
+
+    const QString first = writeFile( "map1" );
+    const QString second = writeFile( "map2" );
+    const QString user = writeFile( "user" );
+    addFile( &manager, first );
+    addFile( &manager, second );
+    addFile( &manager, user, UserDocument );
+
+    // the first loader was started right away, the user document
+    // overtakes the other pending one
+    QVERIFY( waitForFiles( spy, 3 ) );
+    QCOMPARE( addedFiles( spy ), QStringList() << first << user << second );
+}
+
+void FileManagerTest::removePendingFile()
+{
+    MarbleModel model;
+    FileManager manager( &model );
+    manager.setMaximumLoaderCount( 1 );
+    QSignalSpy spy( &manager, SIGNAL(fileAdded(QString)) );
+
+    const QString first = writeFile( "running" );
+    const QString second = writeFile( "pending" );
+    addFile( &manager, first );
+    addFile( &manager, second );
+
+    manager.removeFile( second );
+    QCOMPARE( manager.findChildren<QThread*>().size(), 1 );
+
+    QVERIFY( waitForFiles( spy, 1 ) );
+    QTest::qWait( 200 );
+    QCOMPARE( addedFiles( spy ), QStringList() << first );
+    QCOMPARE( manager.size(), 1 );
+    QVERIFY( manager.at( second ) == 0 );
+}
+
+void FileManagerTest::removeLoadedFile()
+{
+    MarbleModel model;
+    FileManager manager( &model );
+    QSignalSpy spy( &manager, SIGNAL(fileAdded(QString)) );
+    QSignalSpy rowSpy( model.treeModel(), SIGNAL(rowsInserted(QModelIndex,int,int)) );
+
+    const QString fileName = writeFile( "loaded" );
+    addFile( &manager, fileName );
+
+    // The loader is deleted as soon as it finished, while its document waits
+    // for more documents to be added along with it
+    for ( int i = 0; i < 5000 && !manager.findChildren<QThread*>().isEmpty(); ++i ) {
+        QCoreApplication::processEvents( QEventLoop::AllEvents, 1 );
+    }
+    QVERIFY( manager.findChildren<QThread*>().isEmpty() );
+    QCOMPARE( spy.count(), 0 );
+
+    manager.removeFile( fileName );
+
+    QTest::qWait( 300 );
+    QCOMPARE( spy.count(), 0 );
+    QCOMPARE( rowSpy.count(), 0 );
+    QCOMPARE( manager.size(), 0 );
+
+    // the file may be loaded again
+    addFile( &manager, fileName );
+    QVERIFY( waitForFiles( spy, 1 ) );
+    QCOMPARE( manager.size(), 1 );
+}
+
+void FileManagerTest::batchedDocuments()
+{
+    MarbleModel model;
+    FileManager manager( &model );
+    manager.setMaximumLoaderCount( 2 );
+    QSignalSpy spy( &manager, SIGNAL(fileAdded(QString)) );
+    QSignalSpy rowSpy( model.treeModel(), SIGNAL(rowsInserted(QModelIndex,int,int)) );
+
+    const int rowCount = model.treeModel()->rowCount();
+    addFile( &manager, writeFile( "batch1" ) );
+    addFile( &manager, writeFile( "batch2" ) );
+
+    // both documents are inserted into the tree model at once
+    QVERIFY( waitForFiles( spy, 2 ) );
+    QCOMPARE( rowSpy.count(), 1 );
+    QCOMPARE( rowSpy.at( 0 ).at( 1 ).toInt(), rowCount );
+    QCOMPARE( rowSpy.at( 0 ).at( 2 ).toInt(), rowCount + 1 );
+    QCOMPARE( model.treeModel()->rowCount(), rowCount + 2 );
+}
+
+}
+
+QTEST_MAIN( Marble::FileManagerTest )
+
+#include "FileManagerTest.moc"
@@ -0,0 +1,177 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtTest/QtTest>
+
+#include <sys/types.h>
+#ifdef Q_OS_WIN
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#include "FileStorageWatcher.h"
+
+namespace Marble
+{
+
+class FileStorageWatcherTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void init();
+    void cleanup();
+
+    void deleteOldestFiles();
+    void persistedIndex();
+
+ private:
+    void writeFile( const QString &relativePath, int size, int age );
+    bool exists( const QString &relativePath ) const;
+    static void removeDirectory( const QString &path );
+
+    QString m_dataDirectory;
+};
+
+void FileStorageWatcherTest::init()
+{
+    // the watcher refuses to delete anything outside of a "data" directory
+    m_dataDirectory = QDir::tempPath() + QString( "/marble-filestoragewatchertest-%1/data" ).arg( QCoreApplication::applicationPid() );
+    removeDirectory( m_dataDirectory );
+    QDir::root().mkpath( m_dataDirectory );
+}
+
+void FileStorageWatcherTest::cleanup()
+{
+    removeDirectory( QFileInfo( m_dataDirectory ).path() );
+}
+
+void FileStorageWatcherTest::removeDirectory( const QString &path )
+{
+    const QFileInfoList entries = QDir( path ).entryInfoList( QDir::AllEntries | QDir::NoDotAndDotDot );
+    foreach ( const QFileInfo &entry, entries ) {
+        if ( entry.isDir() ) {
+            removeDirectory( entry.absoluteFilePath() );
+        } else {
+            QFile::remove( entry.absoluteFilePath() );
+        }
+    }
+    QDir::root().rmdir( path );
+}
+
+void FileStorageWatcherTest::writeFile( const QString &relativePath, int size, int age )
+{
+    const QString filePath = m_dataDirectory + '/' + relativePath;
+    QDir::root().mkpath( QFileInfo( filePath ).path() );
+
+    QFile file( filePath );
+    QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    file.write( QByteArray( size, 'x' ) );
+    file.close();
+
+    // backdate the file by age seconds
+    const time_t lastModified = QDateTime::currentDateTime().toTime_t() - age;
+    struct utimbuf times;
+    times.actime = lastModified;
+    times.modtime = lastModified;
+    QCOMPARE( utime( QFile::encodeName( filePath ).constData(), &times ), 0 );
+}
+
+bool FileStorageWatcherTest::exists( const QString &relativePath ) const
+{
+    return QFile::exists( m_dataDirectory + '/' + relativePath );
+}
+
+void FileStorageWatcherTest::deleteOldestFiles()
+{
+    writeFile( "maps/earth/shown/5/0/0.png", 100, 2000 );
+    writeFile( "maps/earth/shown/5/0/1.png", 100, 10 );
+    writeFile( "maps/earth/other/5/0/0.png", 200, 1000 );
+    writeFile( "maps/earth/other/5/0/1.png", 100, 500 );
+    // base tiles are never deleted
+    writeFile( "maps/earth/other/0/0/0.png", 100, 3000 );
+
+    FileStorageWatcherThread watcher( m_dataDirectory );
+    watcher.updateTheme( "earth/shown/shown.dgml" );
+    watcher.getCurrentCacheSize();
+
+    // 600 bytes exceed the limit, 95% of it are kept
+    watcher.setCacheLimit( 580 );
+    QTest::qWait( 100 );
+
+    // the oldest tile of the themes not shown goes first
+    QVERIFY( !exists( "maps/earth/other/5/0/0.png" ) );
+    QVERIFY( exists( "maps/earth/other/5/0/1.png" ) );
+    QVERIFY( exists( "maps/earth/shown/5/0/0.png" ) );
+    QVERIFY( exists( "maps/earth/other/0/0/0.png" ) );
+
+    // then the rest of them and the shown theme last, except for the files
+    // written just now
+    watcher.setCacheLimit( 100 );
+    QTest::qWait( 100 );
+
+    QVERIFY( !exists( "maps/earth/other/5/0/1.png" ) );
+    QVERIFY( !exists( "maps/earth/shown/5/0/0.png" ) );
+    QVERIFY( exists( "maps/earth/shown/5/0/1.png" ) );
+    QVERIFY( exists( "maps/earth/other/0/0/0.png" ) );
+
+    // files announced by the storage policy get indexed, too
+    writeFile( "maps/earth/other/6/0/0.png", 300, 4000 );
+    watcher.addFile( m_dataDirectory + "/maps/earth/other/6/0/0.png" );
+    watcher.addToCurrentSize( 300 );
+    QTest::qWait( 100 );
+
+    QVERIFY( !exists( "maps/earth/other/6/0/0.png" ) );
+}
+
+void FileStorageWatcherTest::persistedIndex()
+{
+    writeFile( "maps/earth/other/5/0/0.png", 200, 1000 );
+    writeFile( "maps/earth/other/0/0/0.png", 100, 3000 );
+
+    {
+        FileStorageWatcherThread watcher( m_dataDirectory );
+        watcher.getCurrentCacheSize();
+        watcher.saveIndex();
+    }
+    QVERIFY( exists( "cache_watcher.idx" ) );
+
+    // A file written behind the back of the watcher is only found by
+    // scanning the data directory
+    writeFile( "maps/earth/other/5/0/1.png", 200, 5000 );
+
+    FileStorageWatcherThread watcher( m_dataDirectory );
+    watcher.updateTheme( "earth/shown/shown.dgml" );
+    watcher.getCurrentCacheSize();
+
+    // the index is only used once, a crash leads to a rescan
+    QVERIFY( !exists( "cache_watcher.idx" ) );
+
+    // the saved cache size of 300 bytes exceeds the limit, the size of the
+    // unknown file doesn't count
+    watcher.setCacheLimit( 250 );
+    QTest::qWait( 100 );
+
+    QVERIFY( !exists( "maps/earth/other/5/0/0.png" ) );
+    QVERIFY( exists( "maps/earth/other/5/0/1.png" ) );
+    QVERIFY( exists( "maps/earth/other/0/0/0.png" ) );
+}
+
+}
+
+QTEST_MAIN( Marble::FileStorageWatcherTest )
+
+#include "FileStorageWatcherTest.moc"
@@ -0,0 +1,135 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtTest/QtTest>
+
+#include "FrameProfiler.h"
+
+namespace Marble
+{
+
+class FrameProfilerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void disabled();
+    void recordFrame();
+    void ringBuffer();
+    void csv();
+    void chromeTrace();
+};
+
+void FrameProfilerTest::disabled()
+{
+    FrameProfiler profiler;
+    QVERIFY( !profiler.isEnabled() );
+
+    profiler.beginFrame();
+    QVERIFY( !profiler.isRecording() );
+    profiler.addEvent( "GeometryLayer", "render", 0, 1 );
+    profiler.endFrame();
+
+    QVERIFY( profiler.frames().isEmpty() );
+}
+
+void FrameProfilerTest::recordFrame()
+{
+    FrameProfiler profiler;
+    profiler.setEnabled( true );
+
+    profiler.beginFrame();
+    QVERIFY( profiler.isRecording() );
+    profiler.addEvent( "GeometryLayer", "viewport", 0, 2, 1 );
+    profiler.addEvent( "GeometryLayer", "render", 2, 3 );
+    profiler.addCounter( "Tile cache hits", 4 );
+    profiler.addCounter( "Tile cache hits", 5 );
+    profiler.endFrame();
+
+    // events outside of a frame are dropped
+    profiler.addEvent( "GeometryLayer", "render", 0, 1 );
+
+    const QList<FrameProfiler::Frame> frames = profiler.frames();
+    QCOMPARE( frames.size(), 1 );
+    QCOMPARE( frames.at( 0 ).number, 0 );
+    QCOMPARE( frames.at( 0 ).events.size(), 2 );
+    QCOMPARE( frames.at( 0 ).events.at( 0 ).category, QString( "viewport" ) );
+    QCOMPARE( frames.at( 0 ).events.at( 0 ).thread, 1 );
+    QCOMPARE( frames.at( 0 ).events.at( 1 ).start, 2 );
+    QCOMPARE( frames.at( 0 ).events.at( 1 ).duration, 3 );
+    QCOMPARE( frames.at( 0 ).counters.value( "Tile cache hits" ), qint64( 9 ) );
+}
+
+void FrameProfilerTest::ringBuffer()
+{
+    FrameProfiler profiler( 3 );
+    profiler.setEnabled( true );
+
+    for ( int i = 0; i < 5; ++i ) {
+        profiler.beginFrame();
+        profiler.endFrame();
+    }
+
+    QList<FrameProfiler::Frame> frames = profiler.frames();
+    QCOMPARE( frames.size(), 3 );
+    QCOMPARE( frames.first().number, 2 );
+    QCOMPARE( frames.last().number, 4 );
+
+    profiler.setFrameCount( 1 );
+    frames = profiler.frames();
+    QCOMPARE( frames.size(), 1 );
+    QCOMPARE( frames.first().number, 4 );
+
+    profiler.clear();
+    QVERIFY( profiler.frames().isEmpty() );
+}
+
+void FrameProfilerTest::csv()
+{
+    FrameProfiler profiler;
+    profiler.setEnabled( true );
+
+    profiler.beginFrame();
+    profiler.addEvent( "Layer, with comma", "render", 1, 2 );
+    profiler.addCounter( "Tile loads", 7 );
+    profiler.endFrame();
+
+    const QStringList lines = profiler.toCsv().trimmed().split( '\n' );
+    QCOMPARE( lines.size(), 4 );
+    QCOMPARE( lines.at( 0 ), QString( "frame,category,name,thread,start,duration,value" ) );
+    QVERIFY( lines.at( 1 ).startsWith( "0,frame,frame,0,0," ) );
+    QCOMPARE( lines.at( 2 ), QString( "0,render,\"Layer, with comma\",0,1,2," ) );
+    QCOMPARE( lines.at( 3 ), QString( "0,counter,Tile loads,,,,7" ) );
+}
+
+void FrameProfilerTest::chromeTrace()
+{
+    FrameProfiler profiler;
+    profiler.setEnabled( true );
+
+    profiler.beginFrame();
+    profiler.addEvent( "Layer \"quoted\"", "render", 1, 2, 3 );
+    profiler.addCounter( "Tile loads", 7 );
+    profiler.endFrame();
+
+    const QString trace = profiler.toChromeTrace();
+    QVERIFY( trace.startsWith( "{\"traceEvents\":[" ) );
+    QVERIFY( trace.contains( "\"name\":\"Frame 0\",\"cat\":\"frame\",\"ph\":\"X\"" ) );
+    QVERIFY( trace.contains( "\"name\":\"Layer \\\"quoted\\\"\",\"cat\":\"render\",\"ph\":\"X\",\"pid\":1,\"tid\":3," ) );
+    QVERIFY( trace.contains( "\"dur\":2000}" ) );
+    QVERIFY( trace.contains( "\"name\":\"Tile loads\",\"cat\":\"counter\",\"ph\":\"C\"" ) );
+    QVERIFY( trace.contains( "\"args\":{\"value\":7}" ) );
+}
+
+}
+
+QTEST_MAIN( Marble::FrameProfilerTest )
+
+#include "FrameProfilerTest.moc"
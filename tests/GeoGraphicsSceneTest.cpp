@@ -0,0 +1,149 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtTest/QtTest>
+
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoGraphicsItem.h"
+#include "GeoGraphicsScene.h"
+
+namespace Marble
+{
+
+class TestGraphicsItem : public GeoGraphicsItem
+{
+ public:
+    TestGraphicsItem( const GeoDataFeature *feature, qreal north, qreal south, qreal east, qreal west, qreal zValue, int minZoomLevel = 0 )
+        : GeoGraphicsItem( feature )
+    {
+        setLatLonAltBox( GeoDataLatLonAltBox( GeoDataLatLonBox( north, south, east, west, GeoDataCoordinates::Degree ), 0, 0 ) );
+        setZValue( zValue );
+        setMinZoomLevel( minZoomLevel );
+    }
+
+    virtual void setViewport( const ViewportParams * ) {}
+    virtual void paint( GeoPainter * ) const {}
+};
+
+class GeoGraphicsSceneTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void zOrder();
+    void boxAndZoomLevel();
+    void dateLine();
+    void removeItem();
+};
+
+static GeoDataLatLonBox box( qreal north, qreal south, qreal east, qreal west )
+{
+    return GeoDataLatLonBox( north, south, east, west, GeoDataCoordinates::Degree );
+}
+
+void GeoGraphicsSceneTest::zOrder()
+{
+    const GeoDataPlacemark placemark;
+    GeoGraphicsScene scene;
+
+    // A large item ends up close to the root, small ones deep in the tree
+    TestGraphicsItem *large = new TestGraphicsItem( &placemark, 60, -60, 100, -100, 2, 10 );
+    TestGraphicsItem *small = new TestGraphicsItem( &placemark, 50.1, 50, 8.1, 8, 3, 10 );
+    TestGraphicsItem *bottom = new TestGraphicsItem( &placemark, 50.1, 50, 8.1, 8, 1, 10 );
+    scene.addItem( small );
+    scene.addItem( large );
+    scene.addItem( bottom );
+
+    const QList<GeoGraphicsItem*> items = scene.items( box( 51, 49, 9, 7 ), 10 );
+    QCOMPARE( items.size(), 3 );
+    QVERIFY( items.at( 0 ) == bottom );
+    QVERIFY( items.at( 1 ) == large );
+    QVERIFY( items.at( 2 ) == small );
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::boxAndZoomLevel()
+{
+    const GeoDataPlacemark placemark;
+    GeoGraphicsScene scene;
+
+    TestGraphicsItem *europe = new TestGraphicsItem( &placemark, 50.1, 50, 8.1, 8, 0, 5 );
+    TestGraphicsItem *america = new TestGraphicsItem( &placemark, 40.1, 40, -74, -74.1, 0, 5 );
+    TestGraphicsItem *detail = new TestGraphicsItem( &placemark, 50.1, 50, 8.1, 8, 0, 12 );
+    scene.addItem( europe );
+    scene.addItem( america );
+    scene.addItem( detail );
+
+    QList<GeoGraphicsItem*> items = scene.items( box( 51, 49, 9, 7 ), 5 );
+    QCOMPARE( items.size(), 1 );
+    QVERIFY( items.at( 0 ) == europe );
+
+    items = scene.items( box( 51, 49, 9, 7 ), 12 );
+    QCOMPARE( items.size(), 2 );
+
+    items = scene.items( box( 90, -90, 180, -180 ), 4 );
+    QCOMPARE( items.size(), 0 );
+
+    items = scene.items( box( 90, -90, 180, -180 ), 5 );
+    QCOMPARE( items.size(), 2 );
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::dateLine()
+{
+    const GeoDataPlacemark placemark;
+    GeoGraphicsScene scene;
+
+    TestGraphicsItem *east = new TestGraphicsItem( &placemark, 10, 0, 179, 178, 0, 3 );
+    TestGraphicsItem *west = new TestGraphicsItem( &placemark, 10, 0, -178, -179, 0, 3 );
+    TestGraphicsItem *center = new TestGraphicsItem( &placemark, 10, 0, 1, 0, 0, 3 );
+    scene.addItem( east );
+    scene.addItem( west );
+    scene.addItem( center );
+
+    const QList<GeoGraphicsItem*> items = scene.items( box( 20, -20, -170, 170 ), 3 );
+    QCOMPARE( items.size(), 2 );
+    QVERIFY( items.contains( east ) );
+    QVERIFY( items.contains( west ) );
+
+    scene.eraseAll();
+}
+
+void GeoGraphicsSceneTest::removeItem()
+{
+    const GeoDataPlacemark first;
+    const GeoDataPlacemark second;
+    GeoGraphicsScene scene;
+
+    TestGraphicsItem *firstItem = new TestGraphicsItem( &first, 50.1, 50, 8.1, 8, 0, 5 );
+    TestGraphicsItem *otherFirstItem = new TestGraphicsItem( &first, 60, -60, 100, -100, 0, 5 );
+    TestGraphicsItem *secondItem = new TestGraphicsItem( &second, 50.1, 50, 8.1, 8, 0, 5 );
+    scene.addItem( firstItem );
+    scene.addItem( otherFirstItem );
+    scene.addItem( secondItem );
+
+    scene.removeItem( &first );
+    const QList<GeoGraphicsItem*> items = scene.items( box( 51, 49, 9, 7 ), 5 );
+    QCOMPARE( items.size(), 1 );
+    QVERIFY( items.at( 0 ) == secondItem );
+
+    delete firstItem;
+    delete otherFirstItem;
+    scene.eraseAll();
+}
+
+}
+
+QTEST_MAIN( Marble::GeoGraphicsSceneTest )
+
+#include "GeoGraphicsSceneTest.moc"
@@ -0,0 +1,201 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QThreadPool>
+#include <QtTest/QtTest>
+
+#include "GeoDataLinearRing.h"
+#include "GeoDataPolygon.h"
+#include "LevelOfDetailCache.h"
+#include "ViewportParams.h"
+
+namespace Marble
+{
+
+class LevelOfDetailCacheTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void detailLevel_data();
+    void detailLevel();
+    void smallLineString();
+    void lineString();
+    void polygon();
+    void mercatorStretch();
+    void modifiedNode();
+    void tessellatedLineString();
+};
+
+static GeoDataLineString zigZag( int count )
+{
+    // Large steps at every 64th node, tiny wiggles in between
+    GeoDataLineString lineString;
+    for ( int i = 0; i < count; ++i ) {
+        const qreal lat = ( i % 64 == 0 ) ? 10.0 : ( i % 2 ) * 1e-5;
+        lineString.append( GeoDataCoordinates( 0.01 * i, lat, 0, GeoDataCoordinates::Degree ) );
+    }
+    return lineString;
+}
+
+void LevelOfDetailCacheTest::detailLevel_data()
+{
+    QTest::addColumn<int>( "radius" );
+    QTest::addColumn<int>( "detail" );
+
+    QTest::newRow( "globe" ) << 100 << 0;
+    QTest::newRow( "256" ) << 256 << 0;
+    QTest::newRow( "257" ) << 257 << 1;
+    QTest::newRow( "1024" ) << 1024 << 1;
+    QTest::newRow( "20000" ) << 20000 << 4;
+    QTest::newRow( "street" ) << 1000000 << int( LevelOfDetailCache::MaximumDetail );
+}
+
+void LevelOfDetailCacheTest::detailLevel()
+{
+    QFETCH( int, radius );
+    QFETCH( int, detail );
+
+    ViewportParams viewport;
+    viewport.setRadius( radius );
+
+    QCOMPARE( LevelOfDetailCache::detailLevel( &viewport ), detail );
+}
+
+void LevelOfDetailCacheTest::smallLineString()
+{
+    const GeoDataLineString lineString = zigZag( 10 );
+    const LevelOfDetailCache cache( &lineString );
+
+    QVERIFY( cache.lineString( 0 ) == &lineString );
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY( cache.lineString( 0 ) == &lineString );
+}
+
+void LevelOfDetailCacheTest::lineString()
+{
+    const GeoDataLineString lineString = zigZag( 1001 );
+    const LevelOfDetailCache cache( &lineString );
+
+    // The copies are built in the background
+    QVERIFY( cache.lineString( 0 ) == &lineString );
+    QThreadPool::globalInstance()->waitForDone();
+
+    const GeoDataLineString *coarse = cache.lineString( 0 );
+    QVERIFY( coarse != &lineString );
+    QVERIFY( coarse->size() < 100 );
+    QCOMPARE( coarse->first(), lineString.first() );
+    QCOMPARE( coarse->last(), lineString.last() );
+
+    int peaks = 0;
+    for ( int i = 0; i < coarse->size(); ++i ) {
+        if ( coarse->at( i ).latitude( GeoDataCoordinates::Degree ) > 9.0 ) {
+            QCOMPARE( coarse->at( i ).detail(), 0 );
+            ++peaks;
+        }
+    }
+    QCOMPARE( peaks, 16 );
+
+    for ( int detail = 1; detail < LevelOfDetailCache::MaximumDetail; ++detail ) {
+        QVERIFY( cache.lineString( detail )->size() >= cache.lineString( detail - 1 )->size() );
+    }
+
+    QVERIFY( cache.lineString( LevelOfDetailCache::MaximumDetail ) == &lineString );
+}
+
+void LevelOfDetailCacheTest::polygon()
+{
+    GeoDataPolygon polygon;
+    polygon.setOuterBoundary( GeoDataLinearRing( zigZag( 1001 ) ) );
+    const LevelOfDetailCache cache( &polygon );
+
+    QVERIFY( cache.polygon( 0 ) == &polygon );
+    QThreadPool::globalInstance()->waitForDone();
+
+    const GeoDataPolygon *coarse = cache.polygon( 0 );
+    QVERIFY( coarse != &polygon );
+    QVERIFY( coarse->outerBoundary().size() < 100 );
+    QCOMPARE( coarse->outerBoundary().first(), polygon.outerBoundary().first() );
+}
+
+void LevelOfDetailCacheTest::mercatorStretch()
+{
+    // Bumps of 0.05 degrees are less than half a pixel at a radius of 256
+    // pixels, but stretched to about 0.29 degrees at 80 degrees in Mercator
+    GeoDataLineString equator;
+    GeoDataLineString polar;
+    for ( int i = 0; i < 1001; ++i ) {
+        const qreal bump = ( i % 64 == 32 ) ? 0.05 : 0.0;
+        equator.append( GeoDataCoordinates( 0.01 * i, bump, 0, GeoDataCoordinates::Degree ) );
+        polar.append( GeoDataCoordinates( 0.01 * i, 80.0 + bump, 0, GeoDataCoordinates::Degree ) );
+    }
+
+    const LevelOfDetailCache equatorCache( &equator );
+    const LevelOfDetailCache polarCache( &polar );
+    equatorCache.lineString( 0 );
+    polarCache.lineString( 0 );
+    QThreadPool::globalInstance()->waitForDone();
+
+    QCOMPARE( equatorCache.lineString( 0 )->size(), 2 );
+
+    const GeoDataLineString *coarse = polarCache.lineString( 0 );
+    QVERIFY( coarse != &polar );
+    int bumps = 0;
+    for ( int i = 0; i < coarse->size(); ++i ) {
+        if ( coarse->at( i ).latitude( GeoDataCoordinates::Degree ) > 80.04 ) {
+            ++bumps;
+        }
+    }
+    QCOMPARE( bumps, 16 );
+}
+
+void LevelOfDetailCacheTest::modifiedNode()
+{
+    GeoDataLineString lineString = zigZag( 1001 );
+    const LevelOfDetailCache cache( &lineString );
+
+    cache.lineString( 0 );
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY( cache.lineString( 0 ) != &lineString );
+
+    // Moving a node keeps the size, but outdates the copies
+    const int revision = lineString.revision();
+    lineString[0] = GeoDataCoordinates( 0.0, -20.0, 0, GeoDataCoordinates::Degree );
+    QVERIFY( lineString.revision() != revision );
+    QCOMPARE( lineString.size(), 1001 );
+
+    QVERIFY( cache.lineString( 0 ) == &lineString );
+    QThreadPool::globalInstance()->waitForDone();
+
+    const GeoDataLineString *coarse = cache.lineString( 0 );
+    QVERIFY( coarse != &lineString );
+    QCOMPARE( coarse->first(), lineString.first() );
+
+    // Copies share the revision until one of them gets modified
+    const GeoDataLineString copy = lineString;
+    QCOMPARE( copy.revision(), lineString.revision() );
+}
+
+void LevelOfDetailCacheTest::tessellatedLineString()
+{
+    GeoDataLineString lineString = zigZag( 1001 );
+    lineString.setTessellate( true );
+    const LevelOfDetailCache cache( &lineString );
+
+    QVERIFY( cache.lineString( 0 ) == &lineString );
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY( cache.lineString( 0 ) == &lineString );
+}
+
+}
+
+QTEST_MAIN( Marble::LevelOfDetailCacheTest )
+
+#include "LevelOfDetailCacheTest.moc"
@@ -10,6 +10,7 @@
 
 #include <QtTest/QtTest>
 #include "GeoPainter.h"
+#include "HttpDownloadManager.h"
 #include "MarbleMap.h"
 #include "MarbleModel.h"
 #include "TestUtils.h"
@@ -65,7 +66,19 @@ class MarbleMapTest : public QObject
     void paint_data();
     void paint();
 
+    void paintIntoImage_data();
+    void paintIntoImage();
+
+    void panCanvas_data();
+    void panCanvas();
+
+    void rotateCanvas();
+
  private:
+    static void setUpMap( MarbleMap *map, Projection projection, const QSize &size, int radius );
+    static QImage paintClipped( MarbleMap *map );
+    static int differingPixels( const QImage &image, const QImage &other, int tolerance );
+
     MarbleModel m_model;
 };
 
@@ -593,6 +606,194 @@ void MarbleMapTest::paint()
     QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
 }
 
+void MarbleMapTest::paintIntoImage_data()
+{
+    QTest::addColumn<int>( "projection" );
+
+    addRow() << (int)Equirectangular;
+    addRow() << (int)Mercator;
+}
+
+void MarbleMapTest::paintIntoImage()
+{
+    QFETCH( int, projection );
+
+    MarbleModel model;
+    model.downloadManager()->setDownloadEnabled( false );
+    MarbleMap map( &model );
+    map.setMapThemeId( "earth/openstreetmap/openstreetmap.dgml" );
+    map.setProjection( (Projection)projection );
+    map.setSize( 200, 150 );
+    map.setRadius( 256 );
+    map.setShowOverviewMap( false );
+    map.setShowScaleBar( false );
+    map.setShowCompass( false );
+    QVERIFY( map.viewport()->mapCoversViewport() );
+
+    const QRect rect( QPoint( 0, 0 ), map.size() );
+    const QRgb background = qRgb( 255, 0, 0 );
+
+    // A clipped painter needs the canvas of the texture layer
+    map.centerOn( 0.0, 0.0 );
+    QImage first( map.size(), QImage::Format_RGB32 );
+    first.fill( background );
+    {
+        GeoPainter painter( &first, map.viewport(), map.mapQuality() );
+        painter.setClipRect( rect );
+        map.paint( painter, QRect() );
+    }
+
+    // Too far to pan the canvas, so the texture gets mapped into the image
+    // directly and the canvas gets outdated
+    map.centerOn( 90.0, 0.0 );
+    QImage direct( map.size(), QImage::Format_RGB32 );
+    direct.fill( background );
+    {
+        GeoPainter painter( &direct, map.viewport(), map.mapQuality() );
+        map.paint( painter, QRect() );
+    }
+    QVERIFY( direct != first );
+    QVERIFY( direct.pixel( 100, 75 ) != background );
+
+    // The next clipped repaint must not draw the outdated canvas
+    QImage viaCanvas( map.size(), QImage::Format_RGB32 );
+    viaCanvas.fill( background );
+    {
+        GeoPainter painter( &viaCanvas, map.viewport(), map.mapQuality() );
+        painter.setClipRect( rect );
+        map.paint( painter, QRect() );
+    }
+    QCOMPARE( viaCanvas, direct );
+
+    // Shared images are not written to behind the back of their copies
+    QImage shared( map.size(), QImage::Format_RGB32 );
+    shared.fill( background );
+    const QImage copy = shared;
+    {
+        GeoPainter painter( &shared, map.viewport(), map.mapQuality() );
+        map.paint( painter, QRect() );
+    }
+    QCOMPARE( shared, direct );
+    QCOMPARE( copy.pixel( 100, 75 ), background );
+}
+
+
+void MarbleMapTest::setUpMap( MarbleMap *map, Projection projection, const QSize &size, int radius )
+{
+    map->setMapThemeId( "earth/openstreetmap/openstreetmap.dgml" );
+    map->setProjection( projection );
+    map->setSize( size );
+    map->setRadius( radius );
+    map->setShowOverviewMap( false );
+    map->setShowScaleBar( false );
+    map->setShowCompass( false );
+}
+
+QImage MarbleMapTest::paintClipped( MarbleMap *map )
+{
+    // the clip rect makes the texture layer paint via its canvas
+    QImage image( map->size(), QImage::Format_RGB32 );
+    image.fill( qRgb( 255, 0, 0 ) );
+    GeoPainter painter( &image, map->viewport(), map->mapQuality() );
+    painter.setClipRect( QRect( QPoint( 0, 0 ), map->size() ) );
+    map->paint( painter, QRect() );
+
+    return image;
+}
+
+int MarbleMapTest::differingPixels( const QImage &image, const QImage &other, int tolerance )
+{
+    int result = 0;
+    for ( int y = 0; y < image.height(); ++y ) {
+        for ( int x = 0; x < image.width(); ++x ) {
+            const QRgb pixel = image.pixel( x, y );
+            const QRgb otherPixel = other.pixel( x, y );
+            if ( qAbs( qRed( pixel ) - qRed( otherPixel ) ) > tolerance
+                 || qAbs( qGreen( pixel ) - qGreen( otherPixel ) ) > tolerance
+                 || qAbs( qBlue( pixel ) - qBlue( otherPixel ) ) > tolerance ) {
+                ++result;
+            }
+        }
+    }
+
+    return result;
+}
+
+void MarbleMapTest::panCanvas_data()
+{
+    QTest::addColumn<int>( "projection" );
+
+    addRow() << (int)Equirectangular;
+    addRow() << (int)Mercator;
+}
+
+void MarbleMapTest::panCanvas()
+{
+    QFETCH( int, projection );
+
+    MarbleModel model;
+    model.downloadManager()->setDownloadEnabled( false );
+    MarbleMap map( &model );
+    setUpMap( &map, (Projection)projection, QSize( 200, 150 ), 256 );
+    QVERIFY( map.viewport()->mapCoversViewport() );
+
+    MarbleMap freshMap( &model );
+    setUpMap( &freshMap, (Projection)projection, QSize( 200, 150 ), 256 );
+
+    // 90 / radius degrees of longitude are one pixel, so the canvas gets
+    // scrolled by whole pixels
+    map.centerOn( 10.123, 5.4321 );
+    paintClipped( &map );
+
+    // The scrolled canvas and the mapped strips along its edges need to match
+    // the texture mapped completely, up to the rounding at the texel borders
+    map.centerOn( 10.123 + 5 * 90.0 / 256, 5.4321 + 0.7 );
+    const QImage panned = paintClipped( &map );
+
+    freshMap.centerOn( 10.123 + 5 * 90.0 / 256, 5.4321 + 0.7 );
+    const QImage expected = paintClipped( &freshMap );
+
+    QVERIFY( differingPixels( panned, expected, 8 ) < panned.width() * panned.height() / 100 );
+
+    // the strip of the opposite direction
+    map.centerOn( 10.123 - 7 * 90.0 / 256, 5.4321 - 1.3 );
+    freshMap.centerOn( 10.123 - 7 * 90.0 / 256, 5.4321 - 1.3 );
+    QVERIFY( differingPixels( paintClipped( &map ), paintClipped( &freshMap ), 8 ) < panned.width() * panned.height() / 100 );
+}
+
+void MarbleMapTest::rotateCanvas()
+{
+    MarbleModel model;
+    model.downloadManager()->setDownloadEnabled( false );
+    MarbleMap map( &model );
+    setUpMap( &map, Spherical, QSize( 300, 300 ), 120 );
+    map.setMapQualityForViewContext( LowQuality, Animation );
+    map.setViewContext( Animation );
+
+    MarbleMap freshMap( &model );
+    setUpMap( &freshMap, Spherical, QSize( 300, 300 ), 120 );
+    freshMap.setMapQualityForViewContext( LowQuality, Animation );
+    freshMap.setViewContext( Animation );
+
+    map.centerOn( 10.0, 20.0 );
+    paintClipped( &map );
+
+    // While dragging, the rotated globe is close to the one mapped completely
+    map.centerOn( 13.0, 21.5 );
+    const QImage rotated = paintClipped( &map );
+
+    freshMap.centerOn( 13.0, 21.5 );
+    const QImage expected = paintClipped( &freshMap );
+
+    QVERIFY( rotated != expected );
+    QVERIFY( differingPixels( rotated, expected, 32 ) < rotated.width() * rotated.height() / 10 );
+
+    // ... and once it is finished, the globe gets mapped exactly
+    map.setViewContext( Still );
+    freshMap.setViewContext( Still );
+    QCOMPARE( paintClipped( &map ), paintClipped( &freshMap ) );
+}
+
 }
 
 QTEST_MAIN( Marble::MarbleMapTest )
@@ -97,6 +97,27 @@ void MercatorProjectionTest::screenCoordinatesValidLat()
         QVERIFY( !globeHidesPoint );
     }
 
+    {
+        const qreal lons[2] = { lon * DEG2RAD, 0.0 };
+        const qreal lats[2] = { lat * DEG2RAD, 0.0 };
+        qreal x[2];
+        qreal y[2];
+        bool visible[2];
+        bool globeHidesPoint[2] = { true, true };
+
+        viewport.currentProjection()->screenCoordinates( 2, lons, lats, 0, &viewport, x, y, visible, globeHidesPoint );
+
+        qreal expectedX;
+        qreal expectedY;
+        viewport.screenCoordinates( lons[0], lats[0], expectedX, expectedY );
+
+        QVERIFY( visible[0] == validLat );
+        QVERIFY( !globeHidesPoint[0] );
+        QCOMPARE( x[0], expectedX );
+        QCOMPARE( y[0], expectedY );
+        QVERIFY( visible[1] );
+    }
+
     QVERIFY( viewport.currentProjection()->repeatX() );
 
     {
@@ -0,0 +1,257 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QDateTime>
+#include <QtGui/QImage>
+#include <QtTest/QtTest>
+
+#include <cmath>
+
+#include "GeoSceneTextureTile.h"
+#include "MarbleClock.h"
+#include "MarbleGlobal.h"
+#include "MergedLayerDecorator.h"
+#include "Planet.h"
+#include "StackedTile.h"
+#include "SunLocator.h"
+#include "TextureTile.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class MergedLayerDecoratorTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    MergedLayerDecoratorTest();
+
+ private slots:
+    void init();
+
+    void shadeMasks();
+    void updateShading();
+
+ private:
+    enum Shading {
+        Lit,
+        Dark,
+        Partial
+    };
+
+    static const int level = 3;
+    static const int tileSize = 64;
+    static const int tileColumns = 2 << level;
+    static const int tileRows = 1 << level;
+
+    static QImage tileImage();
+    QImage referenceShading( const TileId &id ) const;
+    static bool isDark( const QImage &image );
+    static bool fuzzyCompare( const QImage &image, const QImage &expected );
+
+    MarbleClock m_clock;
+    Planet m_planet;
+    SunLocator m_sunLocator;
+    GeoSceneTextureTile m_texture;
+};
+
+MergedLayerDecoratorTest::MergedLayerDecoratorTest() :
+    m_clock(),
+    m_planet( "earth" ),
+    m_sunLocator( &m_clock, &m_planet ),
+    m_texture( "test" )
+{
+    m_texture.setSourceDir( "earth/mergedlayerdecoratortest" );
+    m_texture.setLevelZeroColumns( 2 );
+    m_texture.setLevelZeroRows( 1 );
+    m_texture.setMaximumTileLevel( level );
+    m_texture.setTileSize( QSize( tileSize, tileSize ) );
+}
+
+void MergedLayerDecoratorTest::init()
+{
+    m_clock.setDateTime( QDateTime( QDate( 2026, 6, 21 ), QTime( 12, 0 ), Qt::UTC ) );
+    m_sunLocator.update();
+}
+
+QImage MergedLayerDecoratorTest::tileImage()
+{
+    QImage image( tileSize, tileSize, QImage::Format_ARGB32_Premultiplied );
+    image.fill( qRgb( 255, 255, 255 ) );
+
+    return image;
+}
+
+QImage MergedLayerDecoratorTest::referenceShading( const TileId &id ) const
+{
+    // The brightness of each pixel, as painted before shade masks existed
+    QImage image = tileImage();
+
+    const qreal lonScale = 2*M_PI / ( tileSize * tileColumns );
+    const qreal latScale = -M_PI / ( tileSize * tileRows );
+    const qreal sunLat = DEG2RAD * m_sunLocator.getLat();
+
+    for ( int y = 0; y < tileSize; ++y ) {
+        const qreal lat = latScale * ( id.y() * tileSize + y ) - 0.5*M_PI;
+        const qreal a = sin( ( lat + sunLat ) / 2.0 );
+        const qreal c = cos( lat ) * cos( -sunLat );
+
+        QRgb *scanLine = (QRgb*)image.scanLine( y );
+        for ( int x = 0; x < tileSize; ++x ) {
+            const qreal lon = lonScale * ( id.x() * tileSize + x );
+            m_sunLocator.shadePixel( scanLine[x], m_sunLocator.shading( lon, a, c ) );
+        }
+    }
+
+    return image;
+}
+
+bool MergedLayerDecoratorTest::isDark( const QImage &image )
+{
+    QImage dark = tileImage();
+    dark.fill( qRgb( 89, 89, 89 ) );
+
+    return image == dark;
+}
+
+bool MergedLayerDecoratorTest::fuzzyCompare( const QImage &image, const QImage &expected )
+{
+    // The masks store 8 bits of brightness only
+    for ( int y = 0; y < expected.height(); ++y ) {
+        for ( int x = 0; x < expected.width(); ++x ) {
+            const QRgb pixel = image.pixel( x, y );
+            const QRgb expectedPixel = expected.pixel( x, y );
+            if ( qAbs( qRed( pixel ) - qRed( expectedPixel ) ) > 1 ||
+                 qAbs( qGreen( pixel ) - qGreen( expectedPixel ) ) > 1 ||
+                 qAbs( qBlue( pixel ) - qBlue( expectedPixel ) ) > 1 ) {
+                qWarning() << "pixel" << x << y << "differs:" << pixel << expectedPixel;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void MergedLayerDecoratorTest::shadeMasks()
+{
+    MergedLayerDecorator decorator( 0, &m_sunLocator );
+    decorator.setTextureLayers( QVector<const GeoSceneTextureTile *>() << &m_texture );
+    decorator.setShowSunShading( true );
+
+    const QVector<QSharedPointer<TextureTile> > noTiles;
+    int count[3] = { 0, 0, 0 };
+
+    for ( int y = 0; y < tileRows; ++y ) {
+        for ( int x = 0; x < tileColumns; ++x ) {
+            const TileId id( 0, level, x, y );
+            const StackedTile unshaded( id, tileImage(), noTiles );
+            const QImage expected = referenceShading( id );
+
+            // Tiles estimated to be lit as a whole are left alone, so the
+            // estimate must never miss a shaded pixel
+            StackedTile *const shaded = decorator.updateShading( unshaded );
+            if ( !shaded ) {
+                QCOMPARE( expected, tileImage() );
+                ++count[Lit];
+                continue;
+            }
+
+            QVERIFY( shaded->resultImage()->cacheKey() != shaded->unshadedImage()->cacheKey() );
+            QCOMPARE( *shaded->unshadedImage(), tileImage() );
+            QVERIFY( fuzzyCompare( *shaded->resultImage(), expected ) );
+            ++count[isDark( *shaded->resultImage() ) ? Dark : Partial];
+
+            delete shaded;
+        }
+    }
+
+    // the tiles around the subsolar point are lit, those around its
+    // antipode dark, and the twilight zone crosses the tiles in between
+    QVERIFY( count[Lit] > 0 );
+    QVERIFY( count[Dark] > 0 );
+    QVERIFY( count[Partial] > 0 );
+}
+
+void MergedLayerDecoratorTest::updateShading()
+{
+    MergedLayerDecorator decorator( 0, &m_sunLocator );
+    decorator.setTextureLayers( QVector<const GeoSceneTextureTile *>() << &m_texture );
+    decorator.setShowSunShading( true );
+
+    const QVector<QSharedPointer<TextureTile> > noTiles;
+    QList<StackedTile *> tiles;
+    QList<Shading> shadings;
+
+    for ( int y = 0; y < tileRows; ++y ) {
+        for ( int x = 0; x < tileColumns; ++x ) {
+            StackedTile *const unshaded = new StackedTile( TileId( 0, level, x, y ), tileImage(), noTiles );
+            StackedTile *const shaded = decorator.updateShading( *unshaded );
+            if ( shaded ) {
+                delete unshaded;
+                tiles << shaded;
+                shadings << ( isDark( *shaded->resultImage() ) ? Dark : Partial );
+            } else {
+                tiles << unshaded;
+                shadings << Lit;
+            }
+        }
+    }
+
+    // nothing changes as long as the sun stands still
+    foreach ( const StackedTile *tile, tiles ) {
+        QVERIFY( !decorator.updateShading( *tile ) );
+    }
+
+    // The partially shaded tiles get replaced after the sun moved, all
+    // others only if they end up with a different shading
+    m_clock.setDateTime( QDateTime( QDate( 2026, 6, 21 ), QTime( 13, 0 ), Qt::UTC ) );
+    m_sunLocator.update();
+
+    int replaced = 0;
+    int skipped = 0;
+    for ( int i = 0; i < tiles.size(); ++i ) {
+        StackedTile *const updated = decorator.updateShading( *tiles.at( i ) );
+        QVERIFY( updated || shadings.at( i ) != Partial );
+        if ( updated ) {
+            QCOMPARE( *updated->unshadedImage(), tileImage() );
+            delete tiles.at( i );
+            tiles[i] = updated;
+            ++replaced;
+        } else {
+            ++skipped;
+        }
+
+        QVERIFY( fuzzyCompare( *tiles.at( i )->resultImage(), referenceShading( tiles.at( i )->id() ) ) );
+    }
+    QVERIFY( replaced > 0 );
+    QVERIFY( skipped > 0 );
+
+    // without sun shading, all shaded tiles get their unshaded image back
+    decorator.setShowSunShading( false );
+    for ( int i = 0; i < tiles.size(); ++i ) {
+        const bool isShaded = tiles.at( i )->resultImage()->cacheKey() != tiles.at( i )->unshadedImage()->cacheKey();
+        StackedTile *const updated = decorator.updateShading( *tiles.at( i ) );
+        QCOMPARE( updated != 0, isShaded );
+        if ( updated ) {
+            QCOMPARE( *updated->resultImage(), tileImage() );
+            delete updated;
+        }
+    }
+
+    qDeleteAll( tiles );
+}
+
+}
+
+QTEST_MAIN( Marble::MergedLayerDecoratorTest )
+
+#include "MergedLayerDecoratorTest.moc"
@@ -0,0 +1,150 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtTest/QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "MarbleDirs.h"
+#include "MarbleRunnerManager.h"
+#include "PluginManager.h"
+
+namespace Marble
+{
+
+class OsmRunnerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanup();
+
+    void unsortedNodes();
+    void waysAfterRelations();
+
+ private:
+    GeoDataDocument *parse( const QByteArray &osm );
+    static const GeoDataLineString *lineString( const GeoDataDocument *document, const QString &name );
+
+    PluginManager m_pluginManager;
+    QString m_fileName;
+};
+
+void OsmRunnerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    m_fileName = QDir::tempPath() + QString( "/marble-osmrunnertest-%1.osm" ).arg( QCoreApplication::applicationPid() );
+}
+
+void OsmRunnerTest::cleanup()
+{
+    QFile::remove( m_fileName );
+}
+
+GeoDataDocument *OsmRunnerTest::parse( const QByteArray &osm )
+{
+    QFile file( m_fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        return 0;
+    }
+    file.write( "<?xml version='1.0' encoding='UTF-8'?>\n<osm version='0.6'>\n" );
+    file.write( osm );
+    file.write( "</osm>\n" );
+    file.close();
+
+    MarbleRunnerManager runnerManager( &m_pluginManager );
+    return runnerManager.openFile( m_fileName );
+}
+
+const GeoDataLineString *OsmRunnerTest::lineString( const GeoDataDocument *document, const QString &name )
+{
+    foreach ( const GeoDataPlacemark *placemark, document->placemarkList() ) {
+        if ( placemark->name() == name ) {
+            return dynamic_cast<const GeoDataLineString *>( placemark->geometry() );
+        }
+    }
+
+    return 0;
+}
+
+void OsmRunnerTest::unsortedNodes()
+{
+    // The node store gets sorted by id on the first lookup. A node listed
+    // twice keeps its last position, unknown nodes are skipped.
+    GeoDataDocument *const document = parse(
+        "<node id='30' lat='3.0' lon='30.0'/>\n"
+        "<node id='10' lat='1.0' lon='10.0'/>\n"
+        "<node id='20' lat='9.0' lon='90.0'/>\n"
+        "<node id='20' lat='2.0' lon='20.0'/>\n"
+        "<node id='5000000000' lat='-4.0' lon='-40.0'/>\n"
+        "<way id='1'>\n"
+        " <nd ref='20'/><nd ref='5000000000'/><nd ref='99'/><nd ref='10'/><nd ref='30'/>\n"
+        " <tag k='highway' v='residential'/><tag k='name' v='unsorted'/>\n"
+        "</way>\n" );
+    QVERIFY( document );
+
+    const GeoDataLineString *const way = lineString( document, "unsorted" );
+    QVERIFY( way );
+    QCOMPARE( way->size(), 4 );
+    QCOMPARE( way->at( 0 ).longitude( GeoDataCoordinates::Degree ), 20.0 );
+    QCOMPARE( way->at( 0 ).latitude( GeoDataCoordinates::Degree ), 2.0 );
+    QCOMPARE( way->at( 1 ).longitude( GeoDataCoordinates::Degree ), -40.0 );
+    QCOMPARE( way->at( 2 ).latitude( GeoDataCoordinates::Degree ), 1.0 );
+    QCOMPARE( way->at( 3 ).longitude( GeoDataCoordinates::Degree ), 30.0 );
+
+    delete document;
+}
+
+void OsmRunnerTest::waysAfterRelations()
+{
+    // Files merged by other tools may list ways after relations
+    GeoDataDocument *const document = parse(
+        "<node id='1' lat='1.0' lon='10.0'/>\n"
+        "<node id='2' lat='2.0' lon='20.0'/>\n"
+        "<way id='1'>\n"
+        " <nd ref='1'/><nd ref='2'/>\n"
+        " <tag k='highway' v='residential'/><tag k='name' v='first'/>\n"
+        "</way>\n"
+        "<relation id='1'>\n"
+        " <member type='way' ref='1' role='outer'/>\n"
+        " <tag k='type' v='multipolygon'/>\n"
+        "</relation>\n"
+        "<node id='3' lat='3.0' lon='30.0'/>\n"
+        "<way id='2'>\n"
+        " <nd ref='2'/><nd ref='3'/>\n"
+        " <tag k='highway' v='residential'/><tag k='name' v='second'/>\n"
+        "</way>\n" );
+    QVERIFY( document );
+
+    const GeoDataLineString *const first = lineString( document, "first" );
+    QVERIFY( first );
+    QCOMPARE( first->size(), 2 );
+
+    const GeoDataLineString *const second = lineString( document, "second" );
+    QVERIFY( second );
+    QCOMPARE( second->size(), 2 );
+    QCOMPARE( second->at( 0 ).longitude( GeoDataCoordinates::Degree ), 20.0 );
+    QCOMPARE( second->at( 1 ).latitude( GeoDataCoordinates::Degree ), 3.0 );
+
+    delete document;
+}
+
+}
+
+QTEST_MAIN( Marble::OsmRunnerTest )
+
+#include "OsmRunnerTest.moc"
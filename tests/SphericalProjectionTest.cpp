@@ -0,0 +1,138 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtTest/QtTest>
+#include "SphericalProjection.h"
+#include "ViewportParams.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class SphericalProjectionTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void screenCoordinatesOfPoints_data();
+    void screenCoordinatesOfPoints();
+};
+
+void SphericalProjectionTest::screenCoordinatesOfPoints_data()
+{
+    QTest::addColumn<qreal>( "centerLon" );
+    QTest::addColumn<qreal>( "centerLat" );
+    QTest::addColumn<qreal>( "altitude" );
+
+    addNamedRow( "equator" ) << 0.0 << 0.0 << 0.0;
+    addNamedRow( "date line" ) << 180.0 << 0.0 << 0.0;
+    addNamedRow( "west of date line" ) << -179.5 << 30.0 << 0.0;
+    addNamedRow( "north pole" ) << 0.0 << 90.0 << 0.0;
+    addNamedRow( "low flight" ) << 30.0 << -45.0 << 9000.0;
+    addNamedRow( "satellites" ) << 30.0 << -45.0 << 20000000.0;
+}
+
+void SphericalProjectionTest::screenCoordinatesOfPoints()
+{
+    QFETCH( qreal, centerLon );
+    QFETCH( qreal, centerLat );
+    QFETCH( qreal, altitude );
+
+    ViewportParams viewport;
+    viewport.setProjection( Spherical );
+    viewport.setRadius( 300 ); // larger than the screen, so some points are off screen
+    viewport.setSize( QSize( 640, 480 ) );
+    viewport.centerOn( centerLon * DEG2RAD, centerLat * DEG2RAD );
+
+    // More points than fit into a single block of the batch. The grid never
+    // hits the horizon exactly, where the rounding could decide either way.
+    QVector<GeoDataCoordinates> points;
+    for ( qreal lon = -177.5; lon < 180.0; lon += 5.0 ) {
+        for ( qreal lat = -87.5; lat < 90.0; lat += 5.0 ) {
+            points << GeoDataCoordinates( lon, lat, altitude, GeoDataCoordinates::Degree );
+        }
+    }
+
+    // just in front of and behind the horizon
+    foreach ( qreal distance, QList<qreal>() << 89.9 << 90.1 << -89.9 << -90.1 ) {
+        qreal lon = centerLon;
+        qreal lat = centerLat + distance;
+        if ( lat > 90.0 ) {
+            lat = 180.0 - lat;
+            lon += 180.0;
+        } else if ( lat < -90.0 ) {
+            lat = -180.0 - lat;
+            lon += 180.0;
+        }
+        points << GeoDataCoordinates( lon, lat, altitude, GeoDataCoordinates::Degree );
+    }
+
+    // on both sides of the date line
+    foreach ( qreal lon, QList<qreal>() << -180.0 << -179.9 << 179.9 << 180.0 ) {
+        points << GeoDataCoordinates( lon, -10.5, altitude, GeoDataCoordinates::Degree );
+        points << GeoDataCoordinates( lon, 10.5, altitude, GeoDataCoordinates::Degree );
+    }
+
+    const int count = points.size();
+    QVector<qreal> lons( count );
+    QVector<qreal> lats( count );
+    QVector<qreal> altitudes( count );
+    for ( int i = 0; i < count; ++i ) {
+        lons[i] = points.at( i ).longitude();
+        lats[i] = points.at( i ).latitude();
+        altitudes[i] = points.at( i ).altitude();
+    }
+
+    QVector<qreal> x( count );
+    QVector<qreal> y( count );
+    QVector<bool> visible( count );
+    QVector<bool> globeHidesPoint( count );
+
+    // points on the ground don't need any altitudes
+    viewport.currentProjection()->screenCoordinates( count, lons.constData(), lats.constData(),
+                                                     altitude == 0.0 ? 0 : altitudes.constData(),
+                                                     &viewport, x.data(), y.data(),
+                                                     visible.data(), globeHidesPoint.data() );
+
+    int visibleCount = 0;
+    int hiddenCount = 0;
+    for ( int i = 0; i < count; ++i ) {
+        qreal expectedX;
+        qreal expectedY;
+        bool expectedGlobeHidesPoint = false;
+        const bool expectedVisible = viewport.screenCoordinates( points.at( i ), expectedX, expectedY, expectedGlobeHidesPoint );
+
+        QCOMPARE( visible.at( i ), expectedVisible );
+        QCOMPARE( globeHidesPoint.at( i ), expectedGlobeHidesPoint );
+        if ( !expectedGlobeHidesPoint ) {
+            QFUZZYCOMPARE( x.at( i ), expectedX, 1e-6 );
+            QFUZZYCOMPARE( y.at( i ), expectedY, 1e-6 );
+        }
+
+        visibleCount += visible.at( i ) ? 1 : 0;
+        hiddenCount += expectedGlobeHidesPoint ? 1 : 0;
+    }
+
+    QVERIFY( visibleCount > 0 );
+    QVERIFY( hiddenCount > 0 );
+
+    // the batch may be called without globeHidesPoint
+    QVector<bool> visibleOnly( count );
+    viewport.currentProjection()->screenCoordinates( count, lons.constData(), lats.constData(),
+                                                     altitudes.constData(), &viewport,
+                                                     x.data(), y.data(), visibleOnly.data() );
+    QCOMPARE( visibleOnly, visible );
+}
+
+}
+
+QTEST_MAIN( Marble::SphericalProjectionTest )
+
+#include "SphericalProjectionTest.moc"
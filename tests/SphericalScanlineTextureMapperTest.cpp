@@ -0,0 +1,194 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtGui/QImage>
+#include <QtTest/QtTest>
+
+#include "GeoSceneTextureTile.h"
+#include "HttpDownloadManager.h"
+#include "MarbleGlobal.h"
+#include "MergedLayerDecorator.h"
+#include "SphericalScanlineTextureMapper.h"
+#include "StackedTileLoader.h"
+#include "TileId.h"
+#include "TileLoader.h"
+#include "ViewportParams.h"
+
+Q_DECLARE_METATYPE( Marble::MapQuality )
+
+namespace Marble
+{
+
+class SphericalScanlineTextureMapperTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    SphericalScanlineTextureMapperTest();
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void chunkedMapping_data();
+    void chunkedMapping();
+
+ private:
+    static const int maximumLevel = 1;
+    static const int tileSize = 64;
+
+    static QByteArray scanLine( const QImage &image, int y );
+    static void removeDirectory( const QString &path );
+
+    GeoSceneTextureTile m_texture;
+    HttpDownloadManager m_downloadManager;
+    TileLoader m_tileLoader;
+    MergedLayerDecorator m_decorator;
+    StackedTileLoader m_stackedTileLoader;
+};
+
+SphericalScanlineTextureMapperTest::SphericalScanlineTextureMapperTest() :
+    m_texture( "test" ),
+    m_downloadManager( 0 ),
+    m_tileLoader( &m_downloadManager, 0 ),
+    m_decorator( &m_tileLoader, 0 ),
+    m_stackedTileLoader( &m_decorator )
+{
+}
+
+void SphericalScanlineTextureMapperTest::initTestCase()
+{
+    const QString sourceDir = QDir::tempPath() + QString( "/marble-sphericalscanlinetexturemappertest-%1" ).arg( QCoreApplication::applicationPid() );
+    removeDirectory( sourceDir );
+
+    m_texture.setSourceDir( sourceDir );
+    m_texture.setFileFormat( "PNG" );
+    m_texture.setLevelZeroColumns( 2 );
+    m_texture.setLevelZeroRows( 1 );
+    m_texture.setMaximumTileLevel( maximumLevel );
+    m_texture.setTileSize( QSize( tileSize, tileSize ) );
+
+    // noise, so that each scanline of the map differs from its neighbors
+    qsrand( 42 );
+    for ( int level = 0; level <= maximumLevel; ++level ) {
+        for ( int y = 0; y < 1 << level; ++y ) {
+            for ( int x = 0; x < 2 << level; ++x ) {
+                const QString fileName = m_texture.relativeTileFileName( TileId( 0, level, x, y ) );
+                QDir::root().mkpath( QFileInfo( fileName ).path() );
+
+                QImage image( tileSize, tileSize, QImage::Format_RGB32 );
+                for ( int row = 0; row < tileSize; ++row ) {
+                    for ( int column = 0; column < tileSize; ++column ) {
+                        image.setPixel( column, row, qRgb( qrand() % 256, qrand() % 256, qrand() % 256 ) );
+                    }
+                }
+                QVERIFY( image.save( fileName, "PNG" ) );
+            }
+        }
+    }
+
+    m_decorator.setTextureLayers( QVector<const GeoSceneTextureTile *>() << &m_texture );
+}
+
+void SphericalScanlineTextureMapperTest::cleanupTestCase()
+{
+    removeDirectory( m_texture.sourceDir() );
+}
+
+QByteArray SphericalScanlineTextureMapperTest::scanLine( const QImage &image, int y )
+{
+    return QByteArray( reinterpret_cast<const char *>( image.scanLine( y ) ), image.bytesPerLine() );
+}
+
+void SphericalScanlineTextureMapperTest::removeDirectory( const QString &path )
+{
+    const QFileInfoList entries = QDir( path ).entryInfoList( QDir::AllEntries | QDir::NoDotAndDotDot );
+    foreach ( const QFileInfo &entry, entries ) {
+        if ( entry.isDir() ) {
+            removeDirectory( entry.absoluteFilePath() );
+        } else {
+            QFile::remove( entry.absoluteFilePath() );
+        }
+    }
+    QDir::root().rmdir( path );
+}
+
+void SphericalScanlineTextureMapperTest::chunkedMapping_data()
+{
+    QTest::addColumn<MapQuality>( "mapQuality" );
+    QTest::addColumn<QRect>( "dirtyRect" );
+
+    // The globe starts at scanline 49, so all dirty tops are odd
+    QTest::newRow( "low, whole globe" ) << LowQuality << QRect( 0, 0, 400, 400 );
+    QTest::newRow( "low, odd top" ) << LowQuality << QRect( 0, 51, 400, 200 );
+    QTest::newRow( "low, odd top and height" ) << LowQuality << QRect( 37, 77, 300, 101 );
+    QTest::newRow( "low, single scanline" ) << LowQuality << QRect( 0, 123, 400, 1 );
+    QTest::newRow( "high, whole globe" ) << HighQuality << QRect( 0, 0, 400, 400 );
+    QTest::newRow( "high, odd top" ) << HighQuality << QRect( 0, 51, 400, 200 );
+    QTest::newRow( "high, odd top and height" ) << HighQuality << QRect( 37, 77, 300, 101 );
+}
+
+void SphericalScanlineTextureMapperTest::chunkedMapping()
+{
+    QFETCH( MapQuality, mapQuality );
+    QFETCH( QRect, dirtyRect );
+
+    QVERIFY( SphericalScanlineTextureMapper::DefaultRowChunkSize % 2 == 0 );
+
+    ViewportParams viewport;
+    viewport.setProjection( Spherical );
+    viewport.setRadius( 151 );
+    viewport.setSize( QSize( 400, 400 ) );
+    viewport.centerOn( 20.0 * DEG2RAD, 30.0 * DEG2RAD );
+
+    QImage blank( viewport.size(), QImage::Format_ARGB32_Premultiplied );
+    blank.fill( 0 );
+
+    QImage chunked = blank.copy();
+    SphericalScanlineTextureMapper chunkedMapper;
+    chunkedMapper.mapTexture( &chunked, &m_stackedTileLoader, &viewport, maximumLevel, mapQuality, dirtyRect );
+
+    // a single chunk covers all scanlines, so a single job maps all of them
+    QImage singleJob = blank.copy();
+    SphericalScanlineTextureMapper singleJobMapper( 1 << 20 );
+    singleJobMapper.mapTexture( &singleJob, &m_stackedTileLoader, &viewport, maximumLevel, mapQuality, dirtyRect );
+
+    QVERIFY( chunked != blank );
+    QCOMPARE( chunked, singleJob );
+
+    const int yTop = qMax( viewport.height() / 2 - viewport.radius(), dirtyRect.top() );
+    QVERIFY( yTop % 2 == 1 );
+
+    // the scanlines outside of the dirty rect are left alone
+    for ( int y = 0; y < viewport.height(); ++y ) {
+        if ( y < yTop || y > dirtyRect.bottom() ) {
+            QCOMPARE( scanLine( chunked, y ), scanLine( blank, y ) );
+        }
+    }
+
+    // The interlaced scanlines get copied in pairs, starting at the top. The
+    // last scanline of the globe is skipped.
+    if ( mapQuality == LowQuality ) {
+        const int yBottom = qMin( viewport.height() / 2 + viewport.radius() - 1, dirtyRect.bottom() + 1 );
+        for ( int y = yTop; y + 1 < yBottom; y += 2 ) {
+            QCOMPARE( scanLine( chunked, y + 1 ), scanLine( chunked, y ) );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::SphericalScanlineTextureMapperTest )
+
+#include "SphericalScanlineTextureMapperTest.moc"
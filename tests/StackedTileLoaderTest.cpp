@@ -0,0 +1,411 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTime>
+#include <QtGui/QImage>
+#include <QtTest/QtTest>
+
+#include "GeoSceneTextureTile.h"
+#include "HttpDownloadManager.h"
+#include "MergedLayerDecorator.h"
+#include "StackedTile.h"
+#include "StackedTileLoader.h"
+#include "TileId.h"
+#include "TileLoader.h"
+
+namespace Marble
+{
+
+class TileLoadingJob : public QRunnable
+{
+ public:
+    TileLoadingJob( StackedTileLoader *loader, const QList<TileId> &ids ) :
+        m_loader( loader ),
+        m_ids( ids )
+    {
+        setAutoDelete( false );
+    }
+
+    virtual void run()
+    {
+        foreach ( const TileId &id, m_ids ) {
+            m_tiles << m_loader->loadTile( id );
+        }
+    }
+
+    StackedTileLoader *const m_loader;
+    const QList<TileId> m_ids;
+    QList<const StackedTile *> m_tiles;
+};
+
+class StackedTileLoaderTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    StackedTileLoaderTest();
+
+ public slots:
+    void recordLoadedTile( const TileId &id );
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void placeholders();
+    void integrateDecodedTiles();
+    void discardOlderGeneration();
+    void concurrentLoading();
+
+ private:
+    static const int maximumLevel = 2;
+    static const int tileSize = 16;
+
+    static QRgb tileColor( const TileId &id );
+    static QRgb colorOf( const StackedTile *tile );
+    bool waitForTileLoaded( const TileId &id );
+    static bool loadConcurrently( StackedTileLoader *loader, const QList<TileId> &ids, int threadCount );
+    static void removeDirectory( const QString &path );
+
+    GeoSceneTextureTile m_texture;
+    HttpDownloadManager m_downloadManager;
+    TileLoader m_tileLoader;
+    MergedLayerDecorator m_decorator;
+    QList<TileId> m_loadedTiles;
+};
+
+StackedTileLoaderTest::StackedTileLoaderTest() :
+    m_texture( "test" ),
+    m_downloadManager( 0 ),
+    m_tileLoader( &m_downloadManager, 0 ),
+    m_decorator( &m_tileLoader, 0 )
+{
+}
+
+void StackedTileLoaderTest::recordLoadedTile( const TileId &id )
+{
+    m_loadedTiles << id;
+}
+
+void StackedTileLoaderTest::initTestCase()
+{
+    // an absolute source dir keeps the tiles out of the marble data path
+    const QString sourceDir = QDir::tempPath() + QString( "/marble-stackedtileloadertest-%1" ).arg( QCoreApplication::applicationPid() );
+    removeDirectory( sourceDir );
+
+    m_texture.setSourceDir( sourceDir );
+    m_texture.setFileFormat( "PNG" );
+    m_texture.setLevelZeroColumns( 2 );
+    m_texture.setLevelZeroRows( 1 );
+    m_texture.setMaximumTileLevel( maximumLevel );
+    m_texture.setTileSize( QSize( tileSize, tileSize ) );
+
+    // each tile is filled with a color of its own
+    for ( int level = 0; level <= maximumLevel; ++level ) {
+        for ( int y = 0; y < 1 << level; ++y ) {
+            for ( int x = 0; x < 2 << level; ++x ) {
+                const TileId id( 0, level, x, y );
+                const QString fileName = m_texture.relativeTileFileName( id );
+                QDir::root().mkpath( QFileInfo( fileName ).path() );
+
+                QImage image( tileSize, tileSize, QImage::Format_RGB32 );
+                image.fill( tileColor( id ) );
+                QVERIFY( image.save( fileName, "PNG" ) );
+            }
+        }
+    }
+
+    m_decorator.setTextureLayers( QVector<const GeoSceneTextureTile *>() << &m_texture );
+}
+
+void StackedTileLoaderTest::cleanupTestCase()
+{
+    removeDirectory( m_texture.sourceDir() );
+}
+
+void StackedTileLoaderTest::init()
+{
+    m_loadedTiles.clear();
+}
+
+QRgb StackedTileLoaderTest::tileColor( const TileId &id )
+{
+    return qRgb( 40 + 80 * id.zoomLevel(), 20 * id.x(), 40 * id.y() );
+}
+
+QRgb StackedTileLoaderTest::colorOf( const StackedTile *tile )
+{
+    const QImage *const image = tile->resultImage();
+    const QRgb color = image->pixel( 0, 0 );
+
+    // placeholders are scaled from a single colored part, too
+    if ( image->pixel( tileSize - 1, tileSize - 1 ) != color ) {
+        return qRgba( 0, 0, 0, 0 );
+    }
+
+    return color;
+}
+
+bool StackedTileLoaderTest::waitForTileLoaded( const TileId &id )
+{
+    // the decoded tiles get integrated by the event loop
+    QTime timer;
+    timer.start();
+    while ( !m_loadedTiles.contains( id ) && timer.elapsed() < 5000 ) {
+        QTest::qWait( 10 );
+    }
+
+    return m_loadedTiles.contains( id );
+}
+
+bool StackedTileLoaderTest::loadConcurrently( StackedTileLoader *loader, const QList<TileId> &ids, int threadCount )
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount( threadCount );
+
+    // each thread requests all tiles, starting at a different one
+    QList<TileLoadingJob *> jobs;
+    for ( int i = 0; i < threadCount; ++i ) {
+        const int first = i * ids.size() / threadCount;
+        jobs << new TileLoadingJob( loader, ids.mid( first ) + ids.mid( 0, first ) );
+        pool.start( jobs.last() );
+    }
+    pool.waitForDone();
+
+    bool result = true;
+    foreach ( const TileLoadingJob *job, jobs ) {
+        for ( int i = 0; i < job->m_ids.size(); ++i ) {
+            const StackedTile *const tile = job->m_tiles.at( i );
+            if ( !( tile->id() == job->m_ids.at( i ) ) || colorOf( tile ) != tileColor( tile->id() ) ) {
+                qWarning() << "wrong tile returned for" << job->m_ids.at( i );
+                result = false;
+            }
+        }
+    }
+    qDeleteAll( jobs );
+
+    return result;
+}
+
+void StackedTileLoaderTest::removeDirectory( const QString &path )
+{
+    const QFileInfoList entries = QDir( path ).entryInfoList( QDir::AllEntries | QDir::NoDotAndDotDot );
+    foreach ( const QFileInfo &entry, entries ) {
+        if ( entry.isDir() ) {
+            removeDirectory( entry.absoluteFilePath() );
+        } else {
+            QFile::remove( entry.absoluteFilePath() );
+        }
+    }
+    QDir::root().rmdir( path );
+}
+
+void StackedTileLoaderTest::placeholders()
+{
+    StackedTileLoader loader( &m_decorator );
+    connect( &loader, SIGNAL(tileLoaded(TileId)), SLOT(recordLoadedTile(TileId)) );
+    loader.setAsynchronousLoading( true );
+
+    // without a resident ancestor, the tile gets loaded right away
+    const TileId base( 0, 0, 0, 0 );
+    const StackedTile *tile = loader.loadTile( base );
+    QCOMPARE( tile->id(), base );
+    QCOMPARE( colorOf( tile ), tileColor( base ) );
+    QCOMPARE( m_loadedTiles, QList<TileId>() << base );
+    QCOMPARE( loader.tileLoads(), 1 );
+
+    const TileId orphan( 0, 1, 2, 0 );
+    tile = loader.loadTile( orphan );
+    QCOMPARE( colorOf( tile ), tileColor( orphan ) );
+    QCOMPARE( loader.tileLoads(), 2 );
+
+    // otherwise the matching part of the ancestor gets scaled up, even
+    // several levels down
+    const TileId child( 0, 1, 1, 0 );
+    const TileId grandChild( 0, 2, 2, 1 );
+    const StackedTile *const placeholder = loader.loadTile( child );
+    QCOMPARE( placeholder->id(), child );
+    QCOMPARE( colorOf( placeholder ), tileColor( base ) );
+    QCOMPARE( colorOf( loader.loadTile( grandChild ) ), tileColor( base ) );
+
+    // a placeholder gets returned until the decoded tile replaces it
+    QCOMPARE( loader.loadTile( child ), placeholder );
+    QCOMPARE( m_loadedTiles.size(), 2 );
+
+    QVERIFY( waitForTileLoaded( child ) );
+    QVERIFY( waitForTileLoaded( grandChild ) );
+    QCOMPARE( colorOf( loader.loadTile( child ) ), tileColor( child ) );
+    QCOMPARE( colorOf( loader.loadTile( grandChild ) ), tileColor( grandChild ) );
+    QCOMPARE( loader.tileLoads(), 4 );
+    QCOMPARE( loader.visibleTiles().size(), 4 );
+}
+
+void StackedTileLoaderTest::integrateDecodedTiles()
+{
+    StackedTileLoader loader( &m_decorator );
+    connect( &loader, SIGNAL(tileLoaded(TileId)), SLOT(recordLoadedTile(TileId)) );
+    loader.setAsynchronousLoading( true );
+
+    const TileId base( 0, 0, 1, 0 );
+    loader.loadTile( base );
+
+    // The placeholder may get evicted from the display before the decoded
+    // tile arrives, which then goes to the cache
+    const TileId evicted( 0, 1, 3, 1 );
+    QCOMPARE( colorOf( loader.loadTile( evicted ) ), tileColor( base ) );
+    loader.resetTilehash();
+    loader.loadTile( base );
+    loader.cleanupTilehash();
+    QCOMPARE( loader.visibleTiles(), QList<TileId>() << base );
+
+    QVERIFY( waitForTileLoaded( evicted ) );
+    QCOMPARE( loader.visibleTiles(), QList<TileId>() << base );
+    QCOMPARE( loader.tileCount(), 2 );
+    loader.resetStatistics();
+    QCOMPARE( colorOf( loader.loadTile( evicted ) ), tileColor( evicted ) );
+    QCOMPARE( loader.cacheHits(), 1 );
+    QCOMPARE( loader.tileLoads(), 0 );
+
+    // a texture tile updated during the decoding gets decoded once more
+    const TileId updated( 0, 1, 2, 0 );
+    m_loadedTiles.clear();
+    QCOMPARE( colorOf( loader.loadTile( updated ) ), tileColor( base ) );
+    QImage image( tileSize, tileSize, QImage::Format_RGB32 );
+    image.fill( tileColor( updated ) );
+    loader.updateTile( TileId( m_texture.sourceDir(), 1, 2, 0 ), image );
+
+    QVERIFY( waitForTileLoaded( updated ) );
+    QCOMPARE( m_loadedTiles, QList<TileId>() << updated );
+    QCOMPARE( colorOf( loader.loadTile( updated ) ), tileColor( updated ) );
+    QCOMPARE( loader.tileLoads(), 2 );
+}
+
+void StackedTileLoaderTest::discardOlderGeneration()
+{
+    StackedTileLoader loader( &m_decorator );
+    connect( &loader, SIGNAL(tileLoaded(TileId)), SLOT(recordLoadedTile(TileId)) );
+    loader.setAsynchronousLoading( true );
+
+    const TileId base( 0, 0, 0, 0 );
+    loader.loadTile( base );
+
+    QList<TileId> pending;
+    for ( int y = 0; y < 2; ++y ) {
+        for ( int x = 0; x < 2; ++x ) {
+            pending << TileId( 0, 1, x, y );
+            loader.loadTile( pending.last() );
+        }
+    }
+
+    // the tiles decoded before clearing must not show up afterwards
+    loader.clear();
+    QCOMPARE( loader.tileCount(), 0 );
+    QTest::qWait( 100 );
+
+    QCOMPARE( m_loadedTiles, QList<TileId>() << base );
+    QCOMPARE( loader.tileCount(), 0 );
+    QVERIFY( loader.visibleTiles().isEmpty() );
+
+    // the same tiles load fine once more
+    loader.loadTile( base );
+    foreach ( const TileId &id, pending ) {
+        QCOMPARE( colorOf( loader.loadTile( id ) ), tileColor( base ) );
+    }
+    foreach ( const TileId &id, pending ) {
+        QVERIFY( waitForTileLoaded( id ) );
+        QCOMPARE( colorOf( loader.loadTile( id ) ), tileColor( id ) );
+    }
+}
+
+void StackedTileLoaderTest::concurrentLoading()
+{
+    StackedTileLoader loader( &m_decorator );
+
+    QList<TileId> ids;
+    for ( int y = 0; y < 1 << maximumLevel; ++y ) {
+        for ( int x = 0; x < 2 << maximumLevel; ++x ) {
+            ids << TileId( 0, maximumLevel, x, y );
+        }
+    }
+
+    const int threadCount = 8;
+    const int requests = threadCount * ids.size();
+
+    // Each request is either a hit or a miss. Threads racing for the same
+    // tile may all load it, but only one of them gets displayed.
+    QVERIFY( loadConcurrently( &loader, ids, threadCount ) );
+    QCOMPARE( loader.cacheHits() + loader.cacheMisses(), requests );
+    QCOMPARE( loader.tileLoads(), loader.cacheMisses() );
+    QVERIFY( loader.tileLoads() >= ids.size() );
+    // the shard lock gets taken at most three times per request
+    QVERIFY( loader.lockContentions() <= 3 * requests );
+    QCOMPARE( loader.visibleTiles().size(), ids.size() );
+    QCOMPARE( loader.tileCount(), ids.size() );
+
+    loader.resetStatistics();
+    QCOMPARE( loader.cacheHits(), 0 );
+    QCOMPARE( loader.cacheMisses(), 0 );
+    QCOMPARE( loader.lockContentions(), 0 );
+    QCOMPARE( loader.tileLoads(), 0 );
+
+    // displayed tiles are found in their shards
+    QVERIFY( loadConcurrently( &loader, ids, threadCount ) );
+    QCOMPARE( loader.cacheHits(), requests );
+    QCOMPARE( loader.cacheMisses(), 0 );
+    QCOMPARE( loader.tileLoads(), 0 );
+
+    // hidden tiles move to the global cache and back to their shards once requested again
+    loader.resetTilehash();
+    loader.cleanupTilehash();
+    QVERIFY( loader.visibleTiles().isEmpty() );
+    QCOMPARE( loader.tileCount(), ids.size() );
+
+    loader.resetStatistics();
+    QVERIFY( loadConcurrently( &loader, ids, threadCount ) );
+    QCOMPARE( loader.cacheHits(), requests );
+    QCOMPARE( loader.cacheMisses(), 0 );
+    QCOMPARE( loader.tileLoads(), 0 );
+    QCOMPARE( loader.visibleTiles().size(), ids.size() );
+    QCOMPARE( loader.tileCount(), ids.size() );
+
+    // The cache evicts tiles as soon as their bytes exceed its limit. All
+    // tiles are of the same size, so a single thread tells exactly which
+    // ones are left.
+    const int tileBytes = loader.loadTile( ids.first() )->numBytes();
+    const int cacheLimit = 8; // kilobytes
+    const int cachedCount = cacheLimit * 1024 / tileBytes;
+    QVERIFY( cachedCount > 0 );
+    QVERIFY( cachedCount < ids.size() );
+
+    loader.setVolatileCacheLimit( cacheLimit );
+    loader.resetTilehash();
+    loader.cleanupTilehash();
+    QCOMPARE( loader.tileCount(), cachedCount );
+
+    loader.resetStatistics();
+    QVERIFY( loadConcurrently( &loader, ids, 1 ) );
+    QCOMPARE( loader.cacheHits(), cachedCount );
+    QCOMPARE( loader.cacheMisses(), ids.size() - cachedCount );
+    QCOMPARE( loader.tileLoads(), ids.size() - cachedCount );
+    QCOMPARE( loader.visibleTiles().size(), ids.size() );
+}
+
+}
+
+QTEST_MAIN( Marble::StackedTileLoaderTest )
+
+#include "StackedTileLoaderTest.moc"
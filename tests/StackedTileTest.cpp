@@ -0,0 +1,142 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtGui/QImage>
+#include <QtTest/QtTest>
+
+#include "StackedTile.h"
+#include "TextureTile.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class StackedTileTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void pixelsF_data();
+    void pixelsF();
+
+ private:
+    static QImage randomImage( QImage::Format format, bool grayscale = false );
+};
+
+QImage StackedTileTest::randomImage( QImage::Format format, bool grayscale )
+{
+    qsrand( 42 );
+
+    QImage image( 16, 12, format );
+
+    if ( format == QImage::Format_Indexed8 ) {
+        QVector<QRgb> colorTable;
+        for ( int i = 0; i < 256; ++i ) {
+            colorTable << ( grayscale ? qRgb( i, i, i ) : qRgb( qrand() % 256, qrand() % 256, qrand() % 256 ) );
+        }
+        image.setColorTable( colorTable );
+    }
+
+    for ( int y = 0; y < image.height(); ++y ) {
+        for ( int x = 0; x < image.width(); ++x ) {
+            if ( format == QImage::Format_Indexed8 ) {
+                image.setPixel( x, y, qrand() % 256 );
+            } else {
+                image.setPixel( x, y, qRgb( qrand() % 256, qrand() % 256, qrand() % 256 ) );
+            }
+        }
+    }
+
+    return image;
+}
+
+void StackedTileTest::pixelsF_data()
+{
+    QTest::addColumn<QImage>( "image" );
+    QTest::addColumn<qreal>( "x" );
+    QTest::addColumn<qreal>( "y" );
+    QTest::addColumn<qreal>( "stepX" );
+    QTest::addColumn<qreal>( "stepY" );
+    QTest::addColumn<int>( "n" );
+
+    QList<QPair<QString, QImage> > images;
+    images << qMakePair( QString( "RGB32" ), randomImage( QImage::Format_RGB32 ) );
+    images << qMakePair( QString( "ARGB32" ), randomImage( QImage::Format_ARGB32_Premultiplied ) );
+    images << qMakePair( QString( "Indexed8" ), randomImage( QImage::Format_Indexed8 ) );
+    images << qMakePair( QString( "Grayscale8" ), randomImage( QImage::Format_Indexed8, true ) );
+
+    // The steps are multiples of 1/256, such that pixelsF() samples exactly
+    // the same positions as pixelF() does.
+    for ( int i = 0; i < images.size(); ++i ) {
+        const QString name = images.at( i ).first;
+        const QImage image = images.at( i ).second;
+
+        QTest::newRow( QString( "%1 horizontal" ).arg( name ).toLatin1() )
+            << image << 0.3 << 4.7 << 0.75 << 0.0 << 19;
+        QTest::newRow( QString( "%1 diagonal" ).arg( name ).toLatin1() )
+            << image << 1.1 << 0.2 << 0.5 << 0.4375 << 24;
+        QTest::newRow( QString( "%1 backwards" ).arg( name ).toLatin1() )
+            << image << 15.9 << 11.6 << -0.625 << -0.375 << 25;
+        QTest::newRow( QString( "%1 right edge" ).arg( name ).toLatin1() )
+            << image << 13.2 << 0.6 << 0.25 << 0.5 << 11;
+        QTest::newRow( QString( "%1 bottom edge" ).arg( name ).toLatin1() )
+            << image << 0.0 << 11.0 << 0.9375 << 0.0 << 17;
+        QTest::newRow( QString( "%1 bottom right corner" ).arg( name ).toLatin1() )
+            << image << 14.0 << 10.0 << 0.5 << 0.5 << 4;
+        QTest::newRow( QString( "%1 single pixel" ).arg( name ).toLatin1() )
+            << image << 7.5 << 3.5 << 1.0 << 1.0 << 1;
+    }
+}
+
+void StackedTileTest::pixelsF()
+{
+    QFETCH( QImage, image );
+    QFETCH( qreal, x );
+    QFETCH( qreal, y );
+    QFETCH( qreal, stepX );
+    QFETCH( qreal, stepY );
+    QFETCH( int, n );
+
+    const TileId id( 0, 0, 0, 0 );
+    QVector<QSharedPointer<TextureTile> > tiles;
+    tiles << QSharedPointer<TextureTile>( new TextureTile( id, image, 0 ) );
+    const StackedTile tile( id, image, tiles );
+
+    QVector<QRgb> span( n + 1, 0xdeadbeef );
+    tile.pixelsF( x, y, stepX, stepY, span.data(), n );
+
+    // nothing is written beyond the span
+    QCOMPARE( span.at( n ), QRgb( 0xdeadbeef ) );
+
+    for ( int i = 0; i < n; ++i ) {
+        // the fixed point arithmetic rounds the start position down to 1/256
+        const qreal posX = qFloor( ( x + i * stepX ) * 256.0 ) / 256.0;
+        const qreal posY = qFloor( ( y + i * stepY ) * 256.0 ) / 256.0;
+        const QRgb expected = tile.pixelF( posX, posY );
+        const QRgb actual = span.at( i );
+
+        // pixelF() and pixelsF() round differently
+        const int tolerance = 2;
+        if ( qAbs( qRed( actual ) - qRed( expected ) ) > tolerance
+             || qAbs( qGreen( actual ) - qGreen( expected ) ) > tolerance
+             || qAbs( qBlue( actual ) - qBlue( expected ) ) > tolerance ) {
+            QFAIL( QString( "pixel %1 at (%2, %3): expected %4, got %5" )
+                   .arg( i ).arg( posX ).arg( posY )
+                   .arg( expected & 0xffffff, 6, 16, QChar( '0' ) )
+                   .arg( actual & 0xffffff, 6, 16, QChar( '0' ) ).toLatin1() );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::StackedTileTest )
+
+#include "StackedTileTest.moc"
@@ -0,0 +1,216 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QObject>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtTest/QtTest>
+
+#include "DocumentCache.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPolygon.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTrack.h"
+#include "GeoDataTypes.h"
+#include "MarbleDebug.h"
+#include "TestUtils.h"
+
+using namespace Marble;
+
+class TestDocumentCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void roundTripTest();
+    void outdatedTest();
+    void notCacheableTest();
+    void latLonBoxOnlyTest();
+
+private:
+    void writeSource( const QString &content );
+
+    QString m_sourceFile;
+    QString m_cacheDirectory;
+};
+
+static const QString documentContent(
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+" xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+"<Document>"
+"  <name>Cached</name>"
+"  <Style id=\"red\"><PolyStyle><color>ff0000ff</color></PolyStyle></Style>"
+"  <Folder>"
+"    <name>Areas</name>"
+"    <Placemark>"
+"      <name>Area</name>"
+"      <styleUrl>#red</styleUrl>"
+"      <ExtendedData><Data name=\"key\"><value>value</value></Data></ExtendedData>"
+"      <Polygon>"
+"        <outerBoundaryIs><LinearRing><coordinates>0,0 10,0 10,10 0,10 0,0</coordinates></LinearRing></outerBoundaryIs>"
+"        <innerBoundaryIs><LinearRing><coordinates>2,2 4,2 4,4 2,2</coordinates></LinearRing></innerBoundaryIs>"
+"      </Polygon>"
+"    </Placemark>"
+"  </Folder>"
+"  <Placemark>"
+"    <name>Line</name>"
+"    <Style><LineStyle><width>3</width></LineStyle></Style>"
+"    <LineString><coordinates>1,2,3 4,5,6</coordinates></LineString>"
+"  </Placemark>"
+"  <Placemark>"
+"    <gx:Track>"
+"      <when>2010-05-28T02:02:09Z</when>"
+"      <gx:coord>-122.207881 37.371915 156.000000</gx:coord>"
+"    </gx:Track>"
+"  </Placemark>"
+"</Document>"
+"</kml>" );
+
+void TestDocumentCache::initTestCase()
+{
+    MarbleDebug::enable = true;
+
+    m_sourceFile = QDir::tempPath() + "/TestDocumentCache.kml";
+    m_cacheDirectory = QDir::tempPath() + "/TestDocumentCache";
+}
+
+void TestDocumentCache::cleanupTestCase()
+{
+    const DocumentCache cache( m_cacheDirectory );
+    QFile::remove( cache.cacheFile( m_sourceFile ) );
+    QDir::root().rmdir( m_cacheDirectory );
+    QFile::remove( m_sourceFile );
+}
+
+void TestDocumentCache::writeSource( const QString &content )
+{
+    QFile file( m_sourceFile );
+    QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    file.write( content.toUtf8() );
+}
+
+void TestDocumentCache::roundTripTest()
+{
+    writeSource( documentContent );
+
+    GeoDataDocument *parsed = parseKml( documentContent );
+    QVERIFY( DocumentCache::isCacheable( m_sourceFile ) );
+    QVERIFY( DocumentCache::isCacheable( parsed ) );
+
+    const DocumentCache cache( m_cacheDirectory );
+    QVERIFY( cache.save( m_sourceFile, DocumentCache::pack( m_sourceFile, parsed ) ) );
+    delete parsed;
+
+    const GeoDataLatLonBox bounds = cache.latLonBox( m_sourceFile );
+    QVERIFY( bounds.contains( GeoDataCoordinates( 5, 5, 0, GeoDataCoordinates::Degree ) ) );
+    QVERIFY( bounds.contains( GeoDataCoordinates( -120, 30, 0, GeoDataCoordinates::Degree ) ) );
+    QVERIFY( !bounds.contains( GeoDataCoordinates( 20, 5, 0, GeoDataCoordinates::Degree ) ) );
+
+    GeoDataDocument *document = cache.load( m_sourceFile );
+    QVERIFY( document );
+    QCOMPARE( document->name(), QString( "Cached" ) );
+    QCOMPARE( document->size(), 3 );
+    QCOMPARE( document->style( "red" ).polyStyle().color(), QColor( Qt::red ) );
+
+    QCOMPARE( document->folderList().size(), 1 );
+    GeoDataFolder *folder = document->folderList().at( 0 );
+    QVERIFY( folder->parent() == document );
+    QCOMPARE( folder->placemarkList().size(), 1 );
+
+    GeoDataPlacemark *area = folder->placemarkList().at( 0 );
+    QVERIFY( area->parent() == folder );
+    QCOMPARE( area->styleUrl(), QString( "#red" ) );
+    QVERIFY( area->style() == &document->style( "red" ) );
+    QCOMPARE( area->extendedData().value( "key" ).value().toString(), QString( "value" ) );
+    QCOMPARE( area->geometry()->nodeType(), GeoDataTypes::GeoDataPolygonType );
+    QVERIFY( area->geometry()->parent() == area );
+    const GeoDataPolygon *polygon = static_cast<const GeoDataPolygon*>( area->geometry() );
+    QCOMPARE( polygon->outerBoundary().size(), 5 );
+    QCOMPARE( polygon->innerBoundaries().size(), 1 );
+    QCOMPARE( polygon->innerBoundaries().at( 0 ).size(), 4 );
+
+    GeoDataPlacemark *line = document->placemarkList().at( 0 );
+    QCOMPARE( line->name(), QString( "Line" ) );
+    QCOMPARE( line->style()->lineStyle().width(), float( 3 ) );
+    QCOMPARE( line->geometry()->nodeType(), GeoDataTypes::GeoDataLineStringType );
+    const GeoDataLineString *lineString = static_cast<const GeoDataLineString*>( line->geometry() );
+    QCOMPARE( lineString->size(), 2 );
+    QCOMPARE( lineString->at( 1 ).longitude( GeoDataCoordinates::Degree ), 4.0 );
+    QCOMPARE( lineString->at( 1 ).latitude( GeoDataCoordinates::Degree ), 5.0 );
+    QCOMPARE( lineString->at( 1 ).altitude(), 6.0 );
+
+    GeoDataPlacemark *track = document->placemarkList().at( 1 );
+    QCOMPARE( track->geometry()->nodeType(), GeoDataTypes::GeoDataTrackType );
+    const GeoDataTrack *geoDataTrack = static_cast<const GeoDataTrack*>( track->geometry() );
+    QCOMPARE( geoDataTrack->size(), 1 );
+    QCOMPARE( geoDataTrack->whenList().at( 0 ), QDateTime( QDate( 2010, 5, 28 ), QTime( 2, 2, 9 ), Qt::UTC ) );
+    QCOMPARE( geoDataTrack->coordinatesList().at( 0 ).altitude(), 156.0 );
+
+    delete document;
+}
+
+void TestDocumentCache::outdatedTest()
+{
+    writeSource( documentContent );
+
+    GeoDataDocument *parsed = parseKml( documentContent );
+    const DocumentCache cache( m_cacheDirectory );
+    QVERIFY( cache.save( m_sourceFile, DocumentCache::pack( m_sourceFile, parsed ) ) );
+    delete parsed;
+
+    writeSource( documentContent + '\n' );
+    QVERIFY( cache.load( m_sourceFile ) == 0 );
+    QVERIFY( cache.latLonBox( m_sourceFile ).isEmpty() );
+}
+
+void TestDocumentCache::notCacheableTest()
+{
+    QVERIFY( !DocumentCache::isCacheable( QString( "test.kmz" ) ) );
+    QVERIFY( !DocumentCache::isCacheable( QString( "test.png" ) ) );
+
+    const QString content(
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+"<Document>"
+"  <ScreenOverlay><name>Overlay</name></ScreenOverlay>"
+"</Document>"
+"</kml>" );
+
+    GeoDataDocument *document = parseKml( content );
+    QCOMPARE( document->size(), 1 );
+    QVERIFY( !DocumentCache::isCacheable( document ) );
+    QVERIFY( DocumentCache::pack( m_sourceFile, document ).isEmpty() );
+    delete document;
+}
+
+void TestDocumentCache::latLonBoxOnlyTest()
+{
+    writeSource( documentContent );
+
+    GeoDataDocument *parsed = parseKml( documentContent );
+    const DocumentCache cache( m_cacheDirectory );
+    QVERIFY( cache.save( m_sourceFile, DocumentCache::packLatLonBox( m_sourceFile, parsed ) ) );
+    delete parsed;
+
+    QVERIFY( cache.load( m_sourceFile ) == 0 );
+    const GeoDataLatLonBox bounds = cache.latLonBox( m_sourceFile );
+    QVERIFY( bounds.contains( GeoDataCoordinates( 5, 5, 0, GeoDataCoordinates::Degree ) ) );
+    QVERIFY( !bounds.contains( GeoDataCoordinates( 20, 5, 0, GeoDataCoordinates::Degree ) ) );
+}
+
+QTEST_MAIN( TestDocumentCache )
+
+#include "TestDocumentCache.moc"
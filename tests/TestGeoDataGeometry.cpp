@@ -26,6 +26,9 @@ private slots:
     void deleteAndDetachTest1();
     void deleteAndDetachTest2();
     void deleteAndDetachTest3();
+    void compactStorageTest();
+    void ringContainsTest();
+    void ringContainsLongEdgesTest();
 };
 
 void TestGeoDataGeometry::downcastPointTest_data()
@@ -85,6 +88,114 @@ void TestGeoDataGeometry::deleteAndDetachTest3()
     line2 << GeoDataCoordinates();
 }
 
+void TestGeoDataGeometry::compactStorageTest()
+{
+    GeoDataLinearRing ring;
+    ring.setCompactStorage( true );
+    ring << GeoDataCoordinates( 0.1, 0.2, 10.0, GeoDataCoordinates::Radian, 3 )
+         << GeoDataCoordinates( 0.4, 0.2, 20.0 )
+         << GeoDataCoordinates( 0.4, 0.5, 30.0 );
+
+    QVERIFY( ring.hasCompactStorage() );
+    QCOMPARE( ring.size(), 3 );
+    QCOMPARE( ring.longitudes()[1], 0.4 );
+    QCOMPARE( ring.latitudes()[2], 0.5 );
+    QCOMPARE( ring.altitudes()[0], 10.0 );
+    QCOMPARE( ring.details()[0], 3 );
+
+    // the flat arrays of other line strings are built from their nodes
+    GeoDataLineString line;
+    line << GeoDataCoordinates( 0.1, 0.2, 10.0 ) << GeoDataCoordinates( 0.4, 0.2, 20.0 );
+    QCOMPARE( line.longitudes(), QVector<qreal>() << 0.1 << 0.4 );
+    QCOMPARE( line.altitudes(), QVector<qreal>() << 10.0 << 20.0 );
+    QVERIFY( !line.hasCompactStorage() );
+
+    QVERIFY( ring.contains( GeoDataCoordinates( 0.35, 0.25 ) ) );
+    QVERIFY( !ring.contains( GeoDataCoordinates( 0.15, 0.45 ) ) );
+    QCOMPARE( ring.latLonAltBox().west(), 0.1 );
+    QCOMPARE( ring.latLonAltBox().maxAltitude(), 30.0 );
+    QVERIFY( ring.hasCompactStorage() );
+
+    // const access neither leaves the compact storage nor goes stale
+    const GeoDataLinearRing &constRing = ring;
+    QCOMPARE( constRing.coordinatesAt( 1 ).longitude(), 0.4 );
+    QCOMPARE( constRing.at( 1 ).longitude(), 0.4 );
+    QCOMPARE( constRing.last().altitude(), 30.0 );
+    QCOMPARE( int( constRing.constEnd() - constRing.constBegin() ), 3 );
+    QVERIFY( ring.hasCompactStorage() );
+    ring << GeoDataCoordinates( 0.1, 0.5 );
+    QCOMPARE( constRing.last().latitude(), 0.5 );
+    QCOMPARE( constRing.size(), 4 );
+    QVERIFY( ring.hasCompactStorage() );
+
+    // a copy keeps the compact nodes until it is modified through references
+    GeoDataLinearRing copy = ring;
+    QCOMPARE( copy.at( 2 ).latitude(), 0.5 );
+    QVERIFY( !copy.hasCompactStorage() );
+    copy[0].setLongitude( 0.2 );
+    QCOMPARE( copy.longitudes()[0], 0.2 );
+    QCOMPARE( ring.longitudes()[0], 0.1 );
+    QVERIFY( ring.hasCompactStorage() );
+
+    ring.clear();
+    QVERIFY( ring.isEmpty() );
+}
+
+void TestGeoDataGeometry::ringContainsTest()
+{
+    // A comb with 20 teeth, large enough to get its edges indexed
+    GeoDataLinearRing ring;
+    ring << GeoDataCoordinates( 0.0, 0.0 ) << GeoDataCoordinates( 0.4, 0.0 ) << GeoDataCoordinates( 0.4, 0.1 );
+    for ( int k = 19; k >= 0; --k ) {
+        ring << GeoDataCoordinates( ( 2 * k + 1 ) * 0.01, 0.1 )
+             << GeoDataCoordinates( ( 2 * k + 1 ) * 0.01, 0.5 )
+             << GeoDataCoordinates( 2 * k * 0.01, 0.5 )
+             << GeoDataCoordinates( 2 * k * 0.01, 0.1 );
+    }
+
+    // Repeated queries use the index
+    for ( int pass = 0; pass < 3; ++pass ) {
+        for ( int k = 0; k < 20; ++k ) {
+            QVERIFY( ring.contains( GeoDataCoordinates( ( 2 * k + 0.5 ) * 0.01, 0.3 ) ) );
+            QVERIFY( !ring.contains( GeoDataCoordinates( ( 2 * k + 1.5 ) * 0.01, 0.3 ) ) );
+            QVERIFY( ring.contains( GeoDataCoordinates( ( 2 * k + 1.5 ) * 0.01, 0.05 ) ) );
+            QVERIFY( !ring.contains( GeoDataCoordinates( ( 2 * k + 0.5 ) * 0.01, 0.6 ) ) );
+        }
+    }
+
+    // Shorten the last tooth, which must update the index
+    ring[4].setLatitude( 0.2 );
+    ring[5].setLatitude( 0.2 );
+    QVERIFY( !ring.contains( GeoDataCoordinates( 0.385, 0.3 ) ) );
+    QVERIFY( ring.contains( GeoDataCoordinates( 0.385, 0.15 ) ) );
+    QVERIFY( ring.contains( GeoDataCoordinates( 0.365, 0.3 ) ) );
+}
+
+void TestGeoDataGeometry::ringContainsLongEdgesTest()
+{
+    // A comb with 32 horizontal teeth, whose edges span most of the ring's
+    // longitudes and are too many to be indexed
+    const qreal step = 0.01;
+    GeoDataLinearRing ring;
+    ring << GeoDataCoordinates( 0.0, 0.0 ) << GeoDataCoordinates( 1.0, 0.0 );
+    for ( int k = 0; k < 32; ++k ) {
+        ring << GeoDataCoordinates( 1.0, ( 2 * k + 1 ) * step )
+             << GeoDataCoordinates( 0.1, ( 2 * k + 1 ) * step )
+             << GeoDataCoordinates( 0.1, ( 2 * k + 2 ) * step )
+             << GeoDataCoordinates( 1.0, ( 2 * k + 2 ) * step );
+    }
+    ring << GeoDataCoordinates( 0.0, 64 * step );
+
+    // The first queries scan linearly, the later ones fall back to it
+    for ( int pass = 0; pass < 3; ++pass ) {
+        for ( int k = 0; k < 32; ++k ) {
+            QVERIFY( ring.contains( GeoDataCoordinates( 0.5, ( 2 * k + 0.5 ) * step ) ) );
+            QVERIFY( !ring.contains( GeoDataCoordinates( 0.5, ( 2 * k + 1.5 ) * step ) ) );
+            QVERIFY( ring.contains( GeoDataCoordinates( 0.05, ( 2 * k + 1.5 ) * step ) ) );
+        }
+    }
+}
+
 QTEST_MAIN( TestGeoDataGeometry )
 #include "TestGeoDataGeometry.moc"
 
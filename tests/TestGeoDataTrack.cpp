@@ -36,6 +36,8 @@ private slots:
     void removeAfterTest();
     void extendedDataParseTest();
     void withoutTimeTest();
+    void interpolateTest();
+    void coordinatesAtListTest();
 };
 
 void TestGeoDataTrack::initTestCase()
@@ -319,6 +321,69 @@ void TestGeoDataTrack::withoutTimeTest()
     delete dataDocument;
 }
 
+void TestGeoDataTrack::interpolateTest()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 0, 0 ), Qt::UTC );
+
+    GeoDataTrack track;
+    // inserted out of order on purpose
+    track.addPoint( start.addSecs( 20 ), GeoDataCoordinates( 20.0, 0.0, 200.0, GeoDataCoordinates::Degree ) );
+    track.addPoint( start, GeoDataCoordinates( 0.0, 0.0, 0.0, GeoDataCoordinates::Degree ) );
+    track.addPoint( start.addSecs( 10 ), GeoDataCoordinates( 10.0, 0.0, 100.0, GeoDataCoordinates::Degree ) );
+    QCOMPARE( track.size(), 3 );
+    QCOMPARE( track.firstWhen(), start );
+    QCOMPARE( track.lastWhen(), start.addSecs( 20 ) );
+
+    QVERIFY( !track.coordinatesAt( start.addSecs( 5 ) ).isValid() );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 10 ) ).longitude( GeoDataCoordinates::Degree ), 10.0 );
+
+    track.setInterpolate( true );
+    {
+        const GeoDataCoordinates coord = track.coordinatesAt( start.addSecs( 15 ) );
+        QVERIFY( coord.isValid() );
+        QFUZZYCOMPARE( coord.longitude( GeoDataCoordinates::Degree ), 15.0, 0.0001 );
+        QFUZZYCOMPARE( coord.latitude( GeoDataCoordinates::Degree ), 0.0, 0.0001 );
+        QFUZZYCOMPARE( coord.altitude(), 150.0, 0.0001 );
+    }
+
+    QVERIFY( !track.coordinatesAt( start.addSecs( -1 ) ).isValid() );
+    QVERIFY( !track.coordinatesAt( start.addSecs( 21 ) ).isValid() );
+
+    track.removeBefore( start.addSecs( 10 ) );
+    QVERIFY( !track.coordinatesAt( start.addSecs( 5 ) ).isValid() );
+    QFUZZYCOMPARE( track.coordinatesAt( start.addSecs( 15 ) ).longitude( GeoDataCoordinates::Degree ), 15.0, 0.0001 );
+}
+
+void TestGeoDataTrack::coordinatesAtListTest()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 0, 0 ), Qt::UTC );
+
+    GeoDataTrack track;
+    track.setInterpolate( true );
+    for ( int i = 0; i < 100; ++i ) {
+        track.addPoint( start.addSecs( 10 * i ), GeoDataCoordinates( 0.1 * i, 0.05 * i, 10.0 * i, GeoDataCoordinates::Degree ) );
+    }
+
+    // ascending samples with small and large steps, then a jump back
+    QVector<QDateTime> when;
+    when << start.addSecs( -5 );
+    for ( int i = 0; i < 990; i += 3 ) {
+        when << start.addSecs( i );
+    }
+    when << start.addSecs( 500 ) << start.addSecs( 991 ) << start.addSecs( 12 ) << QDateTime();
+
+    const QVector<GeoDataCoordinates> coordinates = track.coordinatesAt( when );
+    QCOMPARE( coordinates.size(), when.size() );
+
+    for ( int i = 0; i < when.size(); ++i ) {
+        const GeoDataCoordinates expected = track.coordinatesAt( when.at( i ) );
+        QCOMPARE( coordinates.at( i ).isValid(), expected.isValid() );
+        if ( expected.isValid() ) {
+            QCOMPARE( coordinates.at( i ), expected );
+        }
+    }
+}
+
 QTEST_MAIN( TestGeoDataTrack )
 
 #include "TestGeoDataTrack.moc"
@@ -0,0 +1,125 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+#include <GeoDataParser.h>
+#include <GeoDataDocument.h>
+#include <GeoDataPlacemark.h>
+#include <GeoDataLineString.h>
+#include <GeoDataPoint.h>
+#include <GeoDataTrack.h>
+#include <MarbleDebug.h>
+#include "TestUtils.h"
+
+using namespace Marble;
+
+class TestKmlCoordinates : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void lineStringTest_data();
+    void lineStringTest();
+    void pointTest();
+    void trackTest();
+};
+
+static QString placemarkContent( const QString &geometry )
+{
+    return QString( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                    "<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+                    " xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+                    "<Document><Placemark>%1</Placemark></Document>"
+                    "</kml>" ).arg( geometry );
+}
+
+void TestKmlCoordinates::initTestCase()
+{
+    MarbleDebug::enable = true;
+}
+
+void TestKmlCoordinates::lineStringTest_data()
+{
+    QTest::addColumn<QString>( "coordinates" );
+
+    QTest::newRow( "tuples" ) << "8.5,49.25,100 -122.207881,37.371915,156";
+    QTest::newRow( "no altitude" ) << "8.5,49.25 -122.207881,37.371915,156";
+    QTest::newRow( "line breaks" ) << "\n\t8.5,49.25,100\n\t-122.207881,37.371915,156\n";
+    QTest::newRow( "spaces around commas" ) << "8.5 , 49.25, 100  -122.207881 ,37.371915 ,156 ";
+    QTest::newRow( "exponent" ) << "85e-1,4.925E1,1e2 -122.207881,37.371915,156";
+}
+
+void TestKmlCoordinates::lineStringTest()
+{
+    QFETCH( QString, coordinates );
+
+    const QString content = placemarkContent( QString( "<LineString><coordinates>%1</coordinates></LineString>" ).arg( coordinates ) );
+    GeoDataDocument* dataDocument = parseKml( content );
+    QCOMPARE( dataDocument->placemarkList().size(), 1 );
+    GeoDataPlacemark* placemark = dataDocument->placemarkList().at( 0 );
+    QCOMPARE( placemark->geometry()->geometryId(), GeoDataLineStringId );
+    const GeoDataLineString* lineString = static_cast<const GeoDataLineString*>( placemark->geometry() );
+    QCOMPARE( lineString->size(), 2 );
+
+    QCOMPARE( lineString->at( 0 ).longitude( GeoDataCoordinates::Degree ), 8.5 );
+    QCOMPARE( lineString->at( 0 ).latitude( GeoDataCoordinates::Degree ), 49.25 );
+    QCOMPARE( lineString->at( 1 ).longitude( GeoDataCoordinates::Degree ), -122.207881 );
+    QCOMPARE( lineString->at( 1 ).latitude( GeoDataCoordinates::Degree ), 37.371915 );
+    QCOMPARE( lineString->at( 1 ).altitude(), 156.0 );
+
+    delete dataDocument;
+}
+
+void TestKmlCoordinates::pointTest()
+{
+    const QString content = placemarkContent( "<Point><coordinates> 13.377778,52.516389,34 </coordinates></Point>" );
+    GeoDataDocument* dataDocument = parseKml( content );
+    QCOMPARE( dataDocument->placemarkList().size(), 1 );
+    GeoDataPlacemark* placemark = dataDocument->placemarkList().at( 0 );
+    QCOMPARE( placemark->geometry()->geometryId(), GeoDataPointId );
+    const GeoDataCoordinates coordinates = placemark->coordinate();
+    QCOMPARE( coordinates.longitude( GeoDataCoordinates::Degree ), 13.377778 );
+    QCOMPARE( coordinates.latitude( GeoDataCoordinates::Degree ), 52.516389 );
+    QCOMPARE( coordinates.altitude(), 34.0 );
+
+    delete dataDocument;
+}
+
+void TestKmlCoordinates::trackTest()
+{
+    const QString content = placemarkContent( "<gx:Track>"
+                                              "<gx:coord>-122.207881 37.371915 156.000000</gx:coord>"
+                                              "<gx:coord> -122.205712  37.373288 </gx:coord>"
+                                              "</gx:Track>" );
+    GeoDataDocument* dataDocument = parseKml( content );
+    QCOMPARE( dataDocument->placemarkList().size(), 1 );
+    GeoDataPlacemark* placemark = dataDocument->placemarkList().at( 0 );
+    QCOMPARE( placemark->geometry()->geometryId(), GeoDataTrackId );
+    const GeoDataTrack* track = static_cast<const GeoDataTrack*>( placemark->geometry() );
+    QCOMPARE( track->size(), 2 );
+
+    const GeoDataCoordinates first = track->coordinatesList().at( 0 );
+    QCOMPARE( first.longitude( GeoDataCoordinates::Degree ), -122.207881 );
+    QCOMPARE( first.latitude( GeoDataCoordinates::Degree ), 37.371915 );
+    QCOMPARE( first.altitude(), 156.0 );
+
+    const GeoDataCoordinates second = track->coordinatesList().at( 1 );
+    QCOMPARE( second.longitude( GeoDataCoordinates::Degree ), -122.205712 );
+    QCOMPARE( second.latitude( GeoDataCoordinates::Degree ), 37.373288 );
+    QCOMPARE( second.altitude(), 0.0 );
+
+    delete dataDocument;
+}
+
+QTEST_MAIN( TestKmlCoordinates )
+
+#include "TestKmlCoordinates.moc"
@@ -0,0 +1,288 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtTest/QtTest>
+
+#include "TileArchive.h"
+
+namespace Marble
+{
+
+class TileArchiveTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void init();
+    void cleanup();
+
+    void insert();
+    void replace();
+    void remove();
+    void reopen();
+    void reopenWithoutIndex();
+    void discardIncompleteRecord();
+    void compact();
+    void shrink();
+    void sharedBetweenInstances();
+    void archiveForFile();
+
+ private:
+    QString m_filePath;
+};
+
+void TileArchiveTest::init()
+{
+    const QString directory = QDir::tempPath() + QString( "/marble-tilearchivetest-%1" ).arg( QCoreApplication::applicationPid() );
+    QDir::root().mkpath( directory );
+    m_filePath = directory + '/' + TileArchive::fileName();
+}
+
+void TileArchiveTest::cleanup()
+{
+    QFile::remove( m_filePath );
+    QFile::remove( m_filePath + ".index" );
+    QFile::remove( m_filePath + ".lock" );
+    QDir::root().rmdir( QFileInfo( m_filePath ).absolutePath() );
+}
+
+void TileArchiveTest::insert()
+{
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+    QCOMPARE( archive.count(), 0 );
+    QVERIFY( !archive.contains( "0/000000/000000_000000.jpg" ) );
+    QVERIFY( archive.data( "0/000000/000000_000000.jpg" ).isNull() );
+    QVERIFY( !archive.lastModified( "0/000000/000000_000000.jpg" ).isValid() );
+
+    QVERIFY( archive.insert( "0/000000/000000_000000.jpg", "first" ) );
+    QVERIFY( archive.insert( "0/000000/000000_000001.jpg", "second" ) );
+
+    QCOMPARE( archive.count(), 2 );
+    QVERIFY( archive.contains( "0/000000/000000_000000.jpg" ) );
+    QCOMPARE( archive.data( "0/000000/000000_000000.jpg" ), QByteArray( "first" ) );
+    QCOMPARE( archive.data( "0/000000/000000_000001.jpg" ), QByteArray( "second" ) );
+    QVERIFY( archive.lastModified( "0/000000/000000_000000.jpg" ).isValid() );
+    QCOMPARE( archive.size(), QFileInfo( m_filePath ).size() );
+}
+
+void TileArchiveTest::replace()
+{
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+
+    QVERIFY( archive.insert( "1/2/3.png", "old" ) );
+    QVERIFY( archive.insert( "1/2/3.png", "new" ) );
+
+    QCOMPARE( archive.count(), 1 );
+    QCOMPARE( archive.data( "1/2/3.png" ), QByteArray( "new" ) );
+}
+
+void TileArchiveTest::remove()
+{
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+
+    QVERIFY( archive.insert( "1/2/3.png", "tile" ) );
+    QVERIFY( archive.remove( "1/2/3.png" ) );
+    QVERIFY( !archive.remove( "1/2/3.png" ) );
+
+    QCOMPARE( archive.count(), 0 );
+    QVERIFY( archive.data( "1/2/3.png" ).isNull() );
+}
+
+void TileArchiveTest::reopen()
+{
+    {
+        TileArchive archive( m_filePath );
+        QVERIFY( archive.open() );
+        QVERIFY( archive.insert( "1/0/0.png", "a" ) );
+        QVERIFY( archive.insert( "1/0/1.png", "b" ) );
+        QVERIFY( archive.flush() );
+        QVERIFY( QFile::copy( m_filePath + ".index", m_filePath + ".index.old" ) );
+
+        // stored after the index was saved
+        QVERIFY( archive.insert( "1/1/0.png", "c" ) );
+        QVERIFY( archive.remove( "1/0/0.png" ) );
+    }
+
+    // pretend that the archive wasn't closed properly
+    QVERIFY( QFile::remove( m_filePath + ".index" ) );
+    QVERIFY( QFile::rename( m_filePath + ".index.old", m_filePath + ".index" ) );
+
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+    QCOMPARE( archive.count(), 2 );
+    QVERIFY( archive.data( "1/0/0.png" ).isNull() );
+    QCOMPARE( archive.data( "1/0/1.png" ), QByteArray( "b" ) );
+    QCOMPARE( archive.data( "1/1/0.png" ), QByteArray( "c" ) );
+}
+
+void TileArchiveTest::reopenWithoutIndex()
+{
+    {
+        TileArchive archive( m_filePath );
+        QVERIFY( archive.open() );
+        QVERIFY( archive.insert( "1/0/0.png", "a" ) );
+        QVERIFY( archive.insert( "1/0/1.png", "b" ) );
+    }
+
+    QVERIFY( QFile::remove( m_filePath + ".index" ) );
+
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+    QCOMPARE( archive.count(), 2 );
+    QCOMPARE( archive.data( "1/0/0.png" ), QByteArray( "a" ) );
+    QCOMPARE( archive.data( "1/0/1.png" ), QByteArray( "b" ) );
+}
+
+void TileArchiveTest::discardIncompleteRecord()
+{
+    qint64 completeSize = 0;
+    {
+        TileArchive archive( m_filePath );
+        QVERIFY( archive.open() );
+        QVERIFY( archive.insert( "1/0/0.png", "a" ) );
+        completeSize = archive.size();
+        QVERIFY( archive.insert( "1/0/1.png", "interrupted" ) );
+    }
+
+    QFile::remove( m_filePath + ".index" );
+    {
+        QFile file( m_filePath );
+        QVERIFY( file.resize( file.size() - 3 ) );
+    }
+
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+    QCOMPARE( archive.count(), 1 );
+    QCOMPARE( archive.size(), completeSize );
+    QCOMPARE( archive.data( "1/0/0.png" ), QByteArray( "a" ) );
+
+    // the archive stays usable
+    QVERIFY( archive.insert( "1/0/1.png", "b" ) );
+    QCOMPARE( archive.data( "1/0/1.png" ), QByteArray( "b" ) );
+}
+
+void TileArchiveTest::compact()
+{
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+
+    QVERIFY( archive.insert( "1/0/0.png", "replaced" ) );
+    QVERIFY( archive.insert( "1/0/0.png", "a" ) );
+    QVERIFY( archive.insert( "2/0/0.png", "removed" ) );
+    QVERIFY( archive.remove( "2/0/0.png" ) );
+    QVERIFY( archive.insert( "3/0/0.png", "b" ) );
+    QVERIFY( archive.insert( "4/0/0.png", "c" ) );
+
+    const qint64 oldSize = archive.size();
+    QVERIFY( archive.compact() );
+    QVERIFY( archive.size() < oldSize );
+    QCOMPARE( archive.count(), 3 );
+    QCOMPARE( archive.data( "1/0/0.png" ), QByteArray( "a" ) );
+    QCOMPARE( archive.data( "3/0/0.png" ), QByteArray( "b" ) );
+    QCOMPARE( archive.data( "4/0/0.png" ), QByteArray( "c" ) );
+
+    QVERIFY( archive.compact( 3 ) );
+    QCOMPARE( archive.count(), 2 );
+    QVERIFY( archive.data( "4/0/0.png" ).isNull() );
+    QCOMPARE( archive.data( "3/0/0.png" ), QByteArray( "b" ) );
+
+    TileArchive reopened( m_filePath );
+    QVERIFY( reopened.open() );
+    QCOMPARE( reopened.count(), 2 );
+    QCOMPARE( reopened.data( "1/0/0.png" ), QByteArray( "a" ) );
+}
+
+void TileArchiveTest::shrink()
+{
+    TileArchive archive( m_filePath );
+    QVERIFY( archive.open() );
+
+    const QByteArray data( 100, 'x' );
+    QVERIFY( archive.insert( "0/0/0.png", data ) );
+    QVERIFY( archive.insert( "4/0/0.png", data ) );
+    QVERIFY( archive.insert( "4/0/1.png", data ) );
+    QVERIFY( archive.insert( "5/0/0.png", data ) );
+
+    // all tiles are younger than the given time
+    const qint64 oldSize = archive.size();
+    QVERIFY( !archive.shrink( oldSize - 150, 3, QDateTime::currentDateTime().addSecs( -3600 ) ) );
+    QCOMPARE( archive.count(), 4 );
+
+    QVERIFY( archive.shrink( oldSize - 150, 3 ) );
+    QVERIFY( archive.size() <= oldSize - 150 );
+    QCOMPARE( archive.count(), 2 );
+    QCOMPARE( archive.data( "0/0/0.png" ), data );
+
+    // base tiles are never removed
+    QVERIFY( !archive.shrink( 0, 3 ) );
+    QCOMPARE( archive.count(), 1 );
+    QCOMPARE( archive.data( "0/0/0.png" ), data );
+}
+
+void TileArchiveTest::sharedBetweenInstances()
+{
+    // two instances behave like two processes using the same archive
+    TileArchive first( m_filePath );
+    TileArchive second( m_filePath );
+    QVERIFY( first.open() );
+    QVERIFY( second.open() );
+
+    QVERIFY( first.insert( "1/0/0.png", "a" ) );
+    QVERIFY( second.insert( "1/0/1.png", "b" ) );
+    QCOMPARE( second.data( "1/0/0.png" ), QByteArray( "a" ) );
+
+    QVERIFY( first.insert( "1/0/2.png", "c" ) );
+    QCOMPARE( first.data( "1/0/1.png" ), QByteArray( "b" ) );
+    QCOMPARE( first.count(), 3 );
+
+    // the other instance picks up the compacted archive
+    QVERIFY( first.remove( "1/0/0.png" ) );
+    QVERIFY( first.compact() );
+    QVERIFY( second.insert( "1/0/3.png", "d" ) );
+    QCOMPARE( second.count(), 3 );
+    QVERIFY( second.data( "1/0/0.png" ).isNull() );
+    QCOMPARE( second.data( "1/0/2.png" ), QByteArray( "c" ) );
+
+    QVERIFY( first.flush() );
+    QCOMPARE( first.data( "1/0/3.png" ), QByteArray( "d" ) );
+}
+
+void TileArchiveTest::archiveForFile()
+{
+    const QString directory = QFileInfo( m_filePath ).absolutePath();
+
+    QVERIFY( TileArchive::archiveForFile( directory + "/1/0/0.png", 0 ) == 0 );
+
+    TileArchive *const archive = TileArchive::create( directory );
+    QVERIFY( archive );
+    QVERIFY( TileArchive::archive( directory ) == archive );
+
+    QString name;
+    QVERIFY( TileArchive::archiveForFile( directory + "/1/0/0.png", &name ) == archive );
+    QCOMPARE( name, QString( "1/0/0.png" ) );
+    QVERIFY( TileArchive::archiveForFile( directory + "/../1/0/0.png", &name ) == 0 );
+
+    QVERIFY( archive->insert( name, "a" ) );
+    QCOMPARE( archive->data( "1/0/0.png" ), QByteArray( "a" ) );
+    archive->clear();
+    QCOMPARE( archive->count(), 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::TileArchiveTest )
+
+#include "TileArchiveTest.moc"
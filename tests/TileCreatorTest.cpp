@@ -0,0 +1,157 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2026 agent <agent@local>
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtGui/QImage>
+#include <QtTest/QtTest>
+
+#include "MarbleGlobal.h"
+#include "TileCreator.h"
+
+namespace Marble
+{
+
+static const int tileSize = c_defaultTileSize;
+
+class PatternTileCreatorSource : public TileCreatorSource
+{
+ public:
+    virtual QSize fullImageSize() const
+    {
+        // results in a maximum tile level of 1 with 2 x 4 tiles
+        return QSize( 4 * tileSize, 2 * tileSize );
+    }
+
+    virtual QImage tile( int n, int m, int tileLevel )
+    {
+        Q_UNUSED( tileLevel );
+        return patternTile( n, m );
+    }
+
+    static QImage patternTile( int n, int m )
+    {
+        QImage image( tileSize, tileSize, QImage::Format_RGB32 );
+        for ( int y = 0; y < tileSize; ++y ) {
+            QRgb *line = (QRgb*) image.scanLine( y );
+            for ( int x = 0; x < tileSize; ++x ) {
+                line[x] = qRgb( ( 7 * x + 31 * n ) % 256, ( 13 * y + 17 * m ) % 256, ( x ^ y ) % 256 );
+            }
+        }
+
+        return image;
+    }
+};
+
+class TileCreatorTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void init();
+    void cleanup();
+
+    void createPyramid();
+
+ private:
+    QString tileName( int tileLevel, int n, int m ) const;
+    static QImage mergedTile( const QImage &topLeft, const QImage &topRight,
+                              const QImage &bottomLeft, const QImage &bottomRight );
+    static void removeDirectory( const QString &path );
+
+    QString m_targetDir;
+};
+
+void TileCreatorTest::init()
+{
+    m_targetDir = QDir::tempPath() + QString( "/marble-tilecreatortest-%1/" ).arg( QCoreApplication::applicationPid() );
+    removeDirectory( m_targetDir );
+}
+
+void TileCreatorTest::cleanup()
+{
+    removeDirectory( m_targetDir );
+}
+
+QString TileCreatorTest::tileName( int tileLevel, int n, int m ) const
+{
+    return m_targetDir + QString( "%1/%2/%2_%3.png" )
+                         .arg( tileLevel )
+                         .arg( n, tileDigits, 10, QChar( '0' ) )
+                         .arg( m, tileDigits, 10, QChar( '0' ) );
+}
+
+QImage TileCreatorTest::mergedTile( const QImage &topLeft, const QImage &topRight,
+                                    const QImage &bottomLeft, const QImage &bottomRight )
+{
+    // The serial algorithm: every other pixel of each quadrant
+    const int half = tileSize / 2;
+    QImage tile( tileSize, tileSize, QImage::Format_RGB32 );
+    for ( int y = 0; y < tileSize; ++y ) {
+        for ( int x = 0; x < tileSize; ++x ) {
+            const QImage &quadrant = y < half ? ( x < half ? topLeft : topRight )
+                                              : ( x < half ? bottomLeft : bottomRight );
+            const int sourceX = 2 * ( x < half ? x : x - half );
+            const int sourceY = 2 * ( y < half ? y : y - half );
+            tile.setPixel( x, y, quadrant.pixel( sourceX, sourceY ) );
+        }
+    }
+
+    return tile;
+}
+
+void TileCreatorTest::removeDirectory( const QString &path )
+{
+    const QFileInfoList entries = QDir( path ).entryInfoList( QDir::AllEntries | QDir::NoDotAndDotDot );
+    foreach ( const QFileInfo &entry, entries ) {
+        if ( entry.isDir() ) {
+            removeDirectory( entry.absoluteFilePath() );
+        } else {
+            QFile::remove( entry.absoluteFilePath() );
+        }
+    }
+    QDir::root().rmdir( path );
+}
+
+void TileCreatorTest::createPyramid()
+{
+    TileCreator creator( new PatternTileCreatorSource, "false", m_targetDir );
+    creator.setTileFormat( "png" );
+    creator.start();
+    QVERIFY( creator.wait( 60000 ) );
+
+    // the highest level holds the source tiles unchanged
+    for ( int n = 0; n < 2; ++n ) {
+        for ( int m = 0; m < 4; ++m ) {
+            const QImage tile( tileName( 1, n, m ) );
+            QCOMPARE( tile.size(), QSize( tileSize, tileSize ) );
+            QCOMPARE( tile.convertToFormat( QImage::Format_RGB32 ), PatternTileCreatorSource::patternTile( n, m ) );
+        }
+    }
+
+    // the lower level matches the one built tile by tile
+    for ( int m = 0; m < 2; ++m ) {
+        const QImage expected = mergedTile( PatternTileCreatorSource::patternTile( 0, 2 * m ),
+                                            PatternTileCreatorSource::patternTile( 0, 2 * m + 1 ),
+                                            PatternTileCreatorSource::patternTile( 1, 2 * m ),
+                                            PatternTileCreatorSource::patternTile( 1, 2 * m + 1 ) );
+        const QImage tile( tileName( 0, 0, m ) );
+        QCOMPARE( tile.convertToFormat( QImage::Format_RGB32 ), expected );
+    }
+
+    QVERIFY( !QFileInfo( tileName( 0, 1, 0 ) ).exists() );
+}
+
+}
+
+QTEST_MAIN( Marble::TileCreatorTest )
+
+#include "TileCreatorTest.moc"